@@ -0,0 +1,61 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+if(MOBILE_INFERENCE OR RPI)
+    return()
+endif()
+
+include (ExternalProject)
+
+# NOTE: lz4 is needed when linking with recordio
+
+set(LZ4_SOURCES_DIR ${THIRD_PARTY_PATH}/lz4)
+set(LZ4_INSTALL_DIR ${THIRD_PARTY_PATH}/install/lz4)
+set(LZ4_INCLUDE_DIR "${LZ4_INSTALL_DIR}/include" CACHE PATH "lz4 include directory." FORCE)
+
+set(LZ4_LIBRARIES "${LZ4_INSTALL_DIR}/lib/liblz4.a")
+
+ExternalProject_Add(
+    extern_lz4
+    GIT_REPOSITORY  "https://github.com/lz4/lz4"
+    GIT_TAG         "v1.8.3"
+    PREFIX          ${LZ4_SOURCES_DIR}
+    UPDATE_COMMAND  ""
+    # The CMakeLists.txt is in a subdirectory, and SOURCE_SUBDIR requires
+    # CMake 3.7.
+    CONFIGURE_COMMAND ${CMAKE_COMMAND}
+                    ${LZ4_SOURCES_DIR}/src/extern_lz4/contrib/cmake_unofficial
+                    -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+                    -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+                    -DCMAKE_CXX_FLAGS=${CMAKE_CXX_FLAGS}
+                    -DCMAKE_C_FLAGS=${CMAKE_C_FLAGS}
+                    -DCMAKE_INSTALL_PREFIX=${LZ4_INSTALL_DIR}
+                    -DCMAKE_INSTALL_LIBDIR=${LZ4_INSTALL_DIR}/lib
+                    -DCMAKE_POSITION_INDEPENDENT_CODE=ON
+                    -DBUILD_SHARED_LIBS=OFF
+                    -DBUILD_STATIC_LIBS=ON
+                    -DLZ4_BUILD_LEGACY_LZ4C=OFF
+                    -DCMAKE_BUILD_TYPE=${THIRD_PARTY_BUILD_TYPE}
+                    ${EXTERNAL_OPTIONAL_ARGS}
+    CMAKE_CACHE_ARGS -DCMAKE_INSTALL_PREFIX:PATH=${LZ4_INSTALL_DIR}
+                     -DCMAKE_INSTALL_LIBDIR:PATH=${LZ4_INSTALL_DIR}/lib
+                     -DCMAKE_POSITION_INDEPENDENT_CODE:BOOL=ON
+                     -DCMAKE_BUILD_TYPE:STRING=${THIRD_PARTY_BUILD_TYPE}
+)
+
+add_library(lz4 STATIC IMPORTED GLOBAL)
+set_property(TARGET lz4 PROPERTY IMPORTED_LOCATION ${LZ4_LIBRARIES})
+
+include_directories(${LZ4_INCLUDE_DIR})
+add_dependencies(lz4 extern_lz4)
@@ -115,6 +115,18 @@ if(NOT MOBILE_INFERENCE AND NOT RPI)
     DSTS ${dst_dir} ${dst_dir}/lib
     DEPS snappystream)
 
+  set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/lz4")
+  copy(lz4_lib
+    SRCS ${LZ4_INCLUDE_DIR} ${LZ4_LIBRARIES}
+    DSTS ${dst_dir} ${dst_dir}/lib
+    DEPS lz4)
+
+  set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zstd")
+  copy(zstd_lib
+    SRCS ${ZSTD_INCLUDE_DIR} ${ZSTD_LIBRARIES}
+    DSTS ${dst_dir} ${dst_dir}/lib
+    DEPS zstd)
+
   set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zlib")
   copy(zlib_lib
     SRCS ${ZLIB_INCLUDE_DIR} ${ZLIB_LIBRARIES}
@@ -160,8 +172,10 @@ endif()
 set(module "inference")
 copy(inference_lib DEPS ${inference_deps}
   SRCS ${src_dir}/${module}/*.h ${PADDLE_BINARY_DIR}/paddle/fluid/inference/libpaddle_fluid.*
-       ${src_dir}/${module}/api/paddle_inference_api.h ${src_dir}/${module}/api/demo_ci
+       ${src_dir}/${module}/api/paddle_inference_api.h ${src_dir}/${module}/api/batching_predictor.h
+       ${src_dir}/${module}/api/predictor_pool.h ${src_dir}/${module}/api/demo_ci
   DSTS ${dst_dir}/${module} ${dst_dir}/${module} ${dst_dir}/${module} ${dst_dir}/${module}
+       ${dst_dir}/${module} ${dst_dir}/${module}
 )
 
 set(module "platform")
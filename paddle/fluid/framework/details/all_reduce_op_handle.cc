@@ -111,29 +111,13 @@ void AllReduceOpHandle::RunImpl() {
       PADDLE_THROW("Not compiled with CUDA");
 #endif
     } else {  // Special handle CPU only Operator's gradient. Like CRF
-      auto &trg = *this->local_scopes_[0]
-                       ->FindVar(kLocalExecScopeName)
-                       ->Get<Scope *>()
-                       ->FindVar(out_var_handles[0]->name_)
-                       ->GetMutable<framework::LoDTensor>();
-
-      // Reduce All Tensor to trg in CPU
-      ReduceLoDTensor func(lod_tensors, &trg);
-      VisitDataType(ToDataType(lod_tensors[0]->type()), func);
-
-      for (size_t i = 1; i < local_scopes_.size(); ++i) {
-        auto &scope =
-            *local_scopes_[i]->FindVar(kLocalExecScopeName)->Get<Scope *>();
-        auto &p = places_[i];
-        auto *var = scope.FindVar(out_var_handles[i]->name_);
-        auto *dev_ctx = dev_ctxes_[p];
-
-        RunAndRecordEvent(p, [&trg, var, dev_ctx, p] {
-          auto &tensor_gpu = *var->GetMutable<framework::LoDTensor>();
-          auto &tensor_cpu = trg;
-          TensorCopy(tensor_cpu, p, *dev_ctx, &tensor_gpu);
-        });
+      // The inputs are also the outputs, so they are reduced in place.
+      std::vector<LoDTensor *> tensors;
+      for (auto *t : lod_tensors) {
+        tensors.emplace_back(const_cast<LoDTensor *>(t));
       }
+      AllReduceLoDTensors func(tensors, ThreadPool::GetInstance()->Threads());
+      VisitDataType(ToDataType(lod_tensors[0]->type()), func);
     }
   }
 }
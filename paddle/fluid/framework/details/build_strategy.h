@@ -55,6 +55,14 @@ struct BuildStrategy {
   std::string debug_graphviz_path_{""};
 
   bool enable_data_balance_{false};
+
+  // With kAllReduce, pack the dense gradients into buckets of about
+  // fuse_all_reduce_bucket_mb_ MB, in the order they are generated, and
+  // all-reduce every bucket as one op. Models with many small parameters
+  // then pay the cost of launching and synchronizing an all-reduce once per
+  // bucket instead of once per gradient.
+  bool fuse_all_reduce_ops_{false};
+  int fuse_all_reduce_bucket_mb_{32};
 };
 
 }  // namespace details
@@ -26,6 +26,8 @@ struct ExecutionStrategy {
   bool allow_op_delay_{false};
   size_t num_iteration_per_drop_scope_{100};
   ExecutorType type_{kDefault};
+  // Run the ops by a WorkStealingThreadPool instead of a single task queue.
+  bool use_work_stealing_{false};
 };
 
 }  //  namespace details
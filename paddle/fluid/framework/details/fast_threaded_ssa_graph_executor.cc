@@ -29,9 +29,14 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
       local_scopes_(local_scopes),
       places_(places),
       graph_(std::move(graph)),
-      pool_(strategy.num_threads_ +
-            1),  // add one more thread for generate op_deps
       fetch_ctxs_(places) {
+  // add one more thread for generate op_deps
+  if (strategy.use_work_stealing_) {
+    work_stealing_pool_.reset(
+        new WorkStealingThreadPool(strategy.num_threads_ + 1));
+  } else {
+    pool_.reset(new ::ThreadPool(strategy.num_threads_ + 1));
+  }
   auto &ops = graph_->Get<details::GraphOps>("ops");
 
   for (auto &op : ops) {
@@ -125,7 +130,7 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
     OpHandleBase *op, BlockingQueue<size_t> *complete_q) {
   ++remaining_;
-  this->pool_.enqueue([=] {
+  this->Enqueue([=] {
     OpHandleBase *op_to_run = op;
     size_t complete = 0;
     while (op_to_run != nullptr) {
@@ -158,7 +163,7 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
   });
 }
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
-  atomic_op_deps_ = pool_.enqueue([&] {
+  atomic_op_deps_ = Enqueue([&] {
     std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps =
         new std::unordered_map<OpHandleBase *, std::atomic<int>>;
     for (auto &pair : op_deps_) {
@@ -20,6 +20,7 @@
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
 
 namespace paddle {
 namespace framework {
@@ -45,7 +46,9 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
   std::unordered_map<OpHandleBase *, int> op_deps_;
   std::vector<OpHandleBase *> bootstrap_ops_;
 
-  ::ThreadPool pool_;
+  // Only one of them is created, according to strategy_.use_work_stealing_.
+  std::unique_ptr<::ThreadPool> pool_;
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_pool_;
   platform::DeviceContextPool fetch_ctxs_;
   std::atomic<int> remaining_;
 
@@ -54,6 +57,12 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   void PrepareAtomicOpDeps();
 
+  template <typename Callback>
+  auto Enqueue(Callback fn) -> std::future<decltype(fn())> {
+    return work_stealing_pool_ ? work_stealing_pool_->Enqueue(fn)
+                               : pool_->enqueue(fn);
+  }
+
   std::future<
       std::unique_ptr<std::unordered_map<OpHandleBase *, std::atomic<int>>>>
       atomic_op_deps_;
@@ -0,0 +1,160 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+#ifdef PADDLE_WITH_CUDA
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const std::vector<std::string> &grad_names,
+    const platform::NCCLContextMap *ctxs)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      grad_names_(grad_names),
+      buffers_(places.size()),
+      nccl_ctxs_(ctxs) {
+  if (nccl_ctxs_) {
+    for (auto &p : places_) {
+      this->dev_ctxes_[p] = nccl_ctxs_->DevCtx(p);
+    }
+  }
+}
+#else
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const std::vector<std::string> &grad_names)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      grad_names_(grad_names),
+      buffers_(places.size()) {}
+#endif
+
+void FusedAllReduceOpHandle::RunImpl() {
+  platform::RecordEvent r("fused_all_reduce", nullptr);
+  WaitInputVarGenerated();
+
+  // grads[i][j] is the gradient grad_names_[j] on places_[i].
+  std::vector<std::vector<LoDTensor *>> grads(places_.size());
+  for (size_t i = 0; i < local_scopes_.size(); ++i) {
+    auto &local_scope =
+        *local_scopes_[i]->FindVar(kLocalExecScopeName)->Get<Scope *>();
+    for (auto &name : grad_names_) {
+      auto *var = local_scope.FindVar(name);
+      PADDLE_ENFORCE_NOT_NULL(var, "Cannot find gradient %s", name);
+      grads[i].emplace_back(var->GetMutable<LoDTensor>());
+    }
+  }
+
+  auto type = grads[0][0]->type();
+  size_t size_of_type = SizeOfType(type);
+  std::vector<int64_t> offsets{0};
+  for (size_t j = 0; j < grad_names_.size(); ++j) {
+    for (size_t i = 0; i < places_.size(); ++i) {
+      PADDLE_ENFORCE_EQ(grads[i][j]->numel(), grads[0][j]->numel(),
+                        "The gradient %s differs between places.",
+                        grad_names_[j]);
+      PADDLE_ENFORCE(grads[i][j]->type() == type,
+                     "The gradients of a bucket must have the same type.");
+    }
+    offsets.push_back(offsets.back() + grads[0][j]->numel());
+  }
+  for (size_t i = 0; i < places_.size(); ++i) {
+    buffers_[i].Resize({offsets.back()});
+    buffers_[i].mutable_data(places_[i], type);
+  }
+
+  if (platform::is_gpu_place(places_[0])) {
+#ifdef PADDLE_WITH_CUDA
+    PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+    // The copies are issued on the stream of NCCL, so they are ordered with
+    // the all-reduce without extra synchronization.
+    int dtype = platform::ToNCCLDataType(type);
+    size_t numel = static_cast<size_t>(offsets.back());
+    std::vector<std::function<void()>> all_reduce_calls;
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto &p = places_[i];
+      auto *dev_ctx = dev_ctxes_.at(p);
+      for (size_t j = 0; j < grad_names_.size(); ++j) {
+        Tensor slice = buffers_[i].Slice(offsets[j], offsets[j + 1]);
+        TensorCopy(*grads[i][j], p, *dev_ctx, &slice);
+      }
+      void *buffer = buffers_[i].data<void>();
+      int dev_id = boost::get<platform::CUDAPlace>(p).device;
+      auto &nccl_ctx = nccl_ctxs_->at(dev_id);
+      auto stream = nccl_ctx.stream();
+      auto comm = nccl_ctx.comm_;
+      all_reduce_calls.emplace_back([=] {
+        PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+            buffer, buffer, numel, static_cast<ncclDataType_t>(dtype), ncclSum,
+            comm, stream));
+      });
+    }
+    this->RunAndRecordEvent([&] {
+      {
+        platform::NCCLGroupGuard guard;
+        for (auto &call : all_reduce_calls) {
+          call();
+        }
+      }
+      for (size_t i = 0; i < places_.size(); ++i) {
+        auto *dev_ctx = dev_ctxes_.at(places_[i]);
+        for (size_t j = 0; j < grad_names_.size(); ++j) {
+          Tensor slice = buffers_[i].Slice(offsets[j], offsets[j + 1]);
+          slice.Resize(grads[i][j]->dims());
+          TensorCopy(slice, places_[i], *dev_ctx, grads[i][j]);
+        }
+      }
+    });
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    std::vector<LoDTensor *> buffers;
+    for (size_t i = 0; i < places_.size(); ++i) {
+      char *buffer = static_cast<char *>(buffers_[i].data<void>());
+      for (size_t j = 0; j < grad_names_.size(); ++j) {
+        memcpy(buffer + offsets[j] * size_of_type, grads[i][j]->data<void>(),
+               grads[i][j]->numel() * size_of_type);
+      }
+      buffers.emplace_back(&buffers_[i]);
+    }
+    AllReduceLoDTensors func(buffers, ThreadPool::GetInstance()->Threads());
+    VisitDataType(ToDataType(type), func);
+    for (size_t i = 0; i < places_.size(); ++i) {
+      const char *buffer = static_cast<const char *>(buffers_[i].data<void>());
+      for (size_t j = 0; j < grad_names_.size(); ++j) {
+        memcpy(grads[i][j]->data<void>(), buffer + offsets[j] * size_of_type,
+               grads[i][j]->numel() * size_of_type);
+      }
+    }
+  }
+}
+
+std::string FusedAllReduceOpHandle::Name() const { return "fused_all_reduce"; }
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -21,6 +21,7 @@
 #include "paddle/fluid/framework/details/broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/details/data_balance_op_handle.h"
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_pass.h"
 #include "paddle/fluid/framework/details/reduce_op_handle.h"
 #include "paddle/fluid/framework/details/rpc_op_handle.h"
@@ -349,7 +350,33 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
   size_t cur_device_id = 0;
   bool is_forwarding = true;
 
+  // Dense gradients waiting to be all-reduced together. A bucket is inserted
+  // once it is full, so it runs as soon as its last gradient is generated.
+  std::vector<std::string> bucket;
+  std::unordered_set<std::string> bucket_set;
+  int64_t bucket_bytes = 0;
+  proto::VarType::Type bucket_type = proto::VarType::FP32;
+  const int64_t max_bucket_bytes =
+      static_cast<int64_t>(strategy_.fuse_all_reduce_bucket_mb_) << 20;
+  auto flush_bucket = [&] {
+    if (bucket.size() == 1) {
+      InsertAllReduceOp(&result, bucket[0]);
+    } else if (!bucket.empty()) {
+      InsertFusedAllReduceOp(&result, bucket);
+    }
+    bucket.clear();
+    bucket_set.clear();
+    bucket_bytes = 0;
+  };
+
   for (ir::Node *node : sorted_ops) {
+    // An op must see the all-reduced gradients.
+    for (ir::Node *in : node->inputs) {
+      if (bucket_set.count(in->Name())) {
+        flush_bucket();
+        break;
+      }
+    }
     if (boost::get<int>(
             node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName())) ==
         static_cast<int>(OpRole::kRPC)) {
@@ -420,6 +447,24 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
                     if (IsSparseGradient(g_name)) {
                       CreateReduceOp(&result, g_name, 0);
                       CreateBroadcastOp(&result, g_name, 0);
+                    } else if (strategy_.fuse_all_reduce_ops_) {
+                      int64_t bytes = GetGradientBytes(g_name);
+                      auto type = all_vars_.at(g_name)->GetDataType();
+                      if (bytes == 0 || bytes >= max_bucket_bytes) {
+                        // Too large to gain from fusion, or of unknown size.
+                        InsertAllReduceOp(&result, g_name);
+                        break;
+                      }
+                      if (!bucket.empty() && type != bucket_type) {
+                        flush_bucket();
+                      }
+                      bucket.push_back(g_name);
+                      bucket_set.insert(g_name);
+                      bucket_type = type;
+                      bucket_bytes += bytes;
+                      if (bucket_bytes >= max_bucket_bytes) {
+                        flush_bucket();
+                      }
                     } else {
                       InsertAllReduceOp(&result, g_name);
                     }
@@ -437,6 +482,8 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
     }
   }
 
+  flush_bucket();
+
   bool use_gpu = false;
 #ifdef PADDLE_WITH_CUDA
   use_gpu = nccl_ctxs_ != nullptr;
@@ -555,6 +602,46 @@ void MultiDevSSAGraphBuilder::InsertAllReduceOp(ir::Graph *result,
   }
 }
 
+void MultiDevSSAGraphBuilder::InsertFusedAllReduceOp(
+    ir::Graph *result, const std::vector<std::string> &ogs) const {
+#ifdef PADDLE_WITH_CUDA
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_, ogs, nccl_ctxs_));
+#else
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_, ogs));
+#endif
+  auto *op_handle = result->Get<GraphOps>(kGraphOps).back().get();
+
+  for (size_t i = 0; i < places_.size(); ++i) {
+    auto &p = places_[i];
+    SetCommunicationContext(op_handle, p);
+    for (auto &og : ogs) {
+      auto &vars = result->Get<GraphVars>(kGraphVars)[i][og];
+      PADDLE_ENFORCE(!vars.empty());
+      op_handle->AddInput(vars.back().get());
+
+      auto var =
+          new VarHandle(result->CreateEmptyNode(og, ir::Node::Type::kVariable),
+                        vars.size(), i, og, p);
+      vars.emplace_back(var);
+      op_handle->AddOutput(var);
+    }
+  }
+}
+
+int64_t MultiDevSSAGraphBuilder::GetGradientBytes(const std::string &og) const {
+  auto *var_desc = all_vars_.at(og);
+  int64_t numel =
+      framework::product(framework::make_ddim(var_desc->GetShape()));
+  if (numel <= 0) {
+    return 0;
+  }
+  return numel * SizeOfType(ToTypeIndex(var_desc->GetDataType()));
+}
+
 void MultiDevSSAGraphBuilder::InsertDataBalanceOp(
     ir::Graph *result, const std::vector<std::string> &datas) const {
 #ifdef PADDLE_WITH_CUDA
@@ -91,6 +91,13 @@ class MultiDevSSAGraphBuilder : public ir::Pass {
 
   void InsertAllReduceOp(ir::Graph *result, const std::string &og) const;
 
+  void InsertFusedAllReduceOp(ir::Graph *result,
+                              const std::vector<std::string> &ogs) const;
+
+  // Returns the size in bytes of a dense gradient, or 0 if its shape is
+  // unknown.
+  int64_t GetGradientBytes(const std::string &og) const;
+
   void InsertDataBalanceOp(ir::Graph *result,
                            const std::vector<std::string> &datas) const;
 
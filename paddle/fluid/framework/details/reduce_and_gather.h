@@ -14,11 +14,14 @@
 
 #pragma once
 #include <algorithm>
+#include <future>  // NOLINT
 #include <map>
 #include <vector>
+#include "Eigen/Core"
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/threadpool.h"
 namespace paddle {
 namespace framework {
 namespace details {
@@ -53,6 +56,99 @@ struct ReduceLoDTensor {
   }
 };
 
+// dst[i] += src[i] for i in [0, n).
+template <typename T>
+inline void AddTo(const T *src, T *dst, size_t n) {
+  std::transform(src, src + n, dst, dst, [](T a, T b) -> T { return a + b; });
+}
+
+// Floating point gradients are summed with the SIMD instructions Eigen was
+// compiled with.
+template <>
+inline void AddTo<float>(const float *src, float *dst, size_t n) {
+  using Vec = Eigen::Array<float, Eigen::Dynamic, 1>;
+  Eigen::Map<Vec>(dst, n) += Eigen::Map<const Vec>(src, n);
+}
+
+template <>
+inline void AddTo<double>(const double *src, double *dst, size_t n) {
+  using Vec = Eigen::Array<double, Eigen::Dynamic, 1>;
+  Eigen::Map<Vec>(dst, n) += Eigen::Map<const Vec>(src, n);
+}
+
+/*
+ * Sums the CPU tensors and writes the sum back into every one of them.
+ *
+ * The elements are split into at most num_tasks ranges, which are reduced and
+ * broadcast on the threads of framework::ThreadPool. Each range is processed
+ * in blocks small enough to stay in cache: a block of the first tensor
+ * accumulates the other tensors, then it is copied into them. Every element
+ * is summed in the order of the tensors, no matter how the elements are
+ * split, so the result is deterministic as FLAGS_cpu_deterministic requires.
+ */
+struct AllReduceLoDTensors {
+  const std::vector<LoDTensor *> &tensors_;
+  size_t num_tasks_;
+
+  // Blocks are 16KB of float, and a task gets at least 16 blocks.
+  static constexpr size_t kBlockNumel = 4096;
+  static constexpr size_t kMinTaskNumel = 16 * kBlockNumel;
+
+  AllReduceLoDTensors(const std::vector<LoDTensor *> &tensors,
+                      size_t num_tasks)
+      : tensors_(tensors), num_tasks_(std::max<size_t>(num_tasks, 1)) {}
+
+  template <typename T>
+  void apply() const {
+    PADDLE_ENFORCE(!tensors_.empty());
+    auto &t0 = *tensors_[0];
+    for (auto *t : tensors_) {
+      PADDLE_ENFORCE(platform::is_cpu_place(t->place()));
+      PADDLE_ENFORCE_EQ(t->dims(), t0.dims());
+      PADDLE_ENFORCE_EQ(t->type(), t0.type());
+    }
+    std::vector<T *> data;
+    for (auto *t : tensors_) {
+      data.push_back(t->data<T>());
+    }
+
+    size_t numel = static_cast<size_t>(t0.numel());
+    size_t num_tasks = std::min(num_tasks_, numel / kMinTaskNumel);
+    if (num_tasks <= 1) {
+      Reduce(data, 0, numel);
+      return;
+    }
+    // Ranges are multiples of blocks, so that no cache line is shared by
+    // two tasks.
+    size_t num_blocks = (numel + kBlockNumel - 1) / kBlockNumel;
+    size_t task_numel = (num_blocks + num_tasks - 1) / num_tasks * kBlockNumel;
+    std::vector<std::future<void>> futures;
+    for (size_t begin = task_numel; begin < numel; begin += task_numel) {
+      size_t end = std::min(begin + task_numel, numel);
+      futures.emplace_back(ThreadPool::GetInstance()->Run(
+          [&data, begin, end] { Reduce(data, begin, end); }));
+    }
+    Reduce(data, 0, task_numel);
+    for (auto &f : futures) {
+      f.get();
+    }
+  }
+
+  template <typename T>
+  static void Reduce(const std::vector<T *> &data, size_t begin, size_t end) {
+    for (size_t b = begin; b < end; b += kBlockNumel) {
+      size_t n = end - b < kBlockNumel ? end - b : kBlockNumel;
+      T *acc = data[0] + b;
+      for (size_t i = 1; i < data.size(); ++i) {
+        AddTo(data[i] + b, acc, n);
+      }
+      for (size_t i = 1; i < data.size(); ++i) {
+        std::copy(acc, acc + n, data[i] + b);
+      }
+    }
+  }
+};
+
 inline void GatherSelectedRows(
     const std::vector<const SelectedRows *> &src_selecte_rows_,
     const std::vector<platform::Place> &in_places,
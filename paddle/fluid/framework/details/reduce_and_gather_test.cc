@@ -0,0 +1,125 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+class AllReduceTest : public ::testing::Test {
+ protected:
+  void Prepare(size_t num_places, int64_t numel) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> value(-1, 1);
+    tensors_.clear();
+    ptrs_.clear();
+    for (size_t i = 0; i < num_places; ++i) {
+      tensors_.emplace_back(new LoDTensor);
+      tensors_.back()->Resize({numel});
+      float* data = tensors_.back()->mutable_data<float>(platform::CPUPlace());
+      for (int64_t j = 0; j < numel; ++j) {
+        data[j] = value(rng);
+      }
+      ptrs_.push_back(tensors_.back().get());
+    }
+  }
+
+  // The sum of every element in the order of the tensors.
+  std::vector<float> SerialSum() {
+    int64_t numel = tensors_[0]->numel();
+    std::vector<float> sum(tensors_[0]->data<float>(),
+                           tensors_[0]->data<float>() + numel);
+    for (size_t i = 1; i < tensors_.size(); ++i) {
+      const float* data = tensors_[i]->data<float>();
+      for (int64_t j = 0; j < numel; ++j) {
+        sum[j] += data[j];
+      }
+    }
+    return sum;
+  }
+
+  void AllReduce(size_t num_tasks) {
+    AllReduceLoDTensors func(ptrs_, num_tasks);
+    VisitDataType(ToDataType(ptrs_[0]->type()), func);
+  }
+
+  std::vector<std::unique_ptr<LoDTensor>> tensors_;
+  std::vector<LoDTensor*> ptrs_;
+};
+
+TEST_F(AllReduceTest, MatchesSerialSum) {
+  // Not a multiple of blocks, and large enough to be split.
+  const int64_t numel = 10 * AllReduceLoDTensors::kMinTaskNumel + 123;
+  for (size_t num_tasks : {1, 3, 8}) {
+    Prepare(4, numel);
+    auto expected = SerialSum();
+    AllReduce(num_tasks);
+    for (auto* t : ptrs_) {
+      const float* data = t->data<float>();
+      for (int64_t j = 0; j < numel; ++j) {
+        // The summing order is fixed, so the results are bitwise equal.
+        ASSERT_EQ(expected[j], data[j]);
+      }
+    }
+  }
+}
+
+TEST_F(AllReduceTest, SmallTensor) {
+  Prepare(3, 7);
+  auto expected = SerialSum();
+  AllReduce(8);
+  for (auto* t : ptrs_) {
+    for (int64_t j = 0; j < 7; ++j) {
+      ASSERT_EQ(expected[j], t->data<float>()[j]);
+    }
+  }
+}
+
+// Allocates 512MB and runs for long, so it only runs when asked with
+// --gtest_also_run_disabled_tests.
+TEST_F(AllReduceTest, DISABLED_Benchmark) {
+  const size_t kNumPlaces = 8;
+  const int kRepeat = 5;
+  size_t max_tasks = ThreadPool::GetInstance()->Threads();
+  for (int64_t numel : {1 << 16, 1 << 20, 1 << 24}) {
+    Prepare(kNumPlaces, numel);
+    for (size_t num_tasks = 1; num_tasks <= max_tasks; num_tasks *= 2) {
+      AllReduce(num_tasks);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kRepeat; ++i) {
+        AllReduce(num_tasks);
+      }
+      auto end = std::chrono::steady_clock::now();
+      double ms =
+          std::chrono::duration<double, std::milli>(end - start).count() /
+          kRepeat;
+      LOG(INFO) << "all reduce " << kNumPlaces << " x " << numel
+                << " floats with " << num_tasks << " tasks: " << ms << " ms, "
+                << kNumPlaces * numel * sizeof(float) / ms / 1e6 << " GB/s";
+    }
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
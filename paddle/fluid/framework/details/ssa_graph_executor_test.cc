@@ -0,0 +1,161 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// An op doing a small amount of computation, which records when it runs.
+class DummyOpHandle : public OpHandleBase {
+ public:
+  DummyOpHandle(ir::Node* node, std::atomic<int>* counter, int work)
+      : OpHandleBase(node), counter_(counter), work_(work) {}
+
+  std::string Name() const override { return "dummy"; }
+
+  int order() const { return order_; }
+
+ protected:
+  void RunImpl() override {
+    float sum = 0;
+    for (int i = 0; i < work_; ++i) {
+      sum += std::sqrt(static_cast<float>(i));
+    }
+    result_ = sum;
+    order_ = counter_->fetch_add(1);
+  }
+
+ private:
+  std::atomic<int>* counter_;
+  int work_;
+  int order_{-1};
+  volatile float result_{0};
+};
+
+// `depth` layers of `width` ops, each op depends on two ops of the previous
+// layer.
+std::unique_ptr<ir::Graph> BuildGraph(int depth, int width, int work,
+                                      std::atomic<int>* counter) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(ProgramDesc()));
+  graph->Set(kGraphVars, new GraphVars(1));
+  graph->Set(kGraphDepVars, new GraphDepVars);
+  graph->Set(kGraphOps, new GraphOps);
+  auto& ops = graph->Get<GraphOps>(kGraphOps);
+  auto& dep_vars = graph->Get<GraphDepVars>(kGraphDepVars);
+
+  auto link = [&](OpHandleBase* from, OpHandleBase* to) {
+    auto* var = new DummyVarHandle(
+        graph->CreateEmptyNode("dep", ir::Node::Type::kVariable));
+    dep_vars.emplace(var);
+    from->AddOutput(var);
+    if (to) to->AddInput(var);
+  };
+
+  for (int l = 0; l < depth; ++l) {
+    for (int i = 0; i < width; ++i) {
+      ops.emplace_back(new DummyOpHandle(
+          graph->CreateEmptyNode("dummy", ir::Node::Type::kOperation), counter,
+          work));
+      if (l > 0) {
+        auto* prev = ops.data() + (l - 1) * width;
+        link(prev[i].get(), ops.back().get());
+        link(prev[(i + 1) % width].get(), ops.back().get());
+      }
+    }
+  }
+  // The executors wait for the outputs of the last layer.
+  for (int i = 0; i < width; ++i) {
+    link(ops[(depth - 1) * width + i].get(), nullptr);
+  }
+  return graph;
+}
+
+void CheckOrder(const ir::Graph& graph) {
+  for (auto& op : graph.Get<GraphOps>(kGraphOps)) {
+    auto* consumer = static_cast<DummyOpHandle*>(op.get());
+    ASSERT_GE(consumer->order(), 0);
+    for (auto* in : op->Inputs()) {
+      auto* producer = static_cast<DummyOpHandle*>(in->GeneratedOp());
+      EXPECT_LT(producer->order(), consumer->order());
+    }
+  }
+}
+
+void RunGraph(ExecutionStrategy::ExecutorType type, bool use_work_stealing) {
+  const int kDepth = 50;
+  const int kWidth = 16;
+  const int kWork = 200;
+  const int kIterations = 20;
+
+  ExecutionStrategy strategy;
+  strategy.num_threads_ = 4;
+  strategy.use_cuda_ = false;
+  strategy.type_ = type;
+  strategy.use_work_stealing_ = use_work_stealing;
+
+  Scope scope;
+  std::vector<Scope*> local_scopes({&scope});
+  std::vector<platform::Place> places({platform::CPUPlace()});
+  std::atomic<int> counter(0);
+  auto graph = BuildGraph(kDepth, kWidth, kWork, &counter);
+
+  std::unique_ptr<SSAGraphExecutor> executor;
+  if (type == ExecutionStrategy::kDefault) {
+    executor.reset(new ThreadedSSAGraphExecutor(strategy, local_scopes, places,
+                                                std::move(graph)));
+  } else {
+    executor.reset(new FastThreadedSSAGraphExecutor(
+        strategy, local_scopes, places, std::move(graph)));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    counter = 0;
+    executor->Run({});
+    ASSERT_EQ(counter, kDepth * kWidth);
+    CheckOrder(executor->Graph());
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << (type == ExecutionStrategy::kDefault ? "threaded" : "fast")
+            << (use_work_stealing ? " + work stealing" : "") << ": "
+            << kIterations * kDepth * kWidth / seconds << " ops/s" << std::endl;
+}
+
+TEST(ThreadedSSAGraphExecutor, Throughput) {
+  RunGraph(ExecutionStrategy::kDefault, false);
+  RunGraph(ExecutionStrategy::kDefault, true);
+}
+
+TEST(FastThreadedSSAGraphExecutor, Throughput) {
+  RunGraph(ExecutionStrategy::kExperimental, false);
+  RunGraph(ExecutionStrategy::kExperimental, true);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -25,13 +25,20 @@ ThreadedSSAGraphExecutor::ThreadedSSAGraphExecutor(
     const std::vector<platform::Place> &places,
     std::unique_ptr<ir::Graph> &&graph)
     : graph_(std::move(graph)),
-      pool_(strategy.num_threads_ >= 2 ? new ::ThreadPool(strategy.num_threads_)
-                                       : nullptr),
       local_scopes_(local_scopes),
       places_(places),
       fetch_ctxs_(places),
       running_ops_(0),
-      strategy_(strategy) {}
+      strategy_(strategy) {
+  if (strategy.num_threads_ >= 2) {
+    if (strategy.use_work_stealing_) {
+      work_stealing_pool_.reset(
+          new WorkStealingThreadPool(strategy.num_threads_));
+    } else {
+      pool_.reset(new ::ThreadPool(strategy.num_threads_));
+    }
+  }
+}
 
 FeedFetchList ThreadedSSAGraphExecutor::Run(
     const std::vector<std::string> &fetch_tensors) {
@@ -224,7 +231,9 @@ void ThreadedSSAGraphExecutor::RunOp(
       exception_holder_.Catch(std::current_exception());
     }
   };
-  if (pool_) {
+  if (work_stealing_pool_) {
+    run_op_futures_.emplace_back(work_stealing_pool_->Enqueue(op_run));
+  } else if (pool_) {
     run_op_futures_.emplace_back(pool_->enqueue(op_run));
   } else {
     op_run();
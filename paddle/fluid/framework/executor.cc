@@ -14,18 +14,28 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/executor.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/detail/macros.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(benchmark);
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
+DEFINE_bool(eager_delete_tensor, false,
+            "Release the tensors of a block right after the last op using "
+            "them, instead of when the scope is deleted. It reduces the peak "
+            "memory usage, but the non-persistable variables which are read "
+            "by the block can not be read from the scope after it runs.");
 
 namespace paddle {
 namespace framework {
@@ -33,6 +43,110 @@ namespace {
 // block id starts from 0. This id is used to represent the codeblock
 // wrapping the first block 0.
 int kProgramId = -1;
+
+// The ops which send or receive their variables after they return.
+const std::unordered_set<std::string> kAsyncVarOps = {"send", "recv"};
+
+void CollectBlockVars(const BlockDesc& block,
+                      std::unordered_set<std::string>* names);
+
+// Collect the variables used by the sub-blocks of the op.
+void CollectSubBlockVars(const OpDesc& op,
+                         std::unordered_set<std::string>* names) {
+  for (auto& attr : op.GetAttrMap()) {
+    if (attr.second.type() == typeid(BlockDesc*)) {
+      CollectBlockVars(*boost::get<BlockDesc*>(attr.second), names);
+    } else if (attr.second.type() == typeid(std::vector<BlockDesc*>)) {
+      for (auto* sub_block : boost::get<std::vector<BlockDesc*>>(attr.second)) {
+        CollectBlockVars(*sub_block, names);
+      }
+    }
+  }
+}
+
+// Collect the variables used by the ops of the block and its sub-blocks.
+void CollectBlockVars(const BlockDesc& block,
+                      std::unordered_set<std::string>* names) {
+  for (auto* op : block.AllOps()) {
+    for (auto& name : op->InputArgumentNames()) names->insert(name);
+    for (auto& name : op->OutputArgumentNames()) names->insert(name);
+    CollectSubBlockVars(*op, names);
+  }
+}
+
+/*
+ * For every op of the block, the variables whose last use is by it. They are
+ * the non-persistable tensors of the block, which are written in the block
+ * before they are read and are read by some op. So the variables fed by the
+ * caller into the scope, and the results which no op reads, are kept.
+ *
+ * The ops of a sub-block use the variables on behalf of the op holding it.
+ * The variables of a sub-block itself are never released, as it may run many
+ * times and its variables be read by the grad ops, e.g. the step scopes of
+ * while.
+ */
+std::vector<std::vector<std::string>> GetUnusedVars(const BlockDesc& block) {
+  auto ops = block.AllOps();
+  std::vector<std::vector<std::string>> unused_vars(ops.size());
+  if (block.Parent() != kNoneBlockIndex) return unused_vars;
+
+  std::unordered_map<std::string, size_t> last_use;
+  std::unordered_set<std::string> written, read, kept;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    std::unordered_set<std::string> inputs, outputs;
+    for (auto& name : ops[i]->InputArgumentNames()) inputs.insert(name);
+    for (auto& name : ops[i]->OutputArgumentNames()) outputs.insert(name);
+    // A sub-block may both read and write a variable, which is taken as read.
+    CollectSubBlockVars(*ops[i], &inputs);
+    bool is_async = kAsyncVarOps.count(ops[i]->Type()) > 0;
+    for (auto& name : inputs) {
+      if (!written.count(name)) kept.insert(name);
+      read.insert(name);
+      last_use[name] = i;
+      if (is_async) kept.insert(name);
+    }
+    for (auto& name : outputs) {
+      written.insert(name);
+      last_use[name] = i;
+      if (is_async) kept.insert(name);
+    }
+  }
+
+  for (auto& item : last_use) {
+    auto& name = item.first;
+    auto* var = block.FindVar(name);
+    if (var == nullptr || var->Persistable() || !read.count(name) ||
+        kept.count(name)) {
+      continue;
+    }
+    auto type = var->GetType();
+    if (type == proto::VarType::LOD_TENSOR ||
+        type == proto::VarType::SELECTED_ROWS ||
+        type == proto::VarType::LOD_TENSOR_ARRAY) {
+      unused_vars[item.second].push_back(name);
+    }
+  }
+  for (auto& names : unused_vars) {
+    std::sort(names.begin(), names.end());
+  }
+  return unused_vars;
+}
+
+// Release the memory of the variables. On GPU, the ops run in one stream of
+// the place, so a later op reusing the memory runs after the ops reading it.
+void ReleaseVars(const std::vector<std::string>& names, Scope* scope) {
+  for (auto& name : names) {
+    auto* var = scope->FindVar(name);
+    if (var == nullptr) continue;
+    if (var->IsType<LoDTensor>()) {
+      var->GetMutable<LoDTensor>()->clear();
+    } else if (var->IsType<SelectedRows>()) {
+      var->GetMutable<SelectedRows>()->mutable_value()->clear();
+    } else if (var->IsType<LoDTensorArray>()) {
+      var->GetMutable<LoDTensorArray>()->clear();
+    }
+  }
+}
 }  // namespace
 
 ExecutorPrepareContext::ExecutorPrepareContext(
@@ -43,6 +157,25 @@ ExecutorPrepareContext::~ExecutorPrepareContext() {
   VLOG(5) << "destroy ExecutorPrepareContext";
 }
 
+void ExecutorPrepareContext::EnableRuntimeCache() {
+  for (auto& op : ops_) {
+    auto* op_with_kernel = dynamic_cast<OperatorWithKernel*>(op.get());
+    if (op_with_kernel != nullptr) {
+      op_with_kernel->EnableRuntimeCache(true);
+    }
+  }
+  runtime_cache_enabled_ = true;
+}
+
+void ExecutorPrepareContext::ResetRuntimeCache() {
+  for (auto& op : ops_) {
+    auto* op_with_kernel = dynamic_cast<OperatorWithKernel*>(op.get());
+    if (op_with_kernel != nullptr) {
+      op_with_kernel->ResetRuntimeCache();
+    }
+  }
+}
+
 Executor::Executor(const platform::Place& place) : place_(place) {}
 
 void Executor::Close() {
@@ -300,6 +433,7 @@ std::unique_ptr<ExecutorPrepareContext> Executor::Prepare(
   for (auto& op_desc : block.AllOps()) {
     ctx->ops_.push_back(OpRegistry::CreateOp(*op_desc));
   }
+  ctx->unused_vars_ = GetUnusedVars(block);
   return ctx;
 }
 
@@ -313,6 +447,7 @@ std::vector<std::shared_ptr<ExecutorPrepareContext>> Executor::Prepare(
     for (auto& op_desc : block.AllOps()) {
       ctx->ops_.push_back(OpRegistry::CreateOp(*op_desc));
     }
+    ctx->unused_vars_ = GetUnusedVars(block);
     result.push_back(std::shared_ptr<ExecutorPrepareContext>(ctx));
   }
   return result;
@@ -329,16 +464,27 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
     CreateVariables(ctx->prog_, local_scope, ctx->block_id_);
   }
 
-  for (auto& op : ctx->ops_) {
+  size_t peak_memory_usage = 0;
+  for (size_t i = 0; i < ctx->ops_.size(); ++i) {
+    auto& op = ctx->ops_[i];
     op->Run(*local_scope, place_);
 
     if (FLAGS_benchmark) {
+      size_t memory_usage = memory::memory_usage(place_);
+      peak_memory_usage = std::max(peak_memory_usage, memory_usage);
       VLOG(2) << "Memory used after operator " + op->Type() + " running: "
-              << memory::memory_usage(place_);
+              << memory_usage;
+    }
+    if (FLAGS_eager_delete_tensor) {
+      ReleaseVars(ctx->unused_vars_[i], local_scope);
     }
   }
   platform::DeviceContextPool::Instance().Get(place_)->Wait();
   if (local_scope != scope) {
+    if (ctx->runtime_cache_enabled_) {
+      // the cached variables are deleted together with the local scope.
+      ctx->ResetRuntimeCache();
+    }
     scope->DeleteScope(local_scope);
   } else {
     if (!keep_kids) {
@@ -354,6 +500,7 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
 
   if (FLAGS_benchmark) {
     VLOG(2) << "-------------------------------------------------------";
+    VLOG(2) << "Peak memory used by the operators: " << peak_memory_usage;
     VLOG(2) << "Memory used after deleting local scope: "
             << memory::memory_usage(place_);
     VLOG(2) << "-------------------------------------------------------";
@@ -31,9 +31,25 @@ struct ExecutorPrepareContext {
   ExecutorPrepareContext(const framework::ProgramDesc& prog, size_t block_id);
   ~ExecutorPrepareContext();
 
+  /*
+   * Let the operators keep their chosen kernels and the variables they read
+   * and write between runs, see OperatorWithKernel::EnableRuntimeCache. It
+   * pays off when the context is run on the same scope many times, as the
+   * inference predictors do. A context with the cache enabled must not be
+   * run by more than one thread at the same time.
+   */
+  void EnableRuntimeCache();
+
+  // Drop the variables cached by the operators.
+  void ResetRuntimeCache();
+
   const framework::ProgramDesc& prog_;
   size_t block_id_;
   std::vector<std::unique_ptr<OperatorBase>> ops_;
+  // The variables whose last use is by ops_[i], which are released after it
+  // runs if FLAGS_eager_delete_tensor is set.
+  std::vector<std::vector<std::string>> unused_vars_;
+  bool runtime_cache_enabled_{false};
 };
 
 class Executor {
@@ -0,0 +1,102 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/executor.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(scale);
+USE_OP(sum);
+
+DECLARE_bool(eager_delete_tensor);
+
+namespace paddle {
+namespace framework {
+
+void AddOp(const std::string& type, const VariableNameMap& inputs,
+           const VariableNameMap& outputs, const AttributeMap& attrs,
+           BlockDesc* block) {
+  for (auto& kv : outputs) {
+    for (auto& name : kv.second) {
+      auto* var = block->Var(name);
+      var->SetType(proto::VarType::LOD_TENSOR);
+      var->SetDataType(proto::VarType::FP32);
+    }
+  }
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+}
+
+// x->scale->a->scale->b->sum->d
+//           \->scale->c-/
+ProgramDesc BuildProgram() {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  auto* x = block->Var("x");
+  x->SetType(proto::VarType::LOD_TENSOR);
+  x->SetDataType(proto::VarType::FP32);
+  AttributeMap attrs{{"scale", 2.f}};
+  AddOp("scale", {{"X", {"x"}}}, {{"Out", {"a"}}}, attrs, block);
+  AddOp("scale", {{"X", {"a"}}}, {{"Out", {"b"}}}, attrs, block);
+  AddOp("scale", {{"X", {"a"}}}, {{"Out", {"c"}}}, attrs, block);
+  AddOp("sum", {{"X", {"b", "c"}}}, {{"Out", {"d"}}}, {}, block);
+  return prog;
+}
+
+TEST(Executor, unused_vars) {
+  auto prog = BuildProgram();
+  auto ctx = Executor::Prepare(prog, 0);
+  // x is fed by the caller and d is read by no op, so both are kept.
+  ASSERT_EQ(ctx->unused_vars_.size(), 4UL);
+  EXPECT_TRUE(ctx->unused_vars_[0].empty());
+  EXPECT_TRUE(ctx->unused_vars_[1].empty());
+  EXPECT_EQ(ctx->unused_vars_[2], std::vector<std::string>({"a"}));
+  EXPECT_EQ(ctx->unused_vars_[3], std::vector<std::string>({"b", "c"}));
+}
+
+TEST(Executor, eager_delete_tensor) {
+  auto prog = BuildProgram();
+  Scope scope;
+  auto* x = scope.Var("x")->GetMutable<LoDTensor>();
+  float* x_data = x->mutable_data<float>({2, 3}, platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) x_data[i] = i;
+
+  FLAGS_eager_delete_tensor = true;
+  platform::CPUPlace place;
+  Executor exe(place);
+  exe.Run(prog, &scope, 0, false, true);
+  FLAGS_eager_delete_tensor = false;
+
+  for (auto* name : {"a", "b", "c"}) {
+    EXPECT_FALSE(scope.FindVar(name)->Get<LoDTensor>().IsInitialized())
+        << name;
+  }
+  ASSERT_TRUE(scope.FindVar("x")->Get<LoDTensor>().IsInitialized());
+  auto& d = scope.FindVar("d")->Get<LoDTensor>();
+  ASSERT_TRUE(d.IsInitialized());
+  EXPECT_EQ(d.dims(), make_ddim({2, 3}));
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(d.data<float>()[i], 8.f * i);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,340 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/conv_bn_fuse_pass.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool HasInput(OpDesc* op, const std::string& argument) {
+  return op->Inputs().count(argument) && !op->Input(argument).empty();
+}
+
+// A conv2d, or a fusion_conv2d which has no activation yet, so that the ops
+// after it can be folded in.
+bool IsFoldableConv(Node* node) {
+  auto* op = node->Op();
+  if (op->Type() == "conv2d") {
+    bool use_mkldnn = op->HasAttr("use_mkldnn") &&
+                      boost::get<bool>(op->GetAttr("use_mkldnn"));
+    return !use_mkldnn && !HasInput(op, "Bias");
+  }
+  return op->Type() == "fusion_conv2d" &&
+         boost::get<std::string>(op->GetAttr("activation")) == "identity";
+}
+
+// conv -> conv_out -> next -> next_out, where conv_out is read by no other
+// op.
+void BuildPattern(PDPattern* pattern, const std::string& op_type,
+                  const std::string& output) {
+  auto* conv = pattern->NewNode("conv")->assert_is_op()->assert_more(
+      [](Node* node) { return IsFoldableConv(node); });
+  auto* conv_out = pattern->NewNode("conv_out")
+                       ->assert_is_var()
+                       ->assert_more([](Node* node) {
+                         return node->Var() && !node->Var()->Persistable();
+                       })
+                       ->AsIntermediate();
+  auto* next = pattern->NewNode("next")->assert_is_op(op_type);
+  auto* next_out = pattern->NewNode("next_out")
+                       ->assert_is_op_output(op_type, output)
+                       ->AsOutput();
+  conv->LinksTo({conv_out});
+  next->LinksFrom({conv_out}).LinksTo({next_out});
+}
+
+Node* FindInput(Node* op, const std::string& argument) {
+  if (!HasInput(op->Op(), argument)) return nullptr;
+  const std::string& name = op->Op()->Input(argument)[0];
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+// The float tensor of a parameter read by `op` only.
+LoDTensor* OwnedParam(Scope* scope, Node* op, const std::string& argument) {
+  Node* node = FindInput(op, argument);
+  if (node == nullptr || node->outputs.size() != 1UL) return nullptr;
+  auto* var = scope->FindVar(node->Name());
+  if (var == nullptr || !var->IsType<LoDTensor>()) return nullptr;
+  auto* tensor = var->GetMutable<LoDTensor>();
+  if (!tensor->IsInitialized() || tensor->type() != typeid(float)) {
+    return nullptr;
+  }
+  return tensor;
+}
+
+// Replace the conv2d by a fusion_conv2d of the same inputs and attributes.
+Node* ToFusionConv(Graph* graph, Node* conv) {
+  if (conv->Op()->Type() == "fusion_conv2d") return conv;
+  auto* conv_desc = conv->Op();
+  OpDesc desc;
+  desc.SetType("fusion_conv2d");
+  desc.SetInput("Input", conv_desc->Input("Input"));
+  desc.SetInput("Filter", conv_desc->Input("Filter"));
+  desc.SetOutput("Output", conv_desc->Output("Output"));
+  for (const char* attr : {"strides", "paddings", "dilations", "groups"}) {
+    desc.SetAttr(attr, conv_desc->GetAttr(attr));
+  }
+  desc.SetAttr("activation", std::string("identity"));
+  auto* fused = graph->CreateOpNode(&desc);  // OpDesc will be copied.
+  fused->inputs = conv->inputs;
+  fused->outputs = conv->outputs;
+  for (auto* in : conv->inputs) {
+    std::replace(in->outputs.begin(), in->outputs.end(), conv, fused);
+  }
+  for (auto* out : conv->outputs) {
+    std::replace(out->inputs.begin(), out->inputs.end(), conv, fused);
+  }
+  graph->RemoveNode(conv);
+  return fused;
+}
+
+// Set the input `argument` of conv to `node`, which is an input of next.
+void MoveInput(Graph* graph, Node* conv, const std::string& argument,
+               Node* node, Node* next) {
+  Node* old = FindInput(conv, argument);
+  if (old != nullptr) {
+    old->outputs.erase(
+        std::find(old->outputs.begin(), old->outputs.end(), conv));
+    conv->inputs.erase(
+        std::find(conv->inputs.begin(), conv->inputs.end(), old));
+    if (old->inputs.empty() && old->outputs.empty()) graph->RemoveNode(old);
+  }
+  conv->Op()->SetInput(argument, {node->Name()});
+  std::replace(node->outputs.begin(), node->outputs.end(), next, conv);
+  conv->inputs.push_back(node);
+}
+
+// Let conv write next_out, and remove next with conv_out. The inputs of next
+// which are not moved to conv are removed if they are read by no other op.
+void RemoveNext(Graph* graph, Node* conv, Node* conv_out, Node* next,
+                Node* next_out) {
+  conv->Op()->SetOutput("Output", {next_out->Name()});
+  std::replace(conv->outputs.begin(), conv->outputs.end(), conv_out,
+               next_out);
+  std::replace(next_out->inputs.begin(), next_out->inputs.end(), next, conv);
+
+  std::unordered_set<const Node*> nodes2delete({next, conv_out});
+  for (auto* in : next->inputs) {
+    if (in == conv_out) continue;
+    auto it = std::find(in->outputs.begin(), in->outputs.end(), next);
+    if (it == in->outputs.end()) continue;  // Moved to conv.
+    in->outputs.erase(it);
+    if (in->inputs.empty() && in->outputs.empty()) nodes2delete.insert(in);
+  }
+  for (auto* out : next->outputs) {
+    if (out != next_out) nodes2delete.insert(out);
+  }
+  GraphSafeRemoveNodes(graph, nodes2delete);
+}
+
+// Whether the outputs of next other than next_out are read by no op.
+bool OnlyNextOutIsRead(Node* next, Node* next_out) {
+  for (auto* out : next->outputs) {
+    if (out != next_out && !out->outputs.empty()) return false;
+  }
+  return true;
+}
+
+// Channels of the output of a conv, by its filter.
+int64_t OutChannels(Scope* scope, Node* conv) {
+  auto* var = scope->FindVar(conv->Op()->Input("Filter")[0]);
+  if (var == nullptr || !var->IsType<LoDTensor>()) return -1;
+  auto& filter = var->Get<LoDTensor>();
+  return filter.dims().size() == 4 ? filter.dims()[0] : -1;
+}
+
+// Fold batch_norm, y = (x - mean) / sqrt(variance + epsilon) * scale + bias,
+// into the filter and the bias.
+bool FoldBatchNorm(Graph* graph, Scope* scope, Node* conv, Node* conv_out,
+                   Node* bn, Node* bn_out) {
+  auto* bn_desc = bn->Op();
+  if (bn_desc->HasAttr("is_test") &&
+      !boost::get<bool>(bn_desc->GetAttr("is_test"))) {
+    return false;
+  }
+  if (bn_desc->HasAttr("data_layout") &&
+      boost::get<std::string>(bn_desc->GetAttr("data_layout")) != "NCHW" &&
+      boost::get<std::string>(bn_desc->GetAttr("data_layout")) !=
+          "AnyLayout") {
+    return false;
+  }
+  // The residual is not scaled with the conv.
+  if (HasInput(conv->Op(), "ResidualData") || !OnlyNextOutIsRead(bn, bn_out)) {
+    return false;
+  }
+  auto* filter = OwnedParam(scope, conv, "Filter");
+  // Overwritten by the folded bias, which the conv reads instead.
+  auto* bn_bias = OwnedParam(scope, bn, "Bias");
+  int64_t channels = OutChannels(scope, conv);
+  if (filter == nullptr || bn_bias == nullptr || channels <= 0) return false;
+  LoDTensor* conv_bias = nullptr;
+  if (FindInput(conv, "Bias") != nullptr) {
+    auto* var = scope->FindVar(FindInput(conv, "Bias")->Name());
+    if (var == nullptr || !var->IsType<LoDTensor>()) return false;
+    conv_bias = var->GetMutable<LoDTensor>();
+  }
+  std::vector<const LoDTensor*> params;
+  for (const char* argument : {"Scale", "Mean", "Variance"}) {
+    auto* node = FindInput(bn, argument);
+    auto* var = node ? scope->FindVar(node->Name()) : nullptr;
+    if (var == nullptr || !var->IsType<LoDTensor>()) return false;
+    params.push_back(&var->Get<LoDTensor>());
+  }
+  for (auto* param : {params[0], params[1], params[2],
+                      static_cast<const LoDTensor*>(bn_bias)}) {
+    if (param->numel() != channels) return false;
+  }
+  if (conv_bias && conv_bias->numel() != channels) return false;
+
+  float epsilon = boost::get<float>(bn_desc->GetAttr("epsilon"));
+  const float* scale = params[0]->data<float>();
+  const float* mean = params[1]->data<float>();
+  const float* variance = params[2]->data<float>();
+  float* bias = bn_bias->data<float>();
+  float* w = filter->data<float>();
+  int64_t size = filter->numel() / channels;
+  for (int64_t c = 0; c < channels; ++c) {
+    float alpha = scale[c] / std::sqrt(variance[c] + epsilon);
+    for (int64_t i = 0; i < size; ++i) w[c * size + i] *= alpha;
+    float b = conv_bias ? conv_bias->data<float>()[c] : 0.f;
+    bias[c] += (b - mean[c]) * alpha;
+  }
+
+  conv = ToFusionConv(graph, conv);
+  MoveInput(graph, conv, "Bias", FindInput(bn, "Bias"), bn);
+  RemoveNext(graph, conv, conv_out, bn, bn_out);
+  return true;
+}
+
+// Fold elementwise_add into the bias when it adds a bias of every channel, or
+// into the residual when it adds a tensor in the shape of the output.
+bool FoldElementwiseAdd(Graph* graph, Scope* scope, Node* conv,
+                        Node* conv_out, Node* add, Node* add_out) {
+  auto* add_desc = add->Op();
+  bool conv_out_is_x = add_desc->Input("X")[0] == conv_out->Name();
+  Node* other = FindInput(add, conv_out_is_x ? "Y" : "X");
+  if (other == nullptr || other == conv_out) return false;
+  if (other->Var() && other->Var()->Persistable()) {
+    // The bias, Y of the shape (C) added at axis 1.
+    int axis = add_desc->HasAttr("axis")
+                   ? boost::get<int>(add_desc->GetAttr("axis"))
+                   : -1;
+    int64_t channels = OutChannels(scope, conv);
+    auto* var = scope->FindVar(other->Name());
+    if (!conv_out_is_x || axis != 1 || channels <= 0 || var == nullptr ||
+        !var->IsType<LoDTensor>()) {
+      return false;
+    }
+    auto& y = var->Get<LoDTensor>();
+    if (y.type() != typeid(float) || y.numel() != channels) return false;
+    if (FindInput(conv, "Bias") != nullptr) {
+      auto* bias = OwnedParam(scope, conv, "Bias");
+      if (bias == nullptr || bias->numel() != channels) return false;
+      float* b = bias->data<float>();
+      for (int64_t c = 0; c < channels; ++c) b[c] += y.data<float>()[c];
+      conv = ToFusionConv(graph, conv);
+    } else {
+      conv = ToFusionConv(graph, conv);
+      MoveInput(graph, conv, "Bias", other, add);
+    }
+  } else {
+    // The residual, of the same shape as the output.
+    if (HasInput(conv->Op(), "ResidualData") || conv_out->Var() == nullptr ||
+        other->Var() == nullptr ||
+        conv_out->Var()->GetShape() != other->Var()->GetShape()) {
+      return false;
+    }
+    conv = ToFusionConv(graph, conv);
+    MoveInput(graph, conv, "ResidualData", other, add);
+  }
+  RemoveNext(graph, conv, conv_out, add, add_out);
+  return true;
+}
+
+bool FoldRelu(Graph* graph, Node* conv, Node* conv_out, Node* relu,
+              Node* relu_out) {
+  conv = ToFusionConv(graph, conv);
+  conv->Op()->SetAttr("activation", std::string("relu"));
+  RemoveNext(graph, conv, conv_out, relu, relu_out);
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ConvBNFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("conv_bn", graph.get());
+  auto* scope = param_scope();
+  PADDLE_ENFORCE(scope);
+
+  struct Fold {
+    std::string op_type;
+    std::string output;
+  };
+  const std::vector<Fold> folds({{"batch_norm", "Y"},
+                                 {"elementwise_add", "Out"},
+                                 {"relu", "Out"}});
+
+  int fused_count = 0;
+  // A fold may make another possible, e.g. batch_norm after the bias, so the
+  // folds are repeated until none applies.
+  for (int fused = -1; fused != 0;) {
+    fused = 0;
+    for (auto& fold : folds) {
+      GraphPatternDetector gpd;
+      BuildPattern(gpd.mutable_pattern(), fold.op_type, fold.output);
+      auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                         Graph* g) {
+        auto* conv = subgraph.at(gpd.pattern().RetrieveNode("conv"));
+        auto* conv_out = subgraph.at(gpd.pattern().RetrieveNode("conv_out"));
+        auto* next = subgraph.at(gpd.pattern().RetrieveNode("next"));
+        auto* next_out = subgraph.at(gpd.pattern().RetrieveNode("next_out"));
+        bool done = false;
+        if (fold.op_type == "batch_norm") {
+          done = FoldBatchNorm(g, scope, conv, conv_out, next, next_out);
+        } else if (fold.op_type == "elementwise_add") {
+          done = FoldElementwiseAdd(g, scope, conv, conv_out, next, next_out);
+        } else {
+          done = FoldRelu(g, conv, conv_out, next, next_out);
+        }
+        if (done) ++fused;
+      };
+      gpd(graph.get(), handler);
+    }
+    fused_count += fused;
+  }
+
+  AddStatis(fused_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(conv_bn_fuse_pass, paddle::framework::ir::ConvBNFusePass);
@@ -0,0 +1,189 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/conv_bn_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetVar(ProgramDesc* prog, const std::string& name,
+            const std::vector<int64_t>& shape, bool persistable) {
+  auto* var = prog->MutableBlock(0)->Var(name);
+  var->SetType(proto::VarType::LOD_TENSOR);
+  var->SetDataType(proto::VarType::FP32);
+  var->SetShape(shape);
+  var->SetPersistable(persistable);
+}
+
+OpDesc* AppendConv(ProgramDesc* prog, const std::string& x,
+                   const std::string& filter, const std::string& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType("conv2d");
+  op->SetInput("Input", {x});
+  op->SetInput("Filter", {filter});
+  op->SetOutput("Output", {out});
+  op->SetAttr("strides", std::vector<int>({1, 1}));
+  op->SetAttr("paddings", std::vector<int>({0, 0}));
+  op->SetAttr("dilations", std::vector<int>({1, 1}));
+  op->SetAttr("groups", 1);
+  op->SetAttr("use_mkldnn", false);
+  return op;
+}
+
+OpDesc* AppendOp(ProgramDesc* prog, const std::string& type,
+                 const std::vector<std::string>& x, const std::string& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", {x[0]});
+  if (x.size() > 1) op->SetInput("Y", {x[1]});
+  op->SetOutput("Out", {out});
+  return op;
+}
+
+// x->conv2d(f0)->c0->batch_norm->y0->elementwise_add(r)->s0->relu->out0
+// x->conv2d(f1)->c1->elementwise_add(b1)->s1->relu->out1
+// x->conv2d(f2)->c2, which is fetched, ->relu->out2
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& name : {"c0", "y0", "s0", "out0", "c1", "s1", "out1", "c2",
+                     "out2", "r"}) {
+    SetVar(&prog, name, {-1, 2, 1, 1}, false);
+  }
+  SetVar(&prog, "x", {-1, 3, 1, 1}, false);
+  for (auto& name : {"f0", "f1", "f2"}) {
+    SetVar(&prog, name, {2, 3, 1, 1}, true);
+  }
+  for (auto& name : {"scale", "bias", "mean", "variance", "b1"}) {
+    SetVar(&prog, name, {2}, true);
+  }
+  for (auto& name : {"saved_mean", "saved_variance"}) {
+    SetVar(&prog, name, {2}, false);
+  }
+
+  AppendConv(&prog, "x", "f0", "c0");
+  auto* bn = prog.MutableBlock(0)->AppendOp();
+  bn->SetType("batch_norm");
+  bn->SetInput("X", {"c0"});
+  bn->SetInput("Scale", {"scale"});
+  bn->SetInput("Bias", {"bias"});
+  bn->SetInput("Mean", {"mean"});
+  bn->SetInput("Variance", {"variance"});
+  bn->SetOutput("Y", {"y0"});
+  bn->SetOutput("MeanOut", {"mean"});
+  bn->SetOutput("VarianceOut", {"variance"});
+  bn->SetOutput("SavedMean", {"saved_mean"});
+  bn->SetOutput("SavedVariance", {"saved_variance"});
+  bn->SetAttr("epsilon", 0.f);
+  bn->SetAttr("is_test", true);
+  AppendOp(&prog, "elementwise_add", {"y0", "r"}, "s0")->SetAttr("axis", -1);
+  AppendOp(&prog, "relu", {"s0"}, "out0");
+
+  AppendConv(&prog, "x", "f1", "c1");
+  AppendOp(&prog, "elementwise_add", {"c1", "b1"}, "s1")->SetAttr("axis", 1);
+  AppendOp(&prog, "relu", {"s1"}, "out1");
+
+  AppendConv(&prog, "x", "f2", "c2");
+  AppendOp(&prog, "relu", {"c2"}, "out2");
+  AppendOp(&prog, "fetch", {"c2"}, "fetch");
+  return prog;
+}
+
+void InitTensor(Scope* scope, const std::string& name,
+                const std::vector<int64_t>& shape,
+                const std::vector<float>& values) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data =
+      tensor->mutable_data<float>(make_ddim(shape), platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+}
+
+TEST(ConvBNFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  Scope scope;
+  for (auto& name : {"f0", "f1", "f2"}) {
+    InitTensor(&scope, name, {2, 3, 1, 1}, {1, 2, 3, 4, 5, 6});
+  }
+  InitTensor(&scope, "scale", {2}, {1, 6});
+  InitTensor(&scope, "bias", {2}, {1, 1});
+  InitTensor(&scope, "mean", {2}, {1, 2});
+  InitTensor(&scope, "variance", {2}, {4, 9});
+  InitTensor(&scope, "b1", {2}, {0.5, -0.5});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("conv_bn_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, OpDesc*> convs;
+  std::map<std::string, int> op_count;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    ++op_count[node->Op()->Type()];
+    if (node->Op()->Type() == "fusion_conv2d") {
+      convs[node->Op()->Input("Filter")[0]] = node->Op();
+    }
+  }
+  EXPECT_EQ(op_count["fusion_conv2d"], 2);
+  EXPECT_EQ(op_count["batch_norm"], 0);
+  EXPECT_EQ(op_count["elementwise_add"], 0);
+  // The output of the third conv is fetched, so the relu is kept.
+  EXPECT_EQ(op_count["conv2d"], 1);
+  EXPECT_EQ(op_count["relu"], 1);
+
+  auto* conv0 = convs.at("f0");
+  EXPECT_EQ(conv0->Input("Bias"), std::vector<std::string>({"bias"}));
+  EXPECT_EQ(conv0->Input("ResidualData"), std::vector<std::string>({"r"}));
+  EXPECT_EQ(conv0->Output("Output"), std::vector<std::string>({"out0"}));
+  EXPECT_EQ(boost::get<std::string>(conv0->GetAttr("activation")), "relu");
+  // Scaled by scale / sqrt(variance), which are 0.5 and 2.
+  auto& f0 = scope.FindVar("f0")->Get<LoDTensor>();
+  EXPECT_EQ(std::vector<float>(f0.data<float>(), f0.data<float>() + 6),
+            std::vector<float>({0.5, 1, 1.5, 8, 10, 12}));
+  // bias - mean * scale / sqrt(variance).
+  auto& bias = scope.FindVar("bias")->Get<LoDTensor>();
+  EXPECT_EQ(bias.data<float>()[0], 0.5f);
+  EXPECT_EQ(bias.data<float>()[1], -3.f);
+  // The filters of the other convs are not scaled.
+  auto& f1 = scope.FindVar("f1")->Get<LoDTensor>();
+  EXPECT_EQ(std::vector<float>(f1.data<float>(), f1.data<float>() + 6),
+            std::vector<float>({1, 2, 3, 4, 5, 6}));
+
+  auto* conv1 = convs.at("f1");
+  EXPECT_EQ(conv1->Input("Bias"), std::vector<std::string>({"b1"}));
+  EXPECT_FALSE(conv1->Inputs().count("ResidualData"));
+  EXPECT_EQ(conv1->Output("Output"), std::vector<std::string>({"out1"}));
+  EXPECT_EQ(boost::get<std::string>(conv1->GetAttr("activation")), "relu");
+
+  // The parameters of batch_norm, which are not used any more, are removed
+  // from the graph.
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      EXPECT_NE(node->Name(), "scale");
+      EXPECT_NE(node->Name(), "saved_mean");
+      EXPECT_NE(node->Name(), "c0");
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(conv_bn_fuse_pass);
@@ -0,0 +1,266 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/elemwise_chain_fuse_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The steps of a fusion_elemwise_chain, as its attributes.
+struct Chain {
+  // inputs[0] is the input of the chain.
+  std::vector<std::string> inputs;
+  std::vector<std::string> functors;
+  std::vector<int> operands;
+  std::vector<float> scales;
+};
+
+bool IsBinary(const std::string& type) {
+  return type.compare(0, 12, "elementwise_") == 0;
+}
+
+// The ops fusion_elemwise_chain has a functor of.
+bool IsChainable(Node* node) {
+  static const std::unordered_set<std::string> types({
+      "elementwise_add", "elementwise_sub", "elementwise_mul",
+      "elementwise_div", "elementwise_max", "elementwise_min", "scale", "relu",
+      "sigmoid", "tanh", "exp", "abs", "square", "sqrt", "reciprocal",
+      "fusion_elemwise_chain",
+  });
+  auto* op = node->Op();
+  if (op == nullptr || !types.count(op->Type()) || node->outputs.size() != 1) {
+    return false;
+  }
+  return !op->HasAttr("use_mkldnn") ||
+         !boost::get<bool>(op->GetAttr("use_mkldnn"));
+}
+
+// Let the chain start with inputs[k], the other operand of its first step,
+// by swapping inputs[0] and inputs[k], so that the first step has the value
+// on its other side. False if inputs[k] is read by a later step.
+bool StartWith(int k, Chain* chain) {
+  auto index = [](int operand) {
+    return operand >= 0 ? operand : -operand - 1;
+  };
+  if (!IsBinary(chain->functors[0]) || index(chain->operands[0]) != k) {
+    return false;
+  }
+  for (size_t i = 1; i < chain->functors.size(); ++i) {
+    if (IsBinary(chain->functors[i]) && index(chain->operands[i]) == k) {
+      return false;
+    }
+  }
+  std::swap(chain->inputs[0], chain->inputs[k]);
+  for (size_t i = 0; i < chain->functors.size(); ++i) {
+    if (!IsBinary(chain->functors[i])) continue;
+    int operand = chain->operands[i];
+    int swapped = index(operand) == 0 ? k : index(operand);
+    // The value and the operand of the first step change sides.
+    bool value_first = (operand >= 0) != (i == 0);
+    chain->operands[i] = value_first ? swapped : -swapped - 1;
+  }
+  return true;
+}
+
+// The chain of op whose input is value. False if value is not its input
+// exactly once, or the chain cannot start with it.
+bool ToChain(Node* node, const std::string& value, Chain* chain) {
+  auto* op = node->Op();
+  const std::string& type = op->Type();
+  if (type == "fusion_elemwise_chain") {
+    chain->inputs = op->Input("X");
+    chain->functors =
+        boost::get<std::vector<std::string>>(op->GetAttr("functors"));
+    chain->operands = boost::get<std::vector<int>>(op->GetAttr("operands"));
+    chain->scales = boost::get<std::vector<float>>(op->GetAttr("scales"));
+    auto it = std::find(chain->inputs.begin(), chain->inputs.end(), value);
+    if (it == chain->inputs.end() ||
+        std::count(it, chain->inputs.end(), value) != 1) {
+      return false;
+    }
+    int k = static_cast<int>(it - chain->inputs.begin());
+    return k == 0 || StartWith(k, chain);
+  }
+  chain->functors = {type};
+  chain->scales = {type == "scale" ? boost::get<float>(op->GetAttr("scale"))
+                                   : 1.f};
+  const std::string& x = op->Input("X")[0];
+  if (!IsBinary(type)) {
+    chain->inputs = {x};
+    chain->operands = {0};
+    return x == value;
+  }
+  const std::string& y = op->Input("Y")[0];
+  if (x == y) return false;
+  if (x == value) {
+    chain->inputs = {x, y};
+    chain->operands = {1};  // value op Y
+  } else if (y == value) {
+    chain->inputs = {y, x};
+    chain->operands = {-2};  // X op value
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// The chain of a then b, where the input of b is the output of a.
+Chain Merge(const Chain& a, const Chain& b) {
+  Chain chain = a;
+  // The index in the merged inputs of every input of b, but the first.
+  std::vector<int> index(b.inputs.size(), -1);
+  for (size_t i = 1; i < b.inputs.size(); ++i) {
+    auto it = std::find(chain.inputs.begin(), chain.inputs.end(), b.inputs[i]);
+    index[i] = static_cast<int>(it - chain.inputs.begin());
+    if (it == chain.inputs.end()) chain.inputs.push_back(b.inputs[i]);
+  }
+  for (size_t i = 0; i < b.functors.size(); ++i) {
+    int operand = b.operands[i];
+    if (IsBinary(b.functors[i])) {
+      operand = operand >= 0 ? index[operand] : -index[-operand - 1] - 1;
+    }
+    chain.functors.push_back(b.functors[i]);
+    chain.operands.push_back(operand);
+    chain.scales.push_back(b.scales[i]);
+  }
+  return chain;
+}
+
+// Whether the inputs of op other than value are tensors in the shape and of
+// the data type of value, written once in the graph, so they can be read
+// when the fused op runs.
+bool InputsMatch(Node* op, Node* value,
+                 const std::unordered_map<std::string, int>& writes) {
+  for (auto* in : op->inputs) {
+    if (in == value) continue;
+    auto* var = in->Var();
+    if (var == nullptr || var->GetType() != proto::VarType::LOD_TENSOR ||
+        var->GetDataType() != value->Var()->GetDataType() ||
+        var->GetShape() != value->Var()->GetShape()) {
+      return false;
+    }
+    auto it = writes.find(in->Name());
+    if (it != writes.end() && it->second > 1) return false;
+  }
+  return true;
+}
+
+// a -> a_out -> b -> b_out, where a_out is read by b only.
+void BuildPattern(PDPattern* pattern) {
+  auto* a = pattern->NewNode("a")->assert_is_op()->assert_more(IsChainable);
+  auto* a_out = pattern->NewNode("a_out")
+                    ->assert_is_var()
+                    ->assert_more([](Node* node) {
+                      return node->Var() && !node->Var()->Persistable() &&
+                             node->outputs.size() == 1UL;
+                    })
+                    ->AsIntermediate();
+  auto* b = pattern->NewNode("b")->assert_is_op()->assert_more(IsChainable);
+  auto* b_out = pattern->NewNode("b_out")->assert_is_var()->AsOutput();
+  a->LinksTo({a_out});
+  b->LinksFrom({a_out}).LinksTo({b_out});
+}
+
+bool Fuse(Graph* graph, Node* a, Node* a_out, Node* b, Node* b_out,
+          const std::unordered_map<std::string, int>& writes) {
+  auto type = a_out->Var()->GetDataType();
+  if (type != proto::VarType::FP32 && type != proto::VarType::FP64) {
+    return false;
+  }
+  Chain a_chain, b_chain;
+  if (!ToChain(a, a->Op()->Input("X")[0], &a_chain) ||
+      !ToChain(b, a_out->Name(), &b_chain) ||
+      !InputsMatch(a, a_out, writes) || !InputsMatch(b, a_out, writes)) {
+    return false;
+  }
+  Chain chain = Merge(a_chain, b_chain);
+
+  OpDesc desc;
+  desc.SetType("fusion_elemwise_chain");
+  desc.SetInput("X", chain.inputs);
+  desc.SetOutput("Out", {b_out->Name()});
+  desc.SetAttr("functors", chain.functors);
+  desc.SetAttr("operands", chain.operands);
+  desc.SetAttr("scales", chain.scales);
+  auto* fused = graph->CreateOpNode(&desc);  // OpDesc will be copied.
+
+  for (auto* op : {a, b}) {
+    for (auto* in : op->inputs) {
+      if (in == a_out || std::find(fused->inputs.begin(), fused->inputs.end(),
+                                   in) != fused->inputs.end()) {
+        continue;
+      }
+      fused->inputs.push_back(in);
+      in->outputs.push_back(fused);
+    }
+  }
+  fused->outputs.push_back(b_out);
+  b_out->inputs.push_back(fused);
+  // Also unlinks them from the inputs and b_out.
+  GraphSafeRemoveNodes(graph, {a, a_out, b});
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ElemwiseChainFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("elemwise_chain", graph.get());
+
+  // An input written more than once may be changed before the fused op
+  // reads it.
+  std::unordered_map<std::string, int> writes;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && !node->inputs.empty()) ++writes[node->Name()];
+  }
+
+  int fused_count = 0;
+  // Two ops are fused at a time, so a chain is fused in rounds until no op
+  // is left to add to it.
+  for (int fused = -1; fused != 0;) {
+    fused = 0;
+    GraphPatternDetector gpd;
+    BuildPattern(gpd.mutable_pattern());
+    auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                       Graph* g) {
+      auto* a = subgraph.at(gpd.pattern().RetrieveNode("a"));
+      auto* a_out = subgraph.at(gpd.pattern().RetrieveNode("a_out"));
+      auto* b = subgraph.at(gpd.pattern().RetrieveNode("b"));
+      auto* b_out = subgraph.at(gpd.pattern().RetrieveNode("b_out"));
+      if (Fuse(g, a, a_out, b, b_out, writes)) ++fused;
+    };
+    gpd(graph.get(), handler);
+    fused_count += fused;
+  }
+
+  AddStatis(fused_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(elemwise_chain_fuse_pass,
+              paddle::framework::ir::ElemwiseChainFusePass);
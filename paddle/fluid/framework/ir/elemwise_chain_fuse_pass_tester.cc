@@ -0,0 +1,120 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/elemwise_chain_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetVar(ProgramDesc* prog, const std::string& name,
+            const std::vector<int64_t>& shape) {
+  auto* var = prog->MutableBlock(0)->Var(name);
+  var->SetType(proto::VarType::LOD_TENSOR);
+  var->SetDataType(proto::VarType::FP32);
+  var->SetShape(shape);
+}
+
+OpDesc* AppendOp(ProgramDesc* prog, const std::string& type,
+                 const std::vector<std::string>& x, const std::string& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", {x[0]});
+  if (x.size() > 1) op->SetInput("Y", {x[1]});
+  op->SetOutput("Out", {out});
+  return op;
+}
+
+// x->scale->s->elementwise_add(y)->a->sigmoid->g->elementwise_mul(z, g)->m
+//   ->relu->r
+// r->tanh->t->elementwise_sub(x)->d
+// r->exp->e->elementwise_add(b), broadcast->o
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& name : {"x", "y", "z", "s", "a", "g", "m", "r", "t", "d", "e",
+                     "o"}) {
+    SetVar(&prog, name, {-1, 4});
+  }
+  SetVar(&prog, "b", {4});
+
+  AppendOp(&prog, "scale", {"x"}, "s")->SetAttr("scale", 2.f);
+  AppendOp(&prog, "elementwise_add", {"s", "y"}, "a");
+  AppendOp(&prog, "sigmoid", {"a"}, "g");
+  AppendOp(&prog, "elementwise_mul", {"z", "g"}, "m");
+  AppendOp(&prog, "relu", {"m"}, "r");
+  AppendOp(&prog, "tanh", {"r"}, "t");
+  AppendOp(&prog, "elementwise_sub", {"t", "x"}, "d");
+  AppendOp(&prog, "exp", {"r"}, "e");
+  AppendOp(&prog, "elementwise_add", {"e", "b"}, "o");
+  return prog;
+}
+
+TEST(ElemwiseChainFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("elemwise_chain_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, OpDesc*> chains;
+  std::map<std::string, int> counts;
+  std::set<std::string> vars;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      vars.insert(node->Name());
+      continue;
+    }
+    ++counts[node->Op()->Type()];
+    if (node->Op()->Type() == "fusion_elemwise_chain") {
+      chains[node->Op()->Output("Out")[0]] = node->Op();
+    }
+  }
+  EXPECT_EQ(counts["fusion_elemwise_chain"], 2);
+  EXPECT_EQ(counts["exp"], 1);
+  EXPECT_EQ(counts["elementwise_add"], 1);
+  // x, y, z, b, r, d, e and o are left.
+  EXPECT_EQ(graph->Nodes().size(), 4UL + 8);
+  for (auto& name : {"s", "a", "g", "m", "t"}) {
+    EXPECT_EQ(vars.count(name), 0UL);
+  }
+
+  ASSERT_EQ(chains.count("r"), 1UL);
+  auto* chain = chains["r"];
+  EXPECT_EQ(chain->Input("X"), std::vector<std::string>({"x", "y", "z"}));
+  EXPECT_EQ(boost::get<std::vector<std::string>>(chain->GetAttr("functors")),
+            std::vector<std::string>({"scale", "elementwise_add", "sigmoid",
+                                      "elementwise_mul", "relu"}));
+  // z is the left operand of elementwise_mul.
+  EXPECT_EQ(boost::get<std::vector<int>>(chain->GetAttr("operands")),
+            std::vector<int>({0, 1, 0, -3, 0}));
+  EXPECT_EQ(boost::get<std::vector<float>>(chain->GetAttr("scales")),
+            std::vector<float>({2.f, 1.f, 1.f, 1.f, 1.f}));
+
+  ASSERT_EQ(chains.count("d"), 1UL);
+  chain = chains["d"];
+  EXPECT_EQ(chain->Input("X"), std::vector<std::string>({"r", "x"}));
+  EXPECT_EQ(boost::get<std::vector<std::string>>(chain->GetAttr("functors")),
+            std::vector<std::string>({"tanh", "elementwise_sub"}));
+  EXPECT_EQ(boost::get<std::vector<int>>(chain->GetAttr("operands")),
+            std::vector<int>({0, 1}));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(elemwise_chain_fuse_pass);
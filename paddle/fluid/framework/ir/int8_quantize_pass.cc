@@ -0,0 +1,205 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/int8_quantize_pass.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void Int8Scales::Save(const std::string& path) const {
+  std::ofstream fout(path);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write", path);
+  fout.precision(std::numeric_limits<float>::max_digits10);
+  // Sorted by name, so that the file does not depend on the hash order.
+  std::vector<std::string> names;
+  for (auto& item : max_abs) names.push_back(item.first);
+  std::sort(names.begin(), names.end());
+  for (auto& name : names) {
+    auto& scales = max_abs.at(name);
+    fout << name << " " << is_unsigned.count(name) << " " << scales.size();
+    for (float scale : scales) fout << " " << scale;
+    fout << "\n";
+  }
+}
+
+void Int8Scales::Load(const std::string& path) {
+  std::ifstream fin(path);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open %s to read", path);
+  std::string name;
+  int var_is_unsigned;
+  size_t size;
+  while (fin >> name >> var_is_unsigned >> size) {
+    auto& scales = max_abs[name];
+    scales.resize(size);
+    for (auto& scale : scales) {
+      PADDLE_ENFORCE(static_cast<bool>(fin >> scale),
+                     "Bad scales of %s in %s", name, path);
+    }
+    if (var_is_unsigned) is_unsigned.insert(name);
+  }
+}
+
+namespace {
+
+// Replaces the node `from` in the links by `to`.
+void ReplaceLinks(std::vector<Node*>* links, Node* from, Node* to) {
+  std::replace(links->begin(), links->end(), from, to);
+}
+
+Node* FindInput(Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+// Quantizes the weight w in (K, O) by channels of O into q in (O, K) if
+// transposed, else the weight in (O, K) into q in (O, K).
+void QuantizeWeight(const float* w, int64_t O, int64_t K, bool transposed,
+                    const std::vector<float>& max_abs, int8_t* q) {
+  for (int64_t o = 0; o < O; ++o) {
+    float scale = max_abs[max_abs.size() == 1 ? 0 : o];
+    float factor = scale > 0.f ? 127.f / scale : 0.f;
+    for (int64_t k = 0; k < K; ++k) {
+      float x = transposed ? w[k * O + o] : w[o * K + k];
+      float v = std::round(x * factor);
+      q[o * K + k] = static_cast<int8_t>(std::min(127.f, std::max(-127.f, v)));
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> Int8QuantizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("int8_quantize", graph.get());
+  if (!graph->Has(kInt8ScalesAttr)) {
+    LOG(WARNING) << "int8_quantize_pass runs without the scales";
+    return graph;
+  }
+  const auto& scales = graph->Get<Int8Scales>(kInt8ScalesAttr);
+  auto* scope = param_scope();
+
+  // Collected first, as the loop replaces the op nodes.
+  std::vector<Node*> ops;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() &&
+        (node->Op()->Type() == "fc" || node->Op()->Type() == "conv2d")) {
+      ops.push_back(node);
+    }
+  }
+  std::sort(ops.begin(), ops.end(),
+            [](Node* a, Node* b) { return a->id() < b->id(); });
+
+  int quantized_count = 0;
+  int64_t origin_bytes = 0;
+  int64_t quantized_bytes = 0;
+  for (auto* op : ops) {
+    auto* op_desc = op->Op();
+    bool is_fc = op_desc->Type() == "fc";
+    const std::string& x_name = op_desc->Input("Input")[0];
+    const std::string& w_name = op_desc->Input(is_fc ? "W" : "Filter")[0];
+    auto x_scale = scales.max_abs.find(x_name);
+    auto w_scale = scales.max_abs.find(w_name);
+    Node* w_node = FindInput(op, w_name);
+    auto* w_var = scope->FindVar(w_name);
+    if (x_scale == scales.max_abs.end() || x_scale->second.size() != 1UL ||
+        x_scale->second[0] <= 0.f || w_scale == scales.max_abs.end() ||
+        w_node == nullptr || w_node->outputs.size() != 1UL ||
+        w_var == nullptr || !w_var->IsType<LoDTensor>()) {
+      VLOG(3) << "not quantize " << op_desc->Type() << " of " << w_name;
+      continue;
+    }
+    auto* w = w_var->GetMutable<LoDTensor>();
+    if (w->type() != typeid(float) || (is_fc && w->dims().size() != 2) ||
+        (!is_fc && w->dims().size() != 4)) {
+      VLOG(3) << "not quantize " << op_desc->Type() << " of " << w_name;
+      continue;
+    }
+    int64_t O = is_fc ? w->dims()[1] : w->dims()[0];
+    int64_t K = w->numel() / O;
+    PADDLE_ENFORCE(w_scale->second.size() == 1UL ||
+                       static_cast<int64_t>(w_scale->second.size()) == O,
+                   "%s should have one scale or %d, got %d", w_name, O,
+                   w_scale->second.size());
+
+    DDim q_dims = is_fc ? make_ddim({O, K}) : w->dims();
+    LoDTensor q;
+    QuantizeWeight(w->data<float>(), O, K, is_fc, w_scale->second,
+                   q.mutable_data<int8_t>(q_dims, platform::CPUPlace()));
+    origin_bytes += w->numel() * sizeof(float);
+    quantized_bytes += q.numel() * sizeof(int8_t);
+    // The float weight is released with its last reference.
+    w->ShareDataWith(q);
+    if (w_node->Var()) {
+      w_node->Var()->SetDataType(proto::VarType::INT8);
+      w_node->Var()->SetShape(vectorize(q_dims));
+    }
+
+    OpDesc desc;
+    desc.SetType(is_fc ? "quantized_fc" : "quantized_conv2d");
+    desc.SetInput("Input", op_desc->Input("Input"));
+    if (is_fc) {
+      desc.SetInput("W", op_desc->Input("W"));
+      if (op_desc->Inputs().count("Bias")) {
+        desc.SetInput("Bias", op_desc->Input("Bias"));
+      }
+      desc.SetOutput("Out", op_desc->Output("Out"));
+    } else {
+      desc.SetInput("Filter", op_desc->Input("Filter"));
+      desc.SetOutput("Output", op_desc->Output("Output"));
+      for (const char* attr : {"strides", "paddings", "dilations", "groups"}) {
+        desc.SetAttr(attr, op_desc->GetAttr(attr));
+      }
+    }
+    desc.SetAttr("input_scale", x_scale->second[0]);
+    desc.SetAttr("input_is_unsigned",
+                 static_cast<bool>(scales.is_unsigned.count(x_name)));
+    desc.SetAttr("weight_scale", w_scale->second);
+
+    auto* quantized_op = graph->CreateOpNode(&desc);  // OpDesc will be copied.
+    quantized_op->inputs = op->inputs;
+    quantized_op->outputs = op->outputs;
+    for (auto* in : op->inputs) {
+      ReplaceLinks(&in->outputs, op, quantized_op);
+    }
+    for (auto* out : op->outputs) {
+      ReplaceLinks(&out->inputs, op, quantized_op);
+    }
+    graph->RemoveNode(op);
+    ++quantized_count;
+  }
+
+  LOG(INFO) << "int8_quantize_pass quantizes " << quantized_count
+            << " ops, weights " << origin_bytes << " -> " << quantized_bytes
+            << " bytes";
+  AddStatis(quantized_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(int8_quantize_pass, paddle::framework::ir::Int8QuantizePass);
@@ -0,0 +1,66 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static const char kInt8ScalesAttr[] = "__int8_scales__";
+
+// The scales of the variables of a model, collected by running it on sample
+// data.
+struct Int8Scales {
+  // The max absolute value of a variable, or of every output channel of a
+  // weight.
+  std::unordered_map<std::string, std::vector<float>> max_abs;
+  // The variables which had no negative value.
+  std::unordered_set<std::string> is_unsigned;
+
+  // One variable per line: name, 1 if it is unsigned else 0, the number of
+  // scales and the scales.
+  void Save(const std::string& path) const;
+  void Load(const std::string& path);
+};
+
+/*
+ * Rewrite fc and conv2d to quantized_fc and quantized_conv2d, which run in
+ * 8-bit integers, by the Int8Scales in the graph attribute kInt8ScalesAttr.
+ *
+ * An op is rewritten when the scales of its input and weight are known, and
+ * the weight is read by no other op. The weight is replaced by an int8 tensor
+ * in the parameter scope, which is the transpose of the weight for fc, so
+ * the weights take a quarter of the memory.
+ */
+class Int8QuantizePass : public FusePassBase {
+ public:
+  virtual ~Int8QuantizePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(std::unique_ptr<ir::Graph> graph) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,171 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/int8_quantize_pass.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetVar(ProgramDesc* prog, const std::string& name,
+            const std::vector<int64_t>& shape, bool persistable) {
+  auto* var = prog->MutableBlock(0)->Var(name);
+  var->SetType(proto::VarType::LOD_TENSOR);
+  var->SetDataType(proto::VarType::FP32);
+  var->SetShape(shape);
+  var->SetPersistable(persistable);
+}
+
+// x->conv2d(filter)->c->fc(w0, b0)->y0
+//                      \->fc(w1)->y1->fc(w1)->y2
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  SetVar(&prog, "x", {-1, 2, 3, 3}, false);
+  SetVar(&prog, "filter", {4, 2, 3, 3}, true);
+  SetVar(&prog, "c", {-1, 4, 1, 1}, false);
+  SetVar(&prog, "w0", {4, 3}, true);
+  SetVar(&prog, "b0", {3}, true);
+  SetVar(&prog, "y0", {-1, 3}, false);
+  SetVar(&prog, "w1", {4, 4}, true);
+  SetVar(&prog, "y1", {-1, 4}, false);
+  SetVar(&prog, "y2", {-1, 4}, false);
+
+  auto* conv = prog.MutableBlock(0)->AppendOp();
+  conv->SetType("conv2d");
+  conv->SetInput("Input", {"x"});
+  conv->SetInput("Filter", {"filter"});
+  conv->SetOutput("Output", {"c"});
+  conv->SetAttr("strides", std::vector<int>({1, 1}));
+  conv->SetAttr("paddings", std::vector<int>({0, 0}));
+  conv->SetAttr("dilations", std::vector<int>({1, 1}));
+  conv->SetAttr("groups", 1);
+  auto* fc0 = prog.MutableBlock(0)->AppendOp();
+  fc0->SetType("fc");
+  fc0->SetInput("Input", {"c"});
+  fc0->SetInput("W", {"w0"});
+  fc0->SetInput("Bias", {"b0"});
+  fc0->SetOutput("Out", {"y0"});
+  // w1 is shared by two fc.
+  auto* fc1 = prog.MutableBlock(0)->AppendOp();
+  fc1->SetType("fc");
+  fc1->SetInput("Input", {"c"});
+  fc1->SetInput("W", {"w1"});
+  fc1->SetOutput("Out", {"y1"});
+  auto* fc2 = prog.MutableBlock(0)->AppendOp();
+  fc2->SetType("fc");
+  fc2->SetInput("Input", {"y1"});
+  fc2->SetInput("W", {"w1"});
+  fc2->SetOutput("Out", {"y2"});
+  return prog;
+}
+
+void InitTensor(Scope* scope, const std::string& name,
+                const std::vector<int64_t>& shape) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data = tensor->mutable_data<float>(make_ddim(shape),
+                                            platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i % 5) - 2.f;
+  }
+}
+
+TEST(Int8QuantizePass, basic) {
+  auto prog = BuildProgramDesc();
+  Scope scope;
+  InitTensor(&scope, "filter", {4, 2, 3, 3});
+  InitTensor(&scope, "w0", {4, 3});
+  InitTensor(&scope, "b0", {3});
+  InitTensor(&scope, "w1", {4, 4});
+  auto* scales = new Int8Scales;
+  scales->max_abs["x"] = {1.f};
+  scales->max_abs["c"] = {4.f};
+  scales->max_abs["y1"] = {4.f};
+  scales->is_unsigned.insert("c");
+  // The filter by channel, and the weights of fc by tensor.
+  scales->max_abs["filter"] = {2.f, 2.f, 2.f, 2.f};
+  scales->max_abs["w0"] = {2.f};
+  scales->max_abs["w1"] = {2.f};
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  graph->Set(kInt8ScalesAttr, scales);
+  auto pass = PassRegistry::Instance().Get("int8_quantize_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, OpDesc*> ops;
+  int fc_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    if (node->Op()->Type() == "fc") {
+      ++fc_count;
+    } else {
+      ops[node->Op()->Type()] = node->Op();
+    }
+  }
+  // The fc sharing w1 are kept.
+  EXPECT_EQ(fc_count, 2);
+  ASSERT_EQ(ops.count("quantized_conv2d"), 1UL);
+  ASSERT_EQ(ops.count("quantized_fc"), 1UL);
+
+  auto* conv = ops["quantized_conv2d"];
+  EXPECT_EQ(boost::get<float>(conv->GetAttr("input_scale")), 1.f);
+  EXPECT_FALSE(boost::get<bool>(conv->GetAttr("input_is_unsigned")));
+  EXPECT_EQ(boost::get<std::vector<float>>(conv->GetAttr("weight_scale")),
+            std::vector<float>({2.f, 2.f, 2.f, 2.f}));
+  EXPECT_EQ(boost::get<int>(conv->GetAttr("groups")), 1);
+  auto* fc = ops["quantized_fc"];
+  EXPECT_EQ(fc->Input("Bias"), std::vector<std::string>({"b0"}));
+  EXPECT_EQ(fc->Output("Out"), std::vector<std::string>({"y0"}));
+  EXPECT_TRUE(boost::get<bool>(fc->GetAttr("input_is_unsigned")));
+
+  // The values -2, -1, 0, 1, 2 scaled by 2 are -127, -64, 0, 64, 127.
+  auto& filter = scope.FindVar("filter")->Get<LoDTensor>();
+  ASSERT_EQ(filter.type(), typeid(int8_t));
+  EXPECT_EQ(filter.dims(), make_ddim({4, 2, 3, 3}));
+  EXPECT_EQ(filter.data<int8_t>()[0], -127);
+  EXPECT_EQ(filter.data<int8_t>()[1], -64);
+  // w0 is transposed to (3, 4).
+  auto& w0 = scope.FindVar("w0")->Get<LoDTensor>();
+  ASSERT_EQ(w0.type(), typeid(int8_t));
+  EXPECT_EQ(w0.dims(), make_ddim({3, 4}));
+  std::vector<int8_t> expected_w0({-127, 64, -64, 127, -64, 127, 0, -127, 0,
+                                   -127, 64, -64});
+  EXPECT_EQ(std::vector<int8_t>(w0.data<int8_t>(), w0.data<int8_t>() + 12),
+            expected_w0);
+  EXPECT_EQ(scope.FindVar("w1")->Get<LoDTensor>().type(), typeid(float));
+}
+
+TEST(Int8QuantizePass, save_and_load_scales) {
+  Int8Scales scales;
+  scales.max_abs["x"] = {0.5f};
+  scales.max_abs["w"] = {1.f, 2.5f};
+  scales.is_unsigned.insert("x");
+  std::string path = "int8_quantize_pass_tester.scales";
+  scales.Save(path);
+  Int8Scales loaded;
+  loaded.Load(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(loaded.max_abs, scales.max_abs);
+  EXPECT_EQ(loaded.is_unsigned, scales.is_unsigned);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(int8_quantize_pass);
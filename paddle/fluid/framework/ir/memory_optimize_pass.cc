@@ -0,0 +1,273 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/memory_optimize_pass.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+struct VarLifetime {
+  int def{-1};       // the first operator writing the variable
+  int last_use{-1};  // the last operator reading or writing the variable
+  bool read{false};
+  bool skip{false};
+  std::vector<Node*> nodes;
+};
+
+struct Buffer {
+  std::string name;
+  proto::VarType::Type dtype;
+  bool has_batch;
+  int64_t bytes;
+  int free_after;
+  std::string holder;  // the last variable renamed to the buffer
+};
+
+int64_t SampleBytes(const VarDesc& desc, bool* has_batch) {
+  int64_t numel = 1;
+  *has_batch = false;
+  for (auto dim : desc.GetShape()) {
+    if (dim < 0) {
+      *has_batch = true;
+    } else {
+      numel *= dim;
+    }
+  }
+  return numel * SizeOfType(ToTypeIndex(desc.GetDataType()));
+}
+
+bool HasSubBlock(const OpDesc& op) {
+  for (auto& name : op.AttrNames()) {
+    auto type = op.GetAttrType(name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replace the node `from` in the links to `to`
+void ReplaceLinks(std::vector<Node*>* links, Node* from, Node* to) {
+  std::replace(links->begin(), links->end(), from, to);
+}
+
+// Whether a path leads from the operator `from` to the operator `to`.
+bool HasPath(Node* from, Node* to) {
+  std::unordered_set<Node*> visited;
+  std::vector<Node*> stack({from});
+  while (!stack.empty()) {
+    auto* node = stack.back();
+    stack.pop_back();
+    if (node == to) return true;
+    for (auto* out : node->outputs) {
+      if (visited.insert(out).second) stack.push_back(out);
+    }
+  }
+  return false;
+}
+
+// Append the operators using the nodes to `users`, and the ones writing them
+// to `writers`; either may be null.
+void CollectOps(const std::vector<Node*>& nodes, std::vector<Node*>* users,
+                std::vector<Node*>* writers) {
+  for (auto* node : nodes) {
+    for (auto* op : node->inputs) {
+      if (users) users->push_back(op);
+      if (writers) writers->push_back(op);
+    }
+    if (users) {
+      users->insert(users->end(), node->outputs.begin(), node->outputs.end());
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> MemoryOptimizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+
+  std::vector<Node*> ops = TopologySortOperations(*graph);
+  std::unordered_map<Node*, int> op_index;
+  // Ordered by name, so that the result does not depend on the node address.
+  std::map<std::string, VarLifetime> lifetimes;
+  for (int i = 0; i < static_cast<int>(ops.size()); ++i) {
+    auto* op = ops[i];
+    op_index[op] = i;
+    if (!op->Op()) continue;
+    const std::string& type = op->Op()->Type();
+    bool skip = type == "feed" || type == "fetch" || HasSubBlock(*op->Op());
+    for (auto* in : op->inputs) {
+      if (!in->IsVar() || !in->Var()) continue;
+      auto& lifetime = lifetimes[in->Name()];
+      lifetime.last_use = std::max(lifetime.last_use, i);
+      lifetime.read = true;
+      lifetime.skip |= skip;
+      lifetime.nodes.push_back(in);
+    }
+    for (auto* out : op->outputs) {
+      if (!out->IsVar() || !out->Var()) continue;
+      auto& lifetime = lifetimes[out->Name()];
+      if (lifetime.def < 0) lifetime.def = i;
+      lifetime.last_use = std::max(lifetime.last_use, i);
+      lifetime.skip |= skip;
+      lifetime.nodes.push_back(out);
+    }
+  }
+
+  // Candidates ordered by the operator writing them first.
+  std::vector<std::pair<int, std::string>> candidates;
+  for (auto& item : lifetimes) {
+    auto& lifetime = item.second;
+    auto* desc = lifetime.nodes.front()->Var();
+    if (lifetime.skip || lifetime.def < 0 || !lifetime.read ||
+        desc->Persistable() ||
+        desc->GetType() != proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    // A variable read before it is written is an input of the graph, and
+    // one never read may be fetched by name.
+    bool read_before_def = false;
+    for (auto* node : lifetime.nodes) {
+      for (auto* op : node->outputs) {
+        read_before_def |= op_index.at(op) <= lifetime.def;
+      }
+    }
+    if (read_before_def) continue;
+    candidates.emplace_back(lifetime.def, item.first);
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  MemoryOptimizeStat stat;
+  std::vector<Buffer> buffers;
+  std::map<std::string, std::string> renames;
+  std::vector<std::pair<Node*, Node*>> deps;
+  std::set<std::pair<Node*, Node*>> dep_set;
+  for (auto& candidate : candidates) {
+    auto& lifetime = lifetimes.at(candidate.second);
+    auto* desc = lifetime.nodes.front()->Var();
+    bool has_batch;
+    int64_t bytes = SampleBytes(*desc, &has_batch);
+    stat.origin_bytes += bytes;
+
+    // Prefer the smallest free buffer holding the variable, or else the
+    // largest one, which grows when the variable is written.
+    Buffer* best = nullptr;
+    for (auto& buffer : buffers) {
+      if (buffer.free_after >= lifetime.def ||
+          buffer.dtype != desc->GetDataType() ||
+          buffer.has_batch != has_batch) {
+        continue;
+      }
+      if (best == nullptr) {
+        best = &buffer;
+      } else if (best->bytes < bytes) {
+        if (buffer.bytes > best->bytes) best = &buffer;
+      } else if (buffer.bytes >= bytes && buffer.bytes < best->bytes) {
+        best = &buffer;
+      }
+    }
+    if (best == nullptr) {
+      buffers.push_back(Buffer{candidate.second, desc->GetDataType(),
+                               has_batch, bytes, lifetime.last_use,
+                               candidate.second});
+      continue;
+    }
+    VLOG(4) << "reuse " << best->name << " for " << candidate.second;
+    // The sorted order is only one of the valid ones, so every operator
+    // using the previous holder must run before the writers of the variable.
+    std::vector<Node*> users, writers;
+    CollectOps(lifetimes.at(best->holder).nodes, &users, nullptr);
+    CollectOps(lifetime.nodes, nullptr, &writers);
+    for (auto* user : users) {
+      for (auto* writer : writers) {
+        if (dep_set.emplace(user, writer).second) {
+          deps.emplace_back(user, writer);
+        }
+      }
+    }
+    best->bytes = std::max(best->bytes, bytes);
+    best->free_after = lifetime.last_use;
+    best->holder = candidate.second;
+    renames[candidate.second] = best->name;
+  }
+
+  for (auto& buffer : buffers) {
+    stat.optimized_bytes += buffer.bytes;
+  }
+  stat.reused_vars = static_cast<int>(renames.size());
+
+  // Rewrite the operators and the variable nodes.
+  for (auto& rename : renames) {
+    auto& lifetime = lifetimes.at(rename.first);
+    auto* buffer_desc = lifetimes.at(rename.second).nodes.front()->Var();
+    std::unordered_set<Node*> visited;
+    for (auto* node : lifetime.nodes) {
+      if (!visited.insert(node).second) continue;
+      auto* new_node = graph->CreateVarNode(buffer_desc);
+      new_node->inputs = node->inputs;
+      new_node->outputs = node->outputs;
+      for (auto* op : node->inputs) {
+        op->Op()->Rename(rename.first, rename.second);
+        ReplaceLinks(&op->outputs, node, new_node);
+      }
+      for (auto* op : node->outputs) {
+        op->Op()->Rename(rename.first, rename.second);
+        ReplaceLinks(&op->inputs, node, new_node);
+      }
+      graph->RemoveNode(node);
+    }
+  }
+
+  // Add the control dependencies not implied by the graph already.
+  for (auto& dep : deps) {
+    if (HasPath(dep.first, dep.second)) continue;
+    auto* dep_var = graph->CreateControlDepVar();
+    dep.first->outputs.push_back(dep_var);
+    dep_var->inputs.push_back(dep.first);
+    dep.second->inputs.push_back(dep_var);
+    dep_var->outputs.push_back(dep.second);
+  }
+
+  LOG(INFO) << "memory_optimize_pass reuses " << stat.reused_vars
+            << " variables, temporary memory per sample "
+            << stat.origin_bytes << " -> " << stat.optimized_bytes
+            << " bytes";
+  if (graph->Has(kMemoryOptimizeStatAttr)) {
+    graph->Get<MemoryOptimizeStat>(kMemoryOptimizeStatAttr) = stat;
+  } else {
+    graph->Set(kMemoryOptimizeStatAttr, new MemoryOptimizeStat(stat));
+  }
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(memory_optimize_pass, paddle::framework::ir::MemoryOptimizePass);
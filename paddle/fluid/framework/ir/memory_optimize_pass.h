@@ -0,0 +1,61 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static const char kMemoryOptimizeStatAttr[] = "__memory_optimize_stat__";
+
+// The memory of the temporary variables for one sample, that is, the batch
+// dimension (-1) of the shapes is taken as 1.
+struct MemoryOptimizeStat {
+  int reused_vars{0};
+  int64_t origin_bytes{0};
+  int64_t optimized_bytes{0};
+};
+
+/*
+ * Let temporary LoDTensors whose lifetimes do not overlap share one variable.
+ *
+ * The operators are sorted topologically, and a variable lives from the first
+ * operator writing it to the last operator reading it. A variable is renamed
+ * to a buffer variable that has the same data type and is dead before the
+ * variable is written; the executor then keeps one tensor for all of them and
+ * only reallocates it when a larger one is required. The operators using the
+ * previous variable of a buffer are linked to the writers of the next one by
+ * control dependencies, unless a path orders them already, so that any later
+ * topological sort keeps the reuse valid. Parameters, feed and fetch targets,
+ * variables without a writer or a reader in the graph and the variables of
+ * operators holding sub-blocks are never reused.
+ */
+class MemoryOptimizePass : public Pass {
+ public:
+  virtual ~MemoryOptimizePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(std::unique_ptr<ir::Graph> graph) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
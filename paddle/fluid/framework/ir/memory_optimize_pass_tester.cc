@@ -0,0 +1,162 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/memory_optimize_pass.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+}
+
+// feed->a->OP0->b->OP1->c->OP2->d->OP3->e->fetch
+//                     w-/
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v :
+       std::vector<std::string>({"feed", "a", "b", "c", "d", "e", "w"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({-1, 100});
+    if (v == "w") {
+      var->SetPersistable(true);
+    }
+  }
+  prog.MutableBlock(0)->Var("d")->SetShape({-1, 200});
+
+  SetOp(&prog, "feed", {"feed"}, {"a"});
+  SetOp(&prog, "OP0", {"a"}, {"b"});
+  SetOp(&prog, "OP1", {"b", "w"}, {"c"});
+  SetOp(&prog, "OP2", {"c"}, {"d"});
+  SetOp(&prog, "OP3", {"d"}, {"e"});
+  SetOp(&prog, "fetch", {"e"}, {"feed"});
+  return prog;
+}
+
+TEST(MemoryOptimizePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("memory_optimize_pass");
+  graph = pass->Apply(std::move(graph));
+
+  // b and c are the only temporaries; d reuses b, which is dead after OP1.
+  std::map<std::string, std::vector<std::string>> op_io;
+  std::set<std::string> var_names;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      var_names.insert(node->Name());
+    } else {
+      op_io[node->Op()->Type()] = node->Op()->Output("Out");
+    }
+  }
+  EXPECT_EQ(op_io["OP0"], std::vector<std::string>({"b"}));
+  EXPECT_EQ(op_io["OP1"], std::vector<std::string>({"c"}));
+  EXPECT_EQ(op_io["OP2"], std::vector<std::string>({"b"}));
+  // The feed and fetch targets are kept.
+  EXPECT_EQ(op_io["feed"], std::vector<std::string>({"a"}));
+  EXPECT_EQ(op_io["OP3"], std::vector<std::string>({"e"}));
+  EXPECT_EQ(var_names.count("d"), 0UL);
+
+  auto& stat = graph->Get<MemoryOptimizeStat>(kMemoryOptimizeStatAttr);
+  EXPECT_EQ(stat.reused_vars, 1);
+  EXPECT_EQ(stat.origin_bytes, (100 + 100 + 200) * 4);
+  EXPECT_EQ(stat.optimized_bytes, (200 + 100) * 4);
+}
+
+TEST(MemoryOptimizePass, keep_different_data_type) {
+  auto prog = BuildProgramDesc();
+  prog.MutableBlock(0)->Var("d")->SetDataType(proto::VarType::INT64);
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("memory_optimize_pass");
+  graph = pass->Apply(std::move(graph));
+
+  auto& stat = graph->Get<MemoryOptimizeStat>(kMemoryOptimizeStatAttr);
+  EXPECT_EQ(stat.reused_vars, 0);
+  EXPECT_EQ(stat.origin_bytes, stat.optimized_bytes);
+}
+
+bool HasPath(Node* from, Node* to) {
+  if (from == to) return true;
+  for (auto* out : from->outputs) {
+    if (HasPath(out, to)) return true;
+  }
+  return false;
+}
+
+// feed->a->OP0->b->OP1->c->OP4->f->fetch
+//       \->OP2->d->OP3->e-/
+TEST(MemoryOptimizePass, order_independent_branches) {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"feed", "a", "b", "c", "d", "e", "f"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({-1, 100});
+  }
+  SetOp(&prog, "feed", {"feed"}, {"a"});
+  SetOp(&prog, "OP0", {"a"}, {"b"});
+  SetOp(&prog, "OP1", {"b"}, {"c"});
+  SetOp(&prog, "OP2", {"a"}, {"d"});
+  SetOp(&prog, "OP3", {"d"}, {"e"});
+  SetOp(&prog, "OP4", {"c", "e"}, {"f"});
+  SetOp(&prog, "fetch", {"f"}, {"feed"});
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("memory_optimize_pass");
+  graph = pass->Apply(std::move(graph));
+
+  auto& stat = graph->Get<MemoryOptimizeStat>(kMemoryOptimizeStatAttr);
+  EXPECT_GT(stat.reused_vars, 0);
+  // Every operator using a variable is ordered with every writer of it, so
+  // that no topological sort lets a writer overwrite a value still needed.
+  std::map<std::string, std::vector<Node*>> users, writers;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* in : node->inputs) {
+      if (in->Var()) users[in->Name()].push_back(node);
+    }
+    for (auto* out : node->outputs) {
+      if (!out->Var()) continue;
+      users[out->Name()].push_back(node);
+      writers[out->Name()].push_back(node);
+    }
+  }
+  for (auto& item : writers) {
+    for (auto* writer : item.second) {
+      for (auto* user : users[item.first]) {
+        EXPECT_TRUE(HasPath(writer, user) || HasPath(user, writer))
+            << writer->Name() << " and " << user->Name() << " on "
+            << item.first;
+      }
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(memory_optimize_pass);
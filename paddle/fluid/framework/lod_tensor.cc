@@ -26,6 +26,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/memory.h"
 
 #if !defined(_WIN32)
+#include "paddle/fluid/recordio/mmap_scanner.h"
 #include "paddle/fluid/recordio/scanner.h"
 #include "paddle/fluid/recordio/writer.h"
 #endif  // _WIN32
@@ -249,7 +250,8 @@ void AppendLoD(LoD *lod, const LoD &lod_length) {
 }
 
 void SerializeToStream(std::ostream &os, const LoDTensor &tensor,
-                       const platform::DeviceContext &dev_ctx) {
+                       const platform::DeviceContext &dev_ctx,
+                       size_t data_alignment) {
   {  // the 1st field, uint32_t version for LoDTensor
     constexpr uint32_t version = 0;
     os.write(reinterpret_cast<const char *>(&version), sizeof(version));
@@ -272,7 +274,7 @@ void SerializeToStream(std::ostream &os, const LoDTensor &tensor,
     }
   }
   // the 3st field, Tensor
-  TensorToStream(os, static_cast<Tensor>(tensor), dev_ctx);
+  TensorToStream(os, static_cast<Tensor>(tensor), dev_ctx, data_alignment);
 }
 
 void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
@@ -302,6 +304,43 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx);
 }
 
+size_t DeserializeFromBuffer(const char *data, size_t size,
+                             const std::shared_ptr<void> &owner,
+                             LoDTensor *tensor) {
+  const char *pos = data;
+  const char *end = data + size;
+  auto read = [&pos, end](void *dst, size_t n) {
+    PADDLE_ENFORCE_LE(n, static_cast<size_t>(end - pos),
+                      "The buffer ends in the middle of a LoDTensor");
+    memcpy(dst, pos, n);
+    pos += n;
+  };
+  {
+    // the 1st field, unit32_t version for LoDTensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level;
+    read(&lod_level, sizeof(lod_level));
+    auto &lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t level_size;
+      read(&level_size, sizeof(level_size));
+      std::vector<size_t> tmp(level_size / sizeof(size_t));
+      read(tmp.data(), level_size);
+      lod[i] = tmp;
+    }
+  }
+  // the 3st filed, Tensor
+  pos += TensorFromBuffer(pos, static_cast<size_t>(end - pos), owner,
+                          static_cast<Tensor *>(tensor));
+  return static_cast<size_t>(pos - data);
+}
+
 #if !defined(_WIN32)
 void WriteToRecordIO(recordio::Writer *writer,
                      const std::vector<LoDTensor> &tensor,
@@ -332,9 +371,28 @@ bool ReadFromRecordIO(recordio::Scanner *scanner,
 
   return true;
 }
+
+bool ReadFromRecordIO(recordio::MmapScanner *scanner,
+                      const platform::DeviceContext &dev_ctx,
+                      std::vector<LoDTensor> *result_ptr) {
+  if (!scanner->HasNext()) {
+    return false;
+  }
+  recordio::RecordViewStream sin(scanner->Next());
+  uint32_t sz;
+  sin.read(reinterpret_cast<char *>(&sz), sizeof(uint32_t));
+  auto &result = *result_ptr;
+  result.resize(sz);
+  for (uint32_t i = 0; i < sz; ++i) {
+    DeserializeFromStream(sin, &result[i], dev_ctx);
+  }
+
+  return true;
+}
 #else
 class Writer {};
 class Scanner {};
+class MmapScanner {};
 void WriteToRecordIO(recordio::Writer *writer,
                      const std::vector<LoDTensor> &tensor,
                      const platform::DeviceContext &dev_ctx) {}
@@ -344,6 +402,12 @@ bool ReadFromRecordIO(recordio::Scanner *scanner,
   PADDLE_ENFORCE("windows didn't supported recordio!.");
   return true;
 }
+bool ReadFromRecordIO(recordio::MmapScanner *scanner,
+                      const platform::DeviceContext &dev_ctx,
+                      std::vector<LoDTensor> *result_ptr) {
+  PADDLE_ENFORCE("windows didn't supported recordio!.");
+  return true;
+}
 #endif  // _WIN32
 std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
     const std::vector<platform::Place> places) const {
@@ -364,35 +428,56 @@ std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
       end += remainder;
     }
 
-    LoDTensor dst;
-    if (lod().empty()) {
-      auto src = Slice(begin, end);
-      auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
-    } else {
-      auto lod_and_offset = GetSubLoDAndAbsoluteOffset(lod(), begin, end, 0);
-
-      auto &offset = lod_and_offset.second;
-      auto src = Slice(offset.first, offset.second);
-      auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
-
-      LoD my_lod;
-      for (auto &l : lod_and_offset.first) {
-        std::vector<size_t> v{0};
-        for (auto &ll : l) {
-          v.push_back(ll + v.back());
-        }
-        my_lod.emplace_back(v);
-      }
-      dst.set_lod(my_lod);
-    }
-    results.emplace_back(dst);
+    results.emplace_back(CopyBatch(begin, end, places[i]));
   }
 
   return results;
 }
 
+std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
+    const std::vector<size_t> &batch_sizes, platform::Place place) const {
+  check_memory_size();
+  size_t batch_size = lod().empty() ? static_cast<size_t>(dims()[0])
+                                    : lod()[0].size() - 1;
+  std::vector<LoDTensor> results;
+  results.reserve(batch_sizes.size());
+  size_t begin = 0;
+  for (size_t size : batch_sizes) {
+    PADDLE_ENFORCE_LE(begin + size, batch_size,
+                      "The batch sizes exceed the batch of the tensor.");
+    results.emplace_back(CopyBatch(static_cast<int>(begin),
+                                   static_cast<int>(begin + size), place));
+    begin += size;
+  }
+  return results;
+}
+
+LoDTensor LoDTensor::CopyBatch(int begin, int end,
+                               platform::Place place) const {
+  LoDTensor dst;
+  if (lod().empty()) {
+    auto src = Slice(begin, end);
+    framework::TensorCopy(src, place, &dst);
+  } else {
+    auto lod_and_offset = GetSubLoDAndAbsoluteOffset(lod(), begin, end, 0);
+
+    auto &offset = lod_and_offset.second;
+    auto src = Slice(offset.first, offset.second);
+    framework::TensorCopy(src, place, &dst);
+
+    LoD my_lod;
+    for (auto &l : lod_and_offset.first) {
+      std::vector<size_t> v{0};
+      for (auto &ll : l) {
+        v.push_back(ll + v.back());
+      }
+      my_lod.emplace_back(v);
+    }
+    dst.set_lod(my_lod);
+  }
+  return dst;
+}
+
 void LoDTensor::MergeLoDTensor(
     const std::vector<const LoDTensor *> &lod_tensors,
     platform::Place dst_place) {
@@ -36,6 +36,7 @@ namespace paddle {
 namespace recordio {
 class Writer;
 class Scanner;
+class MmapScanner;
 }
 
 namespace framework {
@@ -149,10 +150,19 @@ class LoDTensor : public Tensor {
   std::vector<LoDTensor> SplitLoDTensor(
       const std::vector<platform::Place> places) const;
 
+  // Split LoDTensor into parts of the given batch sizes, i.e. numbers of
+  // top level sequences, or rows if there is no LoD, and copy them to place.
+  std::vector<LoDTensor> SplitLoDTensor(const std::vector<size_t>& batch_sizes,
+                                        platform::Place place) const;
+
   void MergeLoDTensor(const std::vector<const LoDTensor*>& lod_tensors,
                       platform::Place place);
 
  private:
+  // Copy the sequences [begin, end) of the top level, or the rows if there is
+  // no LoD, to place.
+  LoDTensor CopyBatch(int begin, int end, platform::Place place) const;
+
   LoD lod_;
 };
 
@@ -213,12 +223,24 @@ void AppendLoD(LoD* lod, const LoD& lod_length);
  * Serialize/Desiralize LoDTensor to std::ostream
  * You can pass ofstream or ostringstream to serilize to file
  * or to a in memory string. GPU tensor will be copied to CPU.
+ * If data_alignment is not 0, the tensor data starts at a multiple of
+ * data_alignment bytes in the stream, see TensorToStream.
  */
 void SerializeToStream(std::ostream& os, const LoDTensor& tensor,
-                       const platform::DeviceContext& dev_ctx);
+                       const platform::DeviceContext& dev_ctx,
+                       size_t data_alignment = 0);
 void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx);
 
+/*
+ * Deserialize a CPU LoDTensor from the memory [data, data + size) and return
+ * the number of bytes read. The tensor shares aligned data with the memory
+ * and keeps owner alive if owner is not null, see TensorFromBuffer.
+ */
+size_t DeserializeFromBuffer(const char* data, size_t size,
+                             const std::shared_ptr<void>& owner,
+                             LoDTensor* tensor);
+
 extern void WriteToRecordIO(recordio::Writer* writer,
                             const std::vector<LoDTensor>& tensor,
                             const platform::DeviceContext& dev_ctx);
@@ -227,6 +249,11 @@ extern bool ReadFromRecordIO(recordio::Scanner* scanner,
                              const platform::DeviceContext& dev_ctx,
                              std::vector<LoDTensor>* result_ptr);
 
+// Deserialize the record in place, without copying it out of the file.
+extern bool ReadFromRecordIO(recordio::MmapScanner* scanner,
+                             const platform::DeviceContext& dev_ctx,
+                             std::vector<LoDTensor>* result_ptr);
+
 /*
  * Convert between length-based LoD and offset-based LoD.
  * The implementation of LoDTensor class use offset-based LoD.
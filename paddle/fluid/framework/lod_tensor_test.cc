@@ -156,6 +156,46 @@ TEST(LoD, SplitLoDTensor) {
   EXPECT_EQ(lods[1].lod(), lod1);
 }
 
+TEST(LoD, SplitLoDTensorByBatchSizes) {
+  LoD lod;
+  lod.push_back(std::vector<size_t>({0, 2, 4, 5, 6}));
+  lod.push_back(std::vector<size_t>({0, 1, 6, 8, 13, 15, 20}));
+
+  platform::CPUPlace place;
+  LoDTensor lod_tensor;
+  lod_tensor.Resize({20, 1});
+  float* dst_ptr = lod_tensor.mutable_data<float>(place);
+  for (int i = 0; i < lod_tensor.numel(); ++i) {
+    dst_ptr[i] = i;
+  }
+  lod_tensor.set_lod(lod);
+
+  LoD lod0;
+  lod0.push_back(std::vector<size_t>({0, 2}));
+  lod0.push_back(std::vector<size_t>({0, 1, 6}));
+  LoD lod1;
+  lod1.push_back(std::vector<size_t>({0, 2, 3, 4}));
+  lod1.push_back(std::vector<size_t>({0, 2, 7, 9, 14}));
+
+  auto lods = lod_tensor.SplitLoDTensor(std::vector<size_t>({1, 3}), place);
+  ASSERT_EQ(lods.size(), 2UL);
+  EXPECT_EQ(lods[0].lod(), lod0);
+  EXPECT_EQ(lods[1].lod(), lod1);
+  EXPECT_EQ(lods[1].dims()[0], 14);
+  EXPECT_EQ(lods[1].data<float>()[0], 6);
+
+  LoDTensor tensor;
+  tensor.Resize({5, 2});
+  dst_ptr = tensor.mutable_data<float>(place);
+  for (int i = 0; i < tensor.numel(); ++i) {
+    dst_ptr[i] = i;
+  }
+  auto parts = tensor.SplitLoDTensor(std::vector<size_t>({2, 3}), place);
+  EXPECT_EQ(parts[0].dims(), make_ddim({2, 2}));
+  EXPECT_EQ(parts[1].dims(), make_ddim({3, 2}));
+  EXPECT_EQ(parts[1].data<float>()[0], 4);
+}
+
 TEST(LoD, MergeLoDTensor) {
   LoD lod;
   lod.push_back(std::vector<size_t>({0, 2, 4, 5, 6}));
@@ -369,36 +369,79 @@ static Tensor* GetMutableTensorFromVar(Variable* var) {
   }
 }
 
+RuntimeContext::RuntimeContext(const VariableNameMap& innames,
+                               const VariableNameMap& outnames,
+                               const Scope& scope) {
+  auto resolve = [&](const VariableNameMap& names, VariableValueMap* values) {
+    for (auto& var_name_item : names) {
+      std::vector<Variable*>& vars = (*values)[var_name_item.first];
+      vars.reserve(var_name_item.second.size());
+      for (auto& var_name : var_name_item.second) {
+        if (var_name == kEmptyVarName) {
+          vars.push_back(nullptr);
+          continue;
+        }
+        auto* var = scope.FindVar(var_name);
+        complete = complete && var != nullptr;
+        vars.push_back(var);
+      }
+    }
+  };
+  resolve(innames, &inputs);
+  resolve(outnames, &outputs);
+}
+
+const std::vector<Variable*>& ExecutionContext::MultiInputVariables(
+    const std::string& name) const {
+  auto it = ctx_.inputs.find(name);
+  PADDLE_ENFORCE(it != ctx_.inputs.end(),
+                 "Operator %s does not have the input %s.", op_.Type(), name);
+  return it->second;
+}
+
+const std::vector<Variable*>& ExecutionContext::MultiOutputVariables(
+    const std::string& name) const {
+  auto it = ctx_.outputs.find(name);
+  PADDLE_ENFORCE(it != ctx_.outputs.end(),
+                 "Operator %s does not have an output called %s.", op_.Type(),
+                 name);
+  return it->second;
+}
+
+const Variable* ExecutionContext::InputVar(const std::string& name) const {
+  auto& vars = MultiInputVariables(name);
+  PADDLE_ENFORCE_LE(vars.size(), 1UL,
+                    "Operator %s's input %s should contain only one variable.",
+                    op_.Type(), name);
+  return vars.empty() ? nullptr : vars[0];
+}
+
+Variable* ExecutionContext::OutputVar(const std::string& name) const {
+  auto& vars = MultiOutputVariables(name);
+  PADDLE_ENFORCE_LE(vars.size(), 1UL,
+                    "Operator %s's output %s should contain only one variable.",
+                    op_.Type(), name);
+  return vars.empty() ? nullptr : vars[0];
+}
+
 bool ExecutionContext::HasInput(const std::string& name) const {
-  if (!op_.HasInputs(name)) {
+  auto it = ctx_.inputs.find(name);
+  if (it == ctx_.inputs.end() || it->second.empty()) {
     return false;
   }
-  auto& ins = Inputs(name);
-  size_t length = ins.size();
-  if (length == 0) {
-    return false;
-  }
-  PADDLE_ENFORCE_EQ(length, 1UL,
+  PADDLE_ENFORCE_EQ(it->second.size(), 1UL,
                     "Input %s should not have more than one inputs", name);
-  auto arg = ins[0];
-  auto* var = arg == kEmptyVarName ? nullptr : scope_.FindVar(arg);
-  return var != nullptr;
+  return it->second[0] != nullptr;
 }
 
 bool ExecutionContext::HasOutput(const std::string& name) const {
-  if (!op_.HasOutputs(name)) {
+  auto it = ctx_.outputs.find(name);
+  if (it == ctx_.outputs.end() || it->second.empty()) {
     return false;
   }
-  auto& outs = Outputs(name);
-  size_t length = outs.size();
-  if (length == 0) {
-    return false;
-  }
-  PADDLE_ENFORCE_EQ(length, 1UL,
+  PADDLE_ENFORCE_EQ(it->second.size(), 1UL,
                     "Output %s should not have more than one inputs", name);
-  auto arg = outs[0];
-  auto* var = arg == kEmptyVarName ? nullptr : scope_.FindVar(arg);
-  return var != nullptr;
+  return it->second[0] != nullptr;
 }
 
 template <>
@@ -411,12 +454,11 @@ const Tensor* ExecutionContext::Input<Tensor>(const std::string& name) const {
 template <>
 const std::vector<const Tensor*> ExecutionContext::MultiInput<Tensor>(
     const std::string& name) const {
-  auto names = op().Inputs(name);
+  auto& vars = MultiInputVariables(name);
   std::vector<const Tensor*> res;
-  res.reserve(names.size());
-  std::transform(names.begin(), names.end(), std::back_inserter(res),
-                 [&](const std::string& sub_name) {
-                   auto var = scope_.FindVar(sub_name);
+  res.reserve(vars.size());
+  std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                 [&](Variable* var) {
                    return var == nullptr ? nullptr : GetTensorFromVar(var);
                  });
   return res;
@@ -431,12 +473,11 @@ Tensor* ExecutionContext::Output<Tensor>(const std::string& name) const {
 template <>
 std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
     const std::string& name) const {
-  auto names = op().Outputs(name);
+  auto& vars = MultiOutputVariables(name);
   std::vector<Tensor*> res;
-  res.reserve(names.size());
-  std::transform(names.begin(), names.end(), std::back_inserter(res),
-                 [&](const std::string& sub_name) {
-                   auto var = scope_.FindVar(sub_name);
+  res.reserve(vars.size());
+  std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                 [&](Variable* var) {
                    return var == nullptr ? nullptr
                                          : GetMutableTensorFromVar(var);
                  });
@@ -460,51 +501,37 @@ bool OpSupportGPU(const std::string& op_type) {
 
 class RuntimeInferShapeContext : public InferShapeContext {
  public:
-  RuntimeInferShapeContext(const OperatorBase& op, const Scope& scope)
-      : op_(op), scope_(scope) {}
+  RuntimeInferShapeContext(const OperatorBase& op, const Scope& scope,
+                           const RuntimeContext& ctx)
+      : op_(op), scope_(scope), ctx_(ctx) {}
 
   bool HasInput(const std::string& name) const override {
-    if (!op_.HasInputs(name)) {
-      return false;
-    }
-    auto& ins = Inputs(name);
-    size_t length = ins.size();
-    if (length == 0) {
+    auto it = ctx_.inputs.find(name);
+    if (it == ctx_.inputs.end() || it->second.empty()) {
       return false;
     }
-    PADDLE_ENFORCE_EQ(length, 1UL,
+    PADDLE_ENFORCE_EQ(it->second.size(), 1UL,
                       "Input %s should not have more than one inputs", name);
-    auto ipt = ins[0];
-    auto* var = ipt == kEmptyVarName ? nullptr : scope_.FindVar(ipt);
-    return var != nullptr;
+    return it->second[0] != nullptr;
   }
 
   bool HasOutput(const std::string& name) const override {
-    if (!op_.HasOutputs(name)) {
+    auto it = ctx_.outputs.find(name);
+    if (it == ctx_.outputs.end() || it->second.empty()) {
       return false;
     }
-    auto& outs = Outputs(name);
-    size_t length = outs.size();
-    if (length == 0) {
-      return false;
-    }
-    PADDLE_ENFORCE_EQ(length, 1UL,
+    PADDLE_ENFORCE_EQ(it->second.size(), 1UL,
                       "Output %s should not have more than one inputs", name);
-    auto ipt = outs[0];
-    auto* var = ipt == kEmptyVarName ? nullptr : scope_.FindVar(ipt);
-    return var != nullptr;
+    return it->second[0] != nullptr;
   }
 
   bool HasInputs(const std::string& name) const override {
-    if (!op_.HasInputs(name)) {
-      return false;
-    }
-    auto inputs = op_.Inputs(name);
-    if (inputs.empty()) {
+    auto it = ctx_.inputs.find(name);
+    if (it == ctx_.inputs.end() || it->second.empty()) {
       return false;
     }
-    for (auto& input : inputs) {
-      if (scope_.FindVar(input) == nullptr) {
+    for (auto* var : it->second) {
+      if (var == nullptr) {
         return false;
       }
     }
@@ -512,15 +539,12 @@ class RuntimeInferShapeContext : public InferShapeContext {
   }
 
   bool HasOutputs(const std::string& name) const override {
-    if (!op_.HasOutputs(name)) {
+    auto it = ctx_.outputs.find(name);
+    if (it == ctx_.outputs.end() || it->second.empty()) {
       return false;
     }
-    auto outputs = op_.Outputs(name);
-    if (outputs.empty()) {
-      return false;
-    }
-    for (auto& output : outputs) {
-      if (scope_.FindVar(output) == nullptr) {
+    for (auto* var : it->second) {
+      if (var == nullptr) {
         return false;
       }
     }
@@ -541,10 +565,12 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   void ShareLoD(const std::string& in, const std::string& out, size_t i = 0,
                 size_t j = 0) const override {
-    PADDLE_ENFORCE_LT(i, Inputs(in).size());
-    PADDLE_ENFORCE_LT(j, Outputs(out).size());
-    Variable* in_var = scope_.FindVar(Inputs(in)[i]);
-    Variable* out_var = scope_.FindVar(Outputs(out)[j]);
+    auto& in_vars = ctx_.inputs.at(in);
+    auto& out_vars = ctx_.outputs.at(out);
+    PADDLE_ENFORCE_LT(i, in_vars.size());
+    PADDLE_ENFORCE_LT(j, out_vars.size());
+    Variable* in_var = in_vars[i];
+    Variable* out_var = out_vars[j];
     if (!in_var->IsType<LoDTensor>()) return;
     PADDLE_ENFORCE(out_var->IsType<LoDTensor>(),
                    "The %d-th output of Output(%s) must be LoDTensor.", j, out);
@@ -575,10 +601,12 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   void ShareLayout(const std::string& in, const std::string& out, size_t i = 0,
                    size_t j = 0) const {
-    PADDLE_ENFORCE_LT(i, Inputs(in).size());
-    PADDLE_ENFORCE_LT(j, Outputs(out).size());
-    Variable* in_var = scope_.FindVar(Inputs(in)[i]);
-    Variable* out_var = scope_.FindVar(Outputs(out)[j]);
+    auto& in_vars = ctx_.inputs.at(in);
+    auto& out_vars = ctx_.outputs.at(out);
+    PADDLE_ENFORCE_LT(i, in_vars.size());
+    PADDLE_ENFORCE_LT(j, out_vars.size());
+    Variable* in_var = in_vars[i];
+    Variable* out_var = out_vars[j];
     if (!in_var->IsType<LoDTensor>()) return;
     PADDLE_ENFORCE(out_var->IsType<LoDTensor>(),
                    "The %d-th output of Output(%s) must be LoDTensor.", j, out);
@@ -638,6 +666,7 @@ class RuntimeInferShapeContext : public InferShapeContext {
  private:
   const OperatorBase& op_;
   const Scope& scope_;
+  const RuntimeContext& ctx_;
 };
 
 static void CheckTensorNANOrInf(const std::string& name,
@@ -656,8 +685,65 @@ static void CheckTensorNANOrInf(const std::string& name,
 
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place) const {
-  RuntimeInferShapeContext infer_shape_ctx(*this, scope);
-  this->InferShape(&infer_shape_ctx);
+  if (!enable_runtime_cache_) {
+    RuntimeContext ctx(Inputs(), Outputs(), scope);
+    RunImpl(scope, place, &ctx);
+    return;
+  }
+  if (runtime_ctx_ == nullptr || pre_scope_ != &scope) {
+    runtime_ctx_.reset(new RuntimeContext(Inputs(), Outputs(), scope));
+    // A variable that is not in the scope yet may be created later, so the
+    // variables are resolved again on the next run.
+    pre_scope_ = runtime_ctx_->complete ? &scope : nullptr;
+  }
+  RunImpl(scope, place, runtime_ctx_.get());
+}
+
+// The kind, data type and layout of an input variable, which is what the
+// expected kernel type depends on besides the place and the attributes.
+static int VarKernelTypeCode(const Variable* var) {
+  constexpr int kSelectedRowsOffset = 1 << 8;
+  constexpr int kLayoutShift = 9;
+  auto tensor_code = [](const Tensor& tensor) {
+    return static_cast<int>(ToDataType(tensor.type())) +
+           (static_cast<int>(tensor.layout()) << kLayoutShift);
+  };
+  if (var == nullptr) {
+    return -1;
+  }
+  if (var->IsType<LoDTensor>()) {
+    auto& tensor = var->Get<LoDTensor>();
+    return tensor.IsInitialized() ? tensor_code(tensor) : -2;
+  }
+  if (var->IsType<SelectedRows>()) {
+    auto& tensor = var->Get<SelectedRows>().value();
+    return tensor.IsInitialized() ? kSelectedRowsOffset + tensor_code(tensor)
+                                  : -3;
+  }
+  return -4;
+}
+
+bool OperatorWithKernel::KernelCacheHit(const RuntimeContext& ctx,
+                                        const platform::Place& place) const {
+  if (kernel_func_ == nullptr || !(kernel_place_ == place)) {
+    return false;
+  }
+  size_t i = 0;
+  for (auto& var_pair : ctx.inputs) {
+    for (auto* var : var_pair.second) {
+      if (i >= kernel_input_types_.size() ||
+          VarKernelTypeCode(var) != kernel_input_types_[i]) {
+        return false;
+      }
+      ++i;
+    }
+  }
+  return i == kernel_input_types_.size();
+}
+
+const OperatorWithKernel::OpKernelFunc* OperatorWithKernel::ChooseKernel(
+    const RuntimeContext& ctx, const Scope& scope,
+    const platform::Place& place, OpKernelType* kernel_type) const {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
@@ -678,8 +764,8 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   //   Do selection
   // }
 
-  auto expected_kernel_key =
-      this->GetExpectedKernelType(ExecutionContext(*this, scope, *dev_ctx));
+  auto expected_kernel_key = this->GetExpectedKernelType(
+      ExecutionContext(*this, scope, *dev_ctx, ctx));
   VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
 
   auto kernel_iter = kernels.find(expected_kernel_key);
@@ -697,22 +783,62 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
     PADDLE_THROW("op %s does not have kernel for %s", type_,
                  KernelTypeToString(expected_kernel_key));
   }
+  *kernel_type = expected_kernel_key;
+  return &kernel_iter->second;
+}
+
+void OperatorWithKernel::RunImpl(const Scope& scope,
+                                 const platform::Place& place,
+                                 RuntimeContext* runtime_ctx) const {
+  RuntimeInferShapeContext infer_shape_ctx(*this, scope, *runtime_ctx);
+  this->InferShape(&infer_shape_ctx);
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+
+  // overwritten by ChooseKernel.
+  OpKernelType chosen_kernel_type(proto::VarType::FP32, place);
+  const OpKernelType* expected_kernel_key = &chosen_kernel_type;
+  const OpKernelFunc* kernel_func = nullptr;
+  platform::DeviceContext* dev_ctx = nullptr;
+  if (enable_runtime_cache_) {
+    if (!KernelCacheHit(*runtime_ctx, place)) {
+      kernel_type_.reset(new OpKernelType(proto::VarType::FP32, place));
+      kernel_func_ =
+          ChooseKernel(*runtime_ctx, scope, place, kernel_type_.get());
+      kernel_dev_ctx_ = pool.Get(kernel_type_->place_);
+      kernel_place_ = place;
+      kernel_input_types_.clear();
+      for (auto& var_pair : runtime_ctx->inputs) {
+        for (auto* var : var_pair.second) {
+          kernel_input_types_.push_back(VarKernelTypeCode(var));
+        }
+      }
+    }
+    expected_kernel_key = kernel_type_.get();
+    kernel_func = kernel_func_;
+    dev_ctx = kernel_dev_ctx_;
+  } else {
+    kernel_func = ChooseKernel(*runtime_ctx, scope, place, &chosen_kernel_type);
+    dev_ctx = pool.Get(chosen_kernel_type.place_);
+  }
 
   // do data transformScope &transfer_scope;
   std::vector<std::string> transfered_inplace_vars;
   auto* transfer_scope =
-      TryTransferData(scope, expected_kernel_key, &transfered_inplace_vars);
+      TryTransferData(scope, *expected_kernel_key, *runtime_ctx,
+                      &transfered_inplace_vars);
 
   // exec scope is the scope that kernel actually executed on.
   const Scope& exec_scope =
       (transfer_scope == nullptr ? scope : *transfer_scope);
 
-  if (!(expected_kernel_key.place_ == dev_ctx->GetPlace())) {
-    dev_ctx = pool.Get(expected_kernel_key.place_);
+  if (transfer_scope == nullptr) {
+    (*kernel_func)(ExecutionContext(*this, exec_scope, *dev_ctx, *runtime_ctx));
+  } else {
+    // some inputs have been transformed into the transfer scope.
+    RuntimeContext exec_ctx(Inputs(), Outputs(), exec_scope);
+    (*kernel_func)(ExecutionContext(*this, exec_scope, *dev_ctx, exec_ctx));
   }
 
-  kernel_iter->second(ExecutionContext(*this, exec_scope, *dev_ctx));
-
   if (!transfered_inplace_vars.empty()) {
     // there is inplace variable has been transfered.
     TransferInplaceVarsBack(scope, transfered_inplace_vars, *transfer_scope);
@@ -735,6 +861,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
     }
   }
 }
+
 void OperatorWithKernel::TransferInplaceVarsBack(
     const Scope& scope, const std::vector<std::string>& inplace_vars,
     const Scope& transfer_scope) const {
@@ -749,11 +876,14 @@ void OperatorWithKernel::TransferInplaceVarsBack(
 
 Scope* OperatorWithKernel::TryTransferData(
     const Scope& scope, const OpKernelType& expected_kernel_key,
+    const RuntimeContext& ctx,
     std::vector<std::string>* transfered_inplace_vars) const {
   Scope* new_scope = nullptr;
   for (auto& var_name_item : Inputs()) {
-    for (auto& var_name : var_name_item.second) {
-      auto* var = scope.FindVar(var_name);
+    auto& vars = ctx.inputs.at(var_name_item.first);
+    for (size_t i = 0; i < var_name_item.second.size(); ++i) {
+      auto& var_name = var_name_item.second[i];
+      auto* var = vars[i];
       // Only tensor can be tranfer to another device.
       if (var == nullptr || !VarIsTensor(var)) {
         continue;
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <algorithm>
 #include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -141,11 +143,28 @@ class OperatorBase {
                        const platform::Place& place) const = 0;
 };
 
+using VariableValueMap = std::map<std::string, std::vector<Variable*>>;
+
+// RuntimeContext holds the variables of an operator's inputs and outputs,
+// resolved from a scope once, so that running the operator does not look
+// them up by name again and again.
+class RuntimeContext {
+ public:
+  RuntimeContext(const VariableNameMap& innames,
+                 const VariableNameMap& outnames, const Scope& scope);
+
+  VariableValueMap inputs;
+  VariableValueMap outputs;
+  // Whether every non-empty variable name has been found in the scope.
+  bool complete{true};
+};
+
 class ExecutionContext {
  public:
   ExecutionContext(const OperatorBase& op, const Scope& scope,
-                   const platform::DeviceContext& device_context)
-      : op_(op), scope_(scope), device_context_(device_context) {}
+                   const platform::DeviceContext& device_context,
+                   const RuntimeContext& ctx)
+      : op_(op), scope_(scope), device_context_(device_context), ctx_(ctx) {}
 
   const OperatorBase& op() const { return op_; }
 
@@ -168,39 +187,18 @@ class ExecutionContext {
     return op_.Outputs(name).size();
   }
 
-  const Variable* InputVar(const std::string& name) const {
-    auto ipt = op_.Input(name);
-    return ipt == kEmptyVarName ? nullptr : scope_.FindVar(ipt);
-  }
+  const Variable* InputVar(const std::string& name) const;
 
-  Variable* OutputVar(const std::string& name) const {
-    auto opt = op_.Output(name);
-    return opt == kEmptyVarName ? nullptr : scope_.FindVar(opt);
-  }
+  Variable* OutputVar(const std::string& name) const;
 
   const std::vector<const Variable*> MultiInputVar(
       const std::string& name) const {
-    auto names = op_.Inputs(name);
-    std::vector<const Variable*> res;
-    res.reserve(names.size());
-    std::transform(names.begin(), names.end(), std::back_inserter(res),
-                   [this](const std::string& name) {
-                     return name == kEmptyVarName ? nullptr
-                                                  : scope_.FindVar(name);
-                   });
-    return res;
+    auto& vars = MultiInputVariables(name);
+    return std::vector<const Variable*>(vars.begin(), vars.end());
   }
 
   std::vector<Variable*> MultiOutputVar(const std::string& name) const {
-    auto names = op_.Outputs(name);
-    std::vector<Variable*> res;
-    res.reserve(names.size());
-    std::transform(names.begin(), names.end(), std::back_inserter(res),
-                   [this](const std::string& name) {
-                     return name == kEmptyVarName ? nullptr
-                                                  : scope_.FindVar(name);
-                   });
-    return res;
+    return MultiOutputVariables(name);
   }
 
   template <typename T>
@@ -217,12 +215,11 @@ class ExecutionContext {
 
   template <typename T>
   const std::vector<const T*> MultiInput(const std::string& name) const {
-    auto names = op_.Inputs(name);
+    auto& vars = MultiInputVariables(name);
     std::vector<const T*> res;
-    res.reserve(names.size());
-    std::transform(names.begin(), names.end(), std::back_inserter(res),
-                   [&](const std::string& sub_name) {
-                     auto var = scope_.FindVar(sub_name);
+    res.reserve(vars.size());
+    std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                   [&](const Variable* var) {
                      return var == nullptr ? nullptr : &var->Get<T>();
                    });
     return res;
@@ -230,12 +227,11 @@ class ExecutionContext {
 
   template <typename T>
   std::vector<T*> MultiOutput(const std::string& name) const {
-    auto names = op_.Outputs(name);
+    auto& vars = MultiOutputVariables(name);
     std::vector<T*> res;
-    res.reserve(names.size());
-    std::transform(names.begin(), names.end(), std::back_inserter(res),
-                   [&](const std::string& sub_name) {
-                     auto var = scope_.FindVar(sub_name);
+    res.reserve(vars.size());
+    std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                   [&](Variable* var) {
                      return var == nullptr ? nullptr : var->GetMutable<T>();
                    });
     return res;
@@ -271,9 +267,15 @@ class ExecutionContext {
   }
 
  private:
+  const std::vector<Variable*>& MultiInputVariables(
+      const std::string& name) const;
+  const std::vector<Variable*>& MultiOutputVariables(
+      const std::string& name) const;
+
   const OperatorBase& op_;
   const Scope& scope_;
   const platform::DeviceContext& device_context_;
+  const RuntimeContext& ctx_;
 };
 
 template <>
@@ -338,6 +340,30 @@ class OperatorWithKernel : public OperatorBase {
     OpInfoMap::Instance().Get(Type()).infer_shape_(ctx);
   }
 
+  /*
+   * @brief Let the operator keep, between runs, the kernel it has chosen and
+   * the variables of its inputs and outputs. The kernel is chosen again when
+   * the place, or the kinds, data types or layouts of the inputs change, and
+   * the variables are resolved again when the operator runs on another scope.
+   * The attributes, including use_mkldnn, are fixed once the operator is
+   * created, so FLAGS_use_mkldnn only takes effect on newly created
+   * operators. Any other state GetExpectedKernelType reads, such as global
+   * flags, must stay fixed between runs.
+   *
+   * Note!!! an operator with the cache enabled must not be run by more than
+   * one thread at the same time.
+   */
+  void EnableRuntimeCache(bool enable) {
+    enable_runtime_cache_ = enable;
+    ResetRuntimeCache();
+  }
+
+  // Drop the cached variables, e.g. before the scope they live in is deleted.
+  void ResetRuntimeCache() const {
+    runtime_ctx_.reset();
+    pre_scope_ = nullptr;
+  }
+
  protected:
   virtual OpKernelType GetExpectedKernelType(const ExecutionContext& ctx) const;
   virtual OpKernelType GetKernelTypeForVar(
@@ -349,6 +375,20 @@ class OperatorWithKernel : public OperatorBase {
   // same.
   proto::VarType::Type IndicateDataType(const ExecutionContext& ctx) const;
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
+  void RunImpl(const Scope& scope, const platform::Place& place,
+               RuntimeContext* runtime_ctx) const;
+
+  /**
+   * Choose the kernel to run on the given place. The returned kernel points
+   * into AllOpKernels(), which does not change after the ops are registered.
+   */
+  const OpKernelFunc* ChooseKernel(const RuntimeContext& ctx,
+                                   const Scope& scope,
+                                   const platform::Place& place,
+                                   OpKernelType* kernel_type) const;
+
+  bool KernelCacheHit(const RuntimeContext& ctx,
+                      const platform::Place& place) const;
 
   /**
    * Transfer data from scope to a transfered scope. If there is no data need to
@@ -358,11 +398,23 @@ class OperatorWithKernel : public OperatorBase {
    */
   Scope* TryTransferData(
       const Scope& scope, const OpKernelType& expected_kernel_key,
+      const RuntimeContext& ctx,
       std::vector<std::string>* transfered_inplace_vars) const;
 
   void TransferInplaceVarsBack(const Scope& scope,
                                const std::vector<std::string>& inplace_vars,
                                const Scope& exec_scope) const;
+
+  bool enable_runtime_cache_{false};
+  mutable std::unique_ptr<RuntimeContext> runtime_ctx_;
+  mutable const Scope* pre_scope_{nullptr};
+  mutable std::unique_ptr<OpKernelType> kernel_type_;
+  mutable const OpKernelFunc* kernel_func_{nullptr};
+  mutable platform::DeviceContext* kernel_dev_ctx_{nullptr};
+  mutable platform::Place kernel_place_;
+  // The kind, data type and layout of every input when kernel_func_ was
+  // chosen.
+  mutable std::vector<int> kernel_input_types_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
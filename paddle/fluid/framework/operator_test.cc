@@ -247,3 +247,88 @@ TEST(OpKernel, multi_inputs) {
   auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
   op->Run(scope, cpu_place);
 }
+
+namespace paddle {
+namespace framework {
+
+static int expected_kernel_type_num = 0;
+static const Variable* kernel_input_var = nullptr;
+
+class OpWithCacheTest : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {}
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    ++expected_kernel_type_num;
+    return OpKernelType(proto::VarType::FP32, ctx.GetPlace());
+  }
+};
+
+class CPUKernelCacheTest : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    kernel_input_var = ctx.InputVar("x");
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_with_cache, paddle::framework::OpWithCacheTest,
+    paddle::framework::OpKernelTestProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(op_with_cache, paddle::framework::CPUKernelCacheTest);
+
+TEST(OpKernel, runtime_cache) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_cache");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* in1 = scope.Var("IN1");
+  in1->GetMutable<paddle::framework::LoDTensor>();
+  scope.Var("OUT1")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  auto* op_with_kernel =
+      dynamic_cast<paddle::framework::OperatorWithKernel*>(op.get());
+  ASSERT_NE(op_with_kernel, nullptr);
+  op_with_kernel->EnableRuntimeCache(true);
+
+  // the kernel is chosen once for the same scope, place and input types.
+  for (int i = 0; i < 3; ++i) {
+    op->Run(scope, cpu_place);
+    ASSERT_EQ(paddle::framework::kernel_input_var, in1);
+  }
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, 1);
+
+  // the kernel is chosen again once the data type of an input changes.
+  in1->GetMutable<paddle::framework::LoDTensor>()->mutable_data<float>(
+      paddle::framework::make_ddim({1}), cpu_place);
+  op->Run(scope, cpu_place);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, 2);
+
+  // the variables are resolved again on another scope.
+  paddle::framework::Scope other_scope;
+  auto* other_in1 = other_scope.Var("IN1");
+  other_in1->GetMutable<paddle::framework::LoDTensor>()->mutable_data<float>(
+      paddle::framework::make_ddim({1}), cpu_place);
+  other_scope.Var("OUT1")->GetMutable<paddle::framework::LoDTensor>();
+  op->Run(other_scope, cpu_place);
+  ASSERT_EQ(paddle::framework::kernel_input_var, other_in1);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, 2);
+
+  // without the cache, the kernel is chosen on every run.
+  op_with_kernel->EnableRuntimeCache(false);
+  op->Run(scope, cpu_place);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::kernel_input_var, in1);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, 4);
+}
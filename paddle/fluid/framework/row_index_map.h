@@ -0,0 +1,137 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief RowIndexMap maps a row id (the key of a sparse table) to its
+ * position in the rows of a SelectedRows.
+ *
+ *  It is an open-addressing hash table with linear probing. Slots are kept
+ *  in one flat array and the load factor never exceeds 1/2, so a lookup is
+ *  usually resolved by touching a single cache line. Entries can only be
+ *  inserted or cleared all together, which is all a sparse table needs.
+ */
+class RowIndexMap {
+ public:
+  static constexpr int64_t kNotFound = -1;
+
+  RowIndexMap() { Rehash(kMinCapacity); }
+
+  size_t size() const { return size_; }
+
+  size_t capacity() const { return slots_.size(); }
+
+  void Clear() {
+    for (auto& slot : slots_) {
+      slot.index = kNotFound;
+    }
+    size_ = 0;
+  }
+
+  // Make sure `n` keys can be stored without rehashing.
+  void Reserve(size_t n) {
+    size_t capacity = slots_.size();
+    while (capacity < 2 * n) {
+      capacity <<= 1;
+    }
+    if (capacity != slots_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  /*
+   * @brief Find the position of key.
+   *
+   * @return kNotFound if the key does not exist.
+   */
+  int64_t Find(int64_t key) const {
+    size_t pos = Hash(key) & mask_;
+    while (true) {
+      const Slot& slot = slots_[pos];
+      if (slot.index == kNotFound) return kNotFound;
+      if (slot.key == key) return slot.index;
+      pos = (pos + 1) & mask_;
+    }
+  }
+
+  /*
+   * @brief Insert key with the given index if the key does not exist.
+   *
+   * @return the index stored for key, which is the existing one if the key
+   * has been inserted before.
+   */
+  int64_t Insert(int64_t key, int64_t index) {
+    if (2 * (size_ + 1) > slots_.size()) {
+      Rehash(slots_.size() << 1);
+    }
+    size_t pos = Hash(key) & mask_;
+    while (true) {
+      Slot& slot = slots_[pos];
+      if (slot.index == kNotFound) {
+        slot.key = key;
+        slot.index = index;
+        ++size_;
+        return index;
+      }
+      if (slot.key == key) return slot.index;
+      pos = (pos + 1) & mask_;
+    }
+  }
+
+  // The finalizer of MurmurHash3. Ids of a sparse table are often
+  // consecutive, so they must be scattered before masking.
+  static size_t Hash(int64_t key) {
+    uint64_t h = static_cast<uint64_t>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+ private:
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    int64_t key;
+    int64_t index;
+  };
+
+  void Rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity, Slot{0, kNotFound});
+    old_slots.swap(slots_);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for (auto& slot : old_slots) {
+      if (slot.index != kNotFound) {
+        Insert(slot.key, slot.index);
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_{0};
+  size_t size_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
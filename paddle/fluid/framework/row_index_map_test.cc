@@ -0,0 +1,67 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/row_index_map.h"
+#include <unordered_map>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(RowIndexMap, InsertAndFind) {
+  RowIndexMap map;
+  ASSERT_EQ(map.Find(0), -1);
+  ASSERT_EQ(map.Insert(10, 0), 0);
+  ASSERT_EQ(map.Insert(-3, 1), 1);
+  // the first inserted index is kept for a duplicate key.
+  ASSERT_EQ(map.Insert(10, 2), 0);
+  ASSERT_EQ(map.size(), 2UL);
+  ASSERT_EQ(map.Find(10), 0);
+  ASSERT_EQ(map.Find(-3), 1);
+  ASSERT_EQ(map.Find(11), -1);
+
+  map.Clear();
+  ASSERT_EQ(map.size(), 0UL);
+  ASSERT_EQ(map.Find(10), -1);
+}
+
+TEST(RowIndexMap, Grow) {
+  RowIndexMap map;
+  std::unordered_map<int64_t, int64_t> expected;
+  for (int64_t i = 0; i < 100000; ++i) {
+    int64_t key = (i * 2654435761LL) % 1000003;
+    auto index = map.Insert(key, i);
+    auto it = expected.emplace(key, i).first;
+    ASSERT_EQ(index, it->second);
+  }
+  ASSERT_EQ(map.size(), expected.size());
+  ASSERT_GE(map.capacity(), 2 * map.size());
+  for (auto& pair : expected) {
+    ASSERT_EQ(map.Find(pair.first), pair.second);
+  }
+}
+
+TEST(RowIndexMap, Reserve) {
+  RowIndexMap map;
+  map.Reserve(1000);
+  size_t capacity = map.capacity();
+  ASSERT_GE(capacity, 2000UL);
+  for (int64_t i = 0; i < 1000; ++i) {
+    map.Insert(i, i);
+  }
+  ASSERT_EQ(map.capacity(), capacity);
+}
+
+}  // namespace framework
+}  // namespace paddle
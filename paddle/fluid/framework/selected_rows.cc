@@ -38,31 +38,6 @@ struct ReAllocateVisitor {
   framework::Tensor* tensor_;
 };
 
-struct TensorCopyVisitor {
-  TensorCopyVisitor(framework::Tensor* dst, int64_t dst_offset,
-                    const framework::Tensor src, int64_t src_offset,
-                    int64_t size)
-      : dst_(dst),
-        dst_offset_(dst_offset),
-        src_(src),
-        src_offset_(src_offset),
-        size_(size) {}
-
-  template <typename T>
-  void apply() const {
-    // TODO(Yancey1989): support other place
-    platform::CPUPlace cpu;
-    memory::Copy(cpu, dst_->mutable_data<T>(cpu) + dst_offset_, cpu,
-                 src_.data<T>() + src_offset_, size_ * sizeof(T));
-  }
-
-  framework::Tensor* dst_;
-  int64_t dst_offset_;
-  framework::Tensor src_;
-  int64_t src_offset_;
-  int64_t size_;
-};
-
 void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
                        const platform::DeviceContext& dev_ctx) {
   {  // the 1st field, uint32_t version
@@ -115,60 +90,68 @@ void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
   TensorFromStream(is, selected_rows->mutable_value(), dev_ctx);
 }
 
+int64_t SelectedRows::FindIndex(int64_t key) const {
+  SyncIndexIfDirty();
+  return index_->Find(key);
+}
+
+int64_t SelectedRows::Index(int64_t key) const {
+  auto index = FindIndex(key);
+  if (index == RowIndexMap::kNotFound) {
+    PADDLE_THROW("id %s not in table", key);
+  }
+  return index;
+}
+
 bool SelectedRows::HasKey(int64_t key) const {
-  return std::find(rows_.begin(), rows_.end(), key) == rows_.end() ? false
-                                                                   : true;
+  return FindIndex(key) != RowIndexMap::kNotFound;
 }
 
-int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown) {
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
-    }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
-    }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
-      }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
-    }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
+int64_t SelectedRows::GrowRow(int64_t key, bool auto_grown) {
+  if (!auto_grown) {
+    PADDLE_THROW("key %d not found", key);
+  }
+  std::lock_guard<std::mutex> lock(*grow_mutex_);
+  int64_t row_num = rows_.size();
+  if (row_num == value_->dims()[0]) {
+    PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
   }
+  // key logic to put a key into the index
+  rows_.push_back(key);
+  return row_num;
+}
+
+void SelectedRows::GetIndex(const int64_t* keys, int64_t n, int64_t* index,
+                            bool auto_grown) {
+  SyncIndexIfDirty();
+  index_->Visit(
+      keys, n, false,
+      [this, auto_grown](int64_t key) { return GrowRow(key, auto_grown); },
+      [index](size_t i, int64_t idx) { index[i] = idx; });
+}
+
+int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown) {
+  int64_t index;
+  GetIndex(&key, 1, &index, auto_grown);
+  return index;
+}
+
+void SelectedRows::SyncIndex() const {
+  std::lock_guard<std::mutex> lock(*sync_mutex_);
+  index_->Rebuild(rows_.data(), rows_.size());
+  index_dirty_->store(false, std::memory_order_release);
 }
 
-void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
-  for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+void SelectedRows::SyncIndexIfDirty() const {
+  if (!index_dirty_->load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(*sync_mutex_);
+  // Another thread may have rebuilt it while the lock was waited for.
+  if (index_dirty_->load(std::memory_order_acquire)) {
+    index_->Rebuild(rows_.data(), rows_.size());
+    index_dirty_->store(false, std::memory_order_release);
   }
-  rwlock_->UNLock();
 }
 
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
@@ -178,17 +161,26 @@ void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
   if (ids.numel() == 0) {
     VLOG(3) << "keys is empty, please check data!";
   } else {
+    SyncIndexIfDirty();
     int64_t value_width = value_->numel() / value_->dims()[0];
     PADDLE_ENFORCE_EQ(value_width, value->numel() / value->dims()[0],
                       "output tensor should have the same shape with table "
                       "except the dims[0].");
-    for (int i = 0; i < ids.numel(); ++i) {
-      int64_t index = AutoGrownIndex(ids.data<int64_t>()[i], auto_grown);
-      framework::VisitDataType(
-          framework::ToDataType(value_->type()),
-          TensorCopyVisitor(value, i * value_width, *value_.get(),
-                            index * value_width, value_width));
-    }
+    // TODO(Yancey1989): support other place
+    PADDLE_ENFORCE(platform::is_cpu_place(value_->place()) &&
+                       platform::is_cpu_place(value->place()),
+                   "The sparse table only supports CPUPlace.");
+    size_t row_size = value_width * SizeOfType(value_->type());
+    const char* src = reinterpret_cast<const char*>(value_->data<void>());
+    char* dst = reinterpret_cast<char*>(value->data<void>());
+    // The rows are copied with the read lock of their shard held, so a row
+    // is not copied while it is updated by UpdateRows.
+    index_->Visit(
+        ids.data<int64_t>(), ids.numel(), false,
+        [this, auto_grown](int64_t key) { return GrowRow(key, auto_grown); },
+        [src, dst, row_size](size_t i, int64_t index) {
+          memcpy(dst + i * row_size, src + index * row_size, row_size);
+        });
   }
 }
 
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
@@ -22,7 +23,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/lod_tensor.h"
-#include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/sharded_row_index.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
 
@@ -45,18 +46,29 @@ class SelectedRows {
    * value pointer
    *    with the specified offset.
    *
+   *  Keys are resolved through a hash index on rows, which is rebuilt lazily
+   *  after rows are modified through mutable_rows() or set_rows(). The index
+   *  is sharded by key, each shard with its own lock, so the lookups and the
+   *  updates of a table by many trainers only contend on the same shard.
+   *
    */
  public:
   SelectedRows(const std::vector<int64_t>& rows, const int64_t& height)
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_.reset(new ShardedRowIndex);
+    index_dirty_.reset(new std::atomic<bool>(true));
+    sync_mutex_.reset(new std::mutex);
+    grow_mutex_.reset(new std::mutex);
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_.reset(new ShardedRowIndex);
+    index_dirty_.reset(new std::atomic<bool>(true));
+    sync_mutex_.reset(new std::mutex);
+    grow_mutex_.reset(new std::mutex);
   }
 
   platform::Place place() const { return value_->place(); }
@@ -71,22 +83,23 @@ class SelectedRows {
 
   const Vector<int64_t>& rows() const { return rows_; }
 
-  Vector<int64_t>* mutable_rows() { return &rows_; }
+  Vector<int64_t>* mutable_rows() {
+    index_dirty_->store(true, std::memory_order_release);
+    return &rows_;
+  }
 
-  void set_rows(const Vector<int64_t>& rows) { rows_ = rows; }
+  void set_rows(const Vector<int64_t>& rows) {
+    rows_ = rows;
+    index_dirty_->store(true, std::memory_order_release);
+  }
 
   /*
-   * @brief Get the index of key in rows
+   * @brief Get the index of key in rows. If the key appears more than once,
+   * the index of the first one is returned.
    *
-   * @return -1 if the key does not exists.
+   * Throws if the key does not exist.
    */
-  int64_t Index(int64_t key) const {
-    auto it = std::find(rows_.begin(), rows_.end(), key);
-    if (it == rows_.end()) {
-      PADDLE_THROW("id %s not in table", key);
-    }
-    return static_cast<int64_t>(std::distance(rows_.begin(), it));
-  }
+  int64_t Index(int64_t key) const;
 
   /*
    * @brief whether has the specified key in the table.
@@ -108,9 +121,9 @@ class SelectedRows {
            bool auto_grown = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map. If the key not
+   * @brief Get the index of the key from the index. If the key not
    * exist,
-   * add the key into id_to_index_.
+   * add the key into the index.
    *
    * Note!!! this interface is only used when selected_rows is used as
    * parameters
@@ -120,7 +133,43 @@ class SelectedRows {
    */
   int64_t AutoGrownIndex(int64_t key, bool auto_grown);
 
-  void SyncIndex();
+  /*
+   * @brief Get the indexes of n keys into index, adding the keys which do
+   * not exist if auto_grown. The keys are resolved shard by shard, and the
+   * lock of one shard is held at a time.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   */
+  void GetIndex(const int64_t* keys, int64_t n, int64_t* index,
+                bool auto_grown);
+
+  /*
+   * @brief Update the rows of n keys in value: update(i, index) is called
+   * for the i-th key and its index with the write lock of its shard held,
+   * so the updates of a row do not interleave, and Get never copies a row
+   * being updated.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   */
+  template <typename Fn>
+  void UpdateRows(const int64_t* keys, int64_t n, Fn update,
+                  bool auto_grown = false) {
+    SyncIndexIfDirty();
+    index_->Visit(keys, n, true,
+                  [this, auto_grown](int64_t key) {
+                    return GrowRow(key, auto_grown);
+                  },
+                  update);
+  }
+
+  /*
+   * @brief Rebuild the index of keys from rows.
+   */
+  void SyncIndex() const;
 
   DDim GetCompleteDims() const {
     std::vector<int64_t> dims = vectorize(value_->dims());
@@ -129,14 +178,30 @@ class SelectedRows {
   }
 
  private:
+  // Rebuilds the index once if rows were modified since it was built. It is
+  // called concurrently by the lookups and the updates of a table.
+  void SyncIndexIfDirty() const;
+
+  // Returns RowIndexMap::kNotFound if the key does not exist.
+  int64_t FindIndex(int64_t key) const;
+
+  // Appends the key to rows, with the write lock of its shard held.
+  int64_t GrowRow(int64_t key, bool auto_grown);
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t> id_to_index_;
+  // index_ is a cache of rows_, so it is rebuilt from const methods.
+  std::unique_ptr<ShardedRowIndex> index_{nullptr};
+  // Set when rows_ is modified outside of the index, and cleared once the
+  // index is rebuilt with sync_mutex_ held.
+  std::unique_ptr<std::atomic<bool>> index_dirty_{nullptr};
+  std::unique_ptr<std::mutex> sync_mutex_{nullptr};
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;
-  std::unique_ptr<RWLock> rwlock_{nullptr};
+  // Serializes the keys appended to rows_ from different shards.
+  std::unique_ptr<std::mutex> grow_mutex_{nullptr};
 };
 
 /*
@@ -10,6 +10,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <time.h>
+#include <algorithm>
 #include <thread>  // NOLINT
 
 #include "gtest/gtest.h"
@@ -113,6 +114,143 @@ TEST(SelectedRows, SparseTable) {
   }
 }
 
+TEST(SelectedRows, IndexAfterMutableRows) {
+  std::vector<int64_t> rows{3, 5, 3, 9};
+  SelectedRows table(rows, 10);
+  ASSERT_EQ(table.Index(3), 0);
+  ASSERT_EQ(table.Index(9), 3);
+  ASSERT_FALSE(table.HasKey(7));
+
+  // the index is rebuilt after rows are modified in place.
+  table.mutable_rows()->push_back(7);
+  ASSERT_TRUE(table.HasKey(7));
+  ASSERT_EQ(table.Index(7), 4);
+
+  table.set_rows(std::vector<int64_t>{1, 2});
+  ASSERT_FALSE(table.HasKey(3));
+  ASSERT_EQ(table.Index(2), 1);
+  ASSERT_THROW(table.Index(3), paddle::platform::EnforceNotMet);
+}
+
+// Fills the 4 rows of width 2 of the table with their position, and looks
+// up the rows 3, 5 and 9 through Get.
+void CheckGetAfterRowsSet(SelectedRows* table) {
+  platform::CPUPlace cpu;
+  const int64_t width = 2;
+  auto* data = table->mutable_value()->mutable_data<float>(
+      framework::make_ddim({4, width}), cpu);
+  for (int64_t i = 0; i < 4 * width; ++i) {
+    data[i] = static_cast<float>(i / width);
+  }
+
+  framework::Tensor ids;
+  auto* ids_data = ids.mutable_data<int64_t>(framework::make_ddim({3}), cpu);
+  ids_data[0] = 9;
+  ids_data[1] = 3;
+  ids_data[2] = 5;
+  framework::Tensor out;
+  auto* out_data =
+      out.mutable_data<float>(framework::make_ddim({3, width}), cpu);
+  table->Get(ids, &out);
+  ASSERT_EQ(out_data[0 * width], 2);
+  ASSERT_EQ(out_data[1 * width], 0);
+  ASSERT_EQ(out_data[2 * width], 1);
+
+  // A known key is found instead of appended again, an unknown one grows.
+  ids_data[0] = 5;
+  ids_data[1] = 7;
+  ids_data[2] = 5;
+  table->Get(ids, &out, true);
+  ASSERT_EQ(table->rows().size(), 4UL);
+  ASSERT_EQ(table->rows()[3], 7);
+  ASSERT_EQ(out_data[0 * width], 1);
+  ASSERT_EQ(out_data[1 * width], 3);
+  ASSERT_EQ(out_data[2 * width], 1);
+}
+
+TEST(SelectedRows, GetAfterRowsConstructor) {
+  SelectedRows table(std::vector<int64_t>{3, 5, 9}, 10);
+  CheckGetAfterRowsSet(&table);
+}
+
+TEST(SelectedRows, GetAfterSetRows) {
+  SelectedRows table;
+  // Builds the index of the empty rows before they are replaced.
+  ASSERT_FALSE(table.HasKey(3));
+  table.set_rows(std::vector<int64_t>{3, 5, 9});
+  CheckGetAfterRowsSet(&table);
+}
+
+TEST(SelectedRows, DISABLED_IndexBenchmark) {
+  const int64_t table_size = 20000;
+  const int64_t lookup_times = 20000;
+  std::vector<int64_t> rows(table_size);
+  for (int64_t i = 0; i < table_size; ++i) {
+    rows[i] = (i * 7919) % table_size;
+  }
+  SelectedRows table(rows, table_size);
+  table.SyncIndex();
+
+  int64_t scan_sum = 0;
+  clock_t t1 = clock();
+  for (int64_t i = 0; i < lookup_times; ++i) {
+    auto it = std::find(rows.begin(), rows.end(), i % table_size);
+    scan_sum += std::distance(rows.begin(), it);
+  }
+  clock_t t2 = clock();
+  int64_t index_sum = 0;
+  for (int64_t i = 0; i < lookup_times; ++i) {
+    index_sum += table.Index(i % table_size);
+  }
+  clock_t t3 = clock();
+  ASSERT_EQ(scan_sum, index_sum);
+  std::cout << "linear scan run time:" << t2 - t1
+            << ", hash index run time:" << t3 - t2 << std::endl;
+}
+
+TEST(SelectedRows, UpdateRows) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+  const int64_t table_size = 1000;
+  const int64_t embedding_width = 4;
+  table.mutable_value()->Resize(
+      framework::make_ddim({table_size, embedding_width}));
+  auto* data = table.mutable_value()->mutable_data<float>(cpu);
+  std::fill(data, data + table_size * embedding_width, 0.0f);
+
+  std::vector<int64_t> keys = {7, 3, 7, 900};
+  ASSERT_THROW(table.UpdateRows(keys.data(), keys.size(),
+                                [](int64_t i, int64_t index) {}),
+               paddle::platform::EnforceNotMet);
+  table.UpdateRows(keys.data(), keys.size(),
+                   [&](int64_t i, int64_t index) {
+                     for (int64_t j = 0; j < embedding_width; ++j) {
+                       data[index * embedding_width + j] += i + 1;
+                     }
+                   },
+                   true);
+  ASSERT_EQ(table.rows().size(), 3UL);
+
+  std::vector<int64_t> index(keys.size());
+  table.GetIndex(keys.data(), keys.size(), index.data(), false);
+  ASSERT_EQ(index[0], index[2]);
+  ASSERT_EQ(data[index[0] * embedding_width], 1 + 3);
+  ASSERT_EQ(data[index[1] * embedding_width], 2);
+  ASSERT_EQ(data[index[3] * embedding_width], 4);
+
+  framework::Tensor ids;
+  ids.Resize(framework::make_ddim({2}));
+  auto* ids_data = ids.mutable_data<int64_t>(cpu);
+  ids_data[0] = 900;
+  ids_data[1] = 7;
+  framework::Tensor out;
+  out.Resize(framework::make_ddim({2, embedding_width}));
+  auto* out_data = out.mutable_data<float>(cpu);
+  table.Get(ids, &out);
+  ASSERT_EQ(out_data[0], 4);
+  ASSERT_EQ(out_data[embedding_width], 4);
+}
+
 void f1(SelectedRows* table, int table_size) {
   for (int i = 1000000; i > 0; --i) {
     auto id = i % table_size;
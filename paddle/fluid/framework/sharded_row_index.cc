@@ -0,0 +1,73 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_row_index.h"
+
+namespace paddle {
+namespace framework {
+
+constexpr size_t ShardedRowIndex::kDefaultShards;
+
+ShardedRowIndex::ShardedRowIndex(size_t num_shards)
+    : num_shards_(num_shards), shards_(new Shard[num_shards]) {
+  PADDLE_ENFORCE_GT(num_shards, 0UL);
+}
+
+void ShardedRowIndex::Rebuild(const int64_t* rows, size_t size) {
+  for (size_t s = 0; s < num_shards_; ++s) {
+    shards_[s].lock.WRLock();
+  }
+  std::vector<size_t> counts(num_shards_, 0);
+  for (size_t i = 0; i < size; ++i) {
+    ++counts[ShardOf(rows[i])];
+  }
+  for (size_t s = 0; s < num_shards_; ++s) {
+    shards_[s].index.Clear();
+    shards_[s].index.Reserve(counts[s]);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    shards_[ShardOf(rows[i])].index.Insert(rows[i], static_cast<int64_t>(i));
+  }
+  for (size_t s = 0; s < num_shards_; ++s) {
+    shards_[s].lock.UNLock();
+  }
+}
+
+int64_t ShardedRowIndex::Find(int64_t key) {
+  Shard& shard = shards_[ShardOf(key)];
+  RWLockGuard guard(&shard.lock, RWLockGuard::Status::kRDLock);
+  return shard.index.Find(key);
+}
+
+void ShardedRowIndex::GroupByShard(const int64_t* keys, size_t n,
+                                   std::vector<size_t>* order,
+                                   std::vector<size_t>* offsets) const {
+  std::vector<size_t> shard_of(n);
+  offsets->assign(num_shards_ + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    shard_of[i] = ShardOf(keys[i]);
+    ++(*offsets)[shard_of[i] + 1];
+  }
+  for (size_t s = 0; s < num_shards_; ++s) {
+    (*offsets)[s + 1] += (*offsets)[s];
+  }
+  std::vector<size_t> next(offsets->begin(), offsets->end() - 1);
+  order->resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    (*order)[next[shard_of[i]]++] = i;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,127 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/framework/row_index_map.h"
+#include "paddle/fluid/framework/rw_lock.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief ShardedRowIndex is the index of the keys of a sparse table, split
+ * into shards by the hash of the keys. Every shard has its own lock and
+ * RowIndexMap, so the trainers looking up and updating a table on a pserver
+ * only contend on the keys of the same shard.
+ *
+ *  The positions the keys map to are kept by the owner of the index, which
+ *  appends the rows of new keys. Batched operations visit the keys shard by
+ *  shard and hold the lock of one shard at a time.
+ */
+class ShardedRowIndex {
+ public:
+  static constexpr size_t kDefaultShards = 16;
+
+  explicit ShardedRowIndex(size_t num_shards = kDefaultShards);
+
+  size_t num_shards() const { return num_shards_; }
+
+  size_t ShardOf(int64_t key) const {
+    // The low bits of the hash place the key in the RowIndexMap of the shard.
+    return (RowIndexMap::Hash(key) >> 40) % num_shards_;
+  }
+
+  /*
+   * @brief Rebuild the index from rows with the locks of all shards held. If
+   * a key appears more than once, the first position is kept.
+   */
+  void Rebuild(const int64_t* rows, size_t size);
+
+  /*
+   * @brief Find the position of key.
+   *
+   * @return RowIndexMap::kNotFound if the key does not exist.
+   */
+  int64_t Find(int64_t key);
+
+  /*
+   * @brief Calls fn(i, index) for the i-th of the n keys with index, its
+   * position, shard by shard. fn is called with the lock of the shard of the
+   * key held, which is a write lock if exclusive, so the row of the key can
+   * be read, or updated if exclusive, in fn.
+   *
+   * A key not in the index is passed to grow(key) with the write lock of its
+   * shard held, which returns the position to store for the key.
+   */
+  template <typename GrowFn, typename Fn>
+  void Visit(const int64_t* keys, size_t n, bool exclusive, GrowFn grow,
+             Fn fn);
+
+ private:
+  struct Shard {
+    RWLock lock;
+    RowIndexMap index;
+  };
+
+  // Sorts the positions of the keys by shard into order, where the keys of
+  // shard s are in [offsets[s], offsets[s + 1]).
+  void GroupByShard(const int64_t* keys, size_t n, std::vector<size_t>* order,
+                    std::vector<size_t>* offsets) const;
+
+  size_t num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+template <typename GrowFn, typename Fn>
+void ShardedRowIndex::Visit(const int64_t* keys, size_t n, bool exclusive,
+                            GrowFn grow, Fn fn) {
+  std::vector<size_t> order;
+  std::vector<size_t> offsets;
+  GroupByShard(keys, n, &order, &offsets);
+  for (size_t s = 0; s < num_shards_; ++s) {
+    if (offsets[s] == offsets[s + 1]) {
+      continue;
+    }
+    Shard& shard = shards_[s];
+    RWLockGuard guard(&shard.lock, exclusive ? RWLockGuard::Status::kWRLock
+                                             : RWLockGuard::Status::kRDLock);
+    bool write_locked = exclusive;
+    for (size_t k = offsets[s]; k < offsets[s + 1]; ++k) {
+      size_t i = order[k];
+      int64_t index = shard.index.Find(keys[i]);
+      if (index == RowIndexMap::kNotFound) {
+        if (!write_locked) {
+          // The positions found so far stay valid, since keys are never
+          // removed except by Rebuild, which takes every lock.
+          guard.UnLock();
+          guard.WRLock();
+          write_locked = true;
+          index = shard.index.Find(keys[i]);
+        }
+        if (index == RowIndexMap::kNotFound) {
+          index = shard.index.Insert(keys[i], grow(keys[i]));
+        }
+      }
+      fn(i, index);
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
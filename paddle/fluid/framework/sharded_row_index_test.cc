@@ -0,0 +1,173 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_row_index.h"
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+// A sparse table of rows of width floats, growing as keys are visited.
+class Table {
+ public:
+  Table(size_t num_shards, int64_t capacity, int64_t width)
+      : index_(num_shards), width_(width), values_(capacity * width, 0.0f) {}
+
+  void Lookup(const std::vector<int64_t>& keys, float* out) {
+    index_.Visit(keys.data(), keys.size(), false,
+                 [this](int64_t key) { return Grow(key); },
+                 [this, out](size_t i, int64_t index) {
+                   std::copy(&values_[index * width_],
+                             &values_[(index + 1) * width_], out + i * width_);
+                 });
+  }
+
+  void Update(const std::vector<int64_t>& keys, float delta) {
+    index_.Visit(keys.data(), keys.size(), true,
+                 [this](int64_t key) { return Grow(key); },
+                 [this, delta](size_t i, int64_t index) {
+                   for (int64_t j = 0; j < width_; ++j) {
+                     values_[index * width_ + j] += delta;
+                   }
+                 });
+  }
+
+  int64_t Find(int64_t key) { return index_.Find(key); }
+  int64_t size() const { return rows_.size(); }
+  float value(int64_t index) const { return values_[index * width_]; }
+
+ private:
+  int64_t Grow(int64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rows_.push_back(key);
+    return rows_.size() - 1;
+  }
+
+  ShardedRowIndex index_;
+  int64_t width_;
+  std::vector<float> values_;
+  std::mutex mutex_;
+  std::vector<int64_t> rows_;
+};
+
+TEST(ShardedRowIndex, Rebuild) {
+  ShardedRowIndex index(4);
+  std::vector<int64_t> rows = {5, 3, 5, 100, -7};
+  index.Rebuild(rows.data(), rows.size());
+  EXPECT_EQ(index.Find(5), 0);
+  EXPECT_EQ(index.Find(3), 1);
+  EXPECT_EQ(index.Find(100), 3);
+  EXPECT_EQ(index.Find(-7), 4);
+  EXPECT_EQ(index.Find(4), -1);
+
+  rows = {4};
+  index.Rebuild(rows.data(), rows.size());
+  EXPECT_EQ(index.Find(4), 0);
+  EXPECT_EQ(index.Find(5), -1);
+}
+
+TEST(ShardedRowIndex, VisitInOrderOfShards) {
+  ShardedRowIndex index(8);
+  std::vector<int64_t> keys(1000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = (i * 7919) % 500;
+  }
+  int64_t next = 0;
+  std::vector<int64_t> found(keys.size(), -1);
+  size_t last_shard = 0;
+  index.Visit(keys.data(), keys.size(), false,
+              [&next](int64_t key) { return next++; },
+              [&](size_t i, int64_t idx) {
+                size_t shard = index.ShardOf(keys[i]);
+                EXPECT_GE(shard, last_shard);
+                last_shard = shard;
+                found[i] = idx;
+              });
+  // Every distinct key grows once, and the duplicates share its position.
+  EXPECT_EQ(next, 500);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(found[i], index.Find(keys[i]));
+    EXPECT_EQ(found[i], found[i % 500]);
+  }
+}
+
+TEST(ShardedRowIndex, ConcurrentUpdate) {
+  const int kThreads = 8;
+  const int kSteps = 200;
+  const int64_t kKeys = 1000;
+  Table table(16, kKeys, 4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&table, t] {
+      std::vector<int64_t> keys(kKeys);
+      for (int step = 0; step < kSteps; ++step) {
+        for (int64_t i = 0; i < kKeys; ++i) {
+          keys[i] = (i * 31 + step + t) % kKeys;
+        }
+        table.Update(keys, 1.0f);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  ASSERT_EQ(table.size(), kKeys);
+  for (int64_t key = 0; key < kKeys; ++key) {
+    ASSERT_EQ(table.value(table.Find(key)), kThreads * kSteps) << key;
+  }
+}
+
+// Trainers looking up and updating a table on a pserver at the same time, as
+// prefetch and the sparse optimizers do, with a single lock and with shards.
+TEST(ShardedRowIndex, DISABLED_ContentionBenchmark) {
+  const int kClients = 8;
+  const int kBatches = 200;
+  const int64_t kBatchSize = 1024;
+  const int64_t kTableSize = 1 << 18;
+  const int64_t kWidth = 64;
+  for (size_t num_shards : {1UL, ShardedRowIndex::kDefaultShards}) {
+    Table table(num_shards, kTableSize, kWidth);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int c = 0; c < kClients; ++c) {
+      clients.emplace_back([&table, c] {
+        std::vector<int64_t> keys(kBatchSize);
+        std::vector<float> out(kBatchSize * kWidth);
+        uint64_t seed = c + 1;
+        for (int b = 0; b < kBatches; ++b) {
+          for (auto& key : keys) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            key = (seed >> 33) % kTableSize;
+          }
+          table.Lookup(keys, out.data());
+          table.Update(keys, 0.1f);
+        }
+      });
+    }
+    for (auto& c : clients) c.join();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << "shards: " << num_shards << ", clients: " << kClients
+              << ", run time: " << ms << " ms" << std::endl;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -85,6 +85,17 @@ Tensor& Tensor::ShareDataWith(const Tensor& src) {
   return *this;
 }
 
+Tensor& Tensor::ShareExternalData(void* data, size_t size,
+                                  const platform::Place& place,
+                                  std::type_index type,
+                                  std::shared_ptr<void> owner) {
+  PADDLE_ENFORCE_NOT_NULL(data, "Cannot share a null memory block.");
+  holder_.reset(
+      new ExternalPlaceholder(data, size, place, type, std::move(owner)));
+  offset_ = 0;
+  return *this;
+}
+
 Tensor Tensor::Slice(int begin_idx, int end_idx) const {
   check_memory_size();
   PADDLE_ENFORCE_GE(begin_idx, 0,
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <cstring>
 #include <memory>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/data_layout.h"
@@ -120,6 +121,19 @@ class Tensor {
   /*! The internal of two tensors share the same memory block. */
   Tensor& ShareDataWith(const Tensor& src);
 
+  /**
+   * @brief   Use a memory block which is not allocated by the tensor.
+   *
+   * @note    The tensor does not free the block, so the block must be
+   *          available as long as any tensor sharing it. If `owner` is
+   *          given, it is kept alive together with the block. mutable_data
+   *          writes into the block if it is large enough, otherwise it
+   *          allocates a new one.
+   */
+  Tensor& ShareExternalData(void* data, size_t size,
+                            const platform::Place& place, std::type_index type,
+                            std::shared_ptr<void> owner = nullptr);
+
   /**
    * @brief  Return a sub-tensor of the given tensor.
    *
@@ -147,6 +161,13 @@ class Tensor {
 
   void check_memory_size() const;
 
+  /*! Release the memory block, which is freed with its last reference. The
+   *  dimensions are kept. */
+  void clear() {
+    holder_ = nullptr;
+    offset_ = 0;
+  }
+
   DataLayout layout() const { return layout_; }
 
   void set_layout(const DataLayout layout) { layout_ = layout; }
@@ -198,6 +219,30 @@ class Tensor {
     std::type_index type_;
   };
 
+  /*! A memory block not owned by the tensor. */
+  struct ExternalPlaceholder : public Placeholder {
+    ExternalPlaceholder(void* ptr, size_t size, platform::Place place,
+                        std::type_index type, std::shared_ptr<void> owner)
+        : ptr_(ptr),
+          place_(place),
+          size_(size),
+          type_(type),
+          owner_(std::move(owner)) {}
+
+    virtual size_t size() const { return size_; }
+    virtual platform::Place place() const { return place_; }
+    virtual void* ptr() const { return ptr_; }
+    virtual std::type_index type() const { return type_; }
+    virtual void set_type(std::type_index type) { type_ = type; }
+    virtual void set_place(platform::Place place) { place_ = place; }
+
+    void* ptr_;
+    platform::Place place_;
+    size_t size_;
+    std::type_index type_;
+    std::shared_ptr<void> owner_;
+  };
+
   /*! holds the memory block if allocated. */
   std::shared_ptr<Placeholder> holder_;
 
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/tensor.h"
 #include <gtest/gtest.h>
 #include <string>
+#include <vector>
 #include "paddle/fluid/platform/float16.h"
 
 namespace framework = paddle::framework;
@@ -143,6 +144,27 @@ TEST(Tensor, ShareDataWith) {
 #endif
 }
 
+TEST(Tensor, ShareExternalData) {
+  std::vector<float> buf(24, 1.f);
+  framework::Tensor tensor;
+  tensor.Resize(framework::make_ddim({2, 3, 4}));
+  tensor.ShareExternalData(buf.data(), buf.size() * sizeof(float),
+                           platform::CPUPlace(), typeid(float));
+  ASSERT_EQ(tensor.data<float>(), buf.data());
+  ASSERT_EQ(tensor.memory_size(), 24 * sizeof(float));
+
+  // The external block is reused while it is large enough.
+  float* p = tensor.mutable_data<float>(framework::make_ddim({2, 3}),
+                                        platform::CPUPlace());
+  ASSERT_EQ(p, buf.data());
+  framework::Tensor slice = tensor.Slice(1, 2);
+  ASSERT_EQ(slice.data<float>(), buf.data() + 3);
+
+  p = tensor.mutable_data<float>(framework::make_ddim({5, 5}),
+                                 platform::CPUPlace());
+  ASSERT_NE(p, buf.data());
+}
+
 TEST(Tensor, Slice) {
   {
     framework::Tensor src_tensor;
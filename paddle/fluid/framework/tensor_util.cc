@@ -14,6 +14,7 @@
 #include "paddle/fluid/framework/tensor_util.h"
 #include <algorithm>
 #include <limits>
+#include <string>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 
@@ -242,7 +243,8 @@ bool TensorContainsInf(const framework::Tensor& tensor) {
 }
 
 void TensorToStream(std::ostream& os, const Tensor& tensor,
-                    const platform::DeviceContext& dev_ctx) {
+                    const platform::DeviceContext& dev_ctx,
+                    size_t data_alignment) {
   {  // the 1st field, uint32_t version
     constexpr uint32_t version = 0;
     os.write(reinterpret_cast<const char*>(&version), sizeof(version));
@@ -256,6 +258,18 @@ void TensorToStream(std::ostream& os, const Tensor& tensor,
     auto* pb_dims = desc.mutable_dims();
     pb_dims->Resize(static_cast<int>(dims.size()), 0);
     std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    if (data_alignment > 0) {
+      auto pos = os.tellp();
+      PADDLE_ENFORCE(pos != std::ostream::pos_type(-1),
+                     "Cannot align the tensor data in the stream");
+      size_t data_begin = static_cast<size_t>(pos) + sizeof(int32_t);
+      std::string padding;
+      desc.set_padding(padding);
+      while ((data_begin + desc.ByteSize()) % data_alignment != 0) {
+        padding.push_back('\0');
+        desc.set_padding(padding);
+      }
+    }
     int32_t size = desc.ByteSize();
     os.write(reinterpret_cast<const char*>(&size), sizeof(size));
     auto out = desc.SerializeAsString();
@@ -358,5 +372,56 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   }
 }
 
+size_t TensorFromBuffer(const char* data, size_t size,
+                        const std::shared_ptr<void>& owner, Tensor* tensor) {
+  const char* pos = data;
+  const char* end = data + size;
+  auto read = [&pos, end](void* dst, size_t n) {
+    PADDLE_ENFORCE_LE(n, static_cast<size_t>(end - pos),
+                      "The buffer ends in the middle of a tensor");
+    memcpy(dst, pos, n);
+    pos += n;
+  };
+
+  uint32_t version;
+  read(&version, sizeof(version));
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  proto::VarType::TensorDesc desc;
+  {  // int32_t size
+     // proto buffer
+    int32_t desc_size;
+    read(&desc_size, sizeof(desc_size));
+    PADDLE_ENFORCE(desc_size >= 0 && desc_size <= end - pos,
+                   "The buffer ends in the middle of a tensor");
+    PADDLE_ENFORCE(desc.ParseFromArray(pos, desc_size),
+                   "Cannot parse tensor desc");
+    pos += desc_size;
+  }
+  {  // tensor data
+    std::vector<int64_t> dims;
+    dims.reserve(static_cast<size_t>(desc.dims().size()));
+    std::copy(desc.dims().begin(), desc.dims().end(), std::back_inserter(dims));
+    tensor->Resize(framework::make_ddim(dims));
+    auto type = framework::ToTypeIndex(desc.data_type());
+    size_t type_size = framework::SizeOfType(type);
+    size_t data_size = tensor->numel() * type_size;
+    PADDLE_ENFORCE_LE(data_size, static_cast<size_t>(end - pos),
+                      "The buffer ends in the middle of a tensor");
+    platform::CPUPlace cpu;
+    if (owner != nullptr && data_size > 0 &&
+        reinterpret_cast<uintptr_t>(pos) % type_size == 0) {
+      tensor->ShareExternalData(const_cast<char*>(pos), data_size, cpu, type,
+                                owner);
+    } else {
+      void* buf;
+      framework::VisitDataType(desc.data_type(),
+                               DeserializedDataFunctor(&buf, tensor, cpu));
+      memcpy(buf, pos, data_size);
+    }
+    pos += data_size;
+  }
+  return static_cast<size_t>(pos - data);
+}
+
 }  // namespace framework
 }  // namespace paddle
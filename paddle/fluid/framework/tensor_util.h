@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <memory>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/eigen.h"
@@ -60,11 +61,21 @@ void TesnorToVector(const Tensor& src, std::vector<T>* dst);
 bool TensorContainsNAN(const framework::Tensor& tensor);
 bool TensorContainsInf(const framework::Tensor& tensor);
 
+// If data_alignment is not 0, the tensor description is padded so that the
+// data starts at a multiple of data_alignment bytes in the stream.
 void TensorToStream(std::ostream& os, const Tensor& tensor,
-                    const platform::DeviceContext& dev_ctx);
+                    const platform::DeviceContext& dev_ctx,
+                    size_t data_alignment = 0);
 void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx);
 
+// Deserialize a CPU tensor written by TensorToStream from the memory
+// [data, data + size), and return the number of bytes read. If owner is not
+// null and the data is aligned to its type, the tensor shares the memory and
+// keeps owner alive instead of copying the data.
+size_t TensorFromBuffer(const char* data, size_t size,
+                        const std::shared_ptr<void>& owner, Tensor* tensor);
+
 //
 // The implementation of template functions.
 //
@@ -0,0 +1,139 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// The pool and the worker index of the current thread.
+struct CurrentWorker {
+  const WorkStealingThreadPool* pool{nullptr};
+  size_t id{0};
+};
+
+thread_local CurrentWorker current_worker;
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker);
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(
+        new std::thread(&WorkStealingThreadPool::TaskLoop, this, i));
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  scheduled_.notify_all();
+  for (auto& t : threads_) {
+    t->join();
+  }
+}
+
+void WorkStealingThreadPool::Schedule(Task task) {
+  size_t id;
+  if (current_worker.pool == this) {
+    id = current_worker.id;
+  } else {
+    id = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  }
+  unfinished_.fetch_add(1);
+  pending_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(workers_[id]->mutex);
+    workers_[id]->tasks.push_back(std::move(task));
+  }
+  // A thread increases idle_threads_ before it checks pending_ and sleeps,
+  // so either it sees the new task or it is notified here.
+  if (idle_threads_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scheduled_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::Pop(size_t id, Task* task) {
+  auto& worker = *workers_[id];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  *task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingThreadPool::Steal(size_t id, Task* task) {
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    auto& worker = *workers_[(id + i) % workers_.size()];
+    std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || worker.tasks.empty()) {
+      continue;
+    }
+    *task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::TaskLoop(size_t id) {
+  current_worker.pool = this;
+  current_worker.id = id;
+  while (true) {
+    Task task;
+    if (Pop(id, &task) || Steal(id, &task)) {
+      pending_.fetch_sub(1);
+      task();
+      if (unfinished_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.notify_all();
+      }
+      continue;
+    }
+    if (pending_.load() > 0) {
+      // A task is being pushed, or its queue is locked by another thread.
+      std::this_thread::yield();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_threads_.fetch_add(1);
+    scheduled_.wait(lock, [this] { return pending_.load() > 0 || !running_; });
+    idle_threads_.fetch_sub(1);
+    if (!running_ && pending_.load() == 0) {
+      break;
+    }
+  }
+  current_worker.pool = nullptr;
+}
+
+void WorkStealingThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  completed_.wait(lock, [this] { return unfinished_.load() == 0; });
+}
+
+}  // namespace framework
+}  // namespace paddle
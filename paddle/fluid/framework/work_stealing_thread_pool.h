@@ -0,0 +1,101 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// WorkStealingThreadPool gives every thread its own task queue, so that
+// scheduling a task does not contend on a lock shared by all threads.
+//
+// A task scheduled by a thread of the pool goes to the back of the queue of
+// that thread, and the thread always runs the most recent task of its own
+// queue first. So the successors of an operator are run by the thread that
+// produced their inputs while the data is still in its cache. An idle thread
+// steals the oldest task from the queues of the other threads, and sleeps only
+// when there is no task in the pool at all.
+class WorkStealingThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingThreadPool(int num_threads);
+
+  // Runs all the scheduled tasks before returning.
+  ~WorkStealingThreadPool();
+
+  // Returns the number of threads created by the constructor.
+  size_t Threads() const { return workers_.size(); }
+
+  // Schedule pushes a task to the pool. The task should not throw.
+  void Schedule(Task task);
+
+  // Enqueue has the same interface as the ThreadPool in third party, and
+  // returns a std::future holding the result or the exception of `fn`.
+  template <typename Callback>
+  auto Enqueue(Callback fn) -> std::future<decltype(fn())> {
+    using ReturnType = decltype(fn());
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(fn);
+    std::future<ReturnType> f = task->get_future();
+    Schedule([task]() { (*task)(); });
+    return f;
+  }
+
+  // Wait until all the tasks are completed.
+  void Wait();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(WorkStealingThreadPool);
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Pops the newest task of the worker `id`.
+  bool Pop(size_t id, Task* task);
+
+  // Steals the oldest task of the workers other than `id`.
+  bool Steal(size_t id, Task* task);
+
+  void TaskLoop(size_t id);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::unique_ptr<std::thread>> threads_;
+
+  // The tasks in the queues, and those not completed yet.
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> unfinished_{0};
+  std::atomic<size_t> idle_threads_{0};
+  std::atomic<size_t> next_worker_{0};
+
+  std::mutex mutex_;
+  bool running_{true};
+  std::condition_variable scheduled_;
+  std::condition_variable completed_;
+};
+
+}  // namespace framework
+}  // namespace paddle
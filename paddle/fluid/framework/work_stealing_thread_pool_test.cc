@@ -0,0 +1,79 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+
+namespace framework = paddle::framework;
+
+TEST(WorkStealingThreadPool, ConcurrentRun) {
+  framework::WorkStealingThreadPool pool(4);
+  std::atomic<int> sum(0);
+  std::vector<std::thread> threads;
+  int n = 50;
+  // sum = (n * (n + 1)) / 2
+  for (int i = 1; i <= n; ++i) {
+    threads.emplace_back([&pool, &sum, i]() {
+      for (int j = 0; j < i; ++j) {
+        pool.Schedule([&sum]() { sum.fetch_add(1); });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  pool.Wait();
+  EXPECT_EQ(sum, ((n + 1) * n) / 2);
+}
+
+// Tasks scheduled by the tasks themselves, as the executor does for the
+// successors of an operator.
+void Spawn(framework::WorkStealingThreadPool* pool, std::atomic<int>* count,
+           int depth) {
+  count->fetch_add(1);
+  if (depth == 0) return;
+  for (int i = 0; i < 2; ++i) {
+    pool->Schedule([=]() { Spawn(pool, count, depth - 1); });
+  }
+}
+
+TEST(WorkStealingThreadPool, NestedSchedule) {
+  framework::WorkStealingThreadPool pool(3);
+  std::atomic<int> count(0);
+  pool.Schedule([&]() { Spawn(&pool, &count, 10); });
+  pool.Wait();
+  EXPECT_EQ(count, (1 << 11) - 1);
+}
+
+TEST(WorkStealingThreadPool, Enqueue) {
+  framework::WorkStealingThreadPool pool(2);
+  auto f = pool.Enqueue([]() { return 42; });
+  EXPECT_EQ(f.get(), 42);
+  auto g = pool.Enqueue([]() { throw std::runtime_error("error"); });
+  EXPECT_THROW(g.get(), std::runtime_error);
+}
+
+TEST(WorkStealingThreadPool, RunAllBeforeDestroy) {
+  std::atomic<int> count(0);
+  {
+    framework::WorkStealingThreadPool pool(2);
+    for (int i = 0; i < 1000; ++i) {
+      pool.Schedule([&count]() { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count, 1000);
+}
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include <string>
+#include "paddle/fluid/framework/ir/int8_quantize_pass.h"
 #include "paddle/fluid/inference/analysis/data_flow_graph_to_fluid_pass.h"
 #include "paddle/fluid/inference/analysis/dfg_graphviz_draw_pass.h"
 #include "paddle/fluid/inference/analysis/fluid_to_data_flow_graph_pass.h"
@@ -28,6 +29,21 @@ DEFINE_bool(IA_enable_tensorrt_subgraph_engine, false,
 
 DEFINE_bool(IA_enable_ir, false, "Turn on IR support");
 
+DEFINE_bool(IA_enable_memory_optimize, false,
+            "Let the temporary variables with non-overlapping lifetimes share "
+            "memory");
+
+DEFINE_bool(IA_enable_conv_bn_fuse, true,
+            "Fuse conv2d with the batch_norm, elementwise_add and relu after "
+            "it");
+
+DEFINE_bool(IA_enable_elemwise_chain_fuse, true,
+            "Fuse the chains of elementwise ops and activations");
+
+DEFINE_string(IA_int8_scales_path, "",
+              "Quantize fc and conv2d to int8 by the scales in this file, "
+              "which are collected by the Int8Calibrator");
+
 DEFINE_string(IA_graphviz_log_root, "./",
               "Graphviz debuger for data flow graphs.");
 
@@ -114,6 +130,37 @@ void Analyzer::Run(Argument* argument) {
                     "fc_fuse_pass", "graph_viz_pass"               //
 
                 }));
+  // The int8 path quantizes the conv2d as they are calibrated, unfused.
+  if (FLAGS_IA_enable_conv_bn_fuse && FLAGS_IA_int8_scales_path.empty()) {
+    auto& passes =
+        argument->Get<std::vector<std::string>>(kFluidToIrPassesAttr);
+    passes.push_back("conv_bn_fuse_pass");
+    passes.push_back("graph_viz_pass");
+  }
+  if (FLAGS_IA_enable_elemwise_chain_fuse) {
+    // After the passes fusing elementwise_add and relu into fc and conv2d.
+    auto& passes =
+        argument->Get<std::vector<std::string>>(kFluidToIrPassesAttr);
+    passes.push_back("elemwise_chain_fuse_pass");
+    passes.push_back("graph_viz_pass");
+  }
+  if (!FLAGS_IA_int8_scales_path.empty()) {
+    // After fc_fuse_pass, which creates the fc to quantize.
+    auto& passes =
+        argument->Get<std::vector<std::string>>(kFluidToIrPassesAttr);
+    passes.push_back("int8_quantize_pass");
+    passes.push_back("graph_viz_pass");
+    auto* scales = new framework::ir::Int8Scales;
+    scales->Load(FLAGS_IA_int8_scales_path);
+    argument->Set(framework::ir::kInt8ScalesAttr, scales);
+  }
+  if (FLAGS_IA_enable_memory_optimize) {
+    // Run last, after the fuse passes have removed their temporaries.
+    auto& passes =
+        argument->Get<std::vector<std::string>>(kFluidToIrPassesAttr);
+    passes.push_back("memory_optimize_pass");
+    passes.push_back("graph_viz_pass");
+  }
 
   for (auto& x : data_) {
     PADDLE_ENFORCE(x->Initialize(argument));
@@ -45,6 +45,10 @@ DECLARE_bool(IA_enable_tensorrt_subgraph_engine);
 DECLARE_string(IA_graphviz_log_root);
 DECLARE_string(IA_output_storage_path);
 DECLARE_bool(IA_enable_ir);
+DECLARE_bool(IA_enable_memory_optimize);
+DECLARE_bool(IA_enable_conv_bn_fuse);
+DECLARE_bool(IA_enable_elemwise_chain_fuse);
+DECLARE_string(IA_int8_scales_path);
 
 namespace paddle {
 namespace inference {
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/int8_quantize_pass.h"
 #include "paddle/fluid/inference/analysis/ir_pass_manager.h"
 #include "paddle/fluid/inference/analysis/pass.h"
 
@@ -84,6 +85,11 @@ class FluidToIrPass final : public DataFlowGraphPass {
           ir::kParamScopeAttr,
           new Scope *(&argument_->Get<Scope>(ir::kParamScopeAttr)));
     }
+    if (argument_->Has(ir::kInt8ScalesAttr)) {
+      ir_passes.graph().Set(ir::kInt8ScalesAttr,
+                            new ir::Int8Scales(argument_->Get<ir::Int8Scales>(
+                                ir::kInt8ScalesAttr)));
+    }
 
     const auto &ir_passes_to_apply =
         argument_->Get<std::vector<std::string>>(kFluidToIrPassesAttr);
@@ -60,11 +60,17 @@ bool AnalysisPredictor::Init(
 
   OptimizeInferenceProgram();
   ctx_ = executor_->Prepare(*inference_program_, 0);
+  // Every Run goes through ctx_ on the same scope by one thread, so the ops
+  // can keep their kernels and variables between runs.
+  ctx_->EnableRuntimeCache();
 
   VLOG(5) << "to create variables";
   PADDLE_ENFORCE(scope_.get());
-  executor_->CreateVariables(*inference_program_,
-                             sub_scope_ ? sub_scope_ : scope_.get(), 0);
+  // See NativePaddlePredictor::Init.
+  if (!sub_scope_) {
+    sub_scope_ = &(scope_->NewScope());
+  }
+  executor_->CreateVariables(*inference_program_, sub_scope_, 0);
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
   return true;
@@ -134,6 +140,10 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
 
 }  // namespace paddle
 
+USE_PASS(conv_bn_fuse_pass);
+USE_PASS(elemwise_chain_fuse_pass);
 USE_PASS(fc_fuse_pass);
 USE_PASS(graph_viz_pass);
 USE_PASS(infer_clean_graph_pass);
+USE_PASS(int8_quantize_pass);
+USE_PASS(memory_optimize_pass);
@@ -43,6 +43,12 @@ class AnalysisPredictor : public NativePaddlePredictor {
 
   Argument& analysis_argument() { return argument_; }
 
+  // The scope of the last Run, in which the parameters can be found too.
+  framework::Scope* scope() const {
+    return sub_scope_ ? sub_scope_ : scope_.get();
+  }
+  const framework::ProgramDesc& program() const { return *inference_program_; }
+
  private:
   NativeConfig config_;
   Argument argument_;
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <set>
 #include <sstream>
 #include <string>
+#include <typeindex>
 #include <utility>
 #include <vector>
 
@@ -106,14 +107,43 @@ bool NativePaddlePredictor::Init(
   }
 
   ctx_ = executor_->Prepare(*inference_program_, 0);
-  executor_->CreateVariables(*inference_program_,
-                             sub_scope_ ? sub_scope_ : scope_.get(), 0);
+  // Every Run goes through ctx_ on the same scope by one thread, so the ops
+  // can keep their kernels and variables between runs.
+  ctx_->EnableRuntimeCache();
+  if (!sub_scope_) {
+    // Run on a sub scope, so that dropping the kid scopes after a run never
+    // deletes the scopes of the clones sharing the parameters.
+    sub_scope_ = &(scope_->NewScope());
+  }
+  executor_->CreateVariables(*inference_program_, sub_scope_, 0);
 
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
   return true;
 }
 
+bool NativePaddlePredictor::InitFrom(const NativePaddlePredictor &primary) {
+  VLOG(3) << "Predictor::init_from()";
+  if (!primary.inference_program_) {
+    LOG(ERROR) << "the predictor to share has not been initialized.";
+    return false;
+  }
+  place_ = primary.place_;
+  scope_ = primary.scope_;
+  sub_scope_ = &(scope_->NewScope());
+  inference_program_ = primary.inference_program_;
+
+  // Every predictor prepares its own context, since the operators cache
+  // their variables of the scope they run on.
+  executor_.reset(new paddle::framework::Executor(place_));
+  ctx_ = executor_->Prepare(*inference_program_, 0);
+  ctx_->EnableRuntimeCache();
+  executor_->CreateVariables(*inference_program_, sub_scope_, 0);
+
+  PrepareFeedFetch();
+  return true;
+}
+
 NativePaddlePredictor::~NativePaddlePredictor() {
 #if !defined(_WIN32)
   if (FLAGS_profile) {
@@ -139,6 +169,7 @@ bool NativePaddlePredictor::Run(const std::vector<PaddleTensor> &inputs,
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  BindFetchBuffers(*output_data, scope);
   // Run the inference program
   // if share variables, we need not create variables
   VLOG(4) << "Run prepared context";
@@ -159,8 +190,9 @@ std::unique_ptr<PaddlePredictor> NativePaddlePredictor::Clone() {
   VLOG(3) << "Predictor::clone";
   std::unique_ptr<PaddlePredictor> cls(new NativePaddlePredictor(config_));
 
-  if (!dynamic_cast<NativePaddlePredictor *>(cls.get())->Init(scope_)) {
-    LOG(ERROR) << "fail to call Init";
+  // The clone shares the loaded parameters instead of loading them again.
+  if (!dynamic_cast<NativePaddlePredictor *>(cls.get())->InitFrom(*this)) {
+    LOG(ERROR) << "fail to call InitFrom";
     return nullptr;
   }
 #ifdef __clang__
@@ -182,19 +214,29 @@ bool NativePaddlePredictor::SetFeed(const std::vector<PaddleTensor> &inputs,
   for (size_t i = 0; i < inputs.size(); ++i) {
     framework::LoDTensor input;
     framework::DDim ddim = framework::make_ddim(inputs[i].shape);
-    void *input_ptr;
+    input.Resize(ddim);
+    std::type_index type = typeid(float);
     if (inputs[i].dtype == PaddleDType::INT64) {
-      input_ptr = input.mutable_data<int64_t>(ddim, platform::CPUPlace());
-    } else if (inputs[i].dtype == PaddleDType::FLOAT32) {
-      input_ptr = input.mutable_data<float>(ddim, platform::CPUPlace());
-    } else {
+      type = typeid(int64_t);
+    } else if (inputs[i].dtype != PaddleDType::FLOAT32) {
       LOG(ERROR) << "unsupported feed type " << inputs[i].dtype;
       return false;
     }
+    size_t size = input.numel() * PaddleDtypeSize(inputs[i].dtype);
+    if (inputs[i].data.length() < size) {
+      LOG(ERROR) << "the data of input " << i << " is less than its shape";
+      return false;
+    }
 
-    // TODO(panyx0718): Init LoDTensor from existing memcpy to save a copy.
-    std::memcpy(static_cast<void *>(input_ptr), inputs[i].data.data(),
-                inputs[i].data.length());
+    if (!inputs[i].data.memory_owned() && !inputs[i].data.empty()) {
+      // The memory of the caller is available until Run returns, so it is
+      // fed without a copy.
+      input.ShareExternalData(inputs[i].data.data(), inputs[i].data.length(),
+                              platform::CPUPlace(), type);
+    } else {
+      void *input_ptr = input.mutable_data(platform::CPUPlace(), type);
+      std::memcpy(input_ptr, inputs[i].data.data(), size);
+    }
     // TODO(Superjomn) Low performance, need optimization for heavy LoD copy.
     framework::LoD lod;
     for (auto &level : inputs[i].lod) {
@@ -211,61 +253,115 @@ bool NativePaddlePredictor::SetFeed(const std::vector<PaddleTensor> &inputs,
   }
   return true;
 }
+void NativePaddlePredictor::BindFetchBuffers(
+    const std::vector<PaddleTensor> &outputs, framework::Scope *scope) {
+  auto &fetch_list =
+      *scope->Var("fetch")->GetMutable<framework::FeedFetchList>();
+  if (fetch_list.size() < fetchs_.size()) {
+    fetch_list.resize(fetchs_.size());
+  }
+  fetch_bound_.resize(fetchs_.size(), false);
+  fetch_views_.resize(fetchs_.size(), nullptr);
+  for (size_t i = 0; i < fetchs_.size(); ++i) {
+    const PaddleBuf *buffer = i < outputs.size() ? &outputs[i].data : nullptr;
+    bool bind = buffer != nullptr && !buffer->memory_owned() &&
+                !buffer->empty() && buffer->data() != fetch_views_[i];
+    if (bind) {
+      // The fetch op reuses the memory of its output if it is large enough.
+      fetch_list[i].ShareExternalData(buffer->data(), buffer->length(),
+                                      platform::CPUPlace(), typeid(float));
+    } else if (fetch_bound_[i]) {
+      // Never write into the buffer given to the last Run.
+      fetch_list[i] = framework::LoDTensor();
+    }
+    fetch_bound_[i] = bind;
+  }
+}
+
 template <typename T>
-void NativePaddlePredictor::GetFetchOne(const framework::LoDTensor &fetch,
-                                        PaddleTensor *output) {
+bool NativePaddlePredictor::GetFetchOne(const framework::LoDTensor &fetch,
+                                        PaddleTensor *output,
+                                        bool into_buffer) {
   std::vector<int> shape;
   auto dims_i = fetch.dims();
   auto lod = fetch.lod();
   const T *output_ptr = fetch.data<T>();
   auto num = fetch.numel();
-  std::vector<T> data;
+  auto &buffer = output->data;
+  output->lod.clear();
   if (0 == lod.size()) {
-    std::copy(output_ptr, output_ptr + num, std::back_inserter(data));
     for (int j = 0; j < dims_i.size(); ++j) {
       shape.push_back(dims_i[j]);
     }
-  } else {
-    // for batch detection
-    // image[0] -> output[0] shape {145, 6}
-    // image[1] -> output[1] shape {176, 6}
-    // then,
-    // the batch output shape {321, 6}
-    // the lod {{0, 145, 321}}
-    // so we should append output[0] to {176, 6}
-    size_t max_dim = 0;
-    for (size_t j = 1; j < lod[0].size(); j++) {
-      max_dim = std::max(max_dim, lod[0][j] - lod[0][j - 1]);
-    }
-    size_t common_dim = lod[0].back() == 0 ? 0 : num / lod[0].back();
-    if (max_dim > 0) {
-      data.resize((lod[0].size() - 1) * max_dim * common_dim, 0);
-    }
-    for (size_t j = 1; j < lod[0].size(); j++) {
-      size_t start = lod[0][j - 1] * common_dim;
-      size_t end = lod[0][j] * common_dim;
-      if (end > start) {
-        std::copy(output_ptr + start, output_ptr + end,
-                  data.begin() + (j - 1) * max_dim * common_dim);
+    output->shape = shape;
+    size_t bytes = sizeof(T) * num;
+    if (into_buffer) {
+      if (buffer.length() < bytes) {
+        LOG(ERROR) << "the output buffer is too small, " << bytes
+                   << " bytes are needed";
+        return false;
+      }
+      // The fetch op may have written into the buffer already.
+      if (buffer.data() != output_ptr) {
+        std::memcpy(buffer.data(), output_ptr, bytes);
       }
+    } else if (config_.fetch_as_view) {
+      buffer.Reset(const_cast<T *>(output_ptr), bytes);
+    } else {
+      if (buffer.length() != bytes) {
+        buffer.Resize(bytes);
+      }
+      std::memcpy(buffer.data(), output_ptr, bytes);
     }
-    shape.push_back(lod[0].size() - 1);
-    shape.push_back(max_dim);
-    for (int j = 1; j < dims_i.size(); ++j) {
-      shape.push_back(dims_i[j]);
+    return true;
+  }
+
+  // for batch detection
+  // image[0] -> output[0] shape {145, 6}
+  // image[1] -> output[1] shape {176, 6}
+  // then,
+  // the batch output shape {321, 6}
+  // the lod {{0, 145, 321}}
+  // so we should append output[0] to {176, 6}
+  std::vector<T> data;
+  size_t max_dim = 0;
+  for (size_t j = 1; j < lod[0].size(); j++) {
+    max_dim = std::max(max_dim, lod[0][j] - lod[0][j - 1]);
+  }
+  size_t common_dim = lod[0].back() == 0 ? 0 : num / lod[0].back();
+  if (max_dim > 0) {
+    data.resize((lod[0].size() - 1) * max_dim * common_dim, 0);
+  }
+  for (size_t j = 1; j < lod[0].size(); j++) {
+    size_t start = lod[0][j - 1] * common_dim;
+    size_t end = lod[0][j] * common_dim;
+    if (end > start) {
+      std::copy(output_ptr + start, output_ptr + end,
+                data.begin() + (j - 1) * max_dim * common_dim);
     }
   }
+  shape.push_back(lod[0].size() - 1);
+  shape.push_back(max_dim);
+  for (int j = 1; j < dims_i.size(); ++j) {
+    shape.push_back(dims_i[j]);
+  }
 
   output->shape = shape;
-  auto &buffer = output->data;
-  if (buffer.empty() || buffer.length() < sizeof(T) * data.size()) {
-    buffer.Resize(sizeof(T) * data.size());
+  size_t bytes = sizeof(T) * data.size();
+  if (into_buffer && buffer.length() < bytes) {
+    LOG(ERROR) << "the output buffer is too small, " << bytes
+               << " bytes are needed";
+    return false;
   }
-  std::memcpy(buffer.data(), data.data(), buffer.length());
+  if (!into_buffer && buffer.length() < bytes) {
+    buffer.Resize(bytes);
+  }
+  std::memcpy(buffer.data(), data.data(), bytes);
   // copy LoD
   for (const auto &level : fetch.lod()) {
     output->lod.emplace_back(level);
   }
+  return true;
 }
 
 bool NativePaddlePredictor::GetFetch(std::vector<PaddleTensor> *outputs,
@@ -279,15 +375,25 @@ bool NativePaddlePredictor::GetFetch(std::vector<PaddleTensor> *outputs,
         framework::GetFetchVariable(*scope, "fetch", idx);
     auto type = fetch.type();
     auto output = &(outputs->at(i));
+    if (!fetch_bound_[i] && output->data.data() == fetch_views_[i]) {
+      // Drop the view returned by the last Run.
+      output->data = PaddleBuf();
+    }
+    bool ok = true;
     if (type == typeid(float)) {
-      GetFetchOne<float>(fetch, output);
+      ok = GetFetchOne<float>(fetch, output, fetch_bound_[i]);
       output->dtype = PaddleDType::FLOAT32;
     } else if (type == typeid(int64_t)) {
-      GetFetchOne<int64_t>(fetch, output);
+      ok = GetFetchOne<int64_t>(fetch, output, fetch_bound_[i]);
       output->dtype = PaddleDType::INT64;
     } else {
       LOG(ERROR) << "unknown type, only support float32 and int64 now.";
     }
+    if (!ok) {
+      return false;
+    }
+    bool is_view = !fetch_bound_[i] && !output->data.memory_owned();
+    fetch_views_[i] = is_view ? output->data.data() : nullptr;
   }
   return true;
 }
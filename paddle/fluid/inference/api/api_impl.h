@@ -38,6 +38,11 @@ class NativePaddlePredictor : public PaddlePredictor {
   // will only create sub scope if have global scope
   bool Init(std::shared_ptr<framework::Scope> parent_scope);
 
+  // Share the program and the parameters of an initialized predictor without
+  // loading the model again. Only the variables of the activations are
+  // created, in a sub scope of the scope holding the parameters.
+  bool InitFrom(const NativePaddlePredictor &primary);
+
   bool Run(const std::vector<PaddleTensor> &inputs,
            std::vector<PaddleTensor> *output_data,
            int batch_size = -1) override;
@@ -49,11 +54,14 @@ class NativePaddlePredictor : public PaddlePredictor {
  protected:
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
+  // Let the fetch op write into the output buffers provided by the caller.
+  void BindFetchBuffers(const std::vector<PaddleTensor> &output_data,
+                        framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
                 framework::Scope *scope);
   template <typename T>
-  void GetFetchOne(const framework::LoDTensor &fetchs,
-                   PaddleTensor *output_data);
+  bool GetFetchOne(const framework::LoDTensor &fetchs,
+                   PaddleTensor *output_data, bool into_buffer);
   void PrepareFeedFetch();
 
   NativeConfig config_;
@@ -61,12 +69,17 @@ class NativePaddlePredictor : public PaddlePredictor {
   std::unique_ptr<framework::Executor> executor_;
   std::shared_ptr<framework::Scope> scope_;
   std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
-  std::unique_ptr<framework::ProgramDesc> inference_program_;
+  // Shared by the predictor and its clones.
+  std::shared_ptr<framework::ProgramDesc> inference_program_;
   std::vector<framework::OpDesc *> feeds_;
   std::map<std::string, size_t> feed_names_;
   std::vector<framework::OpDesc *> fetchs_;
   // Do not use unique_ptr, use parent scope to delete
   framework::Scope *sub_scope_{nullptr};
+  // Whether each fetch is written into a buffer of the caller in this Run.
+  std::vector<bool> fetch_bound_;
+  // The outputs returned as views by the last Run.
+  std::vector<const void *> fetch_views_;
 };
 
 }  // namespace paddle
@@ -104,6 +104,54 @@ void MainWord2Vec(bool use_gpu) {
   }
 }
 
+void MainWord2VecZeroCopy(bool use_gpu) {
+  NativeConfig config = GetConfig();
+  config.use_gpu = use_gpu;
+  auto predictor = CreatePaddlePredictor<NativeConfig>(config);
+  config.fetch_as_view = true;
+  auto view_predictor = CreatePaddlePredictor<NativeConfig>(config);
+
+  std::vector<framework::LoDTensor> words(4);
+  std::vector<PaddleTensor> feeds;
+  for (auto& word : words) {
+    framework::LoD lod{{0, 1}};
+    int64_t dict_size = 2073;  // The size of dictionary
+    SetupLoDTensor(&word, lod, static_cast<int64_t>(0), dict_size - 1);
+    feeds.push_back(LodTensorToPaddleTensor(&word));
+  }
+
+  // Copy the outputs.
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(feeds, &outputs));
+  ASSERT_EQ(outputs.size(), 1UL);
+  ASSERT_TRUE(outputs[0].data.memory_owned());
+  const size_t len = outputs[0].data.length();
+  const float* ref = static_cast<float*>(outputs[0].data.data());
+
+  // Write the outputs into the buffer of the caller.
+  std::vector<float> buffer(len / sizeof(float));
+  std::vector<PaddleTensor> buffer_outputs(1);
+  buffer_outputs[0].data.Reset(buffer.data(), len);
+  ASSERT_TRUE(predictor->Run(feeds, &buffer_outputs));
+  ASSERT_EQ(buffer_outputs[0].data.data(), buffer.data());
+  for (size_t j = 0; j < buffer.size(); ++j) {
+    EXPECT_NEAR(ref[j], buffer[j], 1e-5);
+  }
+
+  // Return the outputs as views, run twice on the same outputs.
+  std::vector<PaddleTensor> view_outputs;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(view_predictor->Run(feeds, &view_outputs));
+    ASSERT_EQ(view_outputs.size(), 1UL);
+    ASSERT_FALSE(view_outputs[0].data.memory_owned());
+    ASSERT_EQ(view_outputs[0].data.length(), len);
+    const float* view = static_cast<float*>(view_outputs[0].data.data());
+    for (size_t j = 0; j < len / sizeof(float); ++j) {
+      EXPECT_NEAR(ref[j], view[j], 1e-5);
+    }
+  }
+}
+
 void MainImageClassification(bool use_gpu) {
   int batch_size = 2;
   bool repeat = false;
@@ -261,6 +309,9 @@ void MainThreadsImageClassification(bool use_gpu) {
 }
 
 TEST(inference_api_native, word2vec_cpu) { MainWord2Vec(false /*use_gpu*/); }
+TEST(inference_api_native, word2vec_cpu_zero_copy) {
+  MainWord2VecZeroCopy(false /*use_gpu*/);
+}
 TEST(inference_api_native, word2vec_cpu_threads) {
   MainThreadsWord2Vec(false /*use_gpu*/);
 }
@@ -273,6 +324,9 @@ TEST(inference_api_native, image_classification_cpu_threads) {
 
 #ifdef PADDLE_WITH_CUDA
 TEST(inference_api_native, word2vec_gpu) { MainWord2Vec(true /*use_gpu*/); }
+TEST(inference_api_native, word2vec_gpu_zero_copy) {
+  MainWord2VecZeroCopy(true /*use_gpu*/);
+}
 TEST(inference_api_native, word2vec_gpu_threads) {
   MainThreadsWord2Vec(true /*use_gpu*/);
 }
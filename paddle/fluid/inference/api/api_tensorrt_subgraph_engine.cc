@@ -72,8 +72,11 @@ class TensorRTSubgraphPredictor : public NativePaddlePredictor {
     ctx_ = executor_->Prepare(*inference_program_, 0);
 
     VLOG(5) << "to create variables";
-    executor_->CreateVariables(*inference_program_,
-                               sub_scope_ ? sub_scope_ : scope_.get(), 0);
+    // See NativePaddlePredictor::Init.
+    if (!sub_scope_) {
+      sub_scope_ = &(scope_->NewScope());
+    }
+    executor_->CreateVariables(*inference_program_, sub_scope_, 0);
     // Get the feed_target_names and fetch_target_names
     PrepareFeedFetch();
     return true;
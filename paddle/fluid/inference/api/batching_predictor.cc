@@ -0,0 +1,376 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <typeindex>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace {
+
+// The number of samples of a tensor: rows, or top level sequences.
+size_t BatchSize(const PaddleTensor &t) {
+  if (!t.lod.empty()) {
+    return t.lod[0].empty() ? 0 : t.lod[0].size() - 1;
+  }
+  return t.shape.empty() ? 0 : static_cast<size_t>(t.shape[0]);
+}
+
+// Whether all inputs hold the same number of samples, so that a request can
+// be merged with others.
+bool Batchable(const std::vector<PaddleTensor> &inputs) {
+  if (inputs.empty() || BatchSize(inputs[0]) == 0) {
+    return false;
+  }
+  for (auto &input : inputs) {
+    if (BatchSize(input) != BatchSize(inputs[0])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Mergeable(const std::vector<PaddleTensor> &a,
+               const std::vector<PaddleTensor> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].name != b[i].name || a[i].dtype != b[i].dtype ||
+        a[i].lod.size() != b[i].lod.size() ||
+        a[i].shape.size() != b[i].shape.size() || a[i].shape.empty() ||
+        !std::equal(a[i].shape.begin() + 1, a[i].shape.end(),
+                    b[i].shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::type_index ToType(PaddleDType dtype) {
+  if (dtype == PaddleDType::INT64) {
+    return typeid(int64_t);
+  }
+  return typeid(float);
+}
+
+// Share the memory of a PaddleTensor without copying.
+framework::LoDTensor ToLoDTensor(const PaddleTensor &t) {
+  framework::LoDTensor tensor;
+  tensor.Resize(framework::make_ddim(t.shape));
+  tensor.ShareExternalData(t.data.data(), t.data.length(),
+                           platform::CPUPlace(), ToType(t.dtype));
+  framework::LoD lod;
+  for (auto &level : t.lod) {
+    lod.emplace_back(level);
+  }
+  tensor.set_lod(lod);
+  return tensor;
+}
+
+// An output with LoD is padded by the native predictor to
+// [sequences, longest sequence, ...], see NativePaddlePredictor::GetFetchOne.
+// Remove the padding to get the LoDTensor back.
+framework::LoDTensor UnpadOutput(const PaddleTensor &t) {
+  PADDLE_ENFORCE_GE(t.shape.size(), 2UL);
+  const auto &offsets = t.lod[0];
+  size_t max_dim = static_cast<size_t>(t.shape[1]);
+  size_t common_dim = 1;
+  std::vector<int> dims{static_cast<int>(offsets.back())};
+  for (size_t i = 2; i < t.shape.size(); ++i) {
+    common_dim *= t.shape[i];
+    dims.push_back(t.shape[i]);
+  }
+  size_t elem_size = PaddleDtypeSize(t.dtype);
+
+  framework::LoDTensor tensor;
+  tensor.Resize(framework::make_ddim(dims));
+  char *dst = static_cast<char *>(
+      tensor.mutable_data(platform::CPUPlace(), ToType(t.dtype)));
+  const char *src = static_cast<const char *>(t.data.data());
+  for (size_t j = 0; j + 1 < offsets.size(); ++j) {
+    size_t len = (offsets[j + 1] - offsets[j]) * common_dim * elem_size;
+    std::memcpy(dst + offsets[j] * common_dim * elem_size,
+                src + j * max_dim * common_dim * elem_size, len);
+  }
+  framework::LoD lod;
+  for (auto &level : t.lod) {
+    lod.emplace_back(level);
+  }
+  tensor.set_lod(lod);
+  return tensor;
+}
+
+// Returns the memory for `bytes` bytes of an output. A buffer of the caller
+// is used if it is given, just as the native predictor does.
+void *OutputBuffer(size_t bytes, PaddleBuf *buffer) {
+  if (!buffer->memory_owned() && !buffer->empty()) {
+    if (buffer->length() < bytes) {
+      LOG(ERROR) << "the output buffer is too small, " << bytes
+                 << " bytes are needed";
+      return nullptr;
+    }
+  } else if (buffer->length() != bytes) {
+    buffer->Resize(bytes);
+  }
+  return buffer->data();
+}
+
+// The reverse of UnpadOutput, or a plain copy if there is no LoD.
+bool ToPaddleTensor(const framework::LoDTensor &tensor, PaddleDType dtype,
+                    PaddleTensor *output) {
+  size_t elem_size = PaddleDtypeSize(dtype);
+  const char *src = static_cast<const char *>(tensor.data<void>());
+  auto dims = framework::vectorize2int(tensor.dims());
+  output->dtype = dtype;
+  output->lod.clear();
+  if (tensor.lod().empty()) {
+    size_t bytes = tensor.numel() * elem_size;
+    void *dst = OutputBuffer(bytes, &output->data);
+    if (dst == nullptr) return false;
+    std::memcpy(dst, src, bytes);
+    output->shape = dims;
+    return true;
+  }
+
+  const auto &offsets = tensor.lod()[0];
+  size_t max_dim = 0;
+  for (size_t j = 1; j < offsets.size(); ++j) {
+    max_dim = std::max(max_dim, offsets[j] - offsets[j - 1]);
+  }
+  size_t common_dim =
+      offsets.back() == 0 ? 0 : tensor.numel() / offsets.back();
+  size_t row_bytes = max_dim * common_dim * elem_size;
+  size_t bytes = (offsets.size() - 1) * row_bytes;
+  char *dst = static_cast<char *>(OutputBuffer(bytes, &output->data));
+  if (dst == nullptr) return false;
+  std::memset(dst, 0, bytes);
+  for (size_t j = 1; j < offsets.size(); ++j) {
+    std::memcpy(dst + (j - 1) * row_bytes,
+                src + offsets[j - 1] * common_dim * elem_size,
+                (offsets[j] - offsets[j - 1]) * common_dim * elem_size);
+  }
+  output->shape = {static_cast<int>(offsets.size() - 1),
+                   static_cast<int>(max_dim)};
+  for (size_t i = 1; i < dims.size(); ++i) {
+    output->shape.push_back(dims[i]);
+  }
+  for (const auto &level : tensor.lod()) {
+    output->lod.emplace_back(level);
+  }
+  return true;
+}
+
+}  // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig &config)
+    : predictor_(std::move(predictor)), config_(config) {
+  PADDLE_ENFORCE_NOT_NULL(predictor_);
+  PADDLE_ENFORCE_GT(config_.max_batch_size, 0);
+  PADDLE_ENFORCE_GE(config_.max_latency_us, 0);
+  worker_ = std::thread([this] { Loop(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor> &inputs,
+                            std::vector<PaddleTensor> *output_data,
+                            int batch_size) {
+  std::unique_ptr<Request> request(new Request);
+  request->inputs = &inputs;
+  request->outputs = output_data;
+  request->batch_size = Batchable(inputs) ? BatchSize(inputs[0]) : 0;
+  request->arrival = std::chrono::steady_clock::now();
+  auto done = request->done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE(!stop_, "BatchingPredictor is being destroyed.");
+    requests_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return done.get();
+}
+
+std::unique_ptr<PaddlePredictor> BatchingPredictor::Clone() {
+  auto predictor = predictor_->Clone();
+  if (!predictor) {
+    LOG(ERROR) << "fail to clone the predictor";
+    return nullptr;
+  }
+  std::unique_ptr<PaddlePredictor> cls(
+      new BatchingPredictor(std::move(predictor), config_));
+#ifdef __clang__
+  // fix clang compile error
+  return cls;
+#else
+  // fix manylinux compile error.
+  return std::move(cls);
+#endif
+}
+
+void BatchingPredictor::Loop() {
+  while (true) {
+    auto batch = NextBatch();
+    if (batch.empty()) {
+      return;
+    }
+    RunBatch(&batch);
+  }
+}
+
+std::vector<std::unique_ptr<BatchingPredictor::Request>>
+BatchingPredictor::NextBatch() {
+  std::vector<std::unique_ptr<Request>> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+  if (requests_.empty()) {
+    return batch;
+  }
+
+  const size_t max_batch_size = static_cast<size_t>(config_.max_batch_size);
+  auto &first = *requests_.front();
+  if (first.batch_size > 0 && first.batch_size < max_batch_size) {
+    // Wait for others until the batch is full or the window is over.
+    auto deadline =
+        first.arrival + std::chrono::microseconds(config_.max_latency_us);
+    auto queued_size = [this] {
+      size_t size = 0;
+      for (auto &request : requests_) {
+        size += request->batch_size;
+      }
+      return size;
+    };
+    while (!stop_ && queued_size() < max_batch_size &&
+           std::chrono::steady_clock::now() < deadline) {
+      cv_.wait_until(lock, deadline);
+    }
+  }
+
+  batch.emplace_back(std::move(requests_.front()));
+  requests_.pop_front();
+  size_t size = batch[0]->batch_size;
+  if (size == 0) {
+    return batch;
+  }
+  for (auto it = requests_.begin(); it != requests_.end();) {
+    auto &request = *it;
+    if (request->batch_size > 0 &&
+        size + request->batch_size <= max_batch_size &&
+        Mergeable(*batch[0]->inputs, *request->inputs)) {
+      size += request->batch_size;
+      batch.emplace_back(std::move(request));
+      it = requests_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return batch;
+}
+
+void BatchingPredictor::RunBatch(std::vector<std::unique_ptr<Request>> *batch) {
+  auto &requests = *batch;
+  if (requests.size() == 1) {
+    auto &request = requests[0];
+    bool ok = false;
+    try {
+      ok = predictor_->Run(*request->inputs, request->outputs);
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "fail to run a request: " << e.what();
+    }
+    request->done.set_value(ok);
+    return;
+  }
+  VLOG(3) << "Run a batch of " << requests.size() << " requests";
+
+  bool ok = true;
+  try {
+    size_t num_inputs = requests[0]->inputs->size();
+    std::vector<framework::LoDTensor> merged(num_inputs);
+    std::vector<PaddleTensor> inputs(num_inputs);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      std::vector<framework::LoDTensor> parts;
+      std::vector<const framework::LoDTensor *> part_ptrs;
+      parts.reserve(requests.size());
+      for (auto &request : requests) {
+        parts.emplace_back(ToLoDTensor(request->inputs->at(i)));
+        part_ptrs.push_back(&parts.back());
+      }
+      merged[i].MergeLoDTensor(part_ptrs, platform::CPUPlace());
+
+      // The merged tensor is fed without a copy.
+      auto &input = inputs[i];
+      const auto &first = requests[0]->inputs->at(i);
+      input.name = first.name;
+      input.dtype = first.dtype;
+      input.shape = framework::vectorize2int(merged[i].dims());
+      input.data.Reset(merged[i].data<void>(),
+                       merged[i].numel() * PaddleDtypeSize(first.dtype));
+      for (auto &level : merged[i].lod()) {
+        input.lod.emplace_back(level);
+      }
+    }
+
+    std::vector<PaddleTensor> outputs;
+    ok = predictor_->Run(inputs, &outputs);
+
+    std::vector<size_t> batch_sizes;
+    size_t total = 0;
+    for (auto &request : requests) {
+      batch_sizes.push_back(request->batch_size);
+      total += request->batch_size;
+      request->outputs->resize(outputs.size());
+    }
+    for (size_t i = 0; ok && i < outputs.size(); ++i) {
+      auto &output = outputs[i];
+      if (BatchSize(output) != total) {
+        LOG(ERROR) << "output " << i << " holds " << BatchSize(output)
+                   << " samples instead of " << total
+                   << ", it cannot be split to the requests";
+        ok = false;
+        break;
+      }
+      framework::LoDTensor tensor =
+          output.lod.empty() ? ToLoDTensor(output) : UnpadOutput(output);
+      auto parts = tensor.SplitLoDTensor(batch_sizes, platform::CPUPlace());
+      for (size_t j = 0; ok && j < requests.size(); ++j) {
+        auto &dst = requests[j]->outputs->at(i);
+        dst.name = output.name;
+        ok = ToPaddleTensor(parts[j], output.dtype, &dst);
+      }
+    }
+  } catch (const std::exception &e) {
+    LOG(ERROR) << "fail to run a batch: " << e.what();
+    ok = false;
+  }
+  for (auto &request : requests) {
+    request->done.set_value(ok);
+  }
+}
+
+}  // namespace paddle
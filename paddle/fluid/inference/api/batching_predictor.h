@@ -0,0 +1,92 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+
+struct BatchingConfig {
+  // The maximum number of samples, i.e. rows or top level sequences of the
+  // first input, run in one batch. A larger request is run alone.
+  int max_batch_size{32};
+  // How long the first request of a batch waits for others to join.
+  int max_latency_us{1000};
+};
+
+/*
+ * BatchingPredictor serves requests from many threads with one predictor.
+ *
+ * Requests arriving within the latency window are merged into one batch with
+ * LoDTensor::MergeLoDTensor, run once, and the outputs are split back to each
+ * request with LoDTensor::SplitLoDTensor, so that the ops are dispatched once
+ * per batch instead of once per request. Only requests whose inputs have the
+ * same types, LoD levels and shapes except the first dimension are merged.
+ *
+ * Every output must have the batch as its first dimension, or LoD whose top
+ * level holds one sequence per sample.
+ */
+class BatchingPredictor : public PaddlePredictor {
+ public:
+  BatchingPredictor(std::unique_ptr<PaddlePredictor> predictor,
+                    const BatchingConfig& config);
+
+  // Blocks until the batch holding the request has been run. It can be
+  // called by many threads at the same time.
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* output_data,
+           int batch_size = -1) override;
+
+  // A new BatchingPredictor with a clone of the predictor.
+  std::unique_ptr<PaddlePredictor> Clone() override;
+
+  ~BatchingPredictor() override;
+
+ private:
+  struct Request {
+    const std::vector<PaddleTensor>* inputs;
+    std::vector<PaddleTensor>* outputs;
+    size_t batch_size;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<bool> done;
+  };
+
+  void Loop();
+
+  // Pops the first request and the requests which can be merged with it.
+  std::vector<std::unique_ptr<Request>> NextBatch();
+
+  void RunBatch(std::vector<std::unique_ptr<Request>>* batch);
+
+  std::unique_ptr<PaddlePredictor> predictor_;
+  BatchingConfig config_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<Request>> requests_;
+  bool stop_{false};
+  std::thread worker_;
+};
+
+}  // namespace paddle
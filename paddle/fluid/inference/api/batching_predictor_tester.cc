@@ -0,0 +1,208 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/inference/api/batching_predictor.h"
+#include "paddle/fluid/inference/tests/test_helper.h"
+
+DEFINE_string(dirname, "", "Directory of the inference model.");
+
+namespace paddle {
+
+// Doubles its only input. An input with LoD gives an output padded to the
+// longest sequence, as the native predictor does.
+class DoublePredictor : public PaddlePredictor {
+ public:
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* output_data,
+           int batch_size = -1) override {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    const auto& input = inputs[0];
+    const float* src = static_cast<const float*>(input.data.data());
+    output_data->resize(1);
+    auto& output = output_data->at(0);
+    output.dtype = PaddleDType::FLOAT32;
+    output.lod = input.lod;
+    if (input.lod.empty()) {
+      output.shape = input.shape;
+      output.data.Resize(input.data.length());
+      float* dst = static_cast<float*>(output.data.data());
+      for (size_t i = 0; i < input.data.length() / sizeof(float); ++i) {
+        dst[i] = src[i] * 2;
+      }
+      max_rows = std::max<int>(max_rows, input.shape[0]);
+    } else {
+      auto& offsets = input.lod[0];
+      size_t max_len = 0;
+      for (size_t j = 1; j < offsets.size(); ++j) {
+        max_len = std::max(max_len, offsets[j] - offsets[j - 1]);
+      }
+      output.shape = {static_cast<int>(offsets.size() - 1),
+                      static_cast<int>(max_len)};
+      output.data.Resize((offsets.size() - 1) * max_len * sizeof(float));
+      float* dst = static_cast<float*>(output.data.data());
+      std::fill(dst, dst + (offsets.size() - 1) * max_len, 0.f);
+      for (size_t j = 1; j < offsets.size(); ++j) {
+        for (size_t k = offsets[j - 1]; k < offsets[j]; ++k) {
+          dst[(j - 1) * max_len + k - offsets[j - 1]] = src[k] * 2;
+        }
+      }
+      max_rows = std::max<int>(max_rows, offsets.size() - 1);
+    }
+    ++runs;
+    return true;
+  }
+
+  std::unique_ptr<PaddlePredictor> Clone() override {
+    return std::unique_ptr<PaddlePredictor>(new DoublePredictor);
+  }
+
+  std::atomic<int> runs{0};
+  std::atomic<int> max_rows{0};
+};
+
+TEST(BatchingPredictor, merge_and_split) {
+  auto* fake = new DoublePredictor;
+  BatchingConfig config;
+  config.max_batch_size = 8;
+  config.max_latency_us = 100000;
+  BatchingPredictor predictor(std::unique_ptr<PaddlePredictor>(fake), config);
+
+  constexpr int num_threads = 8;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      // Each request holds one row, or one sequence of tid + 1 elements.
+      bool with_lod = tid % 2 == 1;
+      std::vector<float> data(tid + 1, static_cast<float>(tid));
+      PaddleTensor input;
+      input.dtype = PaddleDType::FLOAT32;
+      if (with_lod) {
+        input.shape = {tid + 1, 1};
+        input.lod = {{0, static_cast<size_t>(tid + 1)}};
+      } else {
+        input.shape = {1, tid + 1};
+      }
+      input.data.Reset(data.data(), data.size() * sizeof(float));
+      std::vector<PaddleTensor> outputs;
+      ASSERT_TRUE(predictor.Run({input}, &outputs));
+      ASSERT_EQ(outputs.size(), 1UL);
+      ASSERT_EQ(outputs[0].data.length(), data.size() * sizeof(float));
+      if (with_lod) {
+        ASSERT_EQ(outputs[0].shape, std::vector<int>({1, tid + 1}));
+        ASSERT_EQ(outputs[0].lod[0], std::vector<size_t>({0, data.size()}));
+      } else {
+        ASSERT_EQ(outputs[0].shape, input.shape);
+      }
+      const float* out = static_cast<const float*>(outputs[0].data.data());
+      for (size_t i = 0; i < data.size(); ++i) {
+        ASSERT_EQ(out[i], 2.f * tid);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // Requests of different shapes are not merged, but some of them are.
+  EXPECT_LT(fake->runs, num_threads);
+  EXPECT_GT(fake->max_rows, 1);
+}
+
+// Word2vec requests of 1 sample from many threads, either with one cloned
+// predictor per thread or through one BatchingPredictor.
+void BenchmarkWord2Vec(int max_latency_us) {
+  NativeConfig config;
+  config.model_dir = FLAGS_dirname + "word2vec.inference.model";
+  config.use_gpu = false;
+  auto main_predictor = CreatePaddlePredictor<NativeConfig>(config);
+  BatchingConfig batching_config;
+  batching_config.max_batch_size = 32;
+  batching_config.max_latency_us = max_latency_us;
+  std::unique_ptr<PaddlePredictor> batching;
+  if (max_latency_us >= 0) {
+    batching.reset(
+        new BatchingPredictor(main_predictor->Clone(), batching_config));
+  }
+
+  constexpr int num_threads = 16;
+  constexpr int num_requests = 200;
+  std::vector<std::vector<double>> latency(num_threads);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::unique_ptr<PaddlePredictor> local;
+      PaddlePredictor* predictor = batching.get();
+      if (predictor == nullptr) {
+        local = main_predictor->Clone();
+        predictor = local.get();
+      }
+      std::vector<framework::LoDTensor> words(4);
+      std::vector<PaddleTensor> inputs;
+      for (auto& word : words) {
+        SetupLoDTensor(&word, framework::LoD{{0, 1}}, static_cast<int64_t>(0),
+                       static_cast<int64_t>(2072));
+        PaddleTensor input;
+        input.data.Reset(word.data<void>(), sizeof(int64_t));
+        input.dtype = PaddleDType::INT64;
+        input.shape = {1, 1};
+        input.lod = {{0, 1}};
+        inputs.push_back(input);
+      }
+      std::vector<PaddleTensor> outputs;
+      for (int i = 0; i < num_requests; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        ASSERT_TRUE(predictor->Run(inputs, &outputs));
+        latency[tid].push_back(std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - begin)
+                                   .count());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::vector<double> all;
+  for (auto& l : latency) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+  LOG(INFO) << (max_latency_us < 0
+                    ? std::string("per-thread predictors")
+                    : "batching, window " + std::to_string(max_latency_us) +
+                          "us")
+            << ": " << all.size() / seconds << " QPS, p50 "
+            << all[all.size() / 2] << "ms, p99 " << all[all.size() * 99 / 100]
+            << "ms";
+}
+
+TEST(BatchingPredictor, word2vec_benchmark) {
+  BenchmarkWord2Vec(-1);
+  for (int window : {0, 200, 1000, 5000}) {
+    BenchmarkWord2Vec(window);
+  }
+}
+
+}  // namespace paddle
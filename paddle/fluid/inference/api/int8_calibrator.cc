@@ -0,0 +1,116 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include "paddle/fluid/inference/api/int8_calibrator.h"
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+
+namespace {
+
+const std::string& WeightName(const framework::OpDesc& op) {
+  return op.Input(op.Type() == "fc" ? "W" : "Filter")[0];
+}
+
+}  // namespace
+
+Int8Calibrator::Int8Calibrator(const NativeConfig& config,
+                               bool weight_per_channel) {
+  // Calibrate the float model, keeping every input of the ops to read it
+  // after a run. The conv2d are not fused, as int8_quantize_pass sees them.
+  std::string scales_path = FLAGS_IA_int8_scales_path;
+  bool memory_optimize = FLAGS_IA_enable_memory_optimize;
+  bool conv_bn_fuse = FLAGS_IA_enable_conv_bn_fuse;
+  FLAGS_IA_int8_scales_path = "";
+  FLAGS_IA_enable_memory_optimize = false;
+  FLAGS_IA_enable_conv_bn_fuse = false;
+  predictor_.reset(new AnalysisPredictor(config));
+  bool success = predictor_->Init(nullptr);
+  FLAGS_IA_int8_scales_path = scales_path;
+  FLAGS_IA_enable_memory_optimize = memory_optimize;
+  FLAGS_IA_enable_conv_bn_fuse = conv_bn_fuse;
+  PADDLE_ENFORCE(success, "Fail to load the model to calibrate.");
+
+  for (auto* op : predictor_->program().Block(0).AllOps()) {
+    if (op->Type() == "fc" || op->Type() == "conv2d") {
+      ops_.push_back(op);
+    }
+  }
+  CollectWeightScales(weight_per_channel);
+}
+
+void Int8Calibrator::CollectWeightScales(bool weight_per_channel) {
+  auto* scope = predictor_->scope();
+  for (auto* op : ops_) {
+    const std::string& name = WeightName(*op);
+    auto* var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto& weight = var->Get<framework::LoDTensor>();
+    if (weight.type() != typeid(float) || weight.dims().size() < 2) continue;
+    // The output channels are the columns of the weight of fc, and the first
+    // dimension of the filter of conv2d.
+    bool is_fc = op->Type() == "fc";
+    int64_t channels = is_fc ? weight.dims()[1] : weight.dims()[0];
+    int64_t size = weight.numel() / channels;
+    const float* data = weight.data<float>();
+    std::vector<float> max_abs(channels, 0.f);
+    for (int64_t c = 0; c < channels; ++c) {
+      for (int64_t i = 0; i < size; ++i) {
+        float x = is_fc ? data[i * channels + c] : data[c * size + i];
+        max_abs[c] = std::max(max_abs[c], std::abs(x));
+      }
+    }
+    if (!weight_per_channel) {
+      max_abs.assign(1, *std::max_element(max_abs.begin(), max_abs.end()));
+    }
+    scales_.max_abs[name] = max_abs;
+  }
+}
+
+bool Int8Calibrator::Feed(const std::vector<PaddleTensor>& inputs) {
+  std::vector<PaddleTensor> outputs;
+  if (!predictor_->Run(inputs, &outputs)) return false;
+  for (auto* op : ops_) {
+    UpdateInputScale(op->Input("Input")[0]);
+  }
+  return true;
+}
+
+void Int8Calibrator::UpdateInputScale(const std::string& name) {
+  auto* var = predictor_->scope()->FindVar(name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return;
+  auto& tensor = var->Get<framework::LoDTensor>();
+  if (!tensor.IsInitialized() || tensor.type() != typeid(float)) return;
+  const float* data = tensor.data<float>();
+  float max_abs = 0.f;
+  float min = 0.f;
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    max_abs = std::max(max_abs, std::abs(data[i]));
+    min = std::min(min, data[i]);
+  }
+  auto& scale = scales_.max_abs[name];
+  scale.resize(1, 0.f);
+  scale[0] = std::max(scale[0], max_abs);
+  if (min < 0.f) signed_inputs_.insert(name);
+  if (signed_inputs_.count(name)) {
+    scales_.is_unsigned.erase(name);
+  } else {
+    scales_.is_unsigned.insert(name);
+  }
+}
+
+}  // namespace paddle
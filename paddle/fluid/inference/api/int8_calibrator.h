@@ -0,0 +1,62 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/int8_quantize_pass.h"
+#include "paddle/fluid/inference/api/analysis_predictor.h"
+
+namespace paddle {
+
+/*
+ * Int8Calibrator collects the scales for int8_quantize_pass by running a
+ * model in float on sample inputs.
+ *
+ * The scale of the input of every fc and conv2d is the max absolute value it
+ * takes over all the batches fed, and the input is marked unsigned if it was
+ * never negative. The scales of the weights are taken once from the
+ * parameters, by output channel if weight_per_channel is set.
+ *
+ * The saved scales quantize the model when they are passed to an
+ * AnalysisPredictor by FLAGS_IA_int8_scales_path.
+ */
+class Int8Calibrator {
+ public:
+  explicit Int8Calibrator(const NativeConfig& config,
+                          bool weight_per_channel = true);
+
+  // Run a batch and update the scales of the inputs.
+  bool Feed(const std::vector<PaddleTensor>& inputs);
+
+  const framework::ir::Int8Scales& scales() const { return scales_; }
+  void SaveScales(const std::string& path) const { scales_.Save(path); }
+
+ private:
+  void CollectWeightScales(bool weight_per_channel);
+  void UpdateInputScale(const std::string& name);
+
+  std::unique_ptr<AnalysisPredictor> predictor_;
+  // The fc and conv2d of the optimized program.
+  std::vector<framework::OpDesc*> ops_;
+  framework::ir::Int8Scales scales_;
+  // The inputs which took a negative value.
+  std::unordered_set<std::string> signed_inputs_;
+};
+
+}  // namespace paddle
@@ -0,0 +1,212 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/inference/api/int8_calibrator.h"
+#include "paddle/fluid/inference/api/timer.h"
+#include "paddle/fluid/inference/tests/test_helper.h"
+
+DEFINE_string(dirname, "", "Directory of the inference model.");
+DEFINE_int32(calibration_batches, 10, "Number of batches to calibrate on.");
+DEFINE_int32(test_batches, 10, "Number of batches to compare on.");
+DEFINE_int32(batch_size, 8, "Batch size of the inputs.");
+
+namespace paddle {
+
+NativeConfig GetConfig(const std::string& model) {
+  NativeConfig config;
+  config.model_dir = FLAGS_dirname + model;
+  config.use_gpu = false;
+  return config;
+}
+
+// The images and labels of the test reader, dumped into the model directory
+// by the book test as an int64 [num, numel] header, the float images and the
+// int64 labels.
+struct Samples {
+  int64_t num = 0;
+  int64_t numel = 0;
+  std::vector<float> images;
+  std::vector<int64_t> labels;
+};
+
+Samples LoadSamples(const std::string& model_dir) {
+  std::string path = model_dir + "/test_samples";
+  std::ifstream fin(path, std::ios::binary);
+  PADDLE_ENFORCE(fin.is_open(), "Cannot open %s, run the book test first.",
+                 path);
+  Samples samples;
+  fin.read(reinterpret_cast<char*>(&samples.num), sizeof(int64_t));
+  fin.read(reinterpret_cast<char*>(&samples.numel), sizeof(int64_t));
+  samples.images.resize(samples.num * samples.numel);
+  samples.labels.resize(samples.num);
+  fin.read(reinterpret_cast<char*>(samples.images.data()),
+           samples.images.size() * sizeof(float));
+  fin.read(reinterpret_cast<char*>(samples.labels.data()),
+           samples.labels.size() * sizeof(int64_t));
+  PADDLE_ENFORCE(fin.good(), "%s is truncated.", path);
+  return samples;
+}
+
+// Cuts num batches out of the samples, starting at sample begin.
+std::vector<framework::LoDTensor> Batches(const std::string& model_dir,
+                                          const Samples& samples, int begin,
+                                          int num) {
+  PADDLE_ENFORCE_LE(begin + num * FLAGS_batch_size, samples.num,
+                    "Not enough test samples.");
+  auto shapes = GetFeedTargetShapes(model_dir, false /*is_combined*/);
+  shapes[0][0] = FLAGS_batch_size;
+  auto dims = framework::make_ddim(shapes[0]);
+  PADDLE_ENFORCE_EQ(framework::product(dims),
+                    FLAGS_batch_size * samples.numel);
+  std::vector<framework::LoDTensor> batches(num);
+  for (int i = 0; i < num; ++i) {
+    float* data = batches[i].mutable_data<float>(dims, platform::CPUPlace());
+    auto* first = samples.images.data() +
+                  (begin + i * FLAGS_batch_size) * samples.numel;
+    std::copy(first, first + FLAGS_batch_size * samples.numel, data);
+  }
+  return batches;
+}
+
+std::vector<PaddleTensor> ToPaddleTensors(framework::LoDTensor* t) {
+  PaddleTensor pt;
+  pt.data.Reset(t->data<void>(), t->numel() * sizeof(float));
+  pt.dtype = PaddleDType::FLOAT32;
+  pt.shape = framework::vectorize2int(t->dims());
+  return {pt};
+}
+
+// The bytes of the parameters, in the format the predictor runs them.
+int64_t WeightBytes(const AnalysisPredictor& predictor) {
+  int64_t bytes = 0;
+  for (auto* var : predictor.program().Block(0).AllVars()) {
+    if (!var->Persistable()) continue;
+    auto* v = predictor.scope()->FindVar(var->Name());
+    if (v == nullptr || !v->IsType<framework::LoDTensor>()) continue;
+    auto& t = v->Get<framework::LoDTensor>();
+    if (!t.IsInitialized()) continue;
+    bytes += t.numel() * framework::SizeOfType(t.type());
+  }
+  return bytes;
+}
+
+std::unique_ptr<AnalysisPredictor> CreatePredictor(
+    const NativeConfig& config, const std::string& scales_path) {
+  FLAGS_IA_int8_scales_path = scales_path;
+  std::unique_ptr<AnalysisPredictor> predictor(new AnalysisPredictor(config));
+  bool success = predictor->Init(nullptr);
+  FLAGS_IA_int8_scales_path = "";
+  EXPECT_TRUE(success);
+  return predictor;
+}
+
+void CompareInt8WithFloat(const std::string& model) {
+  NativeConfig config = GetConfig(model);
+  Int8Calibrator calibrator(config);
+  Samples samples = LoadSamples(config.model_dir);
+  // Calibrate and compare on disjoint samples.
+  auto calibration =
+      Batches(config.model_dir, samples, 0, FLAGS_calibration_batches);
+  for (auto& batch : calibration) {
+    ASSERT_TRUE(calibrator.Feed(ToPaddleTensors(&batch)));
+  }
+  std::string scales_path = model + ".int8_scales";
+  calibrator.SaveScales(scales_path);
+
+  auto fp32 = CreatePredictor(config, "");
+  auto int8 = CreatePredictor(config, scales_path);
+  std::remove(scales_path.c_str());
+  auto& statis = int8->analysis_argument()
+                     .Get<std::unordered_map<std::string, int>>(
+                         framework::ir::kFuseStatisAttr);
+  ASSERT_TRUE(statis.count("int8_quantize"));
+  EXPECT_GT(statis.at("int8_quantize"), 0);
+
+  int begin = FLAGS_calibration_batches * FLAGS_batch_size;
+  auto tests = Batches(config.model_dir, samples, begin, FLAGS_test_batches);
+  int num = 0;
+  int top1_agree = 0;
+  int fp32_correct = 0;
+  int int8_correct = 0;
+  float max_diff = 0.f;
+  double fp32_ms = 0;
+  double int8_ms = 0;
+  inference::Timer timer;
+  for (auto& batch : tests) {
+    auto inputs = ToPaddleTensors(&batch);
+    std::vector<PaddleTensor> fp32_out, int8_out;
+    timer.tic();
+    ASSERT_TRUE(fp32->Run(inputs, &fp32_out));
+    fp32_ms += timer.toc();
+    timer.tic();
+    ASSERT_TRUE(int8->Run(inputs, &int8_out));
+    int8_ms += timer.toc();
+    ASSERT_EQ(fp32_out.size(), 1UL);
+    ASSERT_EQ(int8_out.size(), 1UL);
+    ASSERT_EQ(fp32_out[0].data.length(), int8_out[0].data.length());
+
+    // The outputs are the probabilities of the classes.
+    const float* expected = static_cast<float*>(fp32_out[0].data.data());
+    const float* actual = static_cast<float*>(int8_out[0].data.data());
+    int classes = fp32_out[0].shape.back();
+    int rows = fp32_out[0].data.length() / sizeof(float) / classes;
+    for (int r = 0; r < rows; ++r) {
+      const float* e = expected + r * classes;
+      const float* a = actual + r * classes;
+      int64_t label = samples.labels[begin + num + r];
+      int64_t e_top1 = std::max_element(e, e + classes) - e;
+      int64_t a_top1 = std::max_element(a, a + classes) - a;
+      top1_agree += e_top1 == a_top1;
+      fp32_correct += e_top1 == label;
+      int8_correct += a_top1 == label;
+      for (int c = 0; c < classes; ++c) {
+        max_diff = std::max(max_diff, std::abs(e[c] - a[c]));
+      }
+    }
+    num += rows;
+  }
+
+  int64_t fp32_bytes = WeightBytes(*fp32);
+  int64_t int8_bytes = WeightBytes(*int8);
+  LOG(INFO) << model << ": " << statis.at("int8_quantize")
+            << " ops quantized, top-1 accuracy " << fp32_correct << " vs "
+            << int8_correct << " of " << num << ", top-1 agreement "
+            << top1_agree << "/" << num << ", max diff of probabilities "
+            << max_diff << ", " << fp32_ms / num << " vs " << int8_ms / num
+            << " ms per sample, weights " << fp32_bytes << " vs "
+            << int8_bytes << " bytes";
+  EXPECT_LT(int8_bytes, fp32_bytes);
+  EXPECT_LT(max_diff, 0.2f);
+  // int8 may lose at most 5% of top-1 accuracy.
+  EXPECT_LE(fp32_correct - int8_correct, num / 20);
+}
+
+TEST(Int8Calibrator, recognize_digits_conv) {
+  CompareInt8WithFloat("recognize_digits_conv.inference.model");
+}
+
+TEST(Int8Calibrator, image_classification_resnet) {
+  CompareInt8WithFloat("image_classification_resnet.inference.model");
+}
+
+}  // namespace paddle
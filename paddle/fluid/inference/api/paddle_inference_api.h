@@ -54,6 +54,8 @@ class PaddleBuf {
   bool empty() const { return length_ == 0; }
   void* data() const { return data_; }
   size_t length() const { return length_; }
+  // Whether the memory is allocated and freed by this buffer.
+  bool memory_owned() const { return memory_owned_; }
 
   ~PaddleBuf() { Free(); }
 
@@ -99,6 +101,13 @@ class PaddlePredictor {
   // `inputs`. `inputs` should be available until Run returns. Caller should be
   // responsible for the output tensor's buffer, either allocated or passed from
   // outside.
+  //
+  // The native predictors avoid copies in both directions:
+  // - an input whose buffer is not owned by PaddleBuf is used in place.
+  // - an output whose buffer is not owned by PaddleBuf and is not empty is
+  //   written into that buffer, which must be large enough.
+  // - with NativeConfig::fetch_as_view, other outputs without LoD are views
+  //   of the predictor's memory, which stay valid until the next Run.
   virtual bool Run(const std::vector<PaddleTensor>& inputs,
                    std::vector<PaddleTensor>* output_data,
                    int batch_size = -1) = 0;
@@ -123,6 +132,8 @@ struct NativeConfig : public PaddlePredictor::Config {
   float fraction_of_gpu_memory{-1.f};  // Negative to notify initialization.
   // Specify the variable's name of each input.
   bool specify_input_name{false};
+  // Return the outputs as views instead of copies, see PaddlePredictor::Run.
+  bool fetch_as_view{false};
 
   std::string prog_file;
   std::string param_file;
@@ -0,0 +1,53 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include "paddle/fluid/inference/api/predictor_pool.h"
+
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+
+PredictorPool::PredictorPool(std::unique_ptr<PaddlePredictor> predictor,
+                             size_t size,
+                             const std::vector<PaddleTensor>& warmup_inputs) {
+  PADDLE_ENFORCE_NOT_NULL(predictor, "the predictor to clone is null");
+  PADDLE_ENFORCE_GT(size, 0UL, "the pool should hold at least one predictor");
+  predictors_.reserve(size);
+  for (size_t i = 1; i < size; ++i) {
+    auto clone = predictor->Clone();
+    PADDLE_ENFORCE_NOT_NULL(clone, "fail to clone the predictor");
+    predictors_.push_back(std::move(clone));
+  }
+  predictors_.push_back(std::move(predictor));
+
+  if (!warmup_inputs.empty()) {
+    VLOG(3) << "warm up " << size << " predictors";
+    for (auto& p : predictors_) {
+      std::vector<PaddleTensor> outputs;
+      PADDLE_ENFORCE(p->Run(warmup_inputs, &outputs),
+                     "fail to run the warm-up inputs");
+    }
+  }
+}
+
+PaddlePredictor* PredictorPool::Retrieve(size_t idx) {
+  PADDLE_ENFORCE_LT(idx, predictors_.size(), "no predictor of worker %d", idx);
+  return predictors_[idx].get();
+}
+
+}  // namespace paddle
@@ -0,0 +1,49 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+
+/*
+ * PredictorPool holds one predictor for each of a fixed number of worker
+ * threads.
+ *
+ * The predictors are clones of the given one, so the model is loaded once
+ * and the parameters are shared. Each predictor keeps its activations in its
+ * own scope between runs. If warm-up inputs are given, every predictor runs
+ * them once when the pool is created, so the activations are allocated and
+ * the kernels are chosen before the first request is served.
+ */
+class PredictorPool {
+ public:
+  PredictorPool(std::unique_ptr<PaddlePredictor> predictor, size_t size,
+                const std::vector<PaddleTensor>& warmup_inputs = {});
+
+  // The predictor of worker `idx`. A predictor must not be run by more than
+  // one thread at the same time.
+  PaddlePredictor* Retrieve(size_t idx);
+
+  size_t Size() const { return predictors_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors_;
+};
+
+}  // namespace paddle
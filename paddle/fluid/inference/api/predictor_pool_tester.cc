@@ -0,0 +1,92 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <thread>  // NOLINT
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/inference/api/predictor_pool.h"
+#include "paddle/fluid/inference/tests/test_helper.h"
+
+DEFINE_string(dirname, "", "Directory of the inference model.");
+
+namespace paddle {
+
+NativeConfig GetConfig() {
+  NativeConfig config;
+  config.model_dir = FLAGS_dirname + "word2vec.inference.model";
+  config.use_gpu = false;
+  return config;
+}
+
+// Four words of one sample for word2vec.
+std::vector<PaddleTensor> Word2VecInputs(std::vector<int64_t>* words) {
+  std::vector<PaddleTensor> inputs;
+  for (auto& word : *words) {
+    PaddleTensor input;
+    input.data.Reset(&word, sizeof(int64_t));
+    input.dtype = PaddleDType::INT64;
+    input.shape = {1, 1};
+    input.lod = {{0, 1}};
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+TEST(PredictorPool, word2vec) {
+  constexpr int num_threads = 4;
+  constexpr int num_samples = 20;
+  std::vector<std::vector<int64_t>> samples(num_samples);
+  std::vector<std::vector<float>> expected(num_samples);
+  auto reference = CreatePaddlePredictor<NativeConfig>(GetConfig());
+  for (int i = 0; i < num_samples; ++i) {
+    samples[i] = {i, i + 1, i + 2, i + 3};
+    std::vector<PaddleTensor> outputs;
+    ASSERT_TRUE(reference->Run(Word2VecInputs(&samples[i]), &outputs));
+    ASSERT_EQ(outputs.size(), 1UL);
+    const float* data = static_cast<const float*>(outputs[0].data.data());
+    expected[i].assign(data, data + outputs[0].data.length() / sizeof(float));
+  }
+
+  std::vector<int64_t> warmup_words = {0, 0, 0, 0};
+  PredictorPool pool(CreatePaddlePredictor<NativeConfig>(GetConfig()),
+                     num_threads, Word2VecInputs(&warmup_words));
+  ASSERT_EQ(pool.Size(), static_cast<size_t>(num_threads));
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      PaddlePredictor* predictor = pool.Retrieve(tid);
+      auto words = samples;
+      std::vector<PaddleTensor> outputs;
+      for (int i = 0; i < num_samples; ++i) {
+        int sample = (i + tid) % num_samples;
+        ASSERT_TRUE(predictor->Run(Word2VecInputs(&words[sample]), &outputs));
+        const float* data = static_cast<const float*>(outputs[0].data.data());
+        ASSERT_EQ(outputs[0].data.length(),
+                  expected[sample].size() * sizeof(float));
+        for (size_t j = 0; j < expected[sample].size(); ++j) {
+          ASSERT_EQ(expected[sample][j], data[j]);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+}  // namespace paddle
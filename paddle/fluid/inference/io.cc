@@ -27,6 +27,10 @@ DEFINE_string(devices, "", "The devices to be used which is joined by comma.");
 DEFINE_bool(init_p2p, false, "Whether to init p2p.");
 DEFINE_int32(math_num_threads, 1,
              "Number of threads used to run math functions.");
+DEFINE_bool(load_params_by_mmap, false,
+            "Whether to map the combined params file into memory and share "
+            "it with the CPU parameters instead of copying them, so that "
+            "the processes loading one model share its parameters.");
 
 namespace paddle {
 namespace inference {
@@ -106,6 +110,7 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
     op->SetType("load_combine");
     op->SetOutput("Out", paramlist);
     op->SetAttr("file_path", {param_filename});
+    op->SetAttr("use_mmap", FLAGS_load_params_by_mmap);
     op->CheckAttrs();
   }
 
@@ -0,0 +1,102 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/inference/api/predictor_pool.h"
+
+DEFINE_string(dirname, "", "Directory of the inference models.");
+DEFINE_int32(num_requests, 500, "Number of requests sent by each thread.");
+
+namespace paddle {
+
+using Clock = std::chrono::steady_clock;
+
+double Ms(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Word2vec requests of one sample from num_threads threads, each running the
+// predictor of its own worker in a PredictorPool.
+void BenchmarkPool(int num_threads, bool warmup) {
+  NativeConfig config;
+  config.model_dir = FLAGS_dirname + "word2vec.inference.model";
+  config.use_gpu = false;
+
+  std::vector<int64_t> words = {1, 2, 3, 4};
+  std::vector<PaddleTensor> inputs;
+  for (auto& word : words) {
+    PaddleTensor input;
+    input.data.Reset(&word, sizeof(int64_t));
+    input.dtype = PaddleDType::INT64;
+    input.shape = {1, 1};
+    input.lod = {{0, 1}};
+    inputs.push_back(input);
+  }
+
+  auto create_begin = Clock::now();
+  PredictorPool pool(CreatePaddlePredictor<NativeConfig>(config), num_threads,
+                     warmup ? inputs : std::vector<PaddleTensor>());
+  double create_ms = Ms(create_begin, Clock::now());
+
+  std::vector<std::vector<double>> latency(num_threads);
+  std::vector<std::thread> threads;
+  auto start = Clock::now();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      PaddlePredictor* predictor = pool.Retrieve(tid);
+      std::vector<PaddleTensor> outputs;
+      for (int i = 0; i < FLAGS_num_requests; ++i) {
+        auto begin = Clock::now();
+        ASSERT_TRUE(predictor->Run(inputs, &outputs));
+        latency[tid].push_back(Ms(begin, Clock::now()));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  double seconds = Ms(start, Clock::now()) / 1000;
+
+  double first = 0;
+  std::vector<double> all;
+  for (auto& l : latency) {
+    first = std::max(first, l.front());
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+  LOG(INFO) << num_threads << " threads, " << (warmup ? "warm" : "cold")
+            << " pool created in " << create_ms << "ms: first request "
+            << first << "ms, " << all.size() / seconds << " QPS, p50 "
+            << all[all.size() / 2] << "ms, p99 " << all[all.size() * 99 / 100]
+            << "ms";
+}
+
+TEST(PredictorPool, word2vec_benchmark) {
+  for (int num_threads : {1, 2, 4, 8}) {
+    for (bool warmup : {false, true}) {
+      BenchmarkPool(num_threads, warmup);
+    }
+  }
+}
+
+}  // namespace paddle
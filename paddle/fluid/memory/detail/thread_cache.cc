@@ -0,0 +1,196 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/thread_cache.h"
+
+#include <mutex>  // NOLINT
+#include <unordered_set>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+constexpr size_t ThreadCache::kMaxCachedPages;
+constexpr size_t ThreadCache::kHeaderSize;
+
+namespace {
+
+// All alive thread caches and the statistics of the destroyed ones.
+struct ThreadCacheRegistry {
+  std::mutex mutex;
+  std::unordered_set<const ThreadCache*> caches;
+  ThreadCacheStats retired;
+};
+
+ThreadCacheRegistry& Registry() {
+  // Never destroyed, since thread caches may be destroyed at exit.
+  static ThreadCacheRegistry* registry = new ThreadCacheRegistry;
+  return *registry;
+}
+
+}  // namespace
+
+ThreadCache::ThreadCache(BuddyAllocator* buddy_allocator,
+                         size_t min_chunk_size, size_t budget)
+    : buddy_allocator_(buddy_allocator),
+      min_chunk_size_(min_chunk_size),
+      budget_(budget) {
+  PADDLE_ENFORCE_GT(min_chunk_size_,
+                    kHeaderSize + sizeof(MemoryBlock::Desc),
+                    "the minimum chunk size is too small to be cached");
+  // 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, ... pages
+  for (size_t pages = 1; pages <= 4; ++pages) {
+    class_pages_.push_back(pages);
+  }
+  for (size_t base = 4; base < kMaxCachedPages; base *= 2) {
+    for (size_t step = 1; step <= 4; ++step) {
+      class_pages_.push_back(base + base * step / 4);
+    }
+  }
+  page_to_class_.resize(kMaxCachedPages + 1);
+  int size_class = 0;
+  for (size_t pages = 1; pages <= kMaxCachedPages; ++pages) {
+    if (class_pages_[size_class] < pages) ++size_class;
+    page_to_class_[pages] = size_class;
+  }
+  page_to_class_[0] = 0;
+  free_lists_.resize(class_pages_.size());
+
+  std::lock_guard<std::mutex> lock(Registry().mutex);
+  Registry().caches.insert(this);
+}
+
+ThreadCache::~ThreadCache() {
+  Release(0);
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.caches.erase(this);
+  registry.retired.hit += counters_.hit;
+  registry.retired.miss += counters_.miss;
+  registry.retired.released_bytes += counters_.released_bytes;
+}
+
+int ThreadCache::SizeClass(size_t size) const {
+  size_t total = size + kHeaderSize + sizeof(MemoryBlock::Desc);
+  size_t pages = (total + min_chunk_size_ - 1) / min_chunk_size_;
+  if (pages > kMaxCachedPages) {
+    return -1;
+  }
+  return page_to_class_[pages];
+}
+
+size_t ThreadCache::ClassBytes(int size_class) const {
+  // The buddy allocator rounds a block with its MemoryBlock::Desc up to the
+  // minimum chunk size, so a size class fills its chunks exactly.
+  return class_pages_[size_class] * min_chunk_size_ - sizeof(MemoryBlock::Desc);
+}
+
+void* ThreadCache::Alloc(size_t size) {
+  int size_class = SizeClass(size);
+  void* block = nullptr;
+  if (size_class >= 0 && !free_lists_[size_class].empty()) {
+    block = free_lists_[size_class].back();
+    free_lists_[size_class].pop_back();
+    cached_bytes_ -= ClassBytes(size_class);
+    counters_.cached_bytes.store(cached_bytes_, std::memory_order_relaxed);
+    counters_.hit.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    size_t bytes =
+        size_class >= 0 ? ClassBytes(size_class) : size + kHeaderSize;
+    block = buddy_allocator_->Alloc(bytes);
+    if (block == nullptr && cached_bytes_ > 0) {
+      VLOG(10) << "Return all cached blocks and try allocating again";
+      Release(0);
+      block = buddy_allocator_->Alloc(bytes);
+    }
+    if (block == nullptr) {
+      return nullptr;
+    }
+    if (size_class >= 0) {
+      counters_.miss.fetch_add(1, std::memory_order_relaxed);
+    }
+    *static_cast<int*>(block) = size_class;
+  }
+  return static_cast<char*>(block) + kHeaderSize;
+}
+
+void ThreadCache::Free(void* ptr) {
+  void* block = static_cast<char*>(ptr) - kHeaderSize;
+  int size_class = *static_cast<int*>(block);
+  if (size_class < 0) {
+    buddy_allocator_->Free(block);
+    return;
+  }
+  free_lists_[size_class].push_back(block);
+  cached_bytes_ += ClassBytes(size_class);
+  if (cached_bytes_ > budget_) {
+    Release(budget_ / 2);
+  }
+  counters_.cached_bytes.store(cached_bytes_, std::memory_order_relaxed);
+}
+
+void* ThreadCache::AllocUncached(BuddyAllocator* buddy_allocator,
+                                 size_t size) {
+  void* block = buddy_allocator->Alloc(size + kHeaderSize);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *static_cast<int*>(block) = -1;
+  return static_cast<char*>(block) + kHeaderSize;
+}
+
+void ThreadCache::FreeUncached(BuddyAllocator* buddy_allocator, void* ptr) {
+  // The buddy allocator finds the size of a block of any size class.
+  buddy_allocator->Free(static_cast<char*>(ptr) - kHeaderSize);
+}
+
+void ThreadCache::Release(size_t target_bytes) {
+  size_t released = 0;
+  for (int size_class = static_cast<int>(free_lists_.size()) - 1;
+       size_class >= 0 && cached_bytes_ > target_bytes; --size_class) {
+    auto& free_list = free_lists_[size_class];
+    size_t bytes = ClassBytes(size_class);
+    while (!free_list.empty() && cached_bytes_ > target_bytes) {
+      buddy_allocator_->Free(free_list.back());
+      free_list.pop_back();
+      cached_bytes_ -= bytes;
+      released += bytes;
+    }
+  }
+  VLOG(10) << "Return " << released << " bytes to the buddy allocator";
+  counters_.released_bytes.fetch_add(released, std::memory_order_relaxed);
+  counters_.cached_bytes.store(cached_bytes_, std::memory_order_relaxed);
+}
+
+ThreadCacheStats ThreadCache::GlobalStats() {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ThreadCacheStats stats = registry.retired;
+  for (auto* cache : registry.caches) {
+    auto& counters = cache->counters_;
+    stats.hit += counters.hit.load(std::memory_order_relaxed);
+    stats.miss += counters.miss.load(std::memory_order_relaxed);
+    stats.cached_bytes += counters.cached_bytes.load(std::memory_order_relaxed);
+    stats.released_bytes +=
+        counters.released_bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
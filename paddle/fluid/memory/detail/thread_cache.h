@@ -0,0 +1,107 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "paddle/fluid/memory/detail/buddy_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+struct ThreadCacheStats {
+  size_t hit = 0;           // allocations served from a thread cache
+  size_t miss = 0;          // allocations which went to the buddy allocator
+  size_t cached_bytes = 0;  // bytes kept in thread caches now
+  size_t released_bytes = 0;  // bytes returned to the buddy allocator
+};
+
+/**
+ * \brief ThreadCache keeps the freed blocks of one thread in size classes,
+ *        so that most allocations of small and medium tensors are served
+ *        without taking the lock of the shared BuddyAllocator.
+ *
+ * \note  Size classes are multiples of the buddy allocator's minimum chunk
+ *        size, four of them per power of two, so that a cached block wastes
+ *        at most a quarter of its size. Each block starts with a header
+ *        recording its size class, which lets Free() put a block allocated by
+ *        any thread into the cache of the freeing thread. Once the cached
+ *        bytes exceed the budget, the largest blocks are returned to the
+ *        buddy allocator until half of the budget is left.
+ */
+class ThreadCache {
+ public:
+  ThreadCache(BuddyAllocator* buddy_allocator, size_t min_chunk_size,
+              size_t budget);
+
+  // Returns all cached blocks to the buddy allocator.
+  ~ThreadCache();
+
+  void* Alloc(size_t size);
+  void Free(void* ptr);
+
+  // Allocate and free a block with the header of a thread cache straight
+  // from the buddy allocator, for a thread whose cache is destroyed. The
+  // blocks are compatible with the ones of the caches.
+  static void* AllocUncached(BuddyAllocator* buddy_allocator, size_t size);
+  static void FreeUncached(BuddyAllocator* buddy_allocator, void* ptr);
+
+  // Sum of the statistics of all thread caches, alive or destroyed.
+  static ThreadCacheStats GlobalStats();
+
+  // The largest allocation served by size classes.
+  static constexpr size_t kMaxCachedPages = 256;
+
+  // Keeps the payload aligned as the buddy allocator does.
+  static constexpr size_t kHeaderSize = 64;
+
+  // Disable copy and assignment
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache& operator=(const ThreadCache&) = delete;
+
+ private:
+  struct Counters {
+    std::atomic<size_t> hit{0};
+    std::atomic<size_t> miss{0};
+    std::atomic<size_t> cached_bytes{0};
+    std::atomic<size_t> released_bytes{0};
+  };
+
+  // Returns -1 if the size is too large to be cached.
+  int SizeClass(size_t size) const;
+
+  // The size asked from the buddy allocator for a block of the size class.
+  size_t ClassBytes(int size_class) const;
+
+  void Release(size_t target_bytes);
+
+  BuddyAllocator* buddy_allocator_;
+  size_t min_chunk_size_;
+  size_t budget_;
+  size_t cached_bytes_{0};
+
+  std::vector<size_t> class_pages_;
+  // page count -> the smallest size class holding it
+  std::vector<int> page_to_class_;
+  std::vector<std::vector<void*>> free_lists_;
+
+  Counters counters_;
+};
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
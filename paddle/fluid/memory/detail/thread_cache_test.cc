@@ -0,0 +1,172 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/thread_cache.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+static constexpr size_t kMinChunkSize = 1 << 12;
+static constexpr size_t kMaxChunkSize = 1 << 26;
+
+std::unique_ptr<BuddyAllocator> NewBuddyAllocator() {
+  return std::unique_ptr<BuddyAllocator>(
+      new BuddyAllocator(std::unique_ptr<SystemAllocator>(new CPUAllocator),
+                         kMinChunkSize, kMaxChunkSize));
+}
+
+TEST(ThreadCache, ReuseFreedBlocks) {
+  auto buddy = NewBuddyAllocator();
+  auto before = ThreadCache::GlobalStats();
+  {
+    ThreadCache cache(buddy.get(), kMinChunkSize, 1 << 20);
+    void* p = cache.Alloc(1000);
+    ASSERT_NE(p, nullptr);
+    memset(p, 1, 1000);
+    size_t used = buddy->Used();
+    cache.Free(p);
+    // The block stays in the cache.
+    EXPECT_EQ(used, buddy->Used());
+
+    // A size in the same class gets the same block back.
+    void* q = cache.Alloc(2000);
+    EXPECT_EQ(p, q);
+    cache.Free(q);
+
+    auto stats = ThreadCache::GlobalStats();
+    EXPECT_EQ(before.hit + 1, stats.hit);
+    EXPECT_EQ(before.miss + 1, stats.miss);
+  }
+  // All blocks are returned when the cache is destroyed.
+  EXPECT_EQ(0UL, buddy->Used());
+}
+
+TEST(ThreadCache, LargeBlocksBypassCache) {
+  auto buddy = NewBuddyAllocator();
+  ThreadCache cache(buddy.get(), kMinChunkSize, 1 << 20);
+  size_t size = (ThreadCache::kMaxCachedPages + 1) * kMinChunkSize;
+  void* p = cache.Alloc(size);
+  ASSERT_NE(p, nullptr);
+  memset(p, 1, size);
+  cache.Free(p);
+  EXPECT_EQ(0UL, buddy->Used());
+}
+
+TEST(ThreadCache, ReleaseOverBudget) {
+  auto buddy = NewBuddyAllocator();
+  size_t budget = 64 * kMinChunkSize;
+  ThreadCache cache(buddy.get(), kMinChunkSize, budget);
+  std::vector<void*> ptrs;
+  for (size_t i = 1; i <= 32; ++i) {
+    ptrs.push_back(cache.Alloc(i * 100));
+    ptrs.push_back(cache.Alloc(i * kMinChunkSize));
+  }
+  auto before = ThreadCache::GlobalStats();
+  for (auto* p : ptrs) {
+    cache.Free(p);
+  }
+  auto stats = ThreadCache::GlobalStats();
+  EXPECT_GT(stats.released_bytes, before.released_bytes);
+  EXPECT_LE(buddy->Used(), budget);
+}
+
+TEST(ThreadCache, FreeOnAnotherThread) {
+  auto buddy = NewBuddyAllocator();
+  std::vector<void*> ptrs;
+  {
+    ThreadCache cache(buddy.get(), kMinChunkSize, 1 << 20);
+    for (size_t i = 1; i <= 16; ++i) {
+      ptrs.push_back(cache.Alloc(i * 1000));
+    }
+  }
+  std::thread t([&] {
+    ThreadCache cache(buddy.get(), kMinChunkSize, 1 << 20);
+    for (auto* p : ptrs) {
+      cache.Free(p);
+    }
+  });
+  t.join();
+  EXPECT_EQ(0UL, buddy->Used());
+}
+
+// Once the thread cache of a thread is destroyed, its blocks are freed to and
+// allocated from the buddy allocator directly.
+TEST(ThreadCache, FreeAfterCacheDestroyed) {
+  auto buddy = NewBuddyAllocator();
+  void* p = nullptr;
+  void* q = ThreadCache::AllocUncached(buddy.get(), 1000);
+  ASSERT_NE(q, nullptr);
+  {
+    ThreadCache cache(buddy.get(), kMinChunkSize, 1 << 20);
+    p = cache.Alloc(1000);
+    ASSERT_NE(p, nullptr);
+    // A block allocated without a cache can be freed by a cache.
+    cache.Free(q);
+  }
+  ThreadCache::FreeUncached(buddy.get(), p);
+  EXPECT_EQ(0UL, buddy->Used());
+}
+
+// Compare the shared buddy allocator with thread caches in front of it.
+TEST(ThreadCache, DISABLED_Benchmark) {
+  const int kThreads = 4;
+  const int kRounds = 2000;
+  const size_t kSizes[] = {64, 1000, 5000, 20000, 100000};
+
+  auto run = [&](bool use_cache) {
+    auto buddy = NewBuddyAllocator();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&] {
+        ThreadCache cache(buddy.get(), kMinChunkSize, 8 << 20);
+        void* ptrs[sizeof(kSizes) / sizeof(kSizes[0])];
+        for (int r = 0; r < kRounds; ++r) {
+          for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+            ptrs[i] = use_cache ? cache.Alloc(kSizes[i])
+                                : buddy->Alloc(kSizes[i]);
+          }
+          for (auto* p : ptrs) {
+            use_cache ? cache.Free(p) : buddy->Free(p);
+          }
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+        .count();
+  };
+
+  auto buddy_time = run(false);
+  auto cache_time = run(true);
+  auto stats = ThreadCache::GlobalStats();
+  std::cout << "buddy allocator: " << buddy_time
+            << " us, thread cache: " << cache_time << " us, hit " << stats.hit
+            << ", miss " << stats.miss << std::endl;
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -20,6 +20,7 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/detail/buddy_allocator.h"
 #include "paddle/fluid/memory/detail/system_allocator.h"
+#include "paddle/fluid/memory/detail/thread_cache.h"
 #include "paddle/fluid/platform/gpu_info.h"
 
 DEFINE_bool(init_allocated_mem, false,
@@ -28,6 +29,13 @@ DEFINE_bool(init_allocated_mem, false,
             "To find this error in time, we use init_allocated_mem to indicate "
             "that initializing the allocated memory with a small value "
             "during unit testing.");
+DEFINE_bool(use_cpu_thread_cache, false,
+            "Whether to keep freed CPU memory blocks in a cache of each thread "
+            "and serve small allocations from it without locking the "
+            "BuddyAllocator. It is read at the first CPU allocation.");
+DEFINE_int32(cpu_thread_cache_budget_mb, 8,
+             "The maximum size in MB of the freed CPU memory kept by the "
+             "cache of one thread, when use_cpu_thread_cache is set.");
 DECLARE_double(fraction_of_gpu_memory_to_use);
 
 namespace paddle {
@@ -48,10 +56,49 @@ BuddyAllocator* GetCPUBuddyAllocator() {
   return a;
 }
 
+bool UseCPUThreadCache() {
+  // Blocks allocated through the thread cache carry a header, so the flag
+  // must not change once memory has been allocated.
+  static bool use_thread_cache = FLAGS_use_cpu_thread_cache;
+  return use_thread_cache;
+}
+
+namespace {
+
+// Set once the cache of the thread is destroyed at its exit. The destructors
+// of other thread locals and statics may still allocate and free after it.
+thread_local bool cpu_thread_cache_destroyed = false;
+
+struct CPUThreadCacheHolder {
+  ~CPUThreadCacheHolder() { cpu_thread_cache_destroyed = true; }
+  std::unique_ptr<detail::ThreadCache> cache;
+};
+
+}  // namespace
+
+// Returns nullptr once the cache of the thread is destroyed.
+detail::ThreadCache* GetCPUThreadCache() {
+  if (cpu_thread_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local CPUThreadCacheHolder holder{
+      std::unique_ptr<detail::ThreadCache>(new detail::ThreadCache(
+          GetCPUBuddyAllocator(), platform::CpuMinChunkSize(),
+          static_cast<size_t>(FLAGS_cpu_thread_cache_budget_mb) << 20))};
+  return holder.cache.get();
+}
+
 template <>
 void* Alloc<platform::CPUPlace>(platform::CPUPlace place, size_t size) {
   VLOG(10) << "Allocate " << size << " bytes on " << platform::Place(place);
-  void* p = GetCPUBuddyAllocator()->Alloc(size);
+  void* p = nullptr;
+  if (!UseCPUThreadCache()) {
+    p = GetCPUBuddyAllocator()->Alloc(size);
+  } else if (auto* cache = GetCPUThreadCache()) {
+    p = cache->Alloc(size);
+  } else {
+    p = detail::ThreadCache::AllocUncached(GetCPUBuddyAllocator(), size);
+  }
   if (FLAGS_init_allocated_mem) {
     memset(p, 0xEF, size);
   }
@@ -62,7 +109,13 @@ void* Alloc<platform::CPUPlace>(platform::CPUPlace place, size_t size) {
 template <>
 void Free<platform::CPUPlace>(platform::CPUPlace place, void* p) {
   VLOG(10) << "Free pointer=" << p << " on " << platform::Place(place);
-  GetCPUBuddyAllocator()->Free(p);
+  if (!UseCPUThreadCache()) {
+    GetCPUBuddyAllocator()->Free(p);
+  } else if (auto* cache = GetCPUThreadCache()) {
+    cache->Free(p);
+  } else {
+    detail::ThreadCache::FreeUncached(GetCPUBuddyAllocator(), p);
+  }
 }
 
 template <>
@@ -47,9 +47,14 @@ class AdagradOp : public framework::OperatorWithKernel {
     PADDLE_ENFORCE_EQ(framework::product(lr_dims), 1,
                       "LearningRate should have one element");
     auto param_dims = ctx->GetInputDim("Param");
-    PADDLE_ENFORCE_EQ(
-        param_dims, ctx->GetInputDim("Grad"),
-        "Param and Grad input of AdagradOp should have the same dimension.");
+    // The rows of a sparse table are not the rows of its gradient, so only
+    // the shape of the moment is checked.
+    if (ctx->GetInputsVarType("Param")[0] !=
+        framework::proto::VarType::SELECTED_ROWS) {
+      PADDLE_ENFORCE_EQ(
+          param_dims, ctx->GetInputDim("Grad"),
+          "Param and Grad input of AdagradOp should have the same dimension.");
+    }
     PADDLE_ENFORCE_EQ(
         param_dims, ctx->GetInputDim("Moment"),
         "Param and Moment input of AdagradOp should have the same dimension.");
@@ -59,21 +64,38 @@ class AdagradOp : public framework::OperatorWithKernel {
   }
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    auto input_data_type =
-        framework::ToDataType(ctx.Input<Tensor>("Param")->type());
+    auto input_data_type = framework::GetDataTypeOfVar(ctx.InputVar("Param"));
     return framework::OpKernelType(input_data_type, ctx.GetPlace());
   }
 };
 
+class AdagradOpInferVarType : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto input_var = op_desc.Input("Param")[0];
+    for (auto& out_var : op_desc.Output("ParamOut")) {
+      if (block->FindRecursiveOrCreateVar(input_var).GetType() ==
+          framework::proto::VarType::SELECTED_ROWS) {
+        block->FindRecursiveOrCreateVar(out_var).SetType(
+            framework::proto::VarType::SELECTED_ROWS);
+      } else {
+        block->FindRecursiveOrCreateVar(out_var).SetType(
+            framework::proto::VarType::LOD_TENSOR);
+      }
+    }
+  }
+};
+
 class AdagradOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() override {
-    AddInput("Param", "(Tensor) Input parameter");
-    AddInput("Grad", "(Tensor) Input gradient");
+    AddInput("Param", "(Tensor or SelectedRows) Input parameter");
+    AddInput("Grad", "(Tensor or SelectedRows) Input gradient");
     AddInput("Moment", "(Tensor) Second moment");
     AddInput("LearningRate", "(Tensor) Learning rate");
 
-    AddOutput("ParamOut", "(Tensor) Output parameter");
+    AddOutput("ParamOut", "(Tensor or SelectedRows) Output parameter");
     AddOutput("MomentOut", "(Tensor) Output second moment");
 
     AddAttr<float>("epsilon",
@@ -99,54 +121,89 @@ for numerical stability to avoid the division by zero error.
   }
 };
 
-namespace {
-size_t FindPos(const std::vector<int64_t>& rows, int64_t value) {
-  return std::find(rows.begin(), rows.end(), value) - rows.begin();
-}
-}  // namespace
-
 template <typename T>
 struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::SelectedRows& grad,
                   const framework::Tensor& learning_rate, T epsilon,
                   framework::Tensor* moment, framework::Tensor* param) {
-    // 1. g_m.rows = set(g.rows)
+    PADDLE_ENFORCE_EQ(grad.height(), moment->dims()[0]);
     auto grad_width = grad.value().dims()[1];
-    math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
-    auto grad_merge = merge_func(context, grad);
-    auto& merge_rows = grad_merge.rows();
-    auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
-
-    // 2. m += g_m * g_m
-    math::scatter::Mul<platform::CPUDeviceContext, T> sqare_func;
-    auto grad_square = sqare_func(context, grad_merge, grad_merge);
-
-    math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
     auto* lr = learning_rate.data<T>();
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
 
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
-      }
-    }
+    // g_m = merged g, m += g_m * g_m, and the update of the parameter, done
+    // row by row without building the merged gradient.
+    math::scatter::ForEachMergedRow<T>(
+        grad, [&](int64_t row, const T* grad_merge_data) {
+          T* m = moment_data + row * grad_width;
+          T* p = param_data + row * grad_width;
+          for (int64_t j = 0; j < grad_width; j++) {
+            m[j] += grad_merge_data[j] * grad_merge_data[j];
+            p[j] -= lr[0] * grad_merge_data[j] / (std::sqrt(m[j]) + epsilon);
+          }
+        });
   }
 };
 
 template struct SparseAdagradFunctor<platform::CPUDeviceContext, float>;
 template struct SparseAdagradFunctor<platform::CPUDeviceContext, double>;
+
+template <typename T>
+void SparseTableAdagrad(const platform::CPUDeviceContext& context,
+                        const framework::SelectedRows& grad,
+                        const framework::Tensor& learning_rate, T epsilon,
+                        framework::Tensor* moment,
+                        framework::SelectedRows* param) {
+  // for distributed training, a sparse var may be empty,
+  // just skip updating.
+  if (grad.rows().size() == 0) {
+    return;
+  }
+  auto grad_width = grad.value().dims()[1];
+  PADDLE_ENFORCE_EQ(param->value().dims()[1], grad_width,
+                    "param_row should have the same size with grad_row");
+  PADDLE_ENFORCE_EQ(moment->dims(), param->value().dims(),
+                    "Moment should have the same shape with the value of the "
+                    "sparse table");
+
+  math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
+  auto grad_merge = merge_func(context, grad);
+  auto& merge_rows = grad_merge.rows();
+  const auto* grad_data = grad_merge.value().template data<T>();
+  const auto* lr = learning_rate.data<T>();
+  auto* param_data = param->mutable_value()->data<T>();
+  auto* moment_data = moment->data<T>();
+  // The moment is indexed by the rows of the table, so both are updated with
+  // the lock of the shard of the key held.
+  param->UpdateRows(
+      merge_rows.data(), merge_rows.size(), [&](int64_t i, int64_t index) {
+        for (int64_t j = 0; j < grad_width; j++) {
+          T g = grad_data[i * grad_width + j];
+          T& m = moment_data[index * grad_width + j];
+          m += g * g;
+          param_data[index * grad_width + j] -=
+              lr[0] * g / (std::sqrt(m) + epsilon);
+        }
+      });
+}
+
+template void SparseTableAdagrad<float>(
+    const platform::CPUDeviceContext& context,
+    const framework::SelectedRows& grad, const framework::Tensor& learning_rate,
+    float epsilon, framework::Tensor* moment, framework::SelectedRows* param);
+template void SparseTableAdagrad<double>(
+    const platform::CPUDeviceContext& context,
+    const framework::SelectedRows& grad, const framework::Tensor& learning_rate,
+    double epsilon, framework::Tensor* moment, framework::SelectedRows* param);
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
-REGISTER_OP_WITHOUT_GRADIENT(adagrad, ops::AdagradOp, ops::AdagradOpMaker);
+REGISTER_OPERATOR(adagrad, ops::AdagradOp, ops::AdagradOpMaker,
+                  paddle::framework::EmptyGradOpMaker,
+                  ops::AdagradOpInferVarType);
 REGISTER_OP_CPU_KERNEL(
     adagrad, ops::AdagradOpKernel<paddle::platform::CPUDeviceContext, float>,
     ops::AdagradOpKernel<paddle::platform::CPUDeviceContext, double>);
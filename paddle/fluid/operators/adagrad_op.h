@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
 
 namespace paddle {
 namespace operators {
@@ -27,19 +28,49 @@ struct SparseAdagradFunctor {
                   framework::Tensor* moment, framework::Tensor* param);
 };
 
+// Updates the rows of a sparse table on the pserver, with the moment indexed
+// by the rows of the table.
+template <typename T>
+void SparseTableAdagrad(const platform::CPUDeviceContext& context,
+                        const framework::SelectedRows& grad,
+                        const framework::Tensor& learning_rate, T epsilon,
+                        framework::Tensor* moment,
+                        framework::SelectedRows* param);
+
 template <typename DeviceContext, typename T>
 class AdagradOpKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+
+    auto* param_var = ctx.InputVar("Param");
+    auto* grad_var = ctx.InputVar("Grad");
+    if (param_var->IsType<framework::SelectedRows>()) {
+      PADDLE_ENFORCE(grad_var->IsType<framework::SelectedRows>(),
+                     "when param "
+                     "is SelectedRows, gradient should also be SelectedRows");
+      PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                     "The sparse table only supports CPUPlace.");
+      auto* param_out = ctx.Output<framework::SelectedRows>("ParamOut");
+      PADDLE_ENFORCE_EQ(&param_var->Get<framework::SelectedRows>(), param_out);
+      auto* moment_out_tensor = ctx.Output<framework::Tensor>("MomentOut");
+      PADDLE_ENFORCE_EQ(ctx.Input<framework::Tensor>("Moment"),
+                        moment_out_tensor);
+
+      SparseTableAdagrad<T>(
+          ctx.template device_context<platform::CPUDeviceContext>(),
+          grad_var->Get<framework::SelectedRows>(),
+          *ctx.Input<framework::Tensor>("LearningRate"), epsilon,
+          moment_out_tensor, param_out);
+      return;
+    }
+
     auto* param_out_tensor = ctx.Output<framework::Tensor>("ParamOut");
     auto* moment_out_tensor = ctx.Output<framework::Tensor>("MomentOut");
 
     param_out_tensor->mutable_data<T>(ctx.GetPlace());
     moment_out_tensor->mutable_data<T>(ctx.GetPlace());
 
-    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
-
-    auto* grad_var = ctx.InputVar("Grad");
     if (grad_var->IsType<framework::LoDTensor>()) {
       auto param = framework::EigenVector<T>::Flatten(
           *ctx.Input<framework::Tensor>("Param"));
@@ -286,6 +286,30 @@ class AdamOpKernel : public framework::OpKernel<T> {
         VLOG(3) << "grad row size is 0!!";
         return;
       }
+      if (platform::is_cpu_place(ctx.GetPlace())) {
+        // Update the parameter row by row as the duplicated rows are merged,
+        // without building the merged gradient.
+        int64_t row_numel = grad.value().numel() / grad.rows().size();
+        const T* beta1_pow_data = beta1_pow.template data<T>();
+        const T* beta2_pow_data = beta2_pow.template data<T>();
+        const T* mom1_data = mom1.template data<T>();
+        T* mom1_out_data = mom1_out.template mutable_data<T>(ctx.GetPlace());
+        const T* mom2_data = mom2.template data<T>();
+        T* mom2_out_data = mom2_out.template mutable_data<T>(ctx.GetPlace());
+        const T* lr_data = lr.template data<T>();
+        const T* param_data = param.template data<T>();
+        T* param_out_data = param_out.template mutable_data<T>(ctx.GetPlace());
+        scatter::ForEachMergedRow<T>(
+            grad, [&](int64_t row, const T* grad_merge_data) {
+              SparseAdamFunctor<T> functor(
+                  beta1, beta2, epsilon, beta1_pow_data, beta2_pow_data,
+                  mom1_data, mom1_out_data, mom2_data, mom2_out_data, lr_data,
+                  grad_merge_data, param_data, param_out_data, &row,
+                  row_numel);
+              functor(0);
+            });
+        return;
+      }
       // merge duplicated rows if any.
       scatter::MergeAdd<DeviceContext, T> merge_func;
       auto grad_merge =
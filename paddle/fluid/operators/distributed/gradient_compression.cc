@@ -0,0 +1,235 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+namespace {
+
+struct CompressState {
+  std::mutex mutex;
+  std::unordered_map<std::string, CompressConfig> configs;
+  // The references to the elements of an unordered_map stay valid when it
+  // grows, so a residual is updated without holding the mutex. A variable
+  // is not sent by two threads at the same time.
+  std::unordered_map<std::string, std::vector<float>> residuals;
+};
+
+CompressState& State() {
+  static CompressState state;
+  return state;
+}
+
+// Returns the residual of varname, which is reset if numel changes.
+std::vector<float>* Residual(const std::string& varname, int64_t numel) {
+  auto& state = State();
+  std::vector<float>* residual;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    residual = &state.residuals[varname];
+  }
+  if (residual->size() != static_cast<size_t>(numel)) {
+    residual->assign(numel, 0.0f);
+  }
+  return residual;
+}
+
+int64_t TopKNumel(float ratio, int64_t numel) {
+  int64_t k = static_cast<int64_t>(std::ceil(ratio * numel));
+  return std::min(std::max<int64_t>(k, 1), numel);
+}
+
+}  // namespace
+
+CompressType ParseCompressType(const std::string& name) {
+  if (name.empty() || name == "none") {
+    return sendrecv::VariableMessage::NONE;
+  } else if (name == "topk") {
+    return sendrecv::VariableMessage::TOP_K;
+  } else if (name == "fp16") {
+    return sendrecv::VariableMessage::FP16_QUANT;
+  } else if (name == "int8") {
+    return sendrecv::VariableMessage::INT8_QUANT;
+  }
+  PADDLE_THROW("Unknown gradient compression %s", name);
+}
+
+const char* CompressTypeName(CompressType type) {
+  switch (type) {
+    case sendrecv::VariableMessage::NONE:
+      return "none";
+    case sendrecv::VariableMessage::TOP_K:
+      return "topk";
+    case sendrecv::VariableMessage::FP16_QUANT:
+      return "fp16";
+    case sendrecv::VariableMessage::INT8_QUANT:
+      return "int8";
+    default:
+      PADDLE_THROW("Unknown gradient compression %d", type);
+  }
+}
+
+void SetVarCompression(const std::string& varname,
+                       const CompressConfig& config) {
+  PADDLE_ENFORCE(config.ratio > 0 && config.ratio <= 1,
+                 "The top-k ratio of %s should be in (0, 1]", varname);
+  auto& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (config.type == sendrecv::VariableMessage::NONE) {
+    state.configs.erase(varname);
+  } else {
+    state.configs[varname] = config;
+  }
+}
+
+CompressConfig GetVarCompression(const std::string& varname) {
+  auto& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = state.configs.find(varname);
+  return it == state.configs.end() ? CompressConfig() : it->second;
+}
+
+void ResetVarCompression() {
+  auto& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.configs.clear();
+  state.residuals.clear();
+}
+
+size_t CompressedSize(const CompressConfig& config, int64_t numel) {
+  switch (config.type) {
+    case sendrecv::VariableMessage::TOP_K:
+      return TopKNumel(config.ratio, numel) *
+             (sizeof(uint32_t) + sizeof(float));
+    case sendrecv::VariableMessage::FP16_QUANT:
+      return numel * sizeof(platform::float16);
+    case sendrecv::VariableMessage::INT8_QUANT:
+      return numel * sizeof(int8_t);
+    default:
+      return numel * sizeof(float);
+  }
+}
+
+void CompressGradient(const std::string& varname, const CompressConfig& config,
+                      const float* grad, int64_t numel, char* out,
+                      float* scale) {
+  PADDLE_ENFORCE_LE(numel, static_cast<int64_t>(UINT32_MAX));
+  // The residual becomes the gradient to send, and then what is left.
+  std::vector<float>& acc = *Residual(varname, numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    acc[i] += grad[i];
+  }
+  *scale = 1.0f;
+
+  switch (config.type) {
+    case sendrecv::VariableMessage::TOP_K: {
+      int64_t k = TopKNumel(config.ratio, numel);
+      std::vector<uint32_t> index(numel);
+      std::iota(index.begin(), index.end(), 0);
+      std::nth_element(index.begin(), index.begin() + (k - 1), index.end(),
+                       [&acc](uint32_t a, uint32_t b) {
+                         return std::fabs(acc[a]) > std::fabs(acc[b]);
+                       });
+      // Sorted to write the gradient in order when decompressing.
+      std::sort(index.begin(), index.begin() + k);
+      auto* out_index = reinterpret_cast<uint32_t*>(out);
+      auto* out_value = reinterpret_cast<float*>(out_index + k);
+      for (int64_t i = 0; i < k; ++i) {
+        out_index[i] = index[i];
+        out_value[i] = acc[index[i]];
+        acc[index[i]] = 0.0f;
+      }
+      break;
+    }
+    case sendrecv::VariableMessage::FP16_QUANT: {
+      auto* out_value = reinterpret_cast<platform::float16*>(out);
+      for (int64_t i = 0; i < numel; ++i) {
+        out_value[i] = static_cast<platform::float16>(acc[i]);
+        acc[i] -= static_cast<float>(out_value[i]);
+      }
+      break;
+    }
+    case sendrecv::VariableMessage::INT8_QUANT: {
+      float max = 0.0f;
+      for (int64_t i = 0; i < numel; ++i) {
+        max = std::max(max, std::fabs(acc[i]));
+      }
+      *scale = max / 127.0f;
+      auto* out_value = reinterpret_cast<int8_t*>(out);
+      for (int64_t i = 0; i < numel; ++i) {
+        float q = max > 0.0f ? std::round(acc[i] / *scale) : 0.0f;
+        q = std::min(std::max(q, -127.0f), 127.0f);
+        out_value[i] = static_cast<int8_t>(q);
+        acc[i] -= q * *scale;
+      }
+      break;
+    }
+    default:
+      PADDLE_THROW("Unknown gradient compression %d", config.type);
+  }
+}
+
+void DecompressGradient(CompressType type, float scale, const char* data,
+                        size_t size, float* grad, int64_t numel) {
+  switch (type) {
+    case sendrecv::VariableMessage::TOP_K: {
+      PADDLE_ENFORCE_EQ(size % (sizeof(uint32_t) + sizeof(float)), 0UL);
+      size_t k = size / (sizeof(uint32_t) + sizeof(float));
+      auto* index = reinterpret_cast<const uint32_t*>(data);
+      auto* value = reinterpret_cast<const float*>(index + k);
+      std::fill(grad, grad + numel, 0.0f);
+      for (size_t i = 0; i < k; ++i) {
+        PADDLE_ENFORCE_LT(static_cast<int64_t>(index[i]), numel);
+        grad[index[i]] = value[i];
+      }
+      break;
+    }
+    case sendrecv::VariableMessage::FP16_QUANT: {
+      PADDLE_ENFORCE_EQ(size, numel * sizeof(platform::float16));
+      auto* value = reinterpret_cast<const platform::float16*>(data);
+      for (int64_t i = 0; i < numel; ++i) {
+        grad[i] = static_cast<float>(value[i]);
+      }
+      break;
+    }
+    case sendrecv::VariableMessage::INT8_QUANT: {
+      PADDLE_ENFORCE_EQ(size, numel * sizeof(int8_t));
+      auto* value = reinterpret_cast<const int8_t*>(data);
+      for (int64_t i = 0; i < numel; ++i) {
+        grad[i] = value[i] * scale;
+      }
+      break;
+    }
+    default:
+      PADDLE_THROW("Unknown gradient compression %d", type);
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,73 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "paddle/fluid/operators/distributed/send_recv.pb.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+using CompressType = sendrecv::VariableMessage::CompressType;
+
+// How the dense FP32 gradient of a variable is compressed before it is sent
+// to the parameter server:
+//
+// TOP_K: only the ratio of the elements of the largest magnitude are sent,
+//   as pairs of uint32 indices and float values.
+// FP16: every element is sent as a float16.
+// INT8: every element is sent as an int8 times compress_scale, which is the
+//   largest magnitude of the elements divided by 127.
+//
+// What is not sent, the elements left out by TOP_K or the rounding errors of
+// FP16 and INT8, is kept by the trainer as the residual of the variable and
+// added to its next gradient, so the updates are delayed rather than lost.
+struct CompressConfig {
+  CompressType type = sendrecv::VariableMessage::NONE;
+  // The fraction of the elements sent by TOP_K.
+  float ratio = 0.01f;
+};
+
+// Parses "", "none", "topk", "fp16" or "int8".
+CompressType ParseCompressType(const std::string& name);
+const char* CompressTypeName(CompressType type);
+
+// Sets the compression of the variable sent by the name. It is set by the
+// send op, and read when the variable is serialized.
+void SetVarCompression(const std::string& varname,
+                       const CompressConfig& config);
+CompressConfig GetVarCompression(const std::string& varname);
+// Clears the compression settings and the residuals of all variables.
+void ResetVarCompression();
+
+// The size in bytes of the numel elements compressed by config.
+size_t CompressedSize(const CompressConfig& config, int64_t numel);
+
+// Compresses the numel elements of grad plus the residual of varname into
+// out, which holds CompressedSize bytes, and updates the residual. The scale
+// of INT8 is returned in scale.
+void CompressGradient(const std::string& varname, const CompressConfig& config,
+                      const float* grad, int64_t numel, char* out,
+                      float* scale);
+
+// Decompresses size bytes of data into the numel elements of grad.
+void DecompressGradient(CompressType type, float scale, const char* data,
+                        size_t size, float* grad, int64_t numel);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,131 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Compresses grad as varname and returns what the server receives.
+static std::vector<float> SendOnce(const std::string& varname,
+                                   const CompressConfig& config,
+                                   const std::vector<float>& grad,
+                                   size_t* size = nullptr) {
+  int64_t numel = grad.size();
+  std::vector<char> buf(CompressedSize(config, numel));
+  float scale;
+  CompressGradient(varname, config, grad.data(), numel, buf.data(), &scale);
+  std::vector<float> received(numel, -1.0f);
+  DecompressGradient(config.type, scale, buf.data(), buf.size(),
+                     received.data(), numel);
+  if (size != nullptr) {
+    *size = buf.size();
+  }
+  return received;
+}
+
+TEST(GradientCompression, ParseType) {
+  EXPECT_EQ(ParseCompressType(""), sendrecv::VariableMessage::NONE);
+  EXPECT_EQ(ParseCompressType("topk"), sendrecv::VariableMessage::TOP_K);
+  EXPECT_EQ(ParseCompressType("fp16"), sendrecv::VariableMessage::FP16_QUANT);
+  EXPECT_EQ(ParseCompressType("int8"), sendrecv::VariableMessage::INT8_QUANT);
+  EXPECT_STREQ(CompressTypeName(sendrecv::VariableMessage::INT8_QUANT),
+               "int8");
+  EXPECT_THROW(ParseCompressType("zip"), platform::EnforceNotMet);
+}
+
+TEST(GradientCompression, Config) {
+  ResetVarCompression();
+  EXPECT_EQ(GetVarCompression("w@GRAD").type, sendrecv::VariableMessage::NONE);
+  CompressConfig config;
+  config.type = sendrecv::VariableMessage::TOP_K;
+  config.ratio = 0.5f;
+  SetVarCompression("w@GRAD", config);
+  EXPECT_EQ(GetVarCompression("w@GRAD").type, sendrecv::VariableMessage::TOP_K);
+  EXPECT_EQ(GetVarCompression("w@GRAD").ratio, 0.5f);
+  config.ratio = 0.0f;
+  EXPECT_THROW(SetVarCompression("w@GRAD", config), platform::EnforceNotMet);
+  config.type = sendrecv::VariableMessage::NONE;
+  config.ratio = 1.0f;
+  SetVarCompression("w@GRAD", config);
+  EXPECT_EQ(GetVarCompression("w@GRAD").type, sendrecv::VariableMessage::NONE);
+}
+
+TEST(GradientCompression, TopKKeepsResidual) {
+  ResetVarCompression();
+  CompressConfig config;
+  config.type = sendrecv::VariableMessage::TOP_K;
+  config.ratio = 0.25f;
+  std::vector<float> grad = {0.1f, -8.0f, 0.3f, 4.0f, -0.5f, 2.0f, 7.0f, 1.0f};
+  size_t size;
+  auto received = SendOnce("topk", config, grad, &size);
+  EXPECT_EQ(size, 2 * (sizeof(uint32_t) + sizeof(float)));
+  EXPECT_EQ(received,
+            std::vector<float>({0, -8.0f, 0, 0, 0, 0, 7.0f, 0}));
+
+  // The elements left are sent by the next steps, largest first.
+  std::vector<float> zeros(grad.size(), 0.0f);
+  std::vector<float> total = received;
+  received = SendOnce("topk", config, zeros);
+  EXPECT_EQ(received, std::vector<float>({0, 0, 0, 4.0f, 0, 2.0f, 0, 0}));
+  for (int step = 0; step < 2; ++step) {
+    for (size_t i = 0; i < grad.size(); ++i) total[i] += received[i];
+    received = SendOnce("topk", config, zeros);
+  }
+  for (size_t i = 0; i < grad.size(); ++i) total[i] += received[i];
+  EXPECT_EQ(total, grad);
+}
+
+TEST(GradientCompression, QuantizationErrorFeedback) {
+  for (auto type : {sendrecv::VariableMessage::FP16_QUANT,
+                    sendrecv::VariableMessage::INT8_QUANT}) {
+    ResetVarCompression();
+    CompressConfig config;
+    config.type = type;
+    std::vector<float> grad(1000);
+    for (size_t i = 0; i < grad.size(); ++i) {
+      grad[i] = std::sin(i * 0.37f) * 3.0f + 1e-4f;
+    }
+    size_t size;
+    const int kSteps = 50;
+    std::vector<double> total(grad.size(), 0.0);
+    for (int step = 0; step < kSteps; ++step) {
+      auto received = SendOnce("quant", config, grad, &size);
+      for (size_t i = 0; i < grad.size(); ++i) total[i] += received[i];
+    }
+    EXPECT_EQ(size, grad.size() * (type == sendrecv::VariableMessage::INT8_QUANT
+                                       ? 1
+                                       : 2));
+    // With the residual carried over, the sum of what is received is off by
+    // no more than the error of one step, rather than kSteps of them.
+    double max_error = type == sendrecv::VariableMessage::INT8_QUANT
+                           ? 3.0 / 127
+                           : 3.0 / 1024;
+    for (size_t i = 0; i < grad.size(); ++i) {
+      ASSERT_NEAR(total[i], grad[i] * kSteps, max_error) << i;
+    }
+  }
+  ResetVarCompression();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -20,14 +20,45 @@ limitations under the License. */
 
 #include "glog/logging.h"  // For VLOG
 #include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
 #include "paddle/fluid/operators/distributed/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_int32(rpc_stream_min_size_mb, 64,
+             "LoDTensor and SelectedRows variables of at least this size in "
+             "MB are sent in chunks by the SendVariableStream RPC, which "
+             "copies every chunk into the variable of the server as soon as "
+             "it arrives. A non-positive value disables streaming.");
+DEFINE_int32(rpc_stream_chunk_size_kb, 4096,
+             "The size in KB of the chunks sent by SendVariableStream.");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
 
+// Whether the variable is large enough to be sent by SendVariableStream.
+// A compressed variable is always sent in one message, since it is
+// decompressed as a whole.
+static bool UseSendStream(const std::string& name,
+                          const framework::Variable* var) {
+  if (FLAGS_rpc_stream_min_size_mb <= 0 ||
+      GetVarCompression(name).type != sendrecv::VariableMessage::NONE) {
+    return false;
+  }
+  const framework::Tensor* tensor = nullptr;
+  if (var->IsType<framework::LoDTensor>()) {
+    tensor = &var->Get<framework::LoDTensor>();
+  } else if (var->IsType<framework::SelectedRows>()) {
+    tensor = &var->Get<framework::SelectedRows>().value();
+  }
+  if (tensor == nullptr || !tensor->IsInitialized()) {
+    return false;
+  }
+  size_t size = tensor->numel() * framework::SizeOfType(tensor->type());
+  return size >= (static_cast<size_t>(FLAGS_rpc_stream_min_size_mb) << 20);
+}
+
 void GRPCClient::InitImpl() { InitEventLoop(); }
 
 void GRPCClient::InitEventLoop() {
@@ -77,9 +108,6 @@ bool GRPCClient::AsyncSendVar(const std::string& ep,
                       this] {
     auto* var = p_scope->FindVar(var_name_val);
 
-    ::grpc::ByteBuffer req;
-    SerializeToByteBuffer(var_name_val, var, *p_ctx, &req);
-
     // varhandle
     VarHandle var_h;
     var_h.ep = ep_val;
@@ -88,6 +116,14 @@ bool GRPCClient::AsyncSendVar(const std::string& ep,
     var_h.ctx = p_ctx;
     var_h.method = "Send";
 
+    if (UseSendStream(var_name_val, var)) {
+      SendVarStream(var_h, var, ch, time_out);
+      return;
+    }
+
+    ::grpc::ByteBuffer req;
+    SerializeToByteBuffer(var_name_val, var, *p_ctx, &req);
+
     VLOG(3) << var_h.String() << " begin";
 
     // stub context
@@ -105,6 +141,57 @@ bool GRPCClient::AsyncSendVar(const std::string& ep,
   return true;
 }
 
+void GRPCClient::SendVarStream(const VarHandle& var_h, framework::Variable* var,
+                               std::shared_ptr<grpc::Channel> ch,
+                               int64_t time_out) {
+  std::vector<::grpc::ByteBuffer> chunks;
+  SerializeToByteBuffers(
+      var_h.name, var, *var_h.ctx,
+      static_cast<size_t>(FLAGS_rpc_stream_chunk_size_kb) << 10, &chunks);
+
+  VLOG(3) << var_h.String() << " begin streaming " << chunks.size()
+          << " chunks";
+
+  SendProcessor* s = new SendProcessor(ch);
+  s->Prepare(var_h, time_out);
+  s->response_call_back_ = nullptr;
+
+  // The call is driven on its own queue by this thread. A write completes as
+  // soon as the chunk is handed to the transport, so the next chunk is written
+  // while the previous ones are still in flight.
+  ::grpc::CompletionQueue cq;
+  auto call = s->stub_g_.PrepareCall(
+      s->context_.get(), "/sendrecv.SendRecvService/SendVariableStream", &cq);
+  auto wait = [&cq]() {
+    void* tag = nullptr;
+    bool ok = false;
+    return cq.Next(&tag, &ok) && ok;
+  };
+  call->StartCall(s);
+  bool ok = wait();
+  for (size_t i = 0; ok && i < chunks.size(); ++i) {
+    call->Write(chunks[i], s);
+    ok = wait();
+  }
+  if (ok) {
+    call->WritesDone(s);
+    ok = wait();
+  }
+  if (ok) {
+    call->Read(&s->reply_, s);
+    wait();
+  }
+  // Finish gets the status of the call even if the stream broke.
+  call->Finish(&s->status_, s);
+  wait();
+  call.reset();
+  cq.Shutdown();
+  while (wait()) {
+  }
+
+  ProcessResponse(s);
+}
+
 void ProcGetResponse(const VarHandle& var_h,
                      const ::grpc::ByteBuffer& ret_msg) {
   framework::Variable* outvar = nullptr;
@@ -280,28 +367,32 @@ void GRPCClient::Proceed() {
     BaseProcessor* c = static_cast<BaseProcessor*>(tag);
     GPR_ASSERT(ok);
     PADDLE_ENFORCE(c);
-    if (c->status_.ok()) {
-      VLOG(3) << c->var_h_.String() << " process";
-      c->Process();
-    } else if (c->status_.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
-      LOG(ERROR) << c->var_h_.String()
-                 << " meets grpc error:" << c->status_.error_message();
-      {
-        std::lock_guard<std::mutex> lk(sync_mutex_);
-        ok_ = false;
-      }
-      sync_cond_.notify_all();
-    } else {
-      LOG(FATAL) << c->var_h_.String()
-                 << " meets grpc error:" << c->status_.error_message();
-    }
-    delete c;
+    ProcessResponse(c);
+  }
+}
+
+void GRPCClient::ProcessResponse(BaseProcessor* c) {
+  if (c->status_.ok()) {
+    VLOG(3) << c->var_h_.String() << " process";
+    c->Process();
+  } else if (c->status_.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+    LOG(ERROR) << c->var_h_.String()
+               << " meets grpc error:" << c->status_.error_message();
     {
       std::lock_guard<std::mutex> lk(sync_mutex_);
-      req_count_--;
+      ok_ = false;
     }
     sync_cond_.notify_all();
+  } else {
+    LOG(FATAL) << c->var_h_.String()
+               << " meets grpc error:" << c->status_.error_message();
+  }
+  delete c;
+  {
+    std::lock_guard<std::mutex> lk(sync_mutex_);
+    req_count_--;
   }
+  sync_cond_.notify_all();
 }
 
 std::shared_ptr<grpc::Channel> GRPCClient::GetChannel(const std::string& ep) {
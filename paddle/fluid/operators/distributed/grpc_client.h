@@ -217,6 +217,13 @@ class GRPCClient : public RPCClient {
 
   void Proceed();
 
+  // Handles the completed request and deletes it.
+  void ProcessResponse(BaseProcessor* c);
+
+  // Sends a large variable in chunks by SendVariableStream.
+  void SendVarStream(const VarHandle& var_h, framework::Variable* var,
+                     std::shared_ptr<grpc::Channel> ch, int64_t time_out);
+
   std::shared_ptr<grpc::Channel> GetChannel(const std::string& ep);
 
  private:
@@ -0,0 +1,140 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/distributed/grpc_client.h"
+#include "paddle/fluid/operators/distributed/grpc_server.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/string/printf.h"
+
+DECLARE_int32(rpc_stream_min_size_mb);
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+// Counts the variables received, which are parsed into the scope of the
+// server by the RPCs.
+class ReceiveHandler final : public distributed::RequestHandler {
+ public:
+  ReceiveHandler() : RequestHandler(true) {}
+
+  bool Handle(const std::string& varname, framework::Scope* scope,
+              framework::Variable* var, framework::Variable** outvar,
+              const std::string& out_var_name = "") override {
+    received_++;
+    return true;
+  }
+
+  std::atomic<int> received_{0};
+};
+
+class SendStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    handler_.reset(new ReceiveHandler);
+    handler_->SetScope(&server_scope_);
+    handler_->SetDevCtx(&ctx_);
+    server_.reset(new distributed::AsyncGRPCServer("127.0.0.1:0", 1));
+    server_->RegisterRPC(distributed::kRequestSend, handler_.get());
+    handler_->SetRPCServer(server_.get());
+    server_thread_.reset(new std::thread(
+        std::bind(&distributed::RPCServer::StartServer, server_.get())));
+    server_->WaitServerReady();
+    ep_ = paddle::string::Sprintf("127.0.0.1:%d", server_->GetSelectedPort());
+    client_ = distributed::RPCClient::GetInstance<distributed::GRPCClient>();
+  }
+
+  void TearDown() override {
+    server_->ShutDown();
+    server_thread_->join();
+    server_.reset();
+    handler_.reset();
+  }
+
+  // Creates the variable of numel floats on both sides, where the one of the
+  // server is allocated beforehand as in the recv scope of a pserver.
+  void CreateVar(const std::string& name, int64_t numel) {
+    auto* tensor = client_scope_.Var(name)->GetMutable<framework::LoDTensor>();
+    float* data = tensor->mutable_data<float>({numel}, place_);
+    for (int64_t i = 0; i < numel; ++i) {
+      data[i] = static_cast<float>(i % 1000);
+    }
+    server_scope_.Var(name)->GetMutable<framework::LoDTensor>()->mutable_data<
+        float>({numel}, place_);
+  }
+
+  void Send(const std::string& name) {
+    client_->AsyncSendVar(ep_, ctx_, client_scope_, name);
+    ASSERT_TRUE(client_->Wait());
+  }
+
+  platform::CPUPlace place_;
+  platform::CPUDeviceContext ctx_{place_};
+  framework::Scope client_scope_;
+  framework::Scope server_scope_;
+  std::unique_ptr<ReceiveHandler> handler_;
+  std::unique_ptr<distributed::RPCServer> server_;
+  std::unique_ptr<std::thread> server_thread_;
+  distributed::RPCClient* client_;
+  std::string ep_;
+};
+
+TEST_F(SendStreamTest, ReceiveIntoScope) {
+  FLAGS_rpc_stream_min_size_mb = 1;
+  const int64_t numel = (3 << 20) / sizeof(float) + 5;
+  CreateVar("w", numel);
+  auto* tensor = server_scope_.FindVar("w")->GetMutable<framework::LoDTensor>();
+  const float* data = tensor->data<float>();
+
+  Send("w");
+  EXPECT_EQ(handler_->received_, 1);
+  EXPECT_EQ(tensor->data<float>(), data);
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_EQ(data[i], static_cast<float>(i % 1000));
+  }
+}
+
+TEST_F(SendStreamTest, DISABLED_Benchmark) {
+  const int kRepeat = 5;
+  for (int64_t mb : {1, 16, 64, 256}) {
+    std::string name = "var_" + std::to_string(mb);
+    CreateVar(name, (mb << 20) / sizeof(float));
+    double ms[2];
+    for (int stream = 0; stream < 2; ++stream) {
+      // 0 sends the variable in one message.
+      FLAGS_rpc_stream_min_size_mb = stream;
+      Send(name);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kRepeat; ++i) {
+        Send(name);
+      }
+      auto end = std::chrono::steady_clock::now();
+      ms[stream] =
+          std::chrono::duration<double, std::milli>(end - start).count() /
+          kRepeat;
+    }
+    LOG(INFO) << "send " << mb << " MB over loopback: unary " << ms[0]
+              << " ms, stream " << ms[1] << " ms";
+    server_scope_.EraseVars({name});
+    client_scope_.EraseVars({name});
+  }
+}
@@ -16,7 +16,10 @@ limitations under the License. */
 #include <nccl.h>
 #endif
 #include <sys/time.h>
+#include <algorithm>
+#include <memory>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream.h"
@@ -32,57 +35,96 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
-void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
-                           const platform::DeviceContext& ctx,
-                           ::grpc::ByteBuffer* msg,
-                           const std::string& out_name) {
+// Fills the meta info of the variable into request and returns its tensor
+// data in payload, which destroy_callback frees when it is a copy.
+static void GetVarPayload(const std::string& name, framework::Variable* var,
+                          const platform::DeviceContext& ctx,
+                          const std::string& out_name, VarMsg* request,
+                          void** payload, size_t* payload_size,
+                          DestroyCallback* destroy_callback) {
   // Default DestroyCallback does nothing, When using GPU
   // the CPU buffer need to be freed.
-  DestroyCallback destroy_callback = [](void* backing) {};
-  VarMsg request;
-  void* payload = nullptr;
-  size_t payload_size;
-
-  request.set_varname(name);
+  *destroy_callback = [](void* backing) {};
+  request->set_varname(name);
   // Note: normally the profiler is enabled in 1 trainer, hence only
   // 1 trainer returns true for ShouldSendProfileState(). It tells PS
   // servers the trainer's profiling state so that PS can follow the
   // trainer.
   if (platform::ShouldSendProfileState()) {
     if (platform::IsProfileEnabled()) {
-      request.set_profile(platform::kEnableProfiler);
+      request->set_profile(platform::kEnableProfiler);
     } else {
-      request.set_profile(platform::kDisableProfiler);
+      request->set_profile(platform::kDisableProfiler);
     }
   }
   if (!out_name.empty()) {
-    request.set_out_varname(out_name);
+    request->set_out_varname(out_name);
   }
+  bool compressed = false;
   if (var->IsType<framework::LoDTensor>()) {
-    request.set_type(::sendrecv::LOD_TENSOR);
-    GetTensorPayload(var, ctx, &request, &payload, &payload_size);
+    request->set_type(::sendrecv::LOD_TENSOR);
+    GetTensorPayload(var, ctx, request, payload, payload_size);
+    compressed = CompressTensorPayload(ctx, request, payload, payload_size);
   } else if (var->IsType<framework::SelectedRows>()) {
-    request.set_type(::sendrecv::SELECTED_ROWS);
-    GetSelectedRowsPayload(var, ctx, &request, &payload, &payload_size);
+    request->set_type(::sendrecv::SELECTED_ROWS);
+    GetSelectedRowsPayload(var, ctx, request, payload, payload_size);
 #ifdef PADDLE_WITH_CUDA
   } else if (var->IsType<ncclUniqueId>()) {
-    request.set_type(::sendrecv::NCCL_ID);
+    request->set_type(::sendrecv::NCCL_ID);
 #endif
   } else {
     PADDLE_THROW("Serialize does not support type: %s",
                  typeid(var->Type()).name());
   }
 
-  if (platform::is_gpu_place(ctx.GetPlace())) {
+  if (compressed) {
+    *destroy_callback = [](void* backing) {
+      memory::Free(platform::CPUPlace(), backing);
+    };
+  } else if (platform::is_gpu_place(ctx.GetPlace())) {
 #ifdef PADDLE_WITH_CUDA
     // GPU data is copied to CPU buffer when sending,
     // free the buffer when possible.
-    destroy_callback = [](void* backing) {
+    *destroy_callback = [](void* backing) {
       platform::CUDAPinnedPlace cuda_pinned;
       memory::Free(cuda_pinned, backing);
     };
 #endif
   }
+}
+
+// Returns the slice of the rows of a SelectedRows, which is referenced
+// rather than copied, preceded by the slice of its field header.
+static void GetRowsSlices(framework::Variable* var, ::grpc::Slice* header,
+                          ::grpc::Slice* rows) {
+  auto* slr = var->GetMutable<framework::SelectedRows>();
+  char buf[128];
+  ProtoEncodeHelper e(buf, sizeof(buf));
+  size_t rows_memory_size =
+      slr->rows().size() * framework::SizeOfType(typeid(int64_t));
+  e.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
+  *header = ::grpc::Slice(e.size());
+  memcpy(const_cast<uint8_t*>(header->begin()), e.data(), e.size());
+
+  *rows = ::grpc::Slice(
+      grpc_slice_new_with_user_data(
+          const_cast<void*>(reinterpret_cast<const void*>(slr->rows().data())),
+          rows_memory_size, [](void* backing) {},
+          const_cast<char*>(
+              reinterpret_cast<const char*>(slr->rows().data()))),
+      ::grpc::Slice::STEAL_REF);
+}
+
+void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
+                           const platform::DeviceContext& ctx,
+                           ::grpc::ByteBuffer* msg,
+                           const std::string& out_name) {
+  DestroyCallback destroy_callback;
+  VarMsg request;
+  void* payload = nullptr;
+  size_t payload_size;
+  GetVarPayload(name, var, ctx, out_name, &request, &payload, &payload_size,
+                &destroy_callback);
 
   std::string header;
   request.AppendToString(&header);
@@ -120,22 +162,7 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
       ::grpc::Slice::STEAL_REF);
 
   if (var->IsType<framework::SelectedRows>()) {
-    auto* slr = var->GetMutable<framework::SelectedRows>();
-    ProtoEncodeHelper e2(static_cast<char*>(buf), 128);
-    size_t rows_memory_size =
-        slr->rows().size() * framework::SizeOfType(typeid(int64_t));
-    e2.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
-    slices[2] = ::grpc::Slice(e2.size());
-    memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
-
-    slices[3] = ::grpc::Slice(
-        grpc_slice_new_with_user_data(
-            const_cast<void*>(
-                reinterpret_cast<const void*>(slr->rows().data())),
-            rows_memory_size, [](void* backing) {},
-            const_cast<char*>(
-                reinterpret_cast<const char*>(slr->rows().data()))),
-        ::grpc::Slice::STEAL_REF);
+    GetRowsSlices(var, &slices[2], &slices[3]);
     num_slices = 4;
   }
 
@@ -143,6 +170,61 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   msg->Swap(&tmp);
 }
 
+void SerializeToByteBuffers(const std::string& name, framework::Variable* var,
+                            const platform::DeviceContext& ctx,
+                            size_t chunk_size,
+                            std::vector<::grpc::ByteBuffer>* msgs) {
+  PADDLE_ENFORCE(var->IsType<framework::LoDTensor>() ||
+                     var->IsType<framework::SelectedRows>(),
+                 "Only LoDTensor and SelectedRows can be sent in chunks");
+  PADDLE_ENFORCE_GT(chunk_size, 0UL);
+  DestroyCallback destroy_callback;
+  VarMsg request;
+  void* payload = nullptr;
+  size_t payload_size;
+  GetVarPayload(name, var, ctx, std::string(), &request, &payload,
+                &payload_size, &destroy_callback);
+
+  std::string header;
+  request.AppendToString(&header);
+  // Every chunk holds a reference to the payload, so that a copied payload
+  // is freed with the last chunk sent.
+  std::shared_ptr<void> holder(payload, destroy_callback);
+  msgs->clear();
+  size_t offset = 0;
+  do {
+    size_t length = std::min(chunk_size, payload_size - offset);
+    std::vector<::grpc::Slice> slices;
+    // The meta info goes with the first chunk, and the varint of the length
+    // takes at most 10 bytes.
+    std::unique_ptr<char[]> buf(new char[header.size() + 16]);
+    ProtoEncodeHelper e(buf.get(), header.size() + 16);
+    if (offset == 0) {
+      e.WriteRawBytes(header);
+    }
+    e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber, length);
+    slices.emplace_back(e.size());
+    memcpy(const_cast<uint8_t*>(slices.back().begin()), e.data(), e.size());
+    if (length > 0) {
+      slices.emplace_back(
+          grpc_slice_new_with_user_data(
+              static_cast<char*>(payload) + offset, length,
+              [](void* backing) {
+                delete static_cast<std::shared_ptr<void>*>(backing);
+              },
+              new std::shared_ptr<void>(holder)),
+          ::grpc::Slice::STEAL_REF);
+    }
+    offset += length;
+    if (offset == payload_size && var->IsType<framework::SelectedRows>()) {
+      slices.emplace_back();
+      slices.emplace_back();
+      GetRowsSlices(var, &slices[slices.size() - 2], &slices.back());
+    }
+    msgs->emplace_back(slices.data(), slices.size());
+  } while (offset < payload_size);
+}
+
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
                                const framework::Scope* scope,
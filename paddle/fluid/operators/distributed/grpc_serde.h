@@ -40,6 +40,14 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            ::grpc::ByteBuffer* msg,
                            const std::string& out_varname = std::string());
 
+// Serializes a LoDTensor or SelectedRows into the messages of the
+// SendVariableStream RPC, each of which carries at most chunk_size bytes of the
+// tensor data. The tensor data is referenced by the messages, not copied.
+void SerializeToByteBuffers(const std::string& name, framework::Variable* var,
+                            const platform::DeviceContext& ctx,
+                            size_t chunk_size,
+                            std::vector<::grpc::ByteBuffer>* msgs);
+
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
                                const framework::Scope* scope,
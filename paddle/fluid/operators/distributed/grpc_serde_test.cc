@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/operators/detail/macros.h"
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
 #include "paddle/fluid/operators/distributed/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc_variable_response.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
@@ -201,6 +202,128 @@ void RunTestLodTensor(platform::Place place, int from_type = 0) {
   for (int i = 0; i < tensor_numel; ++i) EXPECT_FLOAT_EQ(tensor_data2[i], 31.9);
 }
 
+// Sends the variable in chunks and parses them one after another into the
+// variable of the same name in scope.
+void SendInChunks(framework::Variable* var, framework::Scope* scope,
+                  const platform::DeviceContext& ctx, size_t chunk_size,
+                  size_t expected_chunks) {
+  std::vector<::grpc::ByteBuffer> msgs;
+  operators::distributed::SerializeToByteBuffers("myvar", var, ctx, chunk_size,
+                                                 &msgs);
+  EXPECT_EQ(msgs.size(), expected_chunks);
+  operators::distributed::GRPCVariableResponse resp(scope, &ctx);
+  resp.SetChunked(true);
+  for (auto& msg : msgs) {
+    EXPECT_FALSE(resp.IsComplete());
+    EXPECT_EQ(resp.Parse(msg), 0);
+  }
+  EXPECT_TRUE(resp.IsComplete());
+  EXPECT_EQ(resp.GetVar(), scope->FindVar("myvar"));
+}
+
+TEST(LodTensor, Chunked) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({1000, 3}));
+  framework::LoD lod;
+  lod.push_back(framework::Vector<size_t>({0, 10, 1000}));
+  tensor->set_lod(lod);
+  float* data = tensor->mutable_data<float>(place);
+  for (int i = 0; i < 3000; ++i) data[i] = i * 0.5f;
+
+  // The tensor received is allocated beforehand, and is not reallocated.
+  framework::Scope scope;
+  auto* tensor2 = scope.Var("myvar")->GetMutable<framework::LoDTensor>();
+  float* data2 =
+      tensor2->mutable_data<float>(framework::make_ddim({1000, 3}), place);
+
+  // 12000 bytes in chunks of 1001 bytes, which split the floats.
+  SendInChunks(&var, &scope, ctx, 1001, 12);
+  EXPECT_EQ(tensor2->data<float>(), data2);
+  EXPECT_EQ(tensor2->dims(), tensor->dims());
+  ASSERT_EQ(tensor2->lod().size(), 1UL);
+  EXPECT_EQ(tensor2->lod()[0][1], 10UL);
+  EXPECT_EQ(tensor2->lod()[0][2], 1000UL);
+  for (int i = 0; i < 3000; ++i) EXPECT_EQ(data2[i], i * 0.5f);
+
+  SendInChunks(&var, &scope, ctx, 1 << 20, 1);
+  EXPECT_EQ(tensor2->data<float>(), data2);
+  for (int i = 0; i < 3000; ++i) EXPECT_EQ(data2[i], i * 0.5f);
+
+  // A unary message must hold the whole tensor.
+  std::vector<::grpc::ByteBuffer> msgs;
+  operators::distributed::SerializeToByteBuffers("myvar", &var, ctx, 1001,
+                                                 &msgs);
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_THROW(resp.Parse(msgs[0]), platform::EnforceNotMet);
+}
+
+TEST(SelectedRows, Chunked) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  auto* slr = var.GetMutable<framework::SelectedRows>();
+  slr->set_height(1000);
+  auto* tensor = slr->mutable_value();
+  float* data =
+      tensor->mutable_data<float>(framework::make_ddim({100, 16}), place);
+  for (int i = 0; i < 1600; ++i) data[i] = i;
+  for (int i = 0; i < 100; ++i) slr->mutable_rows()->push_back(i * 3);
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  SendInChunks(&var, &scope, ctx, 1024, 7);
+
+  auto& slr2 = scope.FindVar("myvar")->Get<framework::SelectedRows>();
+  EXPECT_EQ(slr2.height(), 1000);
+  ASSERT_EQ(slr2.rows().size(), 100UL);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(slr2.rows()[i], i * 3);
+  ASSERT_EQ(slr2.value().numel(), 1600);
+  for (int i = 0; i < 1600; ++i) EXPECT_EQ(slr2.value().data<float>()[i], i);
+}
+
+TEST(LodTensor, Compressed) {
+  namespace distributed = operators::distributed;
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  float* data =
+      tensor->mutable_data<float>(framework::make_ddim({100, 10}), place);
+  // Distinct magnitudes, and the largest 100 are the last ones.
+  for (int i = 0; i < 1000; ++i) data[i] = (i % 2 ? 1 : -1) * (i + 1) * 0.01f;
+
+  for (auto type : {"topk", "fp16", "int8"}) {
+    distributed::ResetVarCompression();
+    distributed::CompressConfig config;
+    config.type = distributed::ParseCompressType(type);
+    config.ratio = 0.1f;
+    distributed::SetVarCompression("myvar", config);
+    ::grpc::ByteBuffer msg;
+    distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+    EXPECT_LT(msg.Length(), 4000UL);
+
+    framework::Scope scope;
+    scope.Var("myvar");
+    distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(msg), 0);
+    auto& tensor2 = scope.FindVar("myvar")->Get<framework::LoDTensor>();
+    EXPECT_EQ(tensor2.dims(), tensor->dims());
+    const float* data2 = tensor2.data<float>();
+    for (int i = 0; i < 1000; ++i) {
+      if (config.type == sendrecv::VariableMessage::TOP_K) {
+        EXPECT_EQ(data2[i], i < 900 ? 0.0f : data[i]);
+      } else {
+        // int8 is off by at most half of max / 127.
+        EXPECT_NEAR(data2[i], data[i], 0.04f);
+      }
+    }
+  }
+  distributed::ResetVarCompression();
+}
+
 TEST(LodTensor, Run) {
   platform::CPUPlace place;
   RunTestLodTensor(place);
@@ -41,6 +41,9 @@ class RequestBase {
   }
   virtual ~RequestBase() {}
   virtual void Process() = 0;
+  // A read of a client streaming request completes without a message at the
+  // end of the stream. Returns false if the request isn't reading a stream.
+  virtual bool ProcessEndOfStream() { return false; }
 
   std::string Status2String(const std::string& method) {
     std::string status = "Process";
@@ -114,6 +117,84 @@ class RequestSend final : public RequestBase {
   ServerAsyncResponseWriter<sendrecv::VoidMessage> responder_;
 };
 
+// Receives a variable sent in chunks by SendVariableStream. Every chunk is
+// copied into the variable as soon as it is read, so the variable is complete
+// when the stream ends.
+class RequestSendStream final : public RequestBase {
+ public:
+  explicit RequestSendStream(GrpcService::AsyncService* service,
+                             ::grpc::ServerCompletionQueue* cq,
+                             RequestHandler* request_handler, int req_id)
+      : RequestBase(service, cq, request_handler, req_id),
+        reader_(&ctx_),
+        started_(false) {
+    request_.reset(new GRPCVariableResponse(request_handler->scope(),
+                                            request_handler->dev_ctx(),
+                                            !request_handler->sync_mode()));
+    request_->SetChunked(true);
+    int method_id =
+        static_cast<int>(distributed::GrpcMethod::kSendVariableStream);
+    service_->RequestAsyncClientStreaming(
+        method_id, &ctx_, &reader_, cq_, cq_,
+        reinterpret_cast<void*>(static_cast<intptr_t>(req_id)));
+  }
+  virtual ~RequestSendStream() {}
+  std::string GetReqName() override { return request_->Varname(); }
+
+  void Process() override {
+    if (started_ && request_->Parse(chunk_) != 0) {
+      LOG(ERROR) << "RequestSendStream failed to parse a chunk of "
+                 << GetReqName();
+      Finish(::grpc::Status(::grpc::StatusCode::INTERNAL,
+                            "VariableResponse parse error"));
+      return;
+    }
+    started_ = true;
+    reader_.Read(&chunk_,
+                 reinterpret_cast<void*>(static_cast<intptr_t>(req_id_)));
+  }
+
+  bool ProcessEndOfStream() override {
+    if (!started_) {
+      return false;
+    }
+    std::string varname = GetReqName();
+    VLOG(4) << "RequestSendStream var_name:" << varname;
+    // A read also fails when the client cancels the call, its deadline
+    // expires or the connection breaks, so the variable may be partial.
+    if (!request_->IsComplete()) {
+      LOG(ERROR) << "RequestSendStream of " << varname
+                 << " ended before all of its data arrived";
+      Finish(::grpc::Status(::grpc::StatusCode::DATA_LOSS,
+                            "SendVariableStream ended before the variable "
+                            "was complete"));
+      return true;
+    }
+
+    auto scope = request_->GetMutableLocalScope();
+    auto invar = request_->GetVar();
+    framework::Variable* outvar = nullptr;
+
+    request_handler_->Handle(varname, scope, invar, &outvar);
+    Finish(::grpc::Status::OK);
+    return true;
+  }
+
+ private:
+  void Finish(const ::grpc::Status& status) {
+    std::lock_guard<std::mutex> l(status_mu_);
+    status_ = FINISH;
+    reader_.Finish(reply_, status,
+                   reinterpret_cast<void*>(static_cast<intptr_t>(req_id_)));
+  }
+
+  std::shared_ptr<GRPCVariableResponse> request_;
+  ::grpc::ByteBuffer chunk_;
+  sendrecv::VoidMessage reply_;
+  ::grpc::ServerAsyncReader<sendrecv::VoidMessage, ::grpc::ByteBuffer> reader_;
+  bool started_;
+};
+
 class RequestGet final : public RequestBase {
  public:
   explicit RequestGet(GrpcService::AsyncService* service,
@@ -274,9 +355,10 @@ void AsyncGRPCServer::StartServer() {
     auto threadnum = rpc_thread_num_[rpc_name];
     auto& reqs = rpc_reqs_[rpc_name];
 
-    reqs.reserve(kRequestBufSize);
+    int num_reqs = RequestBufSize(rpc_name);
+    reqs.resize(num_reqs, nullptr);
 
-    for (int i = 0; i < kRequestBufSize; i++) {
+    for (int i = 0; i < num_reqs; i++) {
       VLOG(6) << "TryToRegisterNewOne on RPC NAME: " << rpc_name << " I: " << i;
       TryToRegisterNewOne(rpc_name, i);
     }
@@ -338,7 +420,9 @@ void AsyncGRPCServer::TryToRegisterNewOne(const std::string& rpc_name,
   auto& cq = rpc_cq_[rpc_name];
 
   RequestBase* b = nullptr;
-  if (rpc_name == kRequestSend) {
+  if (rpc_name == kRequestSend && req_id >= kRequestBufSize) {
+    b = new RequestSendStream(&service_, cq.get(), handler, req_id);
+  } else if (rpc_name == kRequestSend) {
     b = new RequestSend(&service_, cq.get(), handler, req_id);
   } else if (rpc_name == kRequestGet) {
     b = new RequestGet(&service_, cq.get(), handler, req_id);
@@ -355,6 +439,11 @@ void AsyncGRPCServer::TryToRegisterNewOne(const std::string& rpc_name,
   VLOG(4) << "Create RequestSend status:" << b->Status();
 }
 
+int AsyncGRPCServer::RequestBufSize(const std::string& rpc_name) {
+  // The streaming sends of large variables share the queue of RequestSend.
+  return rpc_name == kRequestSend ? 2 * kRequestBufSize : kRequestBufSize;
+}
+
 void AsyncGRPCServer::HandleRequest(
     ::grpc::ServerCompletionQueue* cq, const std::string& rpc_name,
     std::function<void(const std::string&, int)> TryToRegisterNewOne) {
@@ -375,7 +464,7 @@ void AsyncGRPCServer::HandleRequest(
     auto& reqs = rpc_reqs_[rpc_name];
     RequestBase* base = nullptr;
     {
-      PADDLE_ENFORCE(req_id >= 0 && req_id < kRequestBufSize);
+      PADDLE_ENFORCE(req_id >= 0 && req_id < RequestBufSize(rpc_name));
       std::unique_lock<std::mutex> lock(cq_mutex_);
       base = reqs[req_id];
     }
@@ -387,6 +476,9 @@ void AsyncGRPCServer::HandleRequest(
     // https://groups.google.com/forum/#!topic/grpc-io/xftlRy-IQwM
     // https://groups.google.com/forum/#!topic/grpc-io/ywATt88Ef_I
     if (!ok) {
+      if (base->Status() == PROCESS && base->ProcessEndOfStream()) {
+        continue;
+      }
       LOG(WARNING) << "completion queue:" << rpc_name
                    << " recv no regular event"
                    << " context:" << base->Status2String(rpc_name);
@@ -59,6 +59,7 @@ class AsyncGRPCServer final : public RPCServer {
       std::function<void(const std::string&, int)> TryToRegisterNewOne);
 
   void TryToRegisterNewOne(const std::string& rpc_name, int req_id);
+  int RequestBufSize(const std::string& rpc_name);
   void ShutdownQueue();
   void ShutDownImpl() override;
 
@@ -81,10 +81,11 @@ enum class GrpcMethod {
   kGetVariable,
   kPrefetchVariable,
   kCheckpointNotify,
+  kSendVariableStream,
 };
 
 static const int kGrpcNumMethods =
-    static_cast<int>(GrpcMethod::kCheckpointNotify) + 1;
+    static_cast<int>(GrpcMethod::kSendVariableStream) + 1;
 
 inline const char* GrpcMethodName(GrpcMethod id) {
   switch (id) {
@@ -96,6 +97,8 @@ inline const char* GrpcMethodName(GrpcMethod id) {
       return "/sendrecv.SendRecvService/PrefetchVariable";
     case GrpcMethod::kCheckpointNotify:
       return "/sendrecv.SendRecvService/CheckpointNotify";
+    case GrpcMethod::kSendVariableStream:
+      return "/sendrecv.SendRecvService/SendVariableStream";
   }
 
   // Shouldn't be reached.
@@ -109,9 +112,13 @@ class GrpcService final {
    public:
     AsyncService() {
       for (int i = 0; i < kGrpcNumMethods; ++i) {
+        auto method = static_cast<GrpcMethod>(i);
         AddMethod(new ::grpc::internal::RpcServiceMethod(
-            GrpcMethodName(static_cast<GrpcMethod>(i)),
-            ::grpc::internal::RpcMethod::NORMAL_RPC, nullptr));
+            GrpcMethodName(method),
+            method == GrpcMethod::kSendVariableStream
+                ? ::grpc::internal::RpcMethod::CLIENT_STREAMING
+                : ::grpc::internal::RpcMethod::NORMAL_RPC,
+            nullptr));
         ::grpc::Service::MarkMethodAsync(i);
       }
     }
@@ -119,6 +126,7 @@ class GrpcService final {
 
     // Make RequestAsyncUnary public for grpc_call.h
     using ::grpc::Service::RequestAsyncUnary;
+    using ::grpc::Service::RequestAsyncClientStreaming;
   };
 };
 
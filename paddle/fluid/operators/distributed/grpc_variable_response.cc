@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +30,7 @@ namespace distributed {
 enum WireType {
   WIRETYPE_VARINT = 0,
   WIRETYPE_LENGTH_DELIMITED = 2,
+  WIRETYPE_FIXED32 = 5,
 };
 
 inline int GetTagFieldNumber(uint32_t tag) { return tag >> 3; }
@@ -293,6 +295,25 @@ int GRPCVariableResponse::Parse(Source* source) {
         }
         break;
       }
+      case sendrecv::VariableMessage::kCompressTypeFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) {
+          return tag;
+        }
+        meta_.set_compress_type(
+            static_cast<::sendrecv::VariableMessage_CompressType>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kCompressScaleFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_FIXED32) || !input.ReadLittleEndian32(&v)) {
+          return tag;
+        }
+        float scale;
+        memcpy(&scale, &v, sizeof(scale));
+        meta_.set_compress_scale(scale);
+        break;
+      }
       default: {
         // Unknown tag, return unknown error.
         return -1;
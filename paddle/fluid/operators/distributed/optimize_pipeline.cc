@@ -0,0 +1,151 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/optimize_pipeline.h"
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+OptimizePipeline::~OptimizePipeline() { Stop(); }
+
+void OptimizePipeline::AddBlock(int block_id,
+                                const std::set<std::string>& recv_vars,
+                                const std::set<std::string>& out_vars) {
+  size_t i = blocks_.size();
+  blocks_.push_back(Block{block_id, recv_vars.size(), 0, false, false});
+  if (recv_vars.empty()) {
+    bool has_recv_blocks = pre_blocks_.size() + 1 < blocks_.size();
+    if (!has_recv_blocks) {
+      // Its outputs are written before the step receives anything, so they
+      // are always ready.
+      pre_blocks_.push_back(i);
+      return;
+    }
+    post_blocks_.push_back(i);
+  }
+  for (auto& var : recv_vars) {
+    recv_var_to_blocks_[var].push_back(i);
+  }
+  for (auto& var : out_vars) {
+    out_var_to_blocks_[var].push_back(i);
+  }
+  VLOG(3) << "optimize block " << block_id << " runs after "
+          << recv_vars.size() << " received vars";
+}
+
+void OptimizePipeline::Run(size_t i) {
+  try {
+    VLOG(3) << "running server block: " << blocks_[i].id;
+    run_block_(blocks_[i].id);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "run sub program error " << e.what();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  blocks_[i].done = true;
+  cond_.notify_all();
+}
+
+void OptimizePipeline::StartStep() {
+  for (size_t i : pre_blocks_) {
+    Run(i);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  received_.clear();
+  for (auto& block : blocks_) {
+    block.pending = block.num_recv_vars;
+    block.started = false;
+    block.done = false;
+  }
+  in_step_ = true;
+}
+
+void OptimizePipeline::Received(const std::string& varname) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Variables received out of a step are left to FinishStep.
+  if (!in_step_ || stopped_ || !received_.insert(varname).second) {
+    return;
+  }
+  auto it = recv_var_to_blocks_.find(varname);
+  if (it == recv_var_to_blocks_.end()) {
+    return;
+  }
+  for (size_t i : it->second) {
+    auto& block = blocks_[i];
+    if (--block.pending == 0 && !block.started) {
+      block.started = true;
+      running_.push_back(framework::Async([this, i] { Run(i); }));
+    }
+  }
+}
+
+void OptimizePipeline::FinishStep() {
+  std::vector<std::future<void>> running;
+  std::vector<size_t> rest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running.swap(running_);
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+      if (blocks_[i].num_recv_vars > 0 && !blocks_[i].started) {
+        blocks_[i].started = true;
+        rest.push_back(i);
+      }
+    }
+  }
+  for (size_t i : rest) {
+    running.push_back(framework::Async([this, i] { Run(i); }));
+  }
+  for (auto& f : running) f.wait();
+  for (size_t i : post_blocks_) {
+    Run(i);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_step_ = false;
+  cond_.notify_all();
+}
+
+void OptimizePipeline::WaitReady(const std::string& varname) {
+  auto it = out_var_to_blocks_.find(varname);
+  if (it == out_var_to_blocks_.end()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this, it] {
+    if (stopped_ || !in_step_) {
+      return true;
+    }
+    for (size_t i : it->second) {
+      if (!blocks_[i].done) return false;
+    }
+    return true;
+  });
+}
+
+void OptimizePipeline::Stop() {
+  std::vector<std::future<void>> running;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    running.swap(running_);
+    cond_.notify_all();
+  }
+  for (auto& f : running) f.wait();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,112 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// OptimizePipeline runs the optimize blocks of a sync mode pserver while the
+// gradients of a step are still being received, instead of after the batch
+// barrier of every trainer.
+//
+// A block which reads received variables, the gradients sent by the
+// trainers, is run as soon as all of them have arrived in the step. The
+// blocks which read no received variable keep their place around them: the
+// blocks added before the first of them, such as learning rate decay, run
+// when a step starts, and the blocks added after, such as the updates of the
+// global optimizer states, run when it finishes. Every block still runs once
+// per step on the same inputs, so the parameters are the same as the ones of
+// the sync loop.
+//
+// A variable written by the blocks is ready to be fetched once the blocks
+// writing it have run in the current step.
+class OptimizePipeline {
+ public:
+  using RunBlock = std::function<void(int block_id)>;
+
+  explicit OptimizePipeline(RunBlock run_block)
+      : run_block_(std::move(run_block)) {}
+
+  ~OptimizePipeline();
+
+  // Adds a block in the order of the optimize blocks. recv_vars are the
+  // received variables it reads, and out_vars the variables it writes.
+  void AddBlock(int block_id, const std::set<std::string>& recv_vars,
+                const std::set<std::string>& out_vars);
+
+  // Runs the blocks added before the first block reading received variables
+  // and starts counting the received variables of a new step.
+  void StartStep();
+
+  // Called once varname is received. Starts the blocks all of whose received
+  // variables have arrived.
+  void Received(const std::string& varname);
+
+  // Called after the batch barrier. Waits for the blocks started, runs the
+  // blocks whose variables were not all received and the blocks added after
+  // the last block reading received variables.
+  void FinishStep();
+
+  // Blocks until varname is ready to be fetched in the current step.
+  void WaitReady(const std::string& varname);
+
+  // Releases the requests waiting in WaitReady and waits for the blocks
+  // started. No block is started after it.
+  void Stop();
+
+ private:
+  struct Block {
+    int id;
+    size_t num_recv_vars;
+    // The received variables not arrived yet in the current step.
+    size_t pending;
+    bool started;
+    bool done;
+  };
+
+  // Runs block i and marks it as done.
+  void Run(size_t i);
+
+  RunBlock run_block_;
+  std::vector<Block> blocks_;
+  // The blocks run by StartStep and by FinishStep.
+  std::vector<size_t> pre_blocks_;
+  std::vector<size_t> post_blocks_;
+  std::unordered_map<std::string, std::vector<size_t>> recv_var_to_blocks_;
+  std::unordered_map<std::string, std::vector<size_t>> out_var_to_blocks_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::unordered_set<std::string> received_;
+  std::vector<std::future<void>> running_;
+  bool in_step_ = false;
+  bool stopped_ = false;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,120 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/optimize_pipeline.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The blocks of a pserver program of two trainers: learning rate decay, the
+// optimize blocks of w1 and w2, and the update of a global optimizer state.
+class OptimizePipelineTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    pipeline_.reset(new OptimizePipeline([this](int block_id) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      runs_.push_back(block_id);
+    }));
+    pipeline_->AddBlock(1, {}, {"lr"});
+    pipeline_->AddBlock(2, {"w1@GRAD.trainer_0", "w1@GRAD.trainer_1"},
+                        {"w1", "w1@GRAD"});
+    pipeline_->AddBlock(3, {"w2@GRAD.trainer_0", "w2@GRAD.trainer_1"},
+                        {"w2", "w2@GRAD"});
+    pipeline_->AddBlock(4, {}, {"beta_pow"});
+  }
+
+  std::vector<int> Runs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return runs_;
+  }
+
+  // Waits for varname in another thread and returns whether it is ready
+  // within a while.
+  bool ReadyWithin(const std::string& varname, int ms) {
+    std::atomic<bool> ready(false);
+    std::thread t([&] {
+      pipeline_->WaitReady(varname);
+      ready = true;
+    });
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!ready && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool result = ready;
+    if (!result) {
+      // Release the thread.
+      pipeline_->Stop();
+    }
+    t.join();
+    return result;
+  }
+
+ protected:
+  std::unique_ptr<OptimizePipeline> pipeline_;
+  std::mutex mutex_;
+  std::vector<int> runs_;
+};
+
+TEST_F(OptimizePipelineTest, RunBlockOnceReceived) {
+  // Before the first step, the parameters are fetched as they are.
+  EXPECT_TRUE(ReadyWithin("w1", 1000));
+  pipeline_->StartStep();
+  EXPECT_EQ(Runs(), std::vector<int>({1}));
+
+  pipeline_->Received("w1@GRAD.trainer_0");
+  pipeline_->Received("w1@GRAD.trainer_0");
+  pipeline_->Received("w2@GRAD.trainer_1");
+  EXPECT_EQ(Runs(), std::vector<int>({1}));
+  pipeline_->Received("w1@GRAD.trainer_1");
+  // w1 is sent as soon as its block has run, while w2 is still waiting for
+  // the gradient of trainer 0.
+  EXPECT_TRUE(ReadyWithin("w1", 10000));
+  EXPECT_EQ(Runs(), std::vector<int>({1, 2}));
+  EXPECT_FALSE(ReadyWithin("w2", 50));
+}
+
+TEST_F(OptimizePipelineTest, FinishStep) {
+  for (int step = 0; step < 3; ++step) {
+    pipeline_->StartStep();
+    pipeline_->Received("w2@GRAD.trainer_0");
+    pipeline_->Received("w2@GRAD.trainer_1");
+    pipeline_->Received("w1@GRAD.trainer_1");
+    EXPECT_TRUE(ReadyWithin("w2", 10000));
+    pipeline_->FinishStep();
+    EXPECT_TRUE(ReadyWithin("w1", 1000));
+    EXPECT_TRUE(ReadyWithin("beta_pow", 1000));
+  }
+  // Every block runs once a step, the blocks reading no gradient at the ends.
+  auto runs = Runs();
+  ASSERT_EQ(runs.size(), 12UL);
+  for (int step = 0; step < 3; ++step) {
+    EXPECT_EQ(std::vector<int>(runs.begin() + step * 4,
+                               runs.begin() + (step + 1) * 4),
+              std::vector<int>({1, 3, 2, 4}));
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -28,6 +28,7 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/operators/distributed/optimize_pipeline.h"
 
 namespace paddle {
 namespace operators {
@@ -74,7 +75,8 @@ class RequestHandler {
         executor_(nullptr),
         scope_(nullptr),
         program_(nullptr),
-        rpc_server_(nullptr) {}
+        rpc_server_(nullptr),
+        pipeline_(nullptr) {}
 
   virtual ~RequestHandler() {}
 
@@ -105,6 +107,11 @@ class RequestHandler {
 
   void SetRPCServer(RPCServer* rpc_server) { rpc_server_ = rpc_server; }
 
+  // Used for the pipelined sync mode.
+  void SetOptimizePipeline(OptimizePipeline* pipeline) {
+    pipeline_ = pipeline;
+  }
+
   // Get attributes.
   bool sync_mode() { return sync_mode_; }
   framework::Scope* scope() { return scope_; }
@@ -151,6 +158,9 @@ class RequestHandler {
       grad_to_prepared_ctx_;
 
   RPCServer* rpc_server_;
+
+  // Used for the pipelined sync mode.
+  OptimizePipeline* pipeline_;
 };
 
 }  // namespace distributed
@@ -72,6 +72,9 @@ bool RequestSendHandler::Handle(const std::string& varname,
       std::unique_lock<std::mutex> lock(mutex_sparse_vars_);
       sparse_vars_.push_back(invar);
     }
+    if (pipeline_ != nullptr) {
+      pipeline_->Received(varname);
+    }
   }
   return true;
 }
@@ -94,6 +97,11 @@ bool RequestGetHandler::Handle(const std::string& varname,
     if (varname == FETCH_BARRIER_MESSAGE) {
       VLOG(3) << "sync: recv fetch barrier message";
       rpc_server_->IncreaseBatchBarrier(kRequestGet);
+    } else if (pipeline_ != nullptr) {
+      // The variable is sent once the blocks updating it have run, while
+      // the other blocks of the step may still be running.
+      pipeline_->WaitReady(varname);
+      *outvar = scope_->FindVar(varname);
     } else {
       rpc_server_->WaitCond(kRequestGet);
       *outvar = scope_->FindVar(varname);
@@ -19,8 +19,11 @@ limitations under the License. */
 #include <thread>  // NOLINT
 
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/string/printf.h"
 
 namespace paddle {
 namespace operators {
@@ -111,6 +114,44 @@ void GetSelectedRowsPayload(framework::Variable* var,
   *payload_size = tensor->numel() * framework::SizeOfType(tensor->type());
 }
 
+bool CompressTensorPayload(const platform::DeviceContext& ctx, VarMsg* request,
+                           void** payload, size_t* payload_size) {
+  CompressConfig config = GetVarCompression(request->varname());
+  if (config.type == VarMsg::NONE) {
+    return false;
+  }
+  if (request->data_type() != VarMsg::FP32 || *payload_size == 0) {
+    VLOG(3) << "do not compress " << request->varname() << " of type "
+            << request->data_type();
+    return false;
+  }
+  platform::RecordEvent record_event(
+      string::Sprintf("compress_%s", CompressTypeName(config.type)), &ctx);
+  int64_t numel = *payload_size / sizeof(float);
+  size_t size = CompressedSize(config, numel);
+  void* buf = memory::Alloc(platform::CPUPlace(), size);
+  float scale;
+  CompressGradient(request->varname(), config,
+                   static_cast<const float*>(*payload), numel,
+                   static_cast<char*>(buf), &scale);
+  if (platform::is_gpu_place(ctx.GetPlace())) {
+#ifdef PADDLE_WITH_CUDA
+    // The copy of the GPU data made by GetTensorPayload.
+    memory::Free(platform::CUDAPinnedPlace(), *payload);
+#endif
+  }
+  request->set_compress_type(config.type);
+  if (config.type == VarMsg::INT8_QUANT) {
+    request->set_compress_scale(scale);
+  }
+  VLOG(3) << "compress " << request->varname() << " by "
+          << CompressTypeName(config.type) << " from " << *payload_size
+          << " to " << size << " bytes";
+  *payload = buf;
+  *payload_size = size;
+  return true;
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
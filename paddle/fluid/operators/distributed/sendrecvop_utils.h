@@ -41,6 +41,13 @@ void GetSelectedRowsPayload(framework::Variable* var,
                             const platform::DeviceContext& ctx, VarMsg* request,
                             void** payload, size_t* payload_size);
 
+// Replaces the payload of a FP32 LoDTensor returned by GetTensorPayload by
+// its compressed copy if a compression is set for the variable by
+// SetVarCompression. Returns whether it is replaced, and then the copy should
+// be freed by memory::Free with platform::CPUPlace.
+bool CompressTensorPayload(const platform::DeviceContext& ctx, VarMsg* request,
+                           void** payload, size_t* payload_size);
+
 inline std::type_index ToTypeIndex(sendrecv::VariableMessage::Type type) {
   switch (type) {
     case sendrecv::VariableMessage::FP32:
@@ -14,7 +14,10 @@
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include <vector>
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
+#include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/string/printf.h"
 
 namespace paddle {
 namespace operators {
@@ -93,25 +96,73 @@ bool VariableResponse::CopyLodTensorData(
     const platform::DeviceContext& ctx, const framework::DDim& dims,
     int length) {
   auto* tensor = GetVar()->GetMutable<framework::LoDTensor>();
-  tensor->Resize(dims);
+  if (serialized_bytes_ == 0) {
+    tensor->Resize(dims);
 
-  framework::LoD lod;
-  for (int i = 0; i < meta_.lod_level(); ++i) {
-    framework::Vector<size_t> v;
-    for (int j = 0; j < meta_.lod(i).lod_data_size(); ++j) {
-      v.push_back(meta_.lod(i).lod_data(j));
+    framework::LoD lod;
+    for (int i = 0; i < meta_.lod_level(); ++i) {
+      framework::Vector<size_t> v;
+      for (int j = 0; j < meta_.lod(i).lod_data_size(); ++j) {
+        v.push_back(meta_.lod(i).lod_data(j));
+      }
+      lod.push_back(v);
     }
-    lod.push_back(v);
+    tensor->set_lod(lod);
+  }
+
+  if (meta_.compress_type() != sendrecv::VariableMessage::NONE) {
+    return CopyCompressedTensorData(input, ctx, tensor, length);
   }
-  tensor->set_lod(lod);
 
+  // Reuses the memory of the tensor in the scope if it is large enough.
   void* tensor_data =
       tensor->mutable_data(ctx.GetPlace(), ToTypeIndex(meta_.data_type()));
+  CheckSerializedBytes(
+      tensor->numel() * framework::SizeOfType(tensor->type()), length);
+
+  if (!ReadRaw(input, ctx, tensor->place(),
+               static_cast<char*>(tensor_data) + serialized_bytes_, length)) {
+    return false;
+  }
+  serialized_bytes_ += length;
+
+  return true;
+}
 
-  if (!ReadRaw(input, ctx, tensor->place(), tensor_data, length)) {
+bool VariableResponse::CopyCompressedTensorData(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, framework::LoDTensor* tensor,
+    int length) {
+  PADDLE_ENFORCE(meta_.data_type() == sendrecv::VariableMessage::FP32,
+                 "only FP32 gradients are compressed, but %s is not",
+                 meta_.varname());
+  platform::RecordEvent record_event(
+      string::Sprintf("decompress_%s", CompressTypeName(meta_.compress_type())),
+      &ctx);
+  std::vector<char> data(length);
+  platform::CPUPlace cpu;
+  if (!ReadRaw(input, ctx, cpu, data.data(), length)) {
     return false;
   }
+  serialized_bytes_ += length;
+
+  if (platform::is_gpu_place(ctx.GetPlace())) {
+#ifdef PADDLE_WITH_CUDA
+    framework::Tensor cpu_tensor;
+    float* grad = cpu_tensor.mutable_data<float>(tensor->dims(), cpu);
+    DecompressGradient(meta_.compress_type(), meta_.compress_scale(),
+                       data.data(), length, grad, cpu_tensor.numel());
+    framework::TensorCopy(cpu_tensor, ctx.GetPlace(), ctx, tensor);
+    ctx.Wait();
+#else
+    PADDLE_THROW("Unexpected branch");
+#endif
+    return true;
+  }
 
+  float* grad = tensor->mutable_data<float>(ctx.GetPlace());
+  DecompressGradient(meta_.compress_type(), meta_.compress_scale(),
+                     data.data(), length, grad, tensor->numel());
   return true;
 }
 
@@ -131,18 +182,20 @@ bool VariableResponse::CopySelectRowsTensorData(
   auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
   slr->set_height(meta_.slr_height());
   auto* tensor = slr->mutable_value();
-  tensor->Resize(dims);
-  PADDLE_ENFORCE_EQ(static_cast<size_t>(tensor->numel()),
-                    length / framework::SizeOfType(
-                                 paddle::operators::distributed::ToTypeIndex(
-                                     meta_.data_type())));
+  if (serialized_bytes_ == 0) {
+    tensor->Resize(dims);
+  }
   void* tensor_data = tensor->mutable_data(
       ctx.GetPlace(),
       paddle::operators::distributed::ToTypeIndex(meta_.data_type()));
+  CheckSerializedBytes(
+      tensor->numel() * framework::SizeOfType(tensor->type()), length);
 
-  if (!ReadRaw(input, ctx, tensor->place(), tensor_data, length)) {
+  if (!ReadRaw(input, ctx, tensor->place(),
+               static_cast<char*>(tensor_data) + serialized_bytes_, length)) {
     return false;
   }
+  serialized_bytes_ += length;
 
   return true;
 }
@@ -150,6 +203,10 @@ bool VariableResponse::CopySelectRowsTensorData(
 bool VariableResponse::CopySelectRowsData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, int length) {
+  // The rows follow the last chunk of the values.
+  PADDLE_ENFORCE(!chunked_ || serialized_bytes_ == ExpectedBytes(),
+                 "the rows of %s arrive before all of its values",
+                 meta_.varname());
   auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
   slr->mutable_rows()->clear();
   slr->mutable_rows()->resize(length /
@@ -161,10 +218,53 @@ bool VariableResponse::CopySelectRowsData(
   if (!ReadRaw(input, ctx, cpu, rows_data, length)) {
     return false;
   }
+  rows_received_ = true;
 
   return true;
 }
 
+void VariableResponse::CheckSerializedBytes(int64_t expected, int length) {
+  if (chunked_) {
+    PADDLE_ENFORCE_LE(serialized_bytes_ + length, expected,
+                      "the tensor data of %s is larger than its dims",
+                      meta_.varname());
+  } else {
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(length), expected,
+                      "the tensor data of %s does not match its dims",
+                      meta_.varname());
+  }
+}
+
+int64_t VariableResponse::ExpectedBytes() {
+  auto* var = GetVar();
+  const framework::Tensor* tensor = nullptr;
+  if (var->IsType<framework::LoDTensor>()) {
+    tensor = &var->Get<framework::LoDTensor>();
+  } else if (var->IsType<framework::SelectedRows>()) {
+    tensor = &var->Get<framework::SelectedRows>().value();
+  } else {
+    return -1;
+  }
+  return tensor->numel() *
+         framework::SizeOfType(ToTypeIndex(meta_.data_type()));
+}
+
+bool VariableResponse::IsComplete() {
+  if (meta_.varname().empty() || GetVar() == nullptr) {
+    return false;
+  }
+  if (meta_.type() == sendrecv::NCCL_ID) {
+    return true;
+  }
+  if (meta_.compress_type() != sendrecv::VariableMessage::NONE) {
+    return serialized_bytes_ > 0;
+  }
+  if (meta_.type() == sendrecv::SELECTED_ROWS && !rows_received_) {
+    return false;
+  }
+  return serialized_bytes_ == ExpectedBytes();
+}
+
 bool VariableResponse::ProcSerializedField(
     int tag, ::google::protobuf::io::CodedInputStream* input,
     int64_t num_bytes) {
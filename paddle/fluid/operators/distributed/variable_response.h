@@ -84,6 +84,14 @@ class VariableResponse {
   inline std::string Varname() const { return meta_.varname(); }
   inline std::string OutVarname() const { return meta_.out_varname(); }
 
+  // The serialized field of a SendVariableStream request is split into
+  // chunks, each of which holds a part of the tensor data.
+  void SetChunked(bool chunked) { chunked_ = chunked; }
+
+  // Whether all the tensor data, and the rows of a SelectedRows, have been
+  // parsed. A stream broken by the client ends without some of them.
+  bool IsComplete();
+
   // should call parse first.
   framework::Variable* GetVar() {
     if (create_scope_) {
@@ -108,6 +116,18 @@ class VariableResponse {
                          const platform::DeviceContext& ctx,
                          const framework::DDim& dims, int length);
 
+  // Decompresses the gradient in the serialized field into the tensor.
+  bool CopyCompressedTensorData(::google::protobuf::io::CodedInputStream* input,
+                                const platform::DeviceContext& ctx,
+                                framework::LoDTensor* tensor, int length);
+
+  // Checks the length of the tensor data in a message, which must be the
+  // whole tensor unless the message is a chunk.
+  void CheckSerializedBytes(int64_t expected, int length);
+
+  // The bytes of the tensor data given by the dims in the meta info.
+  int64_t ExpectedBytes();
+
   bool ProcSerializedField(int tag,
                            ::google::protobuf::io::CodedInputStream* input,
                            int64_t num_bytes);
@@ -119,6 +139,12 @@ class VariableResponse {
   framework::Scope* local_scope_ = nullptr;
 
   sendrecv::VariableMessage meta_;
+  // The bytes of the tensor data received so far. The serialized field may
+  // be split into the chunks of SendVariableStream, which are copied into the
+  // tensor one after another.
+  int64_t serialized_bytes_ = 0;
+  bool chunked_ = false;
+  bool rows_received_ = false;
 };
 
 };  // namespace distributed
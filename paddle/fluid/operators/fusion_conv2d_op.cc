@@ -0,0 +1,226 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_conv2d_op.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "paddle/fluid/operators/conv_op.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+
+namespace paddle {
+namespace operators {
+
+void FusionConv2DOp::InferShape(framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("Input"),
+                 "Input(Input) of FusionConv2DOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("Filter"),
+                 "Input(Filter) of FusionConv2DOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Output"),
+                 "Output(Output) of FusionConv2DOp should not be null.");
+
+  auto in_dims = ctx->GetInputDim("Input");
+  auto filter_dims = ctx->GetInputDim("Filter");
+  std::vector<int> strides = ctx->Attrs().Get<std::vector<int>>("strides");
+  std::vector<int> paddings = ctx->Attrs().Get<std::vector<int>>("paddings");
+  std::vector<int> dilations = ctx->Attrs().Get<std::vector<int>>("dilations");
+  int groups = ctx->Attrs().Get<int>("groups");
+
+  PADDLE_ENFORCE_EQ(in_dims.size(), 4UL,
+                    "Input of FusionConv2DOp should be 4-D tensor.");
+  PADDLE_ENFORCE_EQ(filter_dims.size(), 4UL,
+                    "Filter of FusionConv2DOp should be 4-D tensor.");
+  PADDLE_ENFORCE(strides.size() == 2UL && paddings.size() == 2UL &&
+                     dilations.size() == 2UL,
+                 "strides, paddings and dilations should have 2 elements.");
+  PADDLE_ENFORCE_EQ(in_dims[1], filter_dims[1] * groups,
+                    "The number of input channels should be equal to filter "
+                    "channels * groups.");
+  PADDLE_ENFORCE_EQ(
+      filter_dims[0] % groups, 0,
+      "The number of output channels should be divided by groups.");
+  if (ctx->HasInput("Bias")) {
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Bias")),
+                      filter_dims[0],
+                      "Bias should have one element for every output "
+                      "channel.");
+  }
+  auto activation = ctx->Attrs().Get<std::string>("activation");
+  PADDLE_ENFORCE(activation == "identity" || activation == "relu",
+                 "Unsupported activation %s.", activation);
+
+  std::vector<int64_t> output_shape({in_dims[0], filter_dims[0]});
+  for (size_t i = 0; i < strides.size(); ++i) {
+    output_shape.push_back(ConvOutputSize(in_dims[i + 2], filter_dims[i + 2],
+                                          dilations[i], paddings[i],
+                                          strides[i]));
+  }
+  auto out_dims = framework::make_ddim(output_shape);
+  if (ctx->HasInput("ResidualData")) {
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("ResidualData"), out_dims,
+                      "ResidualData should have the shape of Output.");
+  }
+  ctx->SetOutputDim("Output", out_dims);
+  ctx->ShareLoD("Input", "Output");
+}
+
+framework::OpKernelType FusionConv2DOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+      ctx.GetPlace());
+}
+
+void FusionConv2DOpMaker::Make() {
+  AddInput("Input", "(Tensor) The input tensor of the conv, NCHW.");
+  AddInput("Filter",
+           "(Tensor) The filter, MCHW, where M is the number of output "
+           "channels and C the number of input channels of a group.");
+  AddInput("Bias", "(Tensor, optional) The bias of every output channel, (M).")
+      .AsDispensable();
+  AddInput("ResidualData",
+           "(Tensor, optional) Added to the output before the activation, "
+           "in the shape of Output.")
+      .AsDispensable();
+  AddOutput("Output", "(Tensor) The output tensor, NCHW.");
+  AddAttr<std::vector<int>>("strides", "(vector<int>) The strides.")
+      .SetDefault({1, 1});
+  AddAttr<std::vector<int>>("paddings", "(vector<int>) The paddings.")
+      .SetDefault({0, 0});
+  AddAttr<std::vector<int>>("dilations", "(vector<int>) The dilations.")
+      .SetDefault({1, 1});
+  AddAttr<int>("groups", "(int) The number of groups.").SetDefault(1);
+  AddAttr<std::string>("activation",
+                       "(string, default identity) The activation applied "
+                       "last, identity or relu.")
+      .SetDefault("identity");
+  AddComment(R"DOC(
+Fusion Convolution Operator.
+
+The conv2d of inference with its following ops fused, created by
+conv_bn_fuse_pass:
+
+$$Output = activation(conv(Input, Filter) + Bias + ResidualData)$$
+
+The bias, the residual and the activation are applied to the output of an
+image right after its convolution, so the output is not read and written
+again by an op for each of them.
+)DOC");
+}
+
+template <typename T>
+class FusionConv2DKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* bias = ctx.HasInput("Bias") ? ctx.Input<Tensor>("Bias") : nullptr;
+    auto* residual = ctx.HasInput("ResidualData")
+                         ? ctx.Input<Tensor>("ResidualData")
+                         : nullptr;
+    auto* output = ctx.Output<Tensor>("Output");
+    // Reshaped in the calculations, so it is copied.
+    Tensor filter = *ctx.Input<Tensor>("Filter");
+    int groups = ctx.Attr<int>("groups");
+    std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = ctx.Attr<std::vector<int>>("dilations");
+    bool relu = ctx.Attr<std::string>("activation") == "relu";
+    T* out_data = output->mutable_data<T>(ctx.GetPlace());
+
+    int batch_size = static_cast<int>(input->dims()[0]);
+    int channels = static_cast<int>(output->dims()[1]);
+    int out_size = static_cast<int>(output->dims()[2] * output->dims()[3]);
+    int in_step = static_cast<int>(input->dims()[1]) / groups;
+    int out_step = channels / groups;
+
+    std::vector<int64_t> filter_shape_vec(framework::vectorize(filter.dims()));
+    // {i_c/g, k_h, k_w, o_h, o_w}, multiplied as (i_c/g * k_h * k_w, o_size)
+    framework::DDim col_shape = framework::make_ddim(
+        {in_step, filter_shape_vec[2], filter_shape_vec[3],
+         output->dims()[2], output->dims()[3]});
+    framework::DDim col_matrix_shape = framework::flatten_to_2d(col_shape, 3);
+    bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
+    Tensor col;
+    Tensor col_matrix;
+    if (is_expand) {
+      col.mutable_data<T>(col_shape, ctx.GetPlace());
+      col_matrix.ShareDataWith(col);
+      col_matrix.Resize(col_matrix_shape);
+    }
+    filter.Resize({filter.dims()[0], filter.numel() / filter.dims()[0]});
+    framework::DDim input_shape =
+        framework::slice_ddim(input->dims(), 1, input->dims().size());
+
+    math::Im2ColFunctor<math::ColFormat::kCFO, platform::CPUDeviceContext, T>
+        im2col;
+    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    const T* residual_data = residual ? residual->data<T>() : nullptr;
+    for (int i = 0; i < batch_size; ++i) {
+      Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
+      Tensor out_batch =
+          output->Slice(i, i + 1).Resize({channels, out_size});
+      for (int g = 0; g < groups; ++g) {
+        Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+        if (!is_expand) {
+          col.ShareDataWith(in_slice);
+          col_matrix.ShareDataWith(col);
+          col_matrix.Resize(col_matrix_shape);
+        } else {
+          im2col(dev_ctx, in_slice, dilations, strides,
+                 std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                  paddings[1]},
+                 &col);
+        }
+        Tensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
+        Tensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
+        blas.MatMul(filter_slice, false, col_matrix, false, T(1.0), &out_slice,
+                    T(0.0));
+      }
+
+      // The output of the image is still in cache.
+      int64_t offset = int64_t(i) * channels * out_size;
+      T* out = out_data + offset;
+      const T* res = residual_data ? residual_data + offset : nullptr;
+      for (int c = 0; c < channels; ++c) {
+        T b = bias_data ? bias_data[c] : static_cast<T>(0);
+        T* y = out + int64_t(c) * out_size;
+        const T* r = res ? res + int64_t(c) * out_size : nullptr;
+        const T zero = static_cast<T>(0);
+        if (r && relu) {
+          for (int k = 0; k < out_size; ++k) {
+            y[k] = std::max(y[k] + b + r[k], zero);
+          }
+        } else if (r) {
+          for (int k = 0; k < out_size; ++k) y[k] += b + r[k];
+        } else if (relu) {
+          for (int k = 0; k < out_size; ++k) y[k] = std::max(y[k] + b, zero);
+        } else {
+          for (int k = 0; k < out_size; ++k) y[k] += b;
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_conv2d, ops::FusionConv2DOp, ops::FusionConv2DOpMaker,
+                  paddle::framework::DefaultGradOpDescMaker<true>);
+REGISTER_OP_CPU_KERNEL(fusion_conv2d, ops::FusionConv2DKernel<float>,
+                       ops::FusionConv2DKernel<double>);
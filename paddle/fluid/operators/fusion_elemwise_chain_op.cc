@@ -0,0 +1,281 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_elemwise_chain_op.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/eigen.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+enum class Functor {
+  // Binary, of the running value and an input.
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMax,
+  kMin,
+  // Unary, of the running value.
+  kScale,
+  kRelu,
+  kSigmoid,
+  kTanh,
+  kExp,
+  kAbs,
+  kSquare,
+  kSqrt,
+  kReciprocal,
+};
+
+// By the type of the op fused.
+const std::unordered_map<std::string, Functor>& Functors() {
+  static const std::unordered_map<std::string, Functor> functors({
+      {"elementwise_add", Functor::kAdd},
+      {"elementwise_sub", Functor::kSub},
+      {"elementwise_mul", Functor::kMul},
+      {"elementwise_div", Functor::kDiv},
+      {"elementwise_max", Functor::kMax},
+      {"elementwise_min", Functor::kMin},
+      {"scale", Functor::kScale},
+      {"relu", Functor::kRelu},
+      {"sigmoid", Functor::kSigmoid},
+      {"tanh", Functor::kTanh},
+      {"exp", Functor::kExp},
+      {"abs", Functor::kAbs},
+      {"square", Functor::kSquare},
+      {"sqrt", Functor::kSqrt},
+      {"reciprocal", Functor::kReciprocal},
+  });
+  return functors;
+}
+
+Functor ToFunctor(const std::string& type) {
+  auto it = Functors().find(type);
+  PADDLE_ENFORCE(it != Functors().end(), "Unsupported functor %s.", type);
+  return it->second;
+}
+
+bool IsBinary(Functor functor) { return functor <= Functor::kMin; }
+
+template <typename T>
+using ArrayMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+template <typename T>
+using ConstArrayMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+// out = a op b of n elements, where a is x if x_first, else y. out may be x.
+template <typename T>
+void RunBinary(Functor functor, int n, const T* x, const T* y, bool x_first,
+               T* out) {
+  ConstArrayMap<T> a(x_first ? x : y, n);
+  ConstArrayMap<T> b(x_first ? y : x, n);
+  ArrayMap<T> o(out, n);
+  switch (functor) {
+    case Functor::kAdd:
+      o = a + b;
+      break;
+    case Functor::kSub:
+      o = a - b;
+      break;
+    case Functor::kMul:
+      o = a * b;
+      break;
+    case Functor::kDiv:
+      o = a / b;
+      break;
+    case Functor::kMax:
+      o = a.max(b);
+      break;
+    case Functor::kMin:
+      o = a.min(b);
+      break;
+    default:
+      PADDLE_THROW("Not a binary functor.");
+  }
+}
+
+// out = functor(x) of n elements. out may be x.
+template <typename T>
+void RunUnary(Functor functor, int n, const T* x, T scale, T* out) {
+  ConstArrayMap<T> a(x, n);
+  ArrayMap<T> o(out, n);
+  const T one = static_cast<T>(1);
+  switch (functor) {
+    case Functor::kScale:
+      o = scale * a;
+      break;
+    case Functor::kRelu:
+      o = a.max(static_cast<T>(0));
+      break;
+    case Functor::kSigmoid:
+      o = one / (one + (-a).exp());
+      break;
+    case Functor::kTanh:
+      o = a.tanh();
+      break;
+    case Functor::kExp:
+      o = a.exp();
+      break;
+    case Functor::kAbs:
+      o = a.abs();
+      break;
+    case Functor::kSquare:
+      o = a.square();
+      break;
+    case Functor::kSqrt:
+      o = a.sqrt();
+      break;
+    case Functor::kReciprocal:
+      o = a.inverse();
+      break;
+    default:
+      PADDLE_THROW("Not a unary functor.");
+  }
+}
+
+}  // namespace
+
+void FusionElemwiseChainOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInputs("X"),
+                 "Inputs(X) of FusionElemwiseChainOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of FusionElemwiseChainOp should not be null.");
+  auto x_dims = ctx->GetInputsDim("X");
+  auto functors = ctx->Attrs().Get<std::vector<std::string>>("functors");
+  auto operands = ctx->Attrs().Get<std::vector<int>>("operands");
+  auto scales = ctx->Attrs().Get<std::vector<float>>("scales");
+  PADDLE_ENFORCE(!functors.empty(), "functors should not be empty.");
+  PADDLE_ENFORCE(functors.size() == operands.size() &&
+                     functors.size() == scales.size(),
+                 "functors, operands and scales should have the same size.");
+  for (size_t i = 0; i < functors.size(); ++i) {
+    if (!IsBinary(ToFunctor(functors[i]))) continue;
+    int operand = operands[i] >= 0 ? operands[i] : -operands[i] - 1;
+    PADDLE_ENFORCE_LT(operand, static_cast<int>(x_dims.size()),
+                      "The operand of %s is not in X.", functors[i]);
+  }
+  int64_t numel = framework::product(x_dims[0]);
+  for (size_t i = 1; i < x_dims.size(); ++i) {
+    // The batch size may be unknown before the run.
+    if (ctx->IsRuntime() || (numel > 0 && framework::product(x_dims[i]) > 0)) {
+      PADDLE_ENFORCE_EQ(framework::product(x_dims[i]), numel,
+                        "The inputs X should have the same size.");
+    }
+  }
+  ctx->SetOutputDim("Out", x_dims[0]);
+  ctx->ShareLoD("X", "Out");
+}
+
+framework::OpKernelType FusionElemwiseChainOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.MultiInput<Tensor>("X")[0]->type()),
+      ctx.GetPlace());
+}
+
+void FusionElemwiseChainOpMaker::Make() {
+  AddInput("X",
+           "(vector<LoDTensor>) The input of the chain, then the other "
+           "operands of the binary functors, all of the same size.")
+      .AsDuplicable();
+  AddOutput("Out",
+            "(LoDTensor) The output of the chain, in the shape of X[0].");
+  AddAttr<std::vector<std::string>>(
+      "functors",
+      "(vector<string>) The type of the op of every step: elementwise_add, "
+      "elementwise_sub, elementwise_mul, elementwise_div, elementwise_max, "
+      "elementwise_min, scale, relu, sigmoid, tanh, exp, abs, square, sqrt "
+      "or reciprocal.");
+  AddAttr<std::vector<int>>(
+      "operands",
+      "(vector<int>) For a binary step, i if it computes value op X[i], or "
+      "-i - 1 if X[i] op value. Ignored for a unary step.");
+  AddAttr<std::vector<float>>(
+      "scales",
+      "(vector<float>) The scale of a scale step, ignored for others.");
+  AddComment(R"DOC(
+Fusion Elementwise Chain Operator.
+
+A chain of elementwise and activation ops fused, created by
+elemwise_chain_fuse_pass. The value starts as X[0], and every step of
+functors applies to it in order:
+
+$$value = functor(value) \text{ or } value = value \ functor \ X[i]$$
+
+The steps run on a block of the data at a time, so the block stays in cache
+between them, and only Out is written.
+)DOC");
+}
+
+template <typename T>
+class FusionElemwiseChainKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto xs = ctx.MultiInput<LoDTensor>("X");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    auto& functor_types = ctx.Attr<std::vector<std::string>>("functors");
+    auto& operands = ctx.Attr<std::vector<int>>("operands");
+    auto& scales = ctx.Attr<std::vector<float>>("scales");
+
+    int64_t numel = xs[0]->numel();
+    std::vector<const T*> x_data;
+    for (auto* x : xs) {
+      PADDLE_ENFORCE_EQ(x->numel(), numel,
+                        "The inputs X should have the same size.");
+      x_data.push_back(x->data<T>());
+    }
+    std::vector<Functor> functors;
+    for (auto& type : functor_types) functors.push_back(ToFunctor(type));
+
+    // Small enough for the block of the value and of an operand to stay in
+    // L1.
+    constexpr int64_t kBlockSize = 1024;
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    for (int64_t begin = 0; begin < numel; begin += kBlockSize) {
+      int n = static_cast<int>(std::min(kBlockSize, numel - begin));
+      // The first step reads X[0], and the others the value in Out.
+      const T* value = x_data[0] + begin;
+      T* block = out_data + begin;
+      for (size_t i = 0; i < functors.size(); ++i) {
+        if (IsBinary(functors[i])) {
+          bool value_first = operands[i] >= 0;
+          int operand = value_first ? operands[i] : -operands[i] - 1;
+          RunBinary<T>(functors[i], n, value, x_data[operand] + begin,
+                       value_first, block);
+        } else {
+          RunUnary<T>(functors[i], n, value, static_cast<T>(scales[i]), block);
+        }
+        value = block;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_elemwise_chain, ops::FusionElemwiseChainOp,
+                  ops::FusionElemwiseChainOpMaker,
+                  paddle::framework::DefaultGradOpDescMaker<true>);
+REGISTER_OP_CPU_KERNEL(fusion_elemwise_chain,
+                       ops::FusionElemwiseChainKernel<float>,
+                       ops::FusionElemwiseChainKernel<double>);
@@ -0,0 +1,263 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_embedding_seq_pool_op.h"
+#include <string>
+#include "paddle/fluid/framework/var_type_inference.h"
+#include "paddle/fluid/operators/lookup_table_op.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+void FusionEmbeddingSeqPoolOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("W"),
+                 "Input(W) of FusionEmbeddingSeqPoolOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("Ids"),
+                 "Input(Ids) of FusionEmbeddingSeqPoolOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of FusionEmbeddingSeqPoolOp should not be null.");
+
+  auto table_dims = ctx->GetInputDim("W");
+  auto ids_dims = ctx->GetInputDim("Ids");
+  PADDLE_ENFORCE_EQ(table_dims.size(), 2, "Input(W)'s rank must be 2.");
+  PADDLE_ENFORCE_EQ(ids_dims.size(), 2, "Input(Ids)'s rank must be 2.");
+  PADDLE_ENFORCE_EQ(ids_dims[1], 1,
+                    "The last dimension of the 'Ids' tensor must be 1.");
+
+  // The height of Out is the number of sequences, which is only known from
+  // the LoD of Ids when running.
+  ctx->SetOutputDim("Out", {ids_dims[0], table_dims[1]});
+}
+
+framework::OpKernelType FusionEmbeddingSeqPoolOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+  return framework::OpKernelType(data_type, ctx.device_context());
+}
+
+void FusionEmbeddingSeqPoolOpMaker::Make() {
+  AddInput("W",
+           "(Tensor) The input represents embedding tensors, "
+           "which is a learnable parameter.");
+  AddInput("Ids",
+           "(LoDTensor) An int64 LoDTensor with one level of LoD, which "
+           "contains the ids of every sequence to be looked up in W. "
+           "The last dimension size must be 1.");
+  AddOutput("Out",
+            "(Tensor) The sum of the embeddings of every sequence, "
+            "whose shape is (number of sequences x width of W).");
+  AddAttr<std::string>("combiner",
+                       "(string, default: sum) "
+                       "The pooling type of sequence_pool. "
+                       "Only `sum` is supported now.")
+      .SetDefault("sum")
+      .InEnum({"sum"});
+  AddAttr<bool>("is_sparse",
+                "(boolean, default false) "
+                "Sparse update.")
+      .SetDefault(false);
+  AddAttr<int64_t>("padding_idx",
+                   "(int64, default -1) "
+                   "If the value is -1, it makes no effect to lookup. "
+                   "Otherwise the given value indicates the ids which are "
+                   "skipped when summing the embeddings.")
+      .SetDefault(kNoPadding);
+  AddComment(R"DOC(
+Fusion Embedding + Sequence Pool Operator.
+
+It computes lookup_table followed by sequence_pool with pooltype `SUM`,
+without materializing the embedding of every id.
+
+The input Ids must have one level of LoD.
+
+)DOC");
+}
+
+void FusionEmbeddingSeqPoolGradOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  auto table_dims = ctx->GetInputDim("W");
+  ctx->SetOutputDim(framework::GradVarName("W"), table_dims);
+}
+
+framework::OpKernelType FusionEmbeddingSeqPoolGradOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+  return framework::OpKernelType(data_type, ctx.device_context());
+}
+
+class FusionEmbeddingSeqPoolGradDescMaker
+    : public framework::DefaultGradOpDescMaker<true> {
+  using ::paddle::framework::DefaultGradOpDescMaker<
+      true>::DefaultGradOpDescMaker;
+
+ protected:
+  virtual std::string GradOpType() const {
+    return "fusion_embedding_seq_pool_grad";
+  }
+};
+
+class FusionEmbeddingSeqPoolGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto out_var_name = op_desc.Output(framework::GradVarName("W")).front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    if (is_sparse) {
+      block->Var(out_var_name)
+          ->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      block->Var(out_var_name)->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
+  }
+};
+
+template <typename T>
+class FusionEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using DeviceContext = paddle::platform::CPUDeviceContext;
+    auto* ids_t = ctx.Input<LoDTensor>("Ids");
+    auto* output_t = ctx.Output<LoDTensor>("Out");
+    PADDLE_ENFORCE(ctx.InputVar("W")->IsType<LoDTensor>(),
+                   "The parameter W of FusionEmbeddingSeqPoolOp "
+                   "must be a LoDTensor.");
+    auto* table_t = ctx.Input<LoDTensor>("W");
+
+    auto& ids_lod = ids_t->lod();
+    PADDLE_ENFORCE_EQ(ids_lod.size(), 1UL, "Only support input lod size is 1.");
+    auto& offsets = ids_lod[0];
+    const int64_t num_seqs = static_cast<int64_t>(offsets.size()) - 1;
+    const int64_t row_number = table_t->dims()[0];
+    const int64_t row_width = table_t->dims()[1];
+    int64_t padding_idx = ctx.Attr<int64_t>("padding_idx");
+
+    const int64_t* ids = ids_t->data<int64_t>();
+    CheckIds(ids, ids_t->numel(), row_number, padding_idx);
+
+    output_t->Resize({num_seqs, row_width});
+    const T* table = table_t->data<T>();
+    T* output = output_t->mutable_data<T>(ctx.GetPlace());
+    memset(output, 0, num_seqs * row_width * sizeof(T));
+
+    auto blas = math::GetBlas<DeviceContext, T>(ctx);
+    int64_t ids_numel = ids_t->numel();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (FLAGS_paddle_num_threads > 1 && \
+                             ids_numel >= 2 * kMinIdsPerThread)
+#endif
+    for (int64_t i = 0; i < num_seqs; ++i) {
+      T* out = output + i * row_width;
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+        if (static_cast<int64_t>(j) + kPrefetchDistance < ids_numel) {
+          PrefetchRow(table + ids[j + kPrefetchDistance] * row_width);
+        }
+        if (padding_idx != kNoPadding && ids[j] == padding_idx) {
+          continue;
+        }
+        blas.AXPY(row_width, static_cast<T>(1), table + ids[j] * row_width,
+                  out);
+      }
+    }
+  }
+};
+
+template <typename T>
+class FusionEmbeddingSeqPoolGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(ctx.InputVar("W")->IsType<LoDTensor>(),
+                   "The parameter W of FusionEmbeddingSeqPoolOp "
+                   "must be a LoDTensor.");
+    auto table_dims = ctx.Input<LoDTensor>("W")->dims();
+    auto* ids_t = ctx.Input<LoDTensor>("Ids");
+    auto* d_output = ctx.Input<LoDTensor>(framework::GradVarName("Out"));
+
+    auto& offsets = ids_t->lod()[0];
+    const int64_t num_seqs = static_cast<int64_t>(offsets.size()) - 1;
+    const int64_t row_width = table_dims[1];
+    const int64_t ids_numel = ids_t->numel();
+    const int64_t* ids = ids_t->data<int64_t>();
+    const T* d_output_data = d_output->data<T>();
+    int64_t padding_idx = ctx.Attr<int64_t>("padding_idx");
+    PADDLE_ENFORCE_EQ(d_output->dims()[0], num_seqs);
+
+    // Since paddings are not trainable and fixed in forward, the gradient of
+    // paddings makes no sense and we don't deal with it in backward.
+    if (ctx.Attr<bool>("is_sparse")) {
+      auto* d_table = ctx.Output<SelectedRows>(framework::GradVarName("W"));
+      framework::Vector<int64_t> new_rows;
+      new_rows.assign(ids, ids + ids_numel);
+      d_table->set_rows(new_rows);
+      d_table->set_height(table_dims[0]);
+
+      auto* d_table_value = d_table->mutable_value();
+      d_table_value->Resize({ids_numel, row_width});
+      T* d_table_data = d_table_value->mutable_data<T>(ctx.GetPlace());
+      size_t row_bytes = row_width * sizeof(T);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (FLAGS_paddle_num_threads > 1 && \
+                             ids_numel >= 2 * kMinIdsPerThread)
+#endif
+      for (int64_t i = 0; i < num_seqs; ++i) {
+        const T* src = d_output_data + i * row_width;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+          if (padding_idx != kNoPadding && ids[j] == padding_idx) {
+            memset(d_table_data + j * row_width, 0, row_bytes);
+          } else {
+            memcpy(d_table_data + j * row_width, src, row_bytes);
+          }
+        }
+      }
+    } else {
+      auto* d_table = ctx.Output<LoDTensor>(framework::GradVarName("W"));
+      T* d_table_data = d_table->mutable_data<T>(ctx.GetPlace());
+      memset(d_table_data, 0, d_table->numel() * sizeof(T));
+
+      CheckIds(ids, ids_numel, table_dims[0], padding_idx);
+      for (int64_t i = 0; i < num_seqs; ++i) {
+        const T* src = d_output_data + i * row_width;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+          if (padding_idx != kNoPadding && ids[j] == padding_idx) {
+            continue;
+          }
+          T* dst = d_table_data + ids[j] * row_width;
+          for (int64_t k = 0; k < row_width; ++k) {
+            dst[k] += src[k];
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_embedding_seq_pool, ops::FusionEmbeddingSeqPoolOp,
+                  ops::FusionEmbeddingSeqPoolGradDescMaker,
+                  ops::FusionEmbeddingSeqPoolOpMaker);
+REGISTER_OPERATOR(fusion_embedding_seq_pool_grad,
+                  ops::FusionEmbeddingSeqPoolGradOp,
+                  ops::FusionEmbeddingSeqPoolGradVarTypeInference);
+
+REGISTER_OP_CPU_KERNEL(fusion_embedding_seq_pool,
+                       ops::FusionEmbeddingSeqPoolKernel<float>,
+                       ops::FusionEmbeddingSeqPoolKernel<double>);
+REGISTER_OP_CPU_KERNEL(fusion_embedding_seq_pool_grad,
+                       ops::FusionEmbeddingSeqPoolGradKernel<float>,
+                       ops::FusionEmbeddingSeqPoolGradKernel<double>);
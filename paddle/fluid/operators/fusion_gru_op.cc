@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fusion_gru_op.h"
+#include <algorithm>
 #include <cstring>  // for memcpy
+#include <numeric>
 #include <string>
+#include <vector>
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/fc_compute.h"
@@ -233,58 +236,115 @@ class FusionGRUKernel : public framework::OpKernel<T> {
                                       xx_data,
                                       bias ? bias->data<T>() : nullptr);
 
-    int xx_offset = D3;
-    int gate_offset = D;
-    if (is_reverse) {
-      const int offset = (total_T - 1) * D;
-      xx_data = xx_data + offset * 3;
-      hidden_out_data = hidden_out_data + offset;
-      xx_offset = -D3;
-      gate_offset = -D;
+    // The two parts of the cell, before and after the GEMM of the reset
+    // hidden, where prev_hidden is nullptr for zeros.
+    // W: {W_update, W_reset; W_state}
+    std::function<void(const int, T*, const T*, T*)> gru_reset;
+    std::function<void(const int, T*, const T*, T*)> gru_output;
+    if (act_gate_str == "sigmoid" && act_state_str == "tanh") {
+      // In one pass over the gates.
+      if (platform::jit::MayIUse(platform::jit::avx512_common)) {
+        gru_reset = math::vec_gru_reset<T, platform::jit::avx512_common>;
+        gru_output = math::vec_gru_output<T, platform::jit::avx512_common>;
+      } else if (platform::jit::MayIUse(platform::jit::avx2)) {
+        gru_reset = math::vec_gru_reset<T, platform::jit::avx2>;
+        gru_output = math::vec_gru_output<T, platform::jit::avx2>;
+      } else if (platform::jit::MayIUse(platform::jit::avx)) {
+        gru_reset = math::vec_gru_reset<T, platform::jit::avx>;
+        gru_output = math::vec_gru_output<T, platform::jit::avx>;
+      } else {
+        gru_reset = math::vec_gru_reset<T, platform::jit::isa_any>;
+        gru_output = math::vec_gru_output<T, platform::jit::isa_any>;
+      }
+    } else {
+      gru_reset = [&](const int d, T* gates, const T* prev_hidden_data,
+                      T* reset_hidden_data) {
+        act_gate(D2, gates, gates);
+        if (prev_hidden_data) {
+          // rt = rt*ht_1
+          blas.VMUL(D, prev_hidden_data, gates + D, reset_hidden_data);
+        }
+      };
+      gru_output = [&](const int d, T* gates, const T* prev_hidden_data,
+                       T* hidden_data) {
+        act_state(D, gates + D2, gates + D2);
+        if (prev_hidden_data) {
+          // out = zt*ht~ + (1-zt)*ht_1
+          cross(D, gates, gates + D2, prev_hidden_data, hidden_data);
+        } else {
+          // out = a*b
+          blas.VMUL(D, gates, gates + D2, hidden_data);
+        }
+      };
     }
-    auto move_step = [&]() {
-      xx_data = xx_data + xx_offset;
-      hidden_out_data = hidden_out_data + gate_offset;
+
+    // The sequences run by steps together, the longest first, so that the
+    // sequences still running at a step are the first ones and their hidden
+    // are multiplied by WeightH in one GEMM.
+    std::vector<int> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    auto seq_len = [&](int bid) {
+      return static_cast<int>(x_lod[0][bid + 1] - x_lod[0][bid]);
     };
-    for (int i = 0; i < N; ++i) {
-      int bid = is_reverse ? N - 1 - i : i;
-      int seq_len = x_lod[0][bid + 1] - x_lod[0][bid];
-      const T* prev_hidden_data = nullptr;
-      int tstart = 0;
-      if (h0_data) {
-        prev_hidden_data = h0_data + bid * D;
-      } else {
-        // W: {W_update, W_reset; W_state}
-        // update gate
-        act_gate(D, xx_data, xx_data);
-        // state gate
-        act_state(D, xx_data + D2, xx_data + D2);
-        // out = a*b
-        blas.VMUL(D, xx_data, xx_data + D2, hidden_out_data);
-        // save prev
-        prev_hidden_data = hidden_out_data;
-        tstart = 1;
-        move_step();
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return seq_len(a) > seq_len(b);
+    });
+    // The buffers of the batch mode hold the gates, prev_hidden and
+    // reset_hidden of a step, so that they are not allocated by every run.
+    auto* batched_input = ctx.Output<LoDTensor>("BatchedInput");
+    auto* reordered_h0 = ctx.Output<Tensor>("ReorderedH0");
+    auto* batched_out = ctx.Output<LoDTensor>("BatchedOut");
+    T* gates_data = batched_input->mutable_data<T>(
+        framework::make_ddim({N, D3}), ctx.GetPlace());
+    T* prev_hidden_data = reordered_h0->mutable_data<T>(
+        framework::make_ddim({N, D}), ctx.GetPlace());
+    T* reset_hidden_data = batched_out->mutable_data<T>(
+        framework::make_ddim({N, D}), ctx.GetPlace());
+    std::vector<int> rows(N);
+
+    const int max_seq_len = N > 0 ? seq_len(order[0]) : 0;
+    for (int step = 0; step < max_seq_len; ++step) {
+      int batch_size = 0;
+      while (batch_size < N && seq_len(order[batch_size]) > step) {
+        ++batch_size;
+      }
+      bool has_prev = step > 0 || h0_data;
+      for (int i = 0; i < batch_size; ++i) {
+        int bid = order[i];
+        int offset = is_reverse ? seq_len(bid) - 1 - step : step;
+        rows[i] = static_cast<int>(x_lod[0][bid]) + offset;
+        std::memcpy(gates_data + i * D3, xx_data + rows[i] * D3,
+                    sizeof(T) * D3);
+        if (step > 0) {
+          int prev_row = is_reverse ? rows[i] + 1 : rows[i] - 1;
+          std::memcpy(prev_hidden_data + i * D,
+                      hidden_out_data + prev_row * D, sizeof(T) * D);
+        } else if (h0_data) {
+          std::memcpy(prev_hidden_data + i * D, h0_data + bid * D,
+                      sizeof(T) * D);
+        }
       }
-      for (int step = tstart; step < seq_len; ++step) {
+      if (has_prev) {
         // gemm prev * (Wu + Wr)
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D2, D, static_cast<T>(1),
-                  prev_hidden_data, D, wh_data, D2, static_cast<T>(1), xx_data,
-                  D3);
-        act_gate(D2, xx_data, xx_data);
-        // rt = rt*ht_1 inplace result
-        blas.VMUL(D, prev_hidden_data, xx_data + D, hidden_out_data);
-
+        blas.GEMM(CblasNoTrans, CblasNoTrans, batch_size, D2, D,
+                  static_cast<T>(1), prev_hidden_data, D, wh_data, D2,
+                  static_cast<T>(1), gates_data, D3);
+      }
+      for (int i = 0; i < batch_size; ++i) {
+        gru_reset(D, gates_data + i * D3,
+                  has_prev ? prev_hidden_data + i * D : nullptr,
+                  reset_hidden_data + i * D);
+      }
+      if (has_prev) {
         // gemm rt * Ws
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D, D, static_cast<T>(1),
-                  hidden_out_data, D, wh_state_data, D, static_cast<T>(1),
-                  xx_data + D2, D3);
-        act_state(D, xx_data + D2, xx_data + D2);
-        // out = zt*ht~ + (1-zt)*ht_1
-        cross(D, xx_data, xx_data + D2, prev_hidden_data, hidden_out_data);
-        // save prev
-        prev_hidden_data = hidden_out_data;
-        move_step();
+        blas.GEMM(CblasNoTrans, CblasNoTrans, batch_size, D, D,
+                  static_cast<T>(1), reset_hidden_data, D, wh_state_data, D,
+                  static_cast<T>(1), gates_data + D2, D3);
+      }
+      for (int i = 0; i < batch_size; ++i) {
+        gru_output(D, gates_data + i * D3,
+                   has_prev ? prev_hidden_data + i * D : nullptr,
+                   hidden_out_data + rows[i] * D);
       }
     }
   }
@@ -13,7 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fusion_lstm_op.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <string>
+#include <vector>
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/detail/activation_functions.h"
@@ -231,22 +235,6 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     auto* cell_out = ctx.Output<LoDTensor>("Cell");
     bool is_reverse = ctx.Attr<bool>("is_reverse");
 
-    std::function<void(const int, const T *, T *)> act_gate, act_cell, act_cand;
-    auto& act_gate_str = ctx.Attr<std::string>("gate_activation");
-    auto& act_cell_str = ctx.Attr<std::string>("cell_activation");
-    auto& act_cand_str = ctx.Attr<std::string>("candidate_activation");
-    if (platform::jit::MayIUse(platform::jit::avx)) {
-      math::VecActivations<T, platform::jit::avx> act_functor;
-      act_gate = act_functor(act_gate_str);
-      act_cell = act_functor(act_cell_str);
-      act_cand = act_functor(act_cand_str);
-    } else {
-      math::VecActivations<T, platform::jit::isa_any> act_functor;
-      act_gate = act_functor(act_gate_str);
-      act_cell = act_functor(act_cell_str);
-      act_cand = act_functor(act_cand_str);
-    }
-
     auto x_lod = x->lod();
     auto x_dims = x->dims();    // T x M
     auto wh_dims = wh->dims();  // D x 4D
@@ -270,76 +258,118 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
     math::FCCompute<DeviceContext, T>(blas, total_T, D4, M, x_data, wx_data,
                                       xx_data, bias->data<T>());
-    int xx_offset = D4;
-    int gate_offset = D;
-    if (is_reverse) {
-      const int offset = (total_T - 1) * D;
-      xx_data = xx_data + offset * 4;
-      hidden_out_data = hidden_out_data + offset;
-      cell_out_data = cell_out_data + offset;
-      xx_offset = -D4;
-      gate_offset = -D;
-    }
 
-    auto move_step = [&]() {
-      xx_data = xx_data + xx_offset;
-      hidden_out_data = hidden_out_data + gate_offset;
-      cell_out_data = cell_out_data + gate_offset;
-    };
-
-    for (int i = 0; i < N; ++i) {
-      int bid = is_reverse ? N - 1 - i : i;
-      int seq_len = x_lod[0][bid + 1] - x_lod[0][bid];
-      const T* prev_cell_data = NULL;
-      const T* prev_hidden_data = NULL;
-      int tstart = 0;
-      if (h0_data) {
-        prev_hidden_data = h0_data + bid * D;
-        prev_cell_data = c0_data + bid * D;
+    // The cell of the gates, which may be changed, and of prev_cell, which is
+    // NULL for zeros.
+    std::function<void(const int, T*, const T*, T*, T*)> lstm_cell;
+    auto& act_gate_str = ctx.Attr<std::string>("gate_activation");
+    auto& act_cell_str = ctx.Attr<std::string>("cell_activation");
+    auto& act_cand_str = ctx.Attr<std::string>("candidate_activation");
+    std::function<void(const int, const T *, T *)> act_gate, act_cell, act_cand;
+    if (platform::jit::MayIUse(platform::jit::avx)) {
+      math::VecActivations<T, platform::jit::avx> act_functor;
+      act_gate = act_functor(act_gate_str);
+      act_cell = act_functor(act_cell_str);
+      act_cand = act_functor(act_cand_str);
+    } else {
+      math::VecActivations<T, platform::jit::isa_any> act_functor;
+      act_gate = act_functor(act_gate_str);
+      act_cell = act_functor(act_cell_str);
+      act_cand = act_functor(act_cand_str);
+    }
+    if (act_gate_str == "sigmoid" && act_cell_str == "tanh" &&
+        act_cand_str == "tanh") {
+      // In one pass over the gates.
+      if (platform::jit::MayIUse(platform::jit::avx512_common)) {
+        lstm_cell = math::vec_lstm_cell<T, platform::jit::avx512_common>;
+      } else if (platform::jit::MayIUse(platform::jit::avx2)) {
+        lstm_cell = math::vec_lstm_cell<T, platform::jit::avx2>;
+      } else if (platform::jit::MayIUse(platform::jit::avx)) {
+        lstm_cell = math::vec_lstm_cell<T, platform::jit::avx>;
       } else {
-        // W_ch, W_ih, W_fh, W_oh
-        act_gate(D3, xx_data + D, xx_data + D);
-        act_cand(D, xx_data, xx_data);
-        // cell out= input*tilde
-        blas.VMUL(D, xx_data, xx_data + D, cell_out_data);
-        // hidden out= act_state(cellout) * outgate
-        act_cell(D, cell_out_data, xx_data + D2);
-        blas.VMUL(D, xx_data + D2, xx_data + D3, hidden_out_data);
-
-        // prev
-        prev_hidden_data = hidden_out_data;
-        prev_cell_data = cell_out_data;
-        tstart = 1;
-
-        move_step();
+        lstm_cell = math::vec_lstm_cell<T, platform::jit::isa_any>;
       }
-      for (int step = tstart; step < seq_len; ++step) {
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D4, D, static_cast<T>(1),
-                  prev_hidden_data, D, wh_data, D4, static_cast<T>(1), xx_data,
-                  D4);
-
+    } else {
+      lstm_cell = [&](const int d, T* gates, const T* prev_cell_data,
+                      T* cell_data, T* hidden_data) {
         // W_ch, W_ih, W_fh, W_oh
-        act_gate(D3, xx_data + D, xx_data + D);
-        act_cand(D, xx_data, xx_data);
-
-        // a = forget * prev_cell
-        blas.VMUL(D, xx_data + D2, prev_cell_data, xx_data + D2);
-
-        // b = input * tilde
-        blas.VMUL(D, xx_data, xx_data + D, xx_data + D);
-
-        // cell out= a+b
-        blas.VADD(D, xx_data + D, xx_data + D2, cell_out_data);
-
+        act_gate(D3, gates + D, gates + D);
+        act_cand(D, gates, gates);
+        if (prev_cell_data) {
+          // a = forget * prev_cell
+          blas.VMUL(D, gates + D2, prev_cell_data, gates + D2);
+          // b = input * tilde
+          blas.VMUL(D, gates, gates + D, gates + D);
+          // cell out= a+b
+          blas.VADD(D, gates + D, gates + D2, cell_data);
+        } else {
+          // cell out= input*tilde
+          blas.VMUL(D, gates, gates + D, cell_data);
+        }
         // hidden out= act_state(cellout) * outgate
-        act_cell(D, cell_out_data, xx_data + D2);
-        blas.VMUL(D, xx_data + D2, xx_data + D3, hidden_out_data);
-
-        // prev
-        prev_hidden_data = hidden_out_data;
-        prev_cell_data = cell_out_data;
+        act_cell(D, cell_data, gates + D2);
+        blas.VMUL(D, gates + D2, gates + D3, hidden_data);
+      };
+    }
 
-        move_step();
+    // The sequences run by steps together, the longest first, so that the
+    // sequences still running at a step are the first ones and their hidden
+    // are multiplied by WeightH in one GEMM.
+    std::vector<int> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    auto seq_len = [&](int bid) {
+      return static_cast<int>(x_lod[0][bid + 1] - x_lod[0][bid]);
+    };
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return seq_len(a) > seq_len(b);
+    });
+    // The buffers of the batch mode hold the gates and prev_hidden of a step,
+    // so that they are not allocated by every run.
+    auto* batched_gate = ctx.Output<LoDTensor>("BatchedGate");
+    auto* batched_prev_hidden = ctx.Output<LoDTensor>("BatchCellPreAct");
+    T* gates_data = batched_gate->mutable_data<T>(framework::make_ddim({N, D4}),
+                                                  ctx.GetPlace());
+    T* prev_hidden_data = batched_prev_hidden->mutable_data<T>(
+        framework::make_ddim({N, D}), ctx.GetPlace());
+    std::vector<int> rows(N);
+    std::vector<const T*> prev_cell_data(N);
+
+    const int max_seq_len = N > 0 ? seq_len(order[0]) : 0;
+    for (int step = 0; step < max_seq_len; ++step) {
+      int batch_size = 0;
+      while (batch_size < N && seq_len(order[batch_size]) > step) {
+        ++batch_size;
+      }
+      bool has_prev = step > 0 || h0_data;
+      for (int i = 0; i < batch_size; ++i) {
+        int bid = order[i];
+        int offset = is_reverse ? seq_len(bid) - 1 - step : step;
+        rows[i] = static_cast<int>(x_lod[0][bid]) + offset;
+        std::memcpy(gates_data + i * D4, xx_data + rows[i] * D4,
+                    sizeof(T) * D4);
+        const T* prev_hidden = NULL;
+        if (step > 0) {
+          int prev_row = is_reverse ? rows[i] + 1 : rows[i] - 1;
+          prev_hidden = hidden_out_data + prev_row * D;
+          prev_cell_data[i] = cell_out_data + prev_row * D;
+        } else if (h0_data) {
+          prev_hidden = h0_data + bid * D;
+          prev_cell_data[i] = c0_data + bid * D;
+        } else {
+          prev_cell_data[i] = NULL;
+        }
+        if (has_prev) {
+          std::memcpy(prev_hidden_data + i * D, prev_hidden, sizeof(T) * D);
+        }
+      }
+      if (has_prev) {
+        blas.GEMM(CblasNoTrans, CblasNoTrans, batch_size, D4, D,
+                  static_cast<T>(1), prev_hidden_data, D, wh_data, D4,
+                  static_cast<T>(1), gates_data, D4);
+      }
+      for (int i = 0; i < batch_size; ++i) {
+        lstm_cell(D, gates_data + i * D4, prev_cell_data[i],
+                  cell_out_data + rows[i] * D, hidden_out_data + rows[i] * D);
       }
     }
   }
@@ -175,6 +175,88 @@ void ListenAndServOp::RunSyncLoop(
   }  // while(true)
 }
 
+void ListenAndServOp::RunPipelinedSyncLoop(
+    framework::Executor *executor, framework::ProgramDesc *program,
+    framework::Scope *recv_scope) const {
+  VLOG(2) << "RunPipelinedSyncLoop";
+  size_t num_blocks = program->Size();
+  auto optimize_blocks =
+      Attr<std::vector<framework::BlockDesc *>>(kOptimizeBlocks);
+  PADDLE_ENFORCE_GE(num_blocks, 2,
+                    "server program should have at least 2 blocks");
+
+  std::vector<int> optimize_blocks_list;
+  for (size_t i = 1; i < program->Size(); ++i) {
+    optimize_blocks_list.push_back(i);
+  }
+  auto optimize_prepared = executor->Prepare(*program, optimize_blocks_list);
+  optimize_prepared.insert(
+      optimize_prepared.begin(),
+      std::shared_ptr<framework::ExecutorPrepareContext>(nullptr));
+
+  pipeline_.reset(new distributed::OptimizePipeline(
+      [executor, &optimize_prepared, recv_scope](int block_id) {
+        executor->RunPreparedContext(optimize_prepared[block_id].get(),
+                                     recv_scope);
+      }));
+  // The variables sent by the trainers are the inputs of this op.
+  auto &recv_inputs = Inputs("X");
+  std::set<std::string> recv_vars(recv_inputs.begin(), recv_inputs.end());
+  for (auto *block : optimize_blocks) {
+    std::set<std::string> block_recv_vars;
+    std::set<std::string> block_out_vars;
+    for (auto *op : block->AllOps()) {
+      for (auto &name : op->InputArgumentNames()) {
+        if (recv_vars.count(name)) {
+          block_recv_vars.insert(name);
+        }
+      }
+      for (auto &name : op->OutputArgumentNames()) {
+        block_out_vars.insert(name);
+      }
+    }
+    pipeline_->AddBlock(block->ID(), block_recv_vars, block_out_vars);
+  }
+  request_send_handler_->SetOptimizePipeline(pipeline_.get());
+  request_get_handler_->SetOptimizePipeline(pipeline_.get());
+
+  // Trainers will get all parameters from pserver in the
+  // startup program, so we will wait RequestGet first
+  rpc_service_->SetCond(distributed::kRequestGet);
+  rpc_service_->WaitBarrier(distributed::kRequestGet);
+  rpc_service_->ResetBarrierCounter();
+  while (true) {
+    rpc_service_->Profiler().OneStep();
+    pipeline_->StartStep();
+    rpc_service_->SetCond(distributed::kRequestSend);
+    rpc_service_->WaitBarrier(distributed::kRequestSend);
+
+    if (rpc_service_->IsExit()) {
+      LOG(WARNING) << "get exit!rpc_processor break!";
+      pipeline_->Stop();
+      rpc_service_->SetCond(distributed::kRequestGet);
+      break;
+    }
+
+    // Close the sends before the rest of the step runs. A trainer may fetch
+    // its parameters meanwhile, and its gradients of the next step must wait
+    // for StartStep rather than be taken as received in this one.
+    rpc_service_->SetCond(distributed::kRequestGet);
+
+    double ts = GetTimestamp();
+    pipeline_->FinishStep();
+    VLOG(2) << "run blocks after the barrier spent " << GetTimestamp() - ts
+            << "(ms)";
+
+    // reset received sparse vars to avoid reuse it in the next mini-batch
+    dynamic_cast<distributed::RequestSendHandler *>(request_send_handler_.get())
+        ->ResetSparseVarRecorder();
+
+    rpc_service_->WaitBarrier(distributed::kRequestGet);
+    rpc_service_->ResetBarrierCounter();
+  }  // while(true)
+}
+
 void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
                                    framework::ProgramDesc *program,
                                    framework::Scope *recv_scope) const {
@@ -350,7 +432,9 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
 
   // Write to a file of server selected port for python use.
   SavePort();
-  if (sync_mode) {
+  if (sync_mode && Attr<bool>("pipelined")) {
+    RunPipelinedSyncLoop(&executor, program, &recv_scope);
+  } else if (sync_mode) {
     RunSyncLoop(&executor, program, &recv_scope, prefetch_block_id_list,
                 checkpoint_block_id);
   } else {
@@ -376,6 +460,11 @@ class ListenAndServOpMaker : public framework::OpProtoAndCheckerMaker {
         "a map from grad name to it's optimize block id")
         .SetDefault({});
     AddAttr<bool>("sync_mode", "if works at sync_mode or not").SetDefault(true);
+    AddAttr<bool>("pipelined",
+                  "In sync_mode, run each optimize block once its gradients "
+                  "are received from all the trainers, and send the "
+                  "parameters it updates without waiting for the others.")
+        .SetDefault(false);
     AddAttr<std::vector<framework::BlockDesc *>>(
         kOptimizeBlocks, "Optimize blocks to run on server side.")
         .SetDefault({});
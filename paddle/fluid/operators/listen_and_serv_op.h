@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/optimize_pipeline.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
 
@@ -51,6 +52,12 @@ class ListenAndServOp : public framework::OperatorBase {
                    const std::vector<int>& prefetch_block_id_list,
                    const int checkpoint_point_block_id) const;
 
+  // Runs every optimize block as soon as the gradients it reads have been
+  // received from all the trainers, rather than after the batch barrier.
+  void RunPipelinedSyncLoop(framework::Executor* executor,
+                            framework::ProgramDesc* program,
+                            framework::Scope* recv_scope) const;
+
   void RunAsyncLoop(framework::Executor* executor,
                     framework::ProgramDesc* program,
                     framework::Scope* recv_scope) const;
@@ -74,6 +81,7 @@ class ListenAndServOp : public framework::OperatorBase {
       request_checkpoint_handler_;
 
   mutable std::shared_ptr<std::thread> server_thread_;
+  mutable std::unique_ptr<distributed::OptimizePipeline> pipeline_;
 };
 
 class SignalHandler {
@@ -11,14 +11,64 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/macros.h"
 
 namespace paddle {
 namespace operators {
 
+#if !defined(_WIN32)
+// A file mapped into memory, which is unmapped when the last tensor sharing
+// it is destroyed. The mapping is private, so its pages are shared by all
+// the processes mapping the file, and a tensor writing to them gets private
+// copies of the written pages instead of changing the file.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    PADDLE_ENFORCE_NE(fd, -1, "Cannot open file %s for load_combine op",
+                      filename);
+    struct stat st;
+    PADDLE_ENFORCE_EQ(fstat(fd, &st), 0, "Cannot stat file %s", filename);
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *addr =
+          mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      PADDLE_ENFORCE(addr != MAP_FAILED, "Cannot mmap file %s", filename);
+      data_ = static_cast<char *>(addr);
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char *data_{nullptr};
+  size_t size_{0};
+
+  DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+#endif
+
 class LoadCombineOp : public framework::OperatorBase {
  public:
   LoadCombineOp(const std::string &type,
@@ -32,25 +82,51 @@ class LoadCombineOp : public framework::OperatorBase {
                const platform::Place &place) const override {
     auto filename = Attr<std::string>("file_path");
     auto load_as_fp16 = Attr<bool>("load_as_fp16");
-
-    std::ifstream fin(filename);
-    PADDLE_ENFORCE(static_cast<bool>(fin),
-                   "Cannot open file %s for load_combine op", filename);
+    auto use_mmap = Attr<bool>("use_mmap") && platform::is_cpu_place(place);
 
     auto out_var_names = Outputs("Out");
     PADDLE_ENFORCE_GT(
         static_cast<int>(out_var_names.size()), 0,
         "The number of output variables should be greater than 0.");
 
-    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
-    auto &dev_ctx = *pool.Get(place);
+    std::vector<framework::Variable *> out_vars;
+    for (auto &name : out_var_names) {
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      out_vars.push_back(out_var);
+    }
 
-    for (size_t i = 0; i < out_var_names.size(); i++) {
-      auto *out_var = scope.FindVar(out_var_names[i]);
+#if !defined(_WIN32)
+    if (use_mmap) {
+      std::shared_ptr<MappedFile> file(new MappedFile(filename));
+      const char *pos = file->data();
+      size_t left = file->size();
+      for (auto *out_var : out_vars) {
+        PADDLE_ENFORCE_GT(left, 0UL, "Cannot read more from file %s",
+                          filename);
+        size_t read = framework::DeserializeFromBuffer(
+            pos, left, file, out_var->GetMutable<framework::LoDTensor>());
+        pos += read;
+        left -= read;
+        ConvertDataType(out_var, load_as_fp16, place);
+      }
+      return;
+    }
+#else
+    if (use_mmap) {
+      VLOG(3) << "use_mmap is not supported on Windows, read " << filename;
+    }
+#endif
 
-      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
-                     out_var_names[i]);
+    std::ifstream fin(filename, std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin),
+                   "Cannot open file %s for load_combine op", filename);
 
+    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
+    auto &dev_ctx = *pool.Get(place);
+
+    for (auto *out_var : out_vars) {
       auto *tensor = out_var->GetMutable<framework::LoDTensor>();
 
       // Error checking
@@ -60,26 +136,31 @@ class LoadCombineOp : public framework::OperatorBase {
       // Get data from fin to tensor
       DeserializeFromStream(fin, tensor, dev_ctx);
 
-      auto in_dtype = framework::ToDataType(tensor->type());
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_var->Clear();
-        tensor = out_var->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
-      }
+      ConvertDataType(out_var, load_as_fp16, place);
+    }
+  }
+
+  void ConvertDataType(framework::Variable *out_var, bool load_as_fp16,
+                       const platform::Place &place) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = framework::ToDataType(tensor->type());
+    auto out_dtype = load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      framework::LoDTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                               &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<framework::LoDTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
     }
   }
 };
@@ -98,6 +179,15 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
         "converted to float16 data type. Otherwise, the tensor will be "
         "directly loaded without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>(
+        "use_mmap",
+        "(boolean, default false)"
+        "If true and the place is CPU, the file is mapped into memory and "
+        "the tensors share their data with the mapped pages instead of "
+        "copying them, so all the processes loading the file share one "
+        "physical copy. The data of a tensor is still copied if it is not "
+        "aligned to its data type, see data_alignment of save_combine.")
+        .SetDefault(false);
     AddAttr<std::string>("file_path",
                          "(string) "
                          "LoDTensors will be loaded from \"file_path\".")
@@ -14,14 +14,20 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 
+DECLARE_int32(paddle_num_threads);
+
 namespace paddle {
 namespace operators {
 
@@ -32,6 +38,63 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
+// Ids are random, so the hardware prefetcher cannot guess the next rows.
+// The row copied kPrefetchDistance ids later is prefetched instead.
+constexpr int64_t kPrefetchDistance = 8;
+
+// Prefetches the cache line at addr for reading. It compiles to nothing on
+// the compilers without a prefetch intrinsic.
+inline void PrefetchRow(const void *addr) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char *>(addr), _MM_HINT_T0);
+#elif defined(__GNUC__)
+  __builtin_prefetch(addr);
+#endif
+}
+
+// Running a lookup on several threads only pays off for large batches.
+constexpr int64_t kMinIdsPerThread = 4096;
+
+// Checks all ids once before the rows are copied, which keeps the copy loop
+// free of branches that may throw.
+inline void CheckIds(const int64_t *ids, int64_t ids_numel, int64_t row_number,
+                     int64_t padding_idx) {
+  int64_t min_id = 0;
+  int64_t max_id = 0;
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    int64_t id =
+        padding_idx != kNoPadding && ids[i] == padding_idx ? 0 : ids[i];
+    min_id = std::min(min_id, id);
+    max_id = std::max(max_id, id);
+  }
+  PADDLE_ENFORCE_GE(min_id, 0, "The ids of LookupTable should be >= 0.");
+  PADDLE_ENFORCE_LT(max_id, row_number,
+                    "The ids of LookupTable should be < the height of W.");
+}
+
+// Copies the row rows[i] of table to output row i, or fills the output row
+// with zeros if rows[i] is kNoPadding.
+template <typename T>
+void GatherRows(const T *table, const int64_t *rows, int64_t rows_numel,
+                int64_t row_width, T *output) {
+  size_t row_bytes = row_width * sizeof(T);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (FLAGS_paddle_num_threads > 1 && \
+                             rows_numel >= 2 * kMinIdsPerThread)
+#endif
+  for (int64_t i = 0; i < rows_numel; ++i) {
+    if (i + kPrefetchDistance < rows_numel &&
+        rows[i + kPrefetchDistance] != kNoPadding) {
+      PrefetchRow(table + rows[i + kPrefetchDistance] * row_width);
+    }
+    if (rows[i] == kNoPadding) {
+      memset(output + i * row_width, 0, row_bytes);
+    } else {
+      memcpy(output + i * row_width, table + rows[i] * row_width, row_bytes);
+    }
+  }
+}
+
 template <typename T>
 class LookupTableKernel : public framework::OpKernel<T> {
  public:
@@ -41,7 +104,7 @@ class LookupTableKernel : public framework::OpKernel<T> {
     auto *table_var = context.InputVar("W");
 
     int64_t padding_idx = context.Attr<int64_t>("padding_idx");
-    int64_t *ids = const_cast<int64_t *>(ids_t->data<int64_t>());
+    const int64_t *ids = ids_t->data<int64_t>();
     int64_t ids_numel = ids_t->numel();
 
     if (table_var->IsType<LoDTensor>()) {
@@ -52,15 +115,13 @@ class LookupTableKernel : public framework::OpKernel<T> {
       auto *table = table_t->data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-      for (int64_t i = 0; i < ids_numel; ++i) {
-        if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-          memset(output + i * row_width, 0, row_width * sizeof(T));
-        } else {
-          PADDLE_ENFORCE_LT(ids[i], row_number);
-          PADDLE_ENFORCE_GE(ids[i], 0);
-          memcpy(output + i * row_width, table + ids[i] * row_width,
-                 row_width * sizeof(T));
-        }
+      CheckIds(ids, ids_numel, row_number, padding_idx);
+      if (padding_idx == kNoPadding) {
+        GatherRows(table, ids, ids_numel, row_width, output);
+      } else {
+        std::vector<int64_t> rows(ids, ids + ids_numel);
+        std::replace(rows.begin(), rows.end(), padding_idx, kNoPadding);
+        GatherRows(table, rows.data(), ids_numel, row_width, output);
       }
     } else if (table_var->IsType<SelectedRows>()) {
       const auto &table_t = table_var->Get<SelectedRows>();
@@ -68,17 +129,18 @@ class LookupTableKernel : public framework::OpKernel<T> {
       const auto *table = table_t.value().data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
+      // Resolve the indices before copying, since looking up the index of a
+      // SelectedRows takes its lock.
+      std::vector<int64_t> rows(ids_numel);
       for (int64_t i = 0; i < ids_numel; ++i) {
         if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-          memset(output + i * row_width, 0, row_width * sizeof(T));
+          rows[i] = kNoPadding;
         } else {
           PADDLE_ENFORCE_GE(ids[i], 0);
-          auto id_index = table_t.Index(ids[i]);
-          PADDLE_ENFORCE_GE(id_index, 0, "the input key should be exists.");
-          memcpy(output + i * row_width, table + id_index * row_width,
-                 row_width * sizeof(T));
+          rows[i] = table_t.Index(ids[i]);
         }
       }
+      GatherRows(table, rows.data(), ids_numel, row_width, output);
     }
   }
 };
@@ -112,10 +174,7 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
       int64_t ids_num = ids->numel();
 
       framework::Vector<int64_t> new_rows;
-      new_rows.reserve(ids_num);
-      for (int64_t i = 0; i < ids_num; i++) {
-        new_rows.push_back(ids_data[i]);
-      }
+      new_rows.assign(ids_data, ids_data + ids_num);
       d_table->set_rows(new_rows);
 
       auto *d_table_value = d_table->mutable_value();
@@ -147,11 +206,12 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
 
       memset(d_table_data, 0, d_table->numel() * sizeof(T));
 
+      CheckIds(ids_data, ids->numel(), N, kNoPadding);
       for (int64_t i = 0; i < ids->numel(); ++i) {
-        PADDLE_ENFORCE_LT(ids_data[i], N);
-        PADDLE_ENFORCE_GE(ids_data[i], 0);
+        T *dst = d_table_data + ids_data[i] * D;
+        const T *src = d_output_data + i * D;
         for (int j = 0; j < D; ++j) {
-          d_table_data[ids_data[i] * D + j] += d_output_data[i * D + j];
+          dst[j] += src[j];
         }
       }
     }
@@ -0,0 +1,172 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>  // NOLINT
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+
+USE_OP(lookup_table);
+USE_OP(sequence_pool);
+USE_CPU_ONLY_OP(fusion_embedding_seq_pool);
+
+namespace paddle {
+namespace operators {
+
+namespace f = paddle::framework;
+namespace p = paddle::platform;
+
+// The lookup kernel before the ids were checked up front and the rows were
+// copied on several threads.
+void ScalarLookup(const float* table, int64_t row_number, int64_t row_width,
+                  const int64_t* ids, int64_t ids_numel, float* output) {
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    PADDLE_ENFORCE_LT(ids[i], row_number);
+    PADDLE_ENFORCE_GE(ids[i], 0);
+    memcpy(output + i * row_width, table + ids[i] * row_width,
+           row_width * sizeof(float));
+  }
+}
+
+class LookupTableTest : public ::testing::Test {
+ protected:
+  void Prepare(int64_t row_number, int64_t row_width, int64_t num_seqs,
+               int64_t max_seq_len) {
+    std::mt19937 rng(0);
+    auto* table = scope_.Var("W")->GetMutable<f::LoDTensor>();
+    table->Resize({row_number, row_width});
+    float* table_data = table->mutable_data<float>(place_);
+    std::uniform_real_distribution<float> value(-1, 1);
+    for (int64_t i = 0; i < table->numel(); ++i) {
+      table_data[i] = value(rng);
+    }
+
+    f::LoD lod(1, {0});
+    std::uniform_int_distribution<int64_t> seq_len(1, max_seq_len);
+    for (int64_t i = 0; i < num_seqs; ++i) {
+      lod[0].push_back(lod[0].back() + seq_len(rng));
+    }
+    auto* ids = scope_.Var("Ids")->GetMutable<f::LoDTensor>();
+    ids->set_lod(lod);
+    ids->Resize({static_cast<int64_t>(lod[0].back()), 1});
+    int64_t* ids_data = ids->mutable_data<int64_t>(place_);
+    std::uniform_int_distribution<int64_t> id(0, row_number - 1);
+    for (int64_t i = 0; i < ids->numel(); ++i) {
+      ids_data[i] = id(rng);
+    }
+  }
+
+  void Run(const std::string& type, const f::VariableNameMap& inputs,
+           const std::string& output, const f::AttributeMap& attrs) {
+    scope_.Var(output)->GetMutable<f::LoDTensor>();
+    auto op = f::OpRegistry::CreateOp(type, inputs, {{"Out", {output}}}, attrs);
+    op->Run(scope_, place_);
+  }
+
+  void RunLookupTable() {
+    Run("lookup_table", {{"W", {"W"}}, {"Ids", {"Ids"}}}, "Emb", {});
+  }
+
+  void RunSeqPool() {
+    scope_.Var("MaxIndex")->GetMutable<f::LoDTensor>();
+    auto op = f::OpRegistry::CreateOp(
+        "sequence_pool", {{"X", {"Emb"}}},
+        {{"Out", {"Pooled"}}, {"MaxIndex", {"MaxIndex"}}},
+        {{"pooltype", std::string("SUM")}});
+    scope_.Var("Pooled")->GetMutable<f::LoDTensor>();
+    op->Run(scope_, place_);
+  }
+
+  void RunFused() {
+    Run("fusion_embedding_seq_pool", {{"W", {"W"}}, {"Ids", {"Ids"}}},
+        "FusedPooled", {});
+  }
+
+  const f::LoDTensor& Get(const std::string& name) {
+    return scope_.FindVar(name)->Get<f::LoDTensor>();
+  }
+
+  f::Scope scope_;
+  p::CPUPlace place_;
+};
+
+TEST_F(LookupTableTest, LookupAndFusedPool) {
+  Prepare(1000, 33, 50, 20);
+  RunLookupTable();
+  RunSeqPool();
+  RunFused();
+
+  auto& table = Get("W");
+  auto& ids = Get("Ids");
+  auto& emb = Get("Emb");
+  std::vector<float> expected(ids.numel() * 33);
+  ScalarLookup(table.data<float>(), 1000, 33, ids.data<int64_t>(), ids.numel(),
+               expected.data());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], emb.data<float>()[i]);
+  }
+
+  auto& pooled = Get("Pooled");
+  auto& fused = Get("FusedPooled");
+  ASSERT_EQ(pooled.dims(), fused.dims());
+  ASSERT_EQ(fused.dims()[0], 50);
+  for (int64_t i = 0; i < fused.numel(); ++i) {
+    ASSERT_NEAR(pooled.data<float>()[i], fused.data<float>()[i], 1e-5);
+  }
+}
+
+TEST_F(LookupTableTest, DISABLED_Benchmark) {
+  const int64_t kNumIds = 100000;
+  const int kRepeat = 10;
+  for (int64_t row_width : {64, 512}) {
+    Prepare(100000, row_width, kNumIds / 20, 39);
+    auto& table = Get("W");
+    auto& ids = Get("Ids");
+    std::vector<float> output(ids.numel() * row_width);
+
+    auto time_ms = [&](std::function<void()> fn) {
+      fn();
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kRepeat; ++i) {
+        fn();
+      }
+      auto end = std::chrono::steady_clock::now();
+      return std::chrono::duration<double, std::milli>(end - start).count() /
+             kRepeat;
+    };
+    double scalar = time_ms([&] {
+      ScalarLookup(table.data<float>(), 100000, row_width,
+                   ids.data<int64_t>(), ids.numel(), output.data());
+    });
+    double lookup = time_ms([&] { RunLookupTable(); });
+    double unfused = time_ms([&] {
+      RunLookupTable();
+      RunSeqPool();
+    });
+    double fused = time_ms([&] { RunFused(); });
+    LOG(INFO) << ids.numel() << " ids of width " << row_width
+              << ": scalar lookup " << scalar << " ms, lookup_table " << lookup
+              << " ms, lookup_table + sequence_pool " << unfused
+              << " ms, fusion_embedding_seq_pool " << fused << " ms";
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -460,6 +460,367 @@ inline void vec_relu<float, platform::jit::avx512_common>(const int n,
   vec_relu<float, platform::jit::avx2>(n, x, y);
 }
 
+template <typename T>
+inline T scalar_sigmoid(T x) {
+  const T min = SIGMOID_THRESHOLD_MIN;
+  const T max = SIGMOID_THRESHOLD_MAX;
+  x = (x < min) ? min : ((x > max) ? max : x);
+  return static_cast<T>(1) / (static_cast<T>(1) + std::exp(-x));
+}
+
+template <typename T>
+inline T scalar_tanh(T x) {
+  return static_cast<T>(2) * scalar_sigmoid(static_cast<T>(2) * x) -
+         static_cast<T>(1);
+}
+
+// The polynomial of exp in the Cephes library, which is
+// exp(x) = 2^n * exp(r), n = round(x / ln2), r = x - n * ln2.
+constexpr float kExpMaxInput = 88.3762626647949f;
+constexpr float kExpLog2e = 1.44269504088896341f;
+constexpr float kExpLn2Hi = 0.693359375f;
+constexpr float kExpLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500E-4f;
+constexpr float kExpP1 = 1.3981999507E-3f;
+constexpr float kExpP2 = 8.3334519073E-3f;
+constexpr float kExpP3 = 4.1665795894E-2f;
+constexpr float kExpP4 = 1.6666665459E-1f;
+constexpr float kExpP5 = 5.0000001201E-1f;
+
+#ifdef __AVX__
+inline __m256 avx_exp(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  x = _mm256_min_ps(x, _mm256_set1_ps(kExpMaxInput));
+  x = _mm256_max_ps(x, _mm256_set1_ps(-kExpMaxInput));
+  __m256 n = _mm256_floor_ps(_mm256_add_ps(
+      _mm256_mul_ps(x, _mm256_set1_ps(kExpLog2e)), _mm256_set1_ps(0.5f)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(kExpLn2Hi)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(kExpLn2Lo)));
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(kExpP1));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(kExpP2));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(kExpP3));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(kExpP4));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(kExpP5));
+  y = _mm256_add_ps(_mm256_mul_ps(y, _mm256_mul_ps(x, x)),
+                    _mm256_add_ps(x, one));
+  // 2^n by its exponent bits.
+  __m256i e = _mm256_cvttps_epi32(n);
+#ifdef __AVX2__
+  e = _mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(127)), 23);
+#else
+  // No integer instructions of 256 bits, so by the halves.
+  const __m128i bias = _mm_set1_epi32(127);
+  __m128i lo = _mm_slli_epi32(
+      _mm_add_epi32(_mm256_extractf128_si256(e, 0), bias), 23);
+  __m128i hi = _mm_slli_epi32(
+      _mm_add_epi32(_mm256_extractf128_si256(e, 1), bias), 23);
+  e = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+#endif
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+}
+
+inline __m256 avx_sigmoid(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  x = _mm256_min_ps(x, _mm256_set1_ps(SIGMOID_THRESHOLD_MAX));
+  x = _mm256_max_ps(x, _mm256_set1_ps(SIGMOID_THRESHOLD_MIN));
+  x = avx_exp(_mm256_sub_ps(_mm256_setzero_ps(), x));
+  return _mm256_div_ps(one, _mm256_add_ps(one, x));
+}
+
+inline __m256 avx_tanh(__m256 x) {
+  const __m256 two = _mm256_set1_ps(2.f);
+  x = avx_sigmoid(_mm256_mul_ps(two, x));
+  return _mm256_sub_ps(_mm256_mul_ps(two, x), _mm256_set1_ps(1.f));
+}
+#endif
+
+#ifdef __AVX512F__
+inline __m512 avx512_exp(__m512 x) {
+  const __m512 one = _mm512_set1_ps(1.f);
+  x = _mm512_min_ps(x, _mm512_set1_ps(kExpMaxInput));
+  x = _mm512_max_ps(x, _mm512_set1_ps(-kExpMaxInput));
+  __m512 n = _mm512_roundscale_ps(
+      _mm512_add_ps(_mm512_mul_ps(x, _mm512_set1_ps(kExpLog2e)),
+                    _mm512_set1_ps(0.5f)),
+      _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  x = _mm512_sub_ps(x, _mm512_mul_ps(n, _mm512_set1_ps(kExpLn2Hi)));
+  x = _mm512_sub_ps(x, _mm512_mul_ps(n, _mm512_set1_ps(kExpLn2Lo)));
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, one));
+  __m512i e = _mm512_slli_epi32(
+      _mm512_add_epi32(_mm512_cvttps_epi32(n), _mm512_set1_epi32(127)), 23);
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(e));
+}
+
+inline __m512 avx512_sigmoid(__m512 x) {
+  const __m512 one = _mm512_set1_ps(1.f);
+  x = _mm512_min_ps(x, _mm512_set1_ps(SIGMOID_THRESHOLD_MAX));
+  x = _mm512_max_ps(x, _mm512_set1_ps(SIGMOID_THRESHOLD_MIN));
+  x = avx512_exp(_mm512_sub_ps(_mm512_setzero_ps(), x));
+  return _mm512_div_ps(one, _mm512_add_ps(one, x));
+}
+
+inline __m512 avx512_tanh(__m512 x) {
+  const __m512 two = _mm512_set1_ps(2.f);
+  x = avx512_sigmoid(_mm512_mul_ps(two, x));
+  return _mm512_sub_ps(_mm512_mul_ps(two, x), _mm512_set1_ps(1.f));
+}
+#endif
+
+// The element i of vec_lstm_cell.
+template <typename T>
+inline void lstm_cell_at(const int i, const int d, const T* gates,
+                         const T* prev_c, T* c, T* h) {
+  T cell = scalar_sigmoid(gates[d + i]) * scalar_tanh(gates[i]);
+  if (prev_c) {
+    cell += scalar_sigmoid(gates[2 * d + i]) * prev_c[i];
+  }
+  c[i] = cell;
+  h[i] = scalar_sigmoid(gates[3 * d + i]) * scalar_tanh(cell);
+}
+
+// The LSTM cell of the gates {candidate, input, forget, output} of size d
+// each, with sigmoid gates and tanh candidate and cell, in one pass:
+// c = forget * prev_c + input * candidate, h = output * tanh(c),
+// where prev_c is null for zeros.
+template <typename T, platform::jit::cpu_isa_t isa = platform::jit::isa_any>
+inline void vec_lstm_cell(const int d, const T* gates, const T* prev_c, T* c,
+                          T* h) {
+  for (int i = 0; i < d; ++i) {
+    lstm_cell_at(i, d, gates, prev_c, c, h);
+  }
+}
+
+template <>
+inline void vec_lstm_cell<float, platform::jit::avx>(const int d,
+                                                     const float* gates,
+                                                     const float* prev_c,
+                                                     float* c, float* h) {
+#ifdef __AVX__
+  constexpr int block = AVX_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    __m256 cell = _mm256_mul_ps(avx_sigmoid(_mm256_loadu_ps(gates + d + i)),
+                                avx_tanh(_mm256_loadu_ps(gates + i)));
+    if (prev_c) {
+      cell = _mm256_add_ps(
+          cell, _mm256_mul_ps(avx_sigmoid(_mm256_loadu_ps(gates + 2 * d + i)),
+                              _mm256_loadu_ps(prev_c + i)));
+    }
+    _mm256_storeu_ps(c + i, cell);
+    _mm256_storeu_ps(
+        h + i, _mm256_mul_ps(avx_sigmoid(_mm256_loadu_ps(gates + 3 * d + i)),
+                             avx_tanh(cell)));
+  }
+  for (int i = end; i < d; ++i) {
+    lstm_cell_at(i, d, gates, prev_c, c, h);
+  }
+#else
+  vec_lstm_cell<float, platform::jit::isa_any>(d, gates, prev_c, c, h);
+#endif
+}
+
+template <>
+inline void vec_lstm_cell<float, platform::jit::avx2>(const int d,
+                                                      const float* gates,
+                                                      const float* prev_c,
+                                                      float* c, float* h) {
+  // The integers of avx_exp are of avx2 when compiled with it.
+  vec_lstm_cell<float, platform::jit::avx>(d, gates, prev_c, c, h);
+}
+
+template <>
+inline void vec_lstm_cell<float, platform::jit::avx512_common>(
+    const int d, const float* gates, const float* prev_c, float* c,
+    float* h) {
+#ifdef __AVX512F__
+  constexpr int block = AVX512_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    __m512 cell = _mm512_mul_ps(avx512_sigmoid(_mm512_loadu_ps(gates + d + i)),
+                                avx512_tanh(_mm512_loadu_ps(gates + i)));
+    if (prev_c) {
+      cell = _mm512_fmadd_ps(avx512_sigmoid(_mm512_loadu_ps(gates + 2 * d + i)),
+                             _mm512_loadu_ps(prev_c + i), cell);
+    }
+    _mm512_storeu_ps(c + i, cell);
+    _mm512_storeu_ps(
+        h + i,
+        _mm512_mul_ps(avx512_sigmoid(_mm512_loadu_ps(gates + 3 * d + i)),
+                      avx512_tanh(cell)));
+  }
+  for (int i = end; i < d; ++i) {
+    lstm_cell_at(i, d, gates, prev_c, c, h);
+  }
+#else
+  vec_lstm_cell<float, platform::jit::avx2>(d, gates, prev_c, c, h);
+#endif
+}
+
+// The element i of vec_gru_reset.
+template <typename T>
+inline void gru_reset_at(const int i, const int d, T* gates, const T* prev_h,
+                         T* reset_h) {
+  gates[i] = scalar_sigmoid(gates[i]);
+  gates[d + i] = scalar_sigmoid(gates[d + i]);
+  if (prev_h) {
+    reset_h[i] = gates[d + i] * prev_h[i];
+  }
+}
+
+// The first part of the GRU cell of the gates {update, reset, state} of size
+// d each: the update and reset gates are activated by sigmoid in place, and
+// reset_h = reset * prev_h, which is not written if prev_h is null for zeros.
+template <typename T, platform::jit::cpu_isa_t isa = platform::jit::isa_any>
+inline void vec_gru_reset(const int d, T* gates, const T* prev_h, T* reset_h) {
+  for (int i = 0; i < d; ++i) {
+    gru_reset_at(i, d, gates, prev_h, reset_h);
+  }
+}
+
+template <>
+inline void vec_gru_reset<float, platform::jit::avx>(const int d, float* gates,
+                                                     const float* prev_h,
+                                                     float* reset_h) {
+#ifdef __AVX__
+  constexpr int block = AVX_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    _mm256_storeu_ps(gates + i, avx_sigmoid(_mm256_loadu_ps(gates + i)));
+    __m256 reset = avx_sigmoid(_mm256_loadu_ps(gates + d + i));
+    _mm256_storeu_ps(gates + d + i, reset);
+    if (prev_h) {
+      _mm256_storeu_ps(reset_h + i,
+                       _mm256_mul_ps(reset, _mm256_loadu_ps(prev_h + i)));
+    }
+  }
+  for (int i = end; i < d; ++i) {
+    gru_reset_at(i, d, gates, prev_h, reset_h);
+  }
+#else
+  vec_gru_reset<float, platform::jit::isa_any>(d, gates, prev_h, reset_h);
+#endif
+}
+
+template <>
+inline void vec_gru_reset<float, platform::jit::avx2>(const int d,
+                                                      float* gates,
+                                                      const float* prev_h,
+                                                      float* reset_h) {
+  vec_gru_reset<float, platform::jit::avx>(d, gates, prev_h, reset_h);
+}
+
+template <>
+inline void vec_gru_reset<float, platform::jit::avx512_common>(
+    const int d, float* gates, const float* prev_h, float* reset_h) {
+#ifdef __AVX512F__
+  constexpr int block = AVX512_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    _mm512_storeu_ps(gates + i, avx512_sigmoid(_mm512_loadu_ps(gates + i)));
+    __m512 reset = avx512_sigmoid(_mm512_loadu_ps(gates + d + i));
+    _mm512_storeu_ps(gates + d + i, reset);
+    if (prev_h) {
+      _mm512_storeu_ps(reset_h + i,
+                       _mm512_mul_ps(reset, _mm512_loadu_ps(prev_h + i)));
+    }
+  }
+  for (int i = end; i < d; ++i) {
+    gru_reset_at(i, d, gates, prev_h, reset_h);
+  }
+#else
+  vec_gru_reset<float, platform::jit::avx2>(d, gates, prev_h, reset_h);
+#endif
+}
+
+// The element i of vec_gru_output.
+template <typename T>
+inline void gru_output_at(const int i, const int d, const T* gates,
+                          const T* prev_h, T* h) {
+  T out = gates[i] * scalar_tanh(gates[2 * d + i]);
+  if (prev_h) {
+    out += (static_cast<T>(1) - gates[i]) * prev_h[i];
+  }
+  h[i] = out;
+}
+
+// The second part of the GRU cell, of the gates from vec_gru_reset and the
+// product of reset_h added to the state gate:
+// h = update * tanh(state) + (1 - update) * prev_h, where prev_h is null for
+// zeros.
+template <typename T, platform::jit::cpu_isa_t isa = platform::jit::isa_any>
+inline void vec_gru_output(const int d, const T* gates, const T* prev_h,
+                           T* h) {
+  for (int i = 0; i < d; ++i) {
+    gru_output_at(i, d, gates, prev_h, h);
+  }
+}
+
+template <>
+inline void vec_gru_output<float, platform::jit::avx>(const int d,
+                                                      const float* gates,
+                                                      const float* prev_h,
+                                                      float* h) {
+#ifdef __AVX__
+  constexpr int block = AVX_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    __m256 update = _mm256_loadu_ps(gates + i);
+    __m256 out =
+        _mm256_mul_ps(update, avx_tanh(_mm256_loadu_ps(gates + 2 * d + i)));
+    if (prev_h) {
+      out = _mm256_add_ps(
+          out, _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), update),
+                             _mm256_loadu_ps(prev_h + i)));
+    }
+    _mm256_storeu_ps(h + i, out);
+  }
+  for (int i = end; i < d; ++i) {
+    gru_output_at(i, d, gates, prev_h, h);
+  }
+#else
+  vec_gru_output<float, platform::jit::isa_any>(d, gates, prev_h, h);
+#endif
+}
+
+template <>
+inline void vec_gru_output<float, platform::jit::avx2>(const int d,
+                                                       const float* gates,
+                                                       const float* prev_h,
+                                                       float* h) {
+  vec_gru_output<float, platform::jit::avx>(d, gates, prev_h, h);
+}
+
+template <>
+inline void vec_gru_output<float, platform::jit::avx512_common>(
+    const int d, const float* gates, const float* prev_h, float* h) {
+#ifdef __AVX512F__
+  constexpr int block = AVX512_FLOAT_BLOCK;
+  const int end = d - d % block;
+  for (int i = 0; i < end; i += block) {
+    __m512 update = _mm512_loadu_ps(gates + i);
+    __m512 out =
+        _mm512_mul_ps(update, avx512_tanh(_mm512_loadu_ps(gates + 2 * d + i)));
+    if (prev_h) {
+      out = _mm512_fmadd_ps(_mm512_sub_ps(_mm512_set1_ps(1.f), update),
+                            _mm512_loadu_ps(prev_h + i), out);
+    }
+    _mm512_storeu_ps(h + i, out);
+  }
+  for (int i = end; i < d; ++i) {
+    gru_output_at(i, d, gates, prev_h, h);
+  }
+#else
+  vec_gru_output<float, platform::jit::avx2>(d, gates, prev_h, h);
+#endif
+}
+
 // TODO(TJ): optimize double of sigmoid, tanh and relu if necessary
 
 template <typename T, platform::jit::cpu_isa_t isa = platform::jit::isa_any>
@@ -201,3 +201,134 @@ TEST(CpuVecTest, inplace_relu) {
   }
   TestInplace<double>(30, vec_relu<double>, ref_relu<double>);
 }
+
+// The LSTM cell by the activations and blas of today's fusion_lstm kernel.
+template <typename T>
+void ref_lstm_cell(const int d, const T* gates, const T* prev_c, T* c, T* h) {
+  std::vector<T> tmp(gates, gates + 4 * d);
+  T* g = tmp.data();
+  ref_sigmoid<T>(3 * d, g + d, g + d);
+  ref_tanh<T>(d, g, g);
+  for (int i = 0; i < d; ++i) {
+    c[i] = g[i] * g[d + i] + (prev_c ? g[2 * d + i] * prev_c[i] : 0);
+  }
+  ref_tanh<T>(d, c, g + 2 * d);
+  for (int i = 0; i < d; ++i) {
+    h[i] = g[2 * d + i] * g[3 * d + i];
+  }
+}
+
+// The same by the vectorized activations, as fusion_lstm computed it before
+// vec_lstm_cell.
+template <typename T, paddle::platform::jit::cpu_isa_t isa>
+void multi_pass_lstm_cell(const int d, T* gates, const T* prev_c, T* c,
+                          T* h) {
+  using namespace paddle::operators::math;  // NOLINT
+  vec_sigmoid<T, isa>(3 * d, gates + d, gates + d);
+  vec_tanh<T, isa>(d, gates, gates);
+  for (int i = 0; i < d; ++i) {
+    gates[2 * d + i] *= prev_c[i];
+  }
+  for (int i = 0; i < d; ++i) {
+    gates[d + i] *= gates[i];
+  }
+  for (int i = 0; i < d; ++i) {
+    c[i] = gates[d + i] + gates[2 * d + i];
+  }
+  vec_tanh<T, isa>(d, c, gates + 2 * d);
+  for (int i = 0; i < d; ++i) {
+    h[i] = gates[2 * d + i] * gates[3 * d + i];
+  }
+}
+
+template <typename T, paddle::platform::jit::cpu_isa_t isa>
+void TestAndBenchLSTMCell(const int d) {
+  using namespace paddle::operators::math;  // NOLINT
+  std::vector<T> gates(4 * d), prev_c(d), buf(4 * d);
+  RandomVec<T>(4 * d, gates.data());
+  RandomVec<T>(d, prev_c.data());
+  const T* prev_c_data = prev_c.data();
+  for (const T* pc : {static_cast<const T*>(nullptr), prev_c_data}) {
+    std::vector<T> ctgt(d), htgt(d), cref(d), href(d);
+    vec_lstm_cell<T, isa>(d, gates.data(), pc, ctgt.data(), htgt.data());
+    ref_lstm_cell<T>(d, gates.data(), pc, cref.data(), href.data());
+    for (int i = 0; i < d; ++i) {
+      EXPECT_NEAR(ctgt[i], cref[i], 1e-3);
+      EXPECT_NEAR(htgt[i], href[i], 1e-3);
+    }
+  }
+
+  std::vector<T> c(d), h(d);
+  auto st = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    std::memcpy(buf.data(), gates.data(), sizeof(T) * 4 * d);
+    multi_pass_lstm_cell<T, isa>(d, buf.data(), prev_c.data(), c.data(),
+                                 h.data());
+  }
+  auto mt = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    std::memcpy(buf.data(), gates.data(), sizeof(T) * 4 * d);
+    vec_lstm_cell<T, isa>(d, buf.data(), prev_c.data(), c.data(), h.data());
+  }
+  auto et = GetCurrentUS();
+  VLOG(3) << "LSTM cell of size " << d << ": multiple passes take "
+          << (mt - st) / repeat << " us, one pass takes " << (et - mt) / repeat;
+}
+
+TEST(CpuVecTest, lstm_cell) {
+  namespace jit = paddle::platform::jit;
+  for (auto sz : {1, 7, 8, 15, 16, 30, 64, 128, 256, 512}) {
+    TestAndBenchLSTMCell<float, jit::isa_any>(sz);
+    TestAndBenchLSTMCell<float, jit::avx>(sz);
+    TestAndBenchLSTMCell<float, jit::avx2>(sz);
+    TestAndBenchLSTMCell<float, jit::avx512_common>(sz);
+  }
+  TestAndBenchLSTMCell<double, jit::isa_any>(30);
+}
+
+// The GRU cell of vec_gru_reset and vec_gru_output, where the product of
+// reset_h is taken as reset_h itself.
+template <typename T>
+void ref_gru_cell(const int d, const T* gates, const T* prev_h, T* h) {
+  std::vector<T> g(gates, gates + 3 * d);
+  ref_sigmoid<T>(2 * d, g.data(), g.data());
+  for (int i = 0; i < d; ++i) {
+    T reset_h = prev_h ? g[d + i] * prev_h[i] : 0;
+    T state = _tanh<T>(g[2 * d + i] + reset_h);
+    h[i] = g[i] * state + (prev_h ? (1 - g[i]) * prev_h[i] : 0);
+  }
+}
+
+template <typename T, paddle::platform::jit::cpu_isa_t isa>
+void TestGRUCell(const int d) {
+  using namespace paddle::operators::math;  // NOLINT
+  std::vector<T> gates(3 * d), prev_h(d);
+  RandomVec<T>(3 * d, gates.data());
+  RandomVec<T>(d, prev_h.data());
+  const T* prev_h_data = prev_h.data();
+  for (const T* ph : {static_cast<const T*>(nullptr), prev_h_data}) {
+    std::vector<T> g(gates), reset_h(d), htgt(d), href(d);
+    vec_gru_reset<T, isa>(d, g.data(), ph, reset_h.data());
+    if (ph) {
+      for (int i = 0; i < d; ++i) {
+        g[2 * d + i] += reset_h[i];
+      }
+    }
+    vec_gru_output<T, isa>(d, g.data(), ph, htgt.data());
+    ref_gru_cell<T>(d, gates.data(), ph, href.data());
+    for (int i = 0; i < d; ++i) {
+      EXPECT_NEAR(htgt[i], href[i], 1e-3);
+    }
+  }
+}
+
+TEST(CpuVecTest, gru_cell) {
+  namespace jit = paddle::platform::jit;
+  for (auto sz : {1, 7, 8, 15, 16, 30, 64, 128, 256, 512}) {
+    TestGRUCell<float, jit::isa_any>(sz);
+    TestGRUCell<float, jit::avx>(sz);
+    TestGRUCell<float, jit::avx2>(sz);
+    TestGRUCell<float, jit::avx512_common>(sz);
+  }
+  TestGRUCell<double, jit::isa_any>(30);
+}
@@ -0,0 +1,185 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/gemm_int8.h"
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Parallelize the GEMM over the rows of A only when it is large enough.
+constexpr int64_t kMinParallelMACs = 1 << 20;
+constexpr int kColBlockBytes = 128 * 1024;
+
+void QuantizeInputs(const float* x, int64_t n, float max_abs, bool is_unsigned,
+                    int16_t* out) {
+  float factor = InputQuantizeFactor(max_abs, is_unsigned);
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = QuantizeInput(x[i], factor, is_unsigned);
+  }
+}
+
+static void GemmS8S16Ref(int M, int N, int K, const int8_t* A,
+                         const int16_t* B, int32_t* C) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (int64_t(M) * N * K >= kMinParallelMACs)
+#endif
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      const int8_t* a = A + int64_t(i) * K;
+      const int16_t* b = B + int64_t(j) * K;
+      int32_t sum = 0;
+      for (int k = 0; k < K; ++k) {
+        sum += a[k] * b[k];
+      }
+      C[int64_t(i) * N + j] = sum;
+    }
+  }
+}
+
+#ifdef __AVX2__
+#define AVX2_INT16_BLOCK 16
+
+static inline __m256i LoadS8AsS16(const int8_t* a) {
+  return _mm256_cvtepi8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+}
+
+static inline __m256i LoadS16(const int16_t* b) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+}
+
+static inline int32_t HorizontalSum(__m256i v) {
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+static inline int32_t DotTail(int k, int K, const int8_t* a,
+                              const int16_t* b) {
+  int32_t sum = 0;
+  for (; k < K; ++k) {
+    sum += a[k] * b[k];
+  }
+  return sum;
+}
+
+// The dot product of a row of A and a column of B. Every 16 products are
+// summed by pairs with vpmaddwd into eight int32 lanes.
+static inline int32_t Dot(int K, const int8_t* a, const int16_t* b) {
+  __m256i acc = _mm256_setzero_si256();
+  int k = 0;
+  for (; k + AVX2_INT16_BLOCK <= K; k += AVX2_INT16_BLOCK) {
+    acc = _mm256_add_epi32(
+        acc, _mm256_madd_epi16(LoadS8AsS16(a + k), LoadS16(b + k)));
+  }
+  return HorizontalSum(acc) + DotTail(k, K, a, b);
+}
+
+// The dot products of 4 rows of A and 2 columns of B: the 8 accumulators and
+// the 6 operands fit in the 16 ymm registers.
+static inline void Dot4x2(int K, const int8_t* a, const int16_t* b,
+                          int32_t* c, int ldc) {
+  const int8_t* a0 = a;
+  const int8_t* a1 = a + K;
+  const int8_t* a2 = a1 + K;
+  const int8_t* a3 = a2 + K;
+  const int16_t* b0 = b;
+  const int16_t* b1 = b + K;
+  __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+  __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+  __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+  __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+  int k = 0;
+  for (; k + AVX2_INT16_BLOCK <= K; k += AVX2_INT16_BLOCK) {
+    __m256i vb0 = LoadS16(b0 + k);
+    __m256i vb1 = LoadS16(b1 + k);
+    __m256i va = LoadS8AsS16(a0 + k);
+    c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(va, vb0));
+    c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(va, vb1));
+    va = LoadS8AsS16(a1 + k);
+    c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(va, vb0));
+    c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(va, vb1));
+    va = LoadS8AsS16(a2 + k);
+    c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(va, vb0));
+    c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(va, vb1));
+    va = LoadS8AsS16(a3 + k);
+    c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(va, vb0));
+    c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(va, vb1));
+  }
+  c[0] = HorizontalSum(c00) + DotTail(k, K, a0, b0);
+  c[1] = HorizontalSum(c01) + DotTail(k, K, a0, b1);
+  c[ldc] = HorizontalSum(c10) + DotTail(k, K, a1, b0);
+  c[ldc + 1] = HorizontalSum(c11) + DotTail(k, K, a1, b1);
+  c[2 * ldc] = HorizontalSum(c20) + DotTail(k, K, a2, b0);
+  c[2 * ldc + 1] = HorizontalSum(c21) + DotTail(k, K, a2, b1);
+  c[3 * ldc] = HorizontalSum(c30) + DotTail(k, K, a3, b0);
+  c[3 * ldc + 1] = HorizontalSum(c31) + DotTail(k, K, a3, b1);
+}
+
+static void GemmS8S16AVX2(int M, int N, int K, const int8_t* A,
+                          const int16_t* B, int32_t* C) {
+  // The columns of B are taken by blocks of about 128KB, which stay in the L2
+  // cache while all the rows of A are multiplied by them.
+  int col_block = std::max(2, (kColBlockBytes / (K * 2)) & ~1);
+  int row_blocks = (M + 3) / 4;
+  for (int j0 = 0; j0 < N; j0 += col_block) {
+    int j1 = std::min(N, j0 + col_block);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (int64_t(M) * (j1 - j0) * K >= kMinParallelMACs)
+#endif
+    for (int ib = 0; ib < row_blocks; ++ib) {
+      int i = ib * 4;
+      const int8_t* a = A + int64_t(i) * K;
+      int32_t* c = C + int64_t(i) * N;
+      int j = j0;
+      if (i + 4 <= M) {
+        for (; j + 2 <= j1; j += 2) {
+          Dot4x2(K, a, B + int64_t(j) * K, c + j, N);
+        }
+      }
+      for (int r = 0; r < 4 && i + r < M; ++r) {
+        for (int jj = (i + 4 <= M ? j : j0); jj < j1; ++jj) {
+          c[int64_t(r) * N + jj] =
+              Dot(K, a + int64_t(r) * K, B + int64_t(jj) * K);
+        }
+      }
+    }
+  }
+}
+#endif
+
+void GemmS8S16(int M, int N, int K, const int8_t* A, const int16_t* B,
+               int32_t* C) {
+#ifdef __AVX2__
+  if (platform::jit::MayIUse(platform::jit::avx2)) {
+    GemmS8S16AVX2(M, N, K, A, B, C);
+    return;
+  }
+#endif
+  GemmS8S16Ref(M, N, K, A, B, C);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
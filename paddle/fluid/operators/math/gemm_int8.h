@@ -0,0 +1,60 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The 8-bit integer path of inference.
+ *
+ * A tensor is quantized linearly by the max absolute value of its elements,
+ * the scale: a weight to round(w / scale * 127) in [-127, 127], and an input
+ * to round(x / scale * 127) in [-127, 127], or to round(x / scale * 255) in
+ * [0, 255] when it has no negative value, e.g. the output of a relu. There is
+ * no zero point, so the padding of a convolution is 0 in both.
+ *
+ * The quantized inputs are kept in int16, so that the products of a weight
+ * and an input are summed by pairs into int32 without saturation.
+ */
+
+// The quantized value of 1.0 of an input scaled by max_abs.
+inline float InputQuantizeFactor(float max_abs, bool is_unsigned) {
+  return (is_unsigned ? 255.f : 127.f) / max_abs;
+}
+
+inline int16_t QuantizeInput(float x, float factor, bool is_unsigned) {
+  float q = std::round(x * factor);
+  float lower = is_unsigned ? 0.f : -127.f;
+  float upper = is_unsigned ? 255.f : 127.f;
+  return static_cast<int16_t>(q < lower ? lower : (q > upper ? upper : q));
+}
+
+// Quantizes n inputs scaled by max_abs.
+void QuantizeInputs(const float* x, int64_t n, float max_abs, bool is_unsigned,
+                    int16_t* out);
+
+// C[M, N] = A[M, K] * B[N, K]^T in int32, where A holds the quantized weights
+// and B the quantized inputs, both in row major.
+void GemmS8S16(int M, int N, int K, const int8_t* A, const int16_t* B,
+               int32_t* C);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
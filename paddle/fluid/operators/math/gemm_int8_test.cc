@@ -0,0 +1,125 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/gemm_int8.h"
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace {
+
+uint64_t NextRandom(uint64_t* seed) {
+  *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *seed >> 33;
+}
+
+void RandomS8(std::vector<int8_t>* v, uint64_t* seed) {
+  for (auto& x : *v) x = static_cast<int8_t>(NextRandom(seed) % 255) - 127;
+}
+
+void RandomU8(std::vector<int16_t>* v, uint64_t* seed) {
+  for (auto& x : *v) x = static_cast<int16_t>(NextRandom(seed) % 256);
+}
+
+}  // namespace
+
+TEST(gemm_int8, quantize) {
+  std::vector<float> x({-2.f, -1.f, 0.f, 0.5f, 1.f, 2.f});
+  std::vector<int16_t> q(x.size());
+  paddle::operators::math::QuantizeInputs(x.data(), x.size(), 1.f, false,
+                                          q.data());
+  EXPECT_EQ(q, std::vector<int16_t>({-127, -127, 0, 64, 127, 127}));
+  paddle::operators::math::QuantizeInputs(x.data(), x.size(), 2.f, true,
+                                          q.data());
+  EXPECT_EQ(q, std::vector<int16_t>({0, 0, 0, 64, 128, 255}));
+}
+
+TEST(gemm_int8, gemm) {
+  uint64_t seed = 1;
+  // The shapes cover the tails of the blocks of rows, columns and depth.
+  for (int M : {1, 3, 4, 9}) {
+    for (int N : {1, 2, 5}) {
+      for (int K : {1, 15, 16, 37, 300}) {
+        std::vector<int8_t> a(M * K);
+        std::vector<int16_t> b(N * K);
+        RandomS8(&a, &seed);
+        RandomU8(&b, &seed);
+        std::vector<int32_t> c(M * N, -1);
+        paddle::operators::math::GemmS8S16(M, N, K, a.data(), b.data(),
+                                           c.data());
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < N; ++j) {
+            int32_t expected = 0;
+            for (int k = 0; k < K; ++k) {
+              expected += a[i * K + k] * b[j * K + k];
+            }
+            ASSERT_EQ(c[i * N + j], expected)
+                << "M=" << M << " N=" << N << " K=" << K;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(gemm_int8, benchmark) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext ctx(place);
+  auto blas =
+      paddle::operators::math::GetBlas<paddle::platform::CPUDeviceContext,
+                                       float>(ctx);
+  uint64_t seed = 1;
+  const int repeat = 10;
+  // A conv layer as a GEMM: 64 filters of 64x3x3 over a 28x28 output, and an
+  // fc layer of 1024x1024 for a batch of 8.
+  for (auto shape : std::vector<std::vector<int>>{{64, 784, 576},
+                                                  {1024, 8, 1024}}) {
+    int M = shape[0], N = shape[1], K = shape[2];
+    std::vector<int8_t> a(M * K);
+    std::vector<int16_t> b(N * K);
+    RandomS8(&a, &seed);
+    RandomU8(&b, &seed);
+    std::vector<float> fa(a.begin(), a.end());
+    std::vector<float> fb(b.begin(), b.end());
+    std::vector<int32_t> c(M * N);
+    std::vector<float> fc(M * N);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      blas.GEMM(CblasNoTrans, CblasTrans, M, N, K, 1.f, fa.data(), fb.data(),
+                0.f, fc.data());
+    }
+    auto sgemm_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      paddle::operators::math::GemmS8S16(M, N, K, a.data(), b.data(),
+                                         c.data());
+    }
+    auto int8_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    std::cout << "GEMM " << M << "x" << N << "x" << K
+              << ", sgemm: " << sgemm_us / repeat
+              << " us, int8: " << int8_us / repeat << " us" << std::endl;
+    for (int i = 0; i < M * N; ++i) {
+      // The sums may exceed the 24 bits of precision of float.
+      ASSERT_NEAR(c[i], fc[i], std::abs(fc[i]) * 1e-5f + 1);
+    }
+  }
+}
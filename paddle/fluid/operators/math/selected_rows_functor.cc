@@ -12,9 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <set>
+#include <algorithm>
 #include <vector>
 
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+#include "paddle/fluid/framework/row_index_map.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
@@ -190,8 +195,75 @@ template struct SelectedRowsAddToTensor<platform::CPUDeviceContext, int64_t>;
 // add or mul.
 namespace scatter {
 
-size_t FindPos(const std::vector<int64_t>& rows, int64_t value) {
-  return std::find(rows.begin(), rows.end(), value) - rows.begin();
+void GroupRows(const int64_t* rows, size_t n, RowGroups* groups) {
+  int num_parts = 1;
+#ifdef PADDLE_WITH_MKLML
+  if (n >= 2 * kMinMergeRowsPerThread) {
+    num_parts = omp_get_max_threads();
+  }
+#endif
+  // The index of every row among the distinct rows of its partition.
+  std::vector<framework::RowIndexMap> part_index(num_parts);
+  std::vector<std::vector<int64_t>> part_rows(num_parts);
+  std::vector<int64_t> local_index(n);
+  auto part_of = [num_parts](int64_t row) -> int {
+    return (framework::RowIndexMap::Hash(row) >> 40) % num_parts;
+  };
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_parts > 1)
+#endif
+  for (int t = 0; t < num_parts; ++t) {
+    auto& index = part_index[t];
+    auto& distinct = part_rows[t];
+    for (size_t i = 0; i < n; ++i) {
+      if (num_parts > 1 && part_of(rows[i]) != t) continue;
+      int64_t next = distinct.size();
+      local_index[i] = index.Insert(rows[i], next);
+      if (local_index[i] == next) {
+        distinct.push_back(rows[i]);
+      }
+    }
+  }
+
+  auto& merged = groups->rows;
+  merged.clear();
+  for (auto& distinct : part_rows) {
+    merged.insert(merged.end(), distinct.begin(), distinct.end());
+  }
+  std::sort(merged.begin(), merged.end());
+
+  // The position in merged of the distinct rows of every partition.
+  std::vector<std::vector<size_t>> part_pos(num_parts);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_parts > 1)
+#endif
+  for (int t = 0; t < num_parts; ++t) {
+    part_pos[t].resize(part_rows[t].size());
+    for (size_t l = 0; l < part_rows[t].size(); ++l) {
+      part_pos[t][l] =
+          std::lower_bound(merged.begin(), merged.end(), part_rows[t][l]) -
+          merged.begin();
+    }
+  }
+
+  // Counting sort of the input positions by merged row, which keeps them in
+  // increasing order within a row.
+  std::vector<size_t> pos(n);
+  auto& offsets = groups->offsets;
+  offsets.assign(merged.size() + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    int t = num_parts > 1 ? part_of(rows[i]) : 0;
+    pos[i] = part_pos[t][local_index[i]];
+    ++offsets[pos[i] + 1];
+  }
+  for (size_t k = 0; k < merged.size(); ++k) {
+    offsets[k + 1] += offsets[k];
+  }
+  std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+  groups->order.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    groups->order[next[pos[i]]++] = i;
+  }
 }
 
 template <typename T>
@@ -199,29 +271,28 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
   framework::SelectedRows operator()(const platform::CPUDeviceContext& context,
                                      const framework::SelectedRows& input) {
     framework::SelectedRows out;
-    auto input_rows = input.rows();
-    std::set<int64_t> row_set(input_rows.begin(), input_rows.end());
-    std::vector<int64_t> merge_rows(row_set.begin(), row_set.end());
+    auto& input_rows = input.rows();
+    RowGroups groups;
+    GroupRows(input_rows.data(), input_rows.size(), &groups);
 
     auto input_width = input.value().dims()[1];
-    out.set_rows(merge_rows);
+    int64_t num_rows = groups.rows.size();
+    out.set_rows(groups.rows);
     out.set_height(input.height());
     out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
-        context.GetPlace());
-
-    math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
+        framework::make_ddim({num_rows, input_width}), context.GetPlace());
 
     auto* out_data = out.mutable_value()->data<T>();
     auto* input_data = input.value().data<T>();
-
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = FindPos(merge_rows, input_rows[i]);
-      for (int64_t j = 0; j < input_width; j++) {
-        out_data[out_i * input_width + j] += input_data[i * input_width + j];
-      }
+    // Every merged row is written by one thread and summed in the order of
+    // the input rows, so the result does not depend on the threads.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_rows >= 2 * kMinMergeRowsPerThread)
+#endif
+    for (int64_t k = 0; k < num_rows; ++k) {
+      size_t begin = groups.offsets[k];
+      SumRows(input_data, input_width, groups.order.data() + begin,
+              groups.offsets[k + 1] - begin, out_data + k * input_width);
     }
     return out;
   }
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
+#include <vector>
+
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -67,6 +69,69 @@ struct MergeAdd {
                                      const framework::SelectedRows& input);
 };
 
+// The rows of a SelectedRows grouped by value. rows are the distinct rows in
+// increasing order, and the positions of the input rows equal to rows[k] are
+// order[offsets[k]], ..., order[offsets[k + 1] - 1], in increasing order.
+struct RowGroups {
+  std::vector<int64_t> rows;
+  std::vector<size_t> offsets;
+  std::vector<size_t> order;
+};
+
+// Groups n rows with a hash map per thread, each thread taking the rows whose
+// hash falls in its partition, so no sorting or searching of the input rows
+// is needed.
+void GroupRows(const int64_t* rows, size_t n, RowGroups* groups);
+
+// Merging the rows on several threads only pays off for many rows.
+constexpr int64_t kMinMergeRowsPerThread = 1024;
+
+// Sets out to the sum of the count rows of input at positions, added in that
+// order to zero.
+template <typename T>
+inline void SumRows(const T* input, int64_t width, const size_t* positions,
+                    size_t count, T* out) {
+  std::fill(out, out + width, static_cast<T>(0));
+  for (size_t p = 0; p < count; ++p) {
+    const T* in = input + positions[p] * width;
+    for (int64_t j = 0; j < width; ++j) {
+      out[j] += in[j];
+    }
+  }
+}
+
+// Calls fn(row, merged) for every distinct row of input on CPU, where merged
+// is the sum of the values of the row, which is what MergeAdd computes. It
+// fuses MergeAdd into the sparse update of a parameter. The rows are visited
+// in parallel, so fn may only write the row `row` of the parameter.
+template <typename T, typename Fn>
+void ForEachMergedRow(const framework::SelectedRows& input, Fn fn) {
+  auto& in_rows = input.rows();
+  if (in_rows.size() == 0) {
+    return;
+  }
+  RowGroups groups;
+  GroupRows(in_rows.data(), in_rows.size(), &groups);
+  int64_t width = input.value().numel() / in_rows.size();
+  const T* in_data = input.value().data<T>();
+  int64_t num_rows = groups.rows.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel if (num_rows >= 2 * kMinMergeRowsPerThread)
+#endif
+  {
+    std::vector<T> merged(width);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp for
+#endif
+    for (int64_t k = 0; k < num_rows; ++k) {
+      size_t begin = groups.offsets[k];
+      SumRows(in_data, width, groups.order.data() + begin,
+              groups.offsets[k + 1] - begin, merged.data());
+      fn(groups.rows[k], merged.data());
+    }
+  }
+}
+
 template <typename DeviceContext, typename T>
 struct Add {
   framework::SelectedRows operator()(const DeviceContext& context,
@@ -13,6 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <set>
 #include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/math/math_function.h"
@@ -219,3 +223,106 @@ TEST(selected_rows_functor, cpu_add_to) {
   // row9: 2.0 + 3.0
   EXPECT_EQ(tensor1_data[9 * row_numel + 6], 5.0);
 }
+
+TEST(selected_rows_functor, cpu_merge_add) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  int64_t height = 10;
+  int64_t row_numel = 4;
+
+  std::vector<int64_t> rows{7, 0, 4, 7, 0, 7};
+  paddle::framework::SelectedRows input(rows, height);
+  auto* in_data = input.mutable_value()->mutable_data<float>(
+      paddle::framework::make_ddim(
+          {static_cast<int64_t>(rows.size()), row_numel}),
+      cpu_place);
+  for (int64_t i = 0; i < input.value().numel(); ++i) {
+    in_data[i] = static_cast<float>(i / row_numel + 1);
+  }
+
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add;
+  auto out = merge_add(ctx, input);
+  EXPECT_EQ(out.height(), height);
+  ASSERT_EQ(out.rows().size(), 3UL);
+  EXPECT_EQ(out.rows()[0], 0);
+  EXPECT_EQ(out.rows()[1], 4);
+  EXPECT_EQ(out.rows()[2], 7);
+  auto* out_data = out.value().data<float>();
+  for (int64_t j = 0; j < row_numel; ++j) {
+    // row0: 2.0 + 5.0, row4: 3.0, row7: 1.0 + 4.0 + 6.0
+    EXPECT_EQ(out_data[0 * row_numel + j], 7.0);
+    EXPECT_EQ(out_data[1 * row_numel + j], 3.0);
+    EXPECT_EQ(out_data[2 * row_numel + j], 11.0);
+  }
+
+  std::vector<int64_t> merged_rows;
+  paddle::operators::math::scatter::ForEachMergedRow<float>(
+      input, [&](int64_t row, const float* merged) {
+        merged_rows.push_back(row);
+        for (int64_t j = 0; j < row_numel; ++j) {
+          EXPECT_EQ(merged[j], row == 0 ? 7.0 : row == 4 ? 3.0 : 11.0);
+        }
+      });
+  EXPECT_EQ(merged_rows, std::vector<int64_t>({0, 4, 7}));
+}
+
+TEST(selected_rows_functor, cpu_merge_add_benchmark) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  // The ids of an embedding in a large batch, with many duplicates.
+  const int64_t height = 1000000;
+  const int64_t num_ids = 200000;
+  const int64_t row_numel = 16;
+  std::vector<int64_t> rows(num_ids);
+  uint64_t seed = 1;
+  for (auto& row : rows) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Skewed towards the small ids like the word frequencies.
+    row = ((seed >> 33) % 1000) * ((seed >> 13) % 50);
+  }
+  paddle::framework::SelectedRows input(rows, height);
+  auto* in_data = input.mutable_value()->mutable_data<float>(
+      paddle::framework::make_ddim({num_ids, row_numel}), cpu_place);
+  for (int64_t i = 0; i < num_ids * row_numel; ++i) {
+    in_data[i] = static_cast<float>(i % 7) * 0.25f;
+  }
+
+  // The merge by a sorted set and a linear search of every row.
+  auto start = std::chrono::steady_clock::now();
+  std::set<int64_t> row_set(rows.begin(), rows.end());
+  std::vector<int64_t> set_rows(row_set.begin(), row_set.end());
+  std::vector<float> expected(set_rows.size() * row_numel, 0.0f);
+  for (int64_t i = 0; i < num_ids; ++i) {
+    size_t k = std::find(set_rows.begin(), set_rows.end(), rows[i]) -
+               set_rows.begin();
+    for (int64_t j = 0; j < row_numel; ++j) {
+      expected[k * row_numel + j] += in_data[i * row_numel + j];
+    }
+  }
+  auto linear_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add;
+  start = std::chrono::steady_clock::now();
+  auto out = merge_add(ctx, input);
+  auto hash_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  std::cout << "merge " << num_ids << " rows into " << set_rows.size()
+            << ", linear search: " << linear_ms
+            << " ms, hash grouping: " << hash_ms << " ms" << std::endl;
+
+  ASSERT_EQ(out.rows().size(), set_rows.size());
+  for (size_t k = 0; k < set_rows.size(); ++k) {
+    ASSERT_EQ(out.rows()[k], set_rows[k]);
+  }
+  auto* out_data = out.value().data<float>();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(out_data[i], expected[i]) << i;
+  }
+}
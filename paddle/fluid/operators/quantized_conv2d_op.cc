@@ -0,0 +1,221 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/conv_op.h"
+#include "paddle/fluid/operators/math/gemm_int8.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class QuantizedConv2DOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of QuantizedConv2DOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Filter"),
+                   "Input(Filter) of QuantizedConv2DOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Output"),
+                   "Output(Output) of QuantizedConv2DOp should not be null.");
+
+    auto in_dims = ctx->GetInputDim("Input");
+    auto filter_dims = ctx->GetInputDim("Filter");
+    std::vector<int> strides = ctx->Attrs().Get<std::vector<int>>("strides");
+    std::vector<int> paddings = ctx->Attrs().Get<std::vector<int>>("paddings");
+    std::vector<int> dilations =
+        ctx->Attrs().Get<std::vector<int>>("dilations");
+    int groups = ctx->Attrs().Get<int>("groups");
+
+    PADDLE_ENFORCE_EQ(in_dims.size(), 4UL,
+                      "Input of QuantizedConv2DOp should be 4-D tensor.");
+    PADDLE_ENFORCE_EQ(filter_dims.size(), 4UL,
+                      "Filter of QuantizedConv2DOp should be 4-D tensor.");
+    PADDLE_ENFORCE(strides.size() == 2UL && paddings.size() == 2UL &&
+                       dilations.size() == 2UL,
+                   "strides, paddings and dilations should have 2 elements.");
+    PADDLE_ENFORCE_EQ(in_dims[1], filter_dims[1] * groups,
+                      "The number of input channels should be equal to filter "
+                      "channels * groups.");
+    PADDLE_ENFORCE_EQ(
+        filter_dims[0] % groups, 0,
+        "The number of output channels should be divided by groups.");
+    auto weight_scale = ctx->Attrs().Get<std::vector<float>>("weight_scale");
+    PADDLE_ENFORCE(
+        weight_scale.size() == 1UL ||
+            static_cast<int64_t>(weight_scale.size()) == filter_dims[0],
+        "weight_scale should have one scale or one for every output channel.");
+    // The input is quantized by dividing by input_scale.
+    PADDLE_ENFORCE_GT(ctx->Attrs().Get<float>("input_scale"), 0.f,
+                      "input_scale should be positive.");
+
+    std::vector<int64_t> output_shape({in_dims[0], filter_dims[0]});
+    for (size_t i = 0; i < strides.size(); ++i) {
+      output_shape.push_back(ConvOutputSize(in_dims[i + 2], filter_dims[i + 2],
+                                            dilations[i], paddings[i],
+                                            strides[i]));
+    }
+    ctx->SetOutputDim("Output", framework::make_ddim(output_shape));
+    ctx->ShareLoD("Input", "Output");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class QuantizedConv2DOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor) The input tensor of the conv, NCHW.");
+    AddInput("Filter",
+             "(Tensor) The int8 filter, MCHW, where M is the number of output "
+             "channels and C the number of input channels of a group.");
+    AddOutput("Output", "(Tensor) The output tensor, NCHW.");
+    AddAttr<std::vector<int>>("strides", "(vector<int>) The strides.")
+        .SetDefault({1, 1});
+    AddAttr<std::vector<int>>("paddings", "(vector<int>) The paddings.")
+        .SetDefault({0, 0});
+    AddAttr<std::vector<int>>("dilations", "(vector<int>) The dilations.")
+        .SetDefault({1, 1});
+    AddAttr<int>("groups", "(int) The number of groups.").SetDefault(1);
+    AddAttr<float>("input_scale",
+                   "(float) The max absolute value of Input, by calibration.");
+    AddAttr<bool>("input_is_unsigned",
+                  "(bool, default false) Whether Input has no negative value, "
+                  "so it is quantized into [0, 255] instead of [-127, 127].")
+        .SetDefault(false);
+    AddAttr<std::vector<float>>(
+        "weight_scale",
+        "(vector<float>) The max absolute value of the filter, or of every "
+        "output channel of it.");
+    AddComment(R"DOC(
+Quantized Convolution Operator.
+
+The conv2d of inference in 8-bit integers, created by int8_quantize_pass. The
+patches of Input are quantized by input_scale, convolved with the int8 filter
+with the products accumulated in int32, and the result is scaled back to
+float by input_scale / range * weight_scale / 127, where range is 255 for an
+unsigned input and 127 otherwise.
+)DOC");
+  }
+};
+
+template <typename T>
+class QuantizedConv2DOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* filter = ctx.Input<Tensor>("Filter");
+    auto* output = ctx.Output<Tensor>("Output");
+    std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = ctx.Attr<std::vector<int>>("dilations");
+    int groups = ctx.Attr<int>("groups");
+    float input_scale = ctx.Attr<float>("input_scale");
+    bool is_unsigned = ctx.Attr<bool>("input_is_unsigned");
+    auto weight_scale = ctx.Attr<std::vector<float>>("weight_scale");
+
+    int batch_size = input->dims()[0];
+    int in_height = input->dims()[2];
+    int in_width = input->dims()[3];
+    int out_channels = filter->dims()[0];
+    int channels = filter->dims()[1];
+    int filter_height = filter->dims()[2];
+    int filter_width = filter->dims()[3];
+    int out_height = output->dims()[2];
+    int out_width = output->dims()[3];
+    int out_size = out_height * out_width;
+    int group_out_channels = out_channels / groups;
+    // A patch of the input, multiplied by a row of the filter.
+    int K = channels * filter_height * filter_width;
+
+    Tensor quantized_image;
+    int16_t* qim = quantized_image.mutable_data<int16_t>(
+        framework::make_ddim({groups * channels, in_height, in_width}),
+        ctx.GetPlace());
+    Tensor patches;
+    int16_t* qcol = patches.mutable_data<int16_t>(
+        framework::make_ddim({out_size, K}), ctx.GetPlace());
+    Tensor products;
+    int32_t* acc = products.mutable_data<int32_t>(
+        framework::make_ddim({group_out_channels, out_size}), ctx.GetPlace());
+
+    float factor = math::InputQuantizeFactor(input_scale, is_unsigned);
+    std::vector<float> out_scale(out_channels);
+    for (int o = 0; o < out_channels; ++o) {
+      out_scale[o] =
+          weight_scale[weight_scale.size() == 1 ? 0 : o] / 127.f / factor;
+    }
+
+    int64_t image_size = int64_t(groups) * channels * in_height * in_width;
+    const int8_t* filter_data = filter->data<int8_t>();
+    T* out_data = output->mutable_data<T>(ctx.GetPlace());
+    for (int n = 0; n < batch_size; ++n) {
+      math::QuantizeInputs(input->data<T>() + n * image_size, image_size,
+                           input_scale, is_unsigned, qim);
+      for (int g = 0; g < groups; ++g) {
+        const int16_t* im = qim + int64_t(g) * channels * in_height * in_width;
+        // The patches in (out_size, K), where the padding is 0.
+        for (int oy = 0; oy < out_height; ++oy) {
+          for (int ox = 0; ox < out_width; ++ox) {
+            int16_t* col = qcol + int64_t(oy * out_width + ox) * K;
+            for (int c = 0; c < channels; ++c) {
+              for (int fy = 0; fy < filter_height; ++fy) {
+                int iy = oy * strides[0] - paddings[0] + fy * dilations[0];
+                for (int fx = 0; fx < filter_width; ++fx) {
+                  int ix = ox * strides[1] - paddings[1] + fx * dilations[1];
+                  bool inside =
+                      iy >= 0 && iy < in_height && ix >= 0 && ix < in_width;
+                  *col++ =
+                      inside ? im[(c * in_height + iy) * in_width + ix] : 0;
+                }
+              }
+            }
+          }
+        }
+        int o0 = g * group_out_channels;
+        math::GemmS8S16(group_out_channels, out_size, K,
+                        filter_data + int64_t(o0) * K, qcol, acc);
+        T* out = out_data + (int64_t(n) * out_channels + o0) * out_size;
+        for (int o = 0; o < group_out_channels; ++o) {
+          float scale = out_scale[o0 + o];
+          for (int i = 0; i < out_size; ++i) {
+            out[int64_t(o) * out_size + i] =
+                acc[int64_t(o) * out_size + i] * scale;
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(quantized_conv2d, ops::QuantizedConv2DOp,
+                  ops::QuantizedConv2DOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(quantized_conv2d, ops::QuantizedConv2DOpKernel<float>);
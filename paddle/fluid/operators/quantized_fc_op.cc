@@ -0,0 +1,156 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/gemm_int8.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class QuantizedFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of QuantizedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of QuantizedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of QuantizedFCOp should not be null.");
+    auto in_dims = ctx->GetInputDim("Input");
+    // OI, the transpose of the weight of fc.
+    auto w_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE(in_dims.size() == 2 || in_dims.size() == 4,
+                   "Input of QuantizedFCOp should be 2-D or 4-D tensor.");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2UL, "W should be 2-D tensor.");
+    PADDLE_ENFORCE_EQ(framework::product(in_dims) / in_dims[0], w_dims[1],
+                      "Input and W of QuantizedFCOp do not match.");
+    if (ctx->HasInput("Bias")) {
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Bias")),
+                        w_dims[0], "The shape of Bias must be [1, dim].");
+    }
+    auto weight_scale = ctx->Attrs().Get<std::vector<float>>("weight_scale");
+    PADDLE_ENFORCE(weight_scale.size() == 1UL ||
+                       static_cast<int64_t>(weight_scale.size()) == w_dims[0],
+                   "weight_scale should have one scale or one for every "
+                   "output channel.");
+    // The input is quantized by dividing by input_scale.
+    PADDLE_ENFORCE_GT(ctx->Attrs().Get<float>("input_scale"), 0.f,
+                      "input_scale should be positive.");
+
+    ctx->SetOutputDim("Out", framework::make_ddim({in_dims[0], w_dims[0]}));
+    ctx->ShareLoD("Input", "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class QuantizedFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor) The input tensor of the fc, (N, I).");
+    AddInput("W",
+             "(Tensor) The int8 weight, the transpose of the weight of the "
+             "fc, (O, I).");
+    AddInput("Bias", "(Tensor, optional) Bias vector with shape (1 x O")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output tensor, (N, O).");
+    AddAttr<float>("input_scale",
+                   "(float) The max absolute value of Input, by calibration.");
+    AddAttr<bool>("input_is_unsigned",
+                  "(bool, default false) Whether Input has no negative value, "
+                  "so it is quantized into [0, 255] instead of [-127, 127].")
+        .SetDefault(false);
+    AddAttr<std::vector<float>>(
+        "weight_scale",
+        "(vector<float>) The max absolute value of the weight, or of every "
+        "output channel of it.");
+    AddComment(R"DOC(
+Quantized Fully Connected Operator.
+
+The fc of inference in 8-bit integers, created by int8_quantize_pass. Input is
+quantized by input_scale, multiplied by the int8 weight with the products
+accumulated in int32, and the result is scaled back to float:
+
+$$
+Out = q(Input) W^T \frac{input\_scale}{range} \frac{weight\_scale}{127}
+      + Bias
+$$
+
+where range is 255 for an unsigned input and 127 otherwise.
+)DOC");
+  }
+};
+
+template <typename T>
+class QuantizedFCOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* output = ctx.Output<Tensor>("Out");
+    float input_scale = ctx.Attr<float>("input_scale");
+    bool is_unsigned = ctx.Attr<bool>("input_is_unsigned");
+    auto weight_scale = ctx.Attr<std::vector<float>>("weight_scale");
+
+    int M = input->dims()[0];
+    int O = w->dims()[0];
+    int K = w->dims()[1];
+
+    Tensor quantized_input;
+    int16_t* qx = quantized_input.mutable_data<int16_t>(
+        framework::make_ddim({M, K}), ctx.GetPlace());
+    math::QuantizeInputs(input->data<T>(), int64_t(M) * K, input_scale,
+                         is_unsigned, qx);
+    // The products of the output channels and the inputs, (O, N).
+    Tensor products;
+    int32_t* acc = products.mutable_data<int32_t>(framework::make_ddim({O, M}),
+                                                  ctx.GetPlace());
+    math::GemmS8S16(O, M, K, w->data<int8_t>(), qx, acc);
+
+    float input_step =
+        1.f / math::InputQuantizeFactor(input_scale, is_unsigned);
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* out = output->mutable_data<T>(ctx.GetPlace());
+    for (int o = 0; o < O; ++o) {
+      float scale =
+          input_step * weight_scale[weight_scale.size() == 1 ? 0 : o] / 127.f;
+      T b = bias_data ? bias_data[o] : static_cast<T>(0);
+      for (int m = 0; m < M; ++m) {
+        out[int64_t(m) * O + o] = acc[int64_t(o) * M + m] * scale + b;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(quantized_fc, ops::QuantizedFCOp, ops::QuantizedFCOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(quantized_fc, ops::QuantizedFCOpKernel<float>);
@@ -13,7 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
-#include "paddle/fluid/recordio/scanner.h"
+#include "paddle/fluid/recordio/mmap_scanner.h"
 
 namespace paddle {
 namespace operators {
@@ -21,14 +21,18 @@ namespace reader {
 template <bool ThreadSafe>
 class RecordIOFileReader : public framework::FileReader {
  public:
-  explicit RecordIOFileReader(const std::string& filename)
-      : scanner_(filename),
+  // Reads the chunks of shard `shard_id` when the chunks of the file are
+  // divided into `num_shards` shards.
+  explicit RecordIOFileReader(const std::string& filename, size_t shard_id = 0,
+                              size_t num_shards = 1)
+      : scanner_(filename, shard_id, num_shards),
         dev_ctx_(*platform::DeviceContextPool::Instance().Get(
             platform::CPUPlace())) {
     if (ThreadSafe) {
       mutex_.reset(new std::mutex());
     }
-    LOG(INFO) << "Creating file reader" << filename;
+    LOG(INFO) << "Creating file reader" << filename << ", chunks ["
+              << scanner_.BeginChunk() << ", " << scanner_.EndChunk() << ")";
   }
 
  protected:
@@ -48,10 +52,16 @@ class RecordIOFileReader : public framework::FileReader {
 
  private:
   std::unique_ptr<std::mutex> mutex_;
-  recordio::Scanner scanner_;
+  recordio::MmapScanner scanner_;
   const platform::DeviceContext& dev_ctx_;
 };
 
+std::unique_ptr<framework::ReaderBase> CreateRecordIOReader(
+    const std::string& filename, size_t shard_id, size_t num_shards) {
+  return std::unique_ptr<framework::ReaderBase>(
+      new RecordIOFileReader<false>(filename, shard_id, num_shards));
+}
+
 class CreateRecordIOReaderOp : public framework::OperatorBase {
  public:
   using framework::OperatorBase::OperatorBase;
@@ -194,6 +194,21 @@ class MultiFileReader : public framework::ReaderBase {
     }
   }
 
+  // Each file is read by `readers_per_file` readers, which read the chunks
+  // of shard `shard_id` of `num_shards` shards together.
+  MultiFileReader(const std::vector<std::string>& file_names,
+                  std::unique_ptr<IReaderContainer>&& container,
+                  size_t shard_id, size_t num_shards, size_t readers_per_file)
+      : container_(std::move(container)) {
+    for (auto& fn : file_names) {
+      for (size_t i = 0; i < readers_per_file; ++i) {
+        container_->AppendReader(
+            CreateRecordIOReader(fn, shard_id * readers_per_file + i,
+                                 num_shards * readers_per_file));
+      }
+    }
+  }
+
   ~MultiFileReader() { container_->Stop(); }
 
  protected:
@@ -236,8 +251,18 @@ class OpenFilesOp : public framework::OperatorBase {
           static_cast<size_t>(Attr<int>("thread_num"))));
     }
 
-    std::shared_ptr<framework::ReaderBase> reader(
-        new MultiFileReader(file_names, std::move(container)));
+    int num_shards = Attr<int>("num_shards");
+    int shard_id = Attr<int>("shard_id");
+    int readers_per_file = Attr<int>("readers_per_file");
+    PADDLE_ENFORCE_LT(shard_id, num_shards);
+    std::shared_ptr<framework::ReaderBase> reader;
+    if (num_shards == 1 && readers_per_file == 1) {
+      reader.reset(new MultiFileReader(file_names, std::move(container)));
+    } else {
+      reader.reset(new MultiFileReader(file_names, std::move(container),
+                                       shard_id, num_shards,
+                                       readers_per_file));
+    }
     auto buffer_size = Attr<int>("buffer_size");
     if (buffer_size > 1) {
       reader = framework::MakeDecoratedReader<BufferedReader>(
@@ -264,6 +289,19 @@ class OpenFilesOpMaker : public FileReaderMakerBase {
                  "when is_test = False");
     AddAttr<int>("buffer_size", "The reading buffer of these files.")
         .GreaterThan(0);
+    AddAttr<int>("num_shards",
+                 "The chunks of each recordio file are divided into "
+                 "num_shards shards, e.g. one for each trainer.")
+        .SetDefault(1)
+        .GreaterThan(0);
+    AddAttr<int>("shard_id", "The shard of the chunks to be read.")
+        .SetDefault(0)
+        .EqualGreaterThan(0);
+    AddAttr<int>("readers_per_file",
+                 "The number of readers which read the shard of a file "
+                 "together, each reads a contiguous part of the chunks.")
+        .SetDefault(1)
+        .GreaterThan(0);
   }
 };
 
@@ -41,6 +41,11 @@ int RegisterFileReader(const std::string& filetype) {
 std::unique_ptr<framework::ReaderBase> CreateReaderByFileName(
     const std::string& file_name);
 
+// Creates a reader of a recordio file, which only reads the chunks of shard
+// `shard_id` when the chunks are divided into `num_shards` contiguous shards.
+std::unique_ptr<framework::ReaderBase> CreateRecordIOReader(
+    const std::string& file_name, size_t shard_id, size_t num_shards);
+
 extern std::vector<framework::DDim> RestoreShapes(
     const std::vector<int>& shape_concat, const std::vector<int>& ranks);
 
@@ -71,6 +71,7 @@ class SaveCombineOp : public framework::OperatorBase {
     auto filename = Attr<std::string>("file_path");
     auto overwrite = Attr<bool>("overwrite");
     auto save_as_fp16 = Attr<bool>("save_as_fp16");
+    auto data_alignment = static_cast<size_t>(Attr<int>("data_alignment"));
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -79,7 +80,7 @@ class SaveCombineOp : public framework::OperatorBase {
     }
 
     MkDirRecursively(DirName(filename).c_str());
-    std::ofstream fout(filename);
+    std::ofstream fout(filename, std::ios::binary);
     PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
                    filename);
 
@@ -116,9 +117,9 @@ class SaveCombineOp : public framework::OperatorBase {
         // copy LoD info to the new tensor
         out.set_lod(tensor.lod());
         framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
-        framework::SerializeToStream(fout, out, dev_ctx);
+        framework::SerializeToStream(fout, out, dev_ctx, data_alignment);
       } else {
-        framework::SerializeToStream(fout, tensor, dev_ctx);
+        framework::SerializeToStream(fout, tensor, dev_ctx, data_alignment);
       }
     }
     fout.close();
@@ -148,6 +149,14 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<int>("data_alignment",
+                 "(int, default 0)"
+                 "If greater than 0, the data of every tensor starts at a "
+                 "multiple of this many bytes in the file, so that "
+                 "load_combine with use_mmap can share it without copying. "
+                 "The file can still be loaded by any load_combine.")
+        .SetDefault(0)
+        .AddCustomChecker([](const int &alignment) { return alignment >= 0; });
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <vector>
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/float16.h"
@@ -344,3 +347,122 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+// Save float tensors with and without aligned data, and load them by reading
+// and by mapping the file.
+TEST(SaveLoadCombineOp, Mmap) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<std::string> in_names, out_names;
+  std::vector<float*> expects;
+  std::vector<paddle::framework::LoD> expect_lods;
+  for (int i = 0; i < 3; ++i) {
+    in_names.push_back("mmap_in" + std::to_string(i));
+    out_names.push_back("mmap_out" + std::to_string(i));
+    expect_lods.emplace_back();
+    expects.push_back(CreateForSaveCombineOp<float, float>(
+        7 + i, 13, {0, 2, 7 + i}, in_names.back(), place, &scope,
+        &expect_lods.back()));
+  }
+
+  for (int alignment : {0, 64}) {
+    paddle::framework::AttributeMap save_attrs;
+    save_attrs.insert({"file_path", std::string("check_mmap.ls")});
+    save_attrs.insert({"data_alignment", alignment});
+    auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "save_combine", {{"X", in_names}}, {}, save_attrs);
+    save_combine_op->Run(scope, place);
+
+    for (bool use_mmap : {false, true}) {
+      paddle::framework::AttributeMap load_attrs;
+      load_attrs.insert({"file_path", std::string("check_mmap.ls")});
+      load_attrs.insert({"use_mmap", use_mmap});
+      for (auto& name : out_names) {
+        scope.Var(name)->Clear();
+        GeneratePlaceholderBeforeLoad(name, &scope);
+      }
+      auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+          "load_combine", {}, {{"Out", out_names}}, load_attrs);
+      load_combine_op->Run(scope, place);
+
+      for (size_t i = 0; i < out_names.size(); ++i) {
+        auto* target = scope.FindVar(out_names[i])
+                           ->GetMutable<paddle::framework::LoDTensor>();
+        paddle::framework::LoD actual_lod;
+        float* actual =
+            GetValuesAfterLoadCombineOp<float>(target, scope, &actual_lod);
+        CheckValues<float, float>(expects[i], actual, expect_lods[i],
+                                  actual_lod, (7 + i) * 13);
+        if (alignment > 0) {
+          EXPECT_EQ(reinterpret_cast<uintptr_t>(actual) % alignment, 0UL);
+        }
+      }
+    }
+  }
+}
+
+TEST(LoadCombineOp, DISABLED_StartupBenchmark) {
+  const int kNumParams = 32;
+  const int64_t kRows = 1024, kCols = 512;
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<std::string> in_names, out_names;
+  double expected_sum = 0;
+  for (int i = 0; i < kNumParams; ++i) {
+    in_names.push_back("param" + std::to_string(i));
+    out_names.push_back("loaded_param" + std::to_string(i));
+    auto* tensor =
+        scope.Var(in_names.back())->GetMutable<paddle::framework::LoDTensor>();
+    tensor->Resize({kRows, kCols});
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t j = 0; j < tensor->numel(); ++j) {
+      data[j] = static_cast<float>(j % 101);
+      expected_sum += data[j];
+    }
+  }
+  paddle::framework::AttributeMap save_attrs;
+  save_attrs.insert({"file_path", std::string("benchmark_params")});
+  save_attrs.insert({"data_alignment", 64});
+  paddle::framework::OpRegistry::CreateOp("save_combine", {{"X", in_names}},
+                                          {}, save_attrs)
+      ->Run(scope, place);
+
+  for (bool use_mmap : {false, true}) {
+    paddle::framework::AttributeMap load_attrs;
+    load_attrs.insert({"file_path", std::string("benchmark_params")});
+    load_attrs.insert({"use_mmap", use_mmap});
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", out_names}}, load_attrs);
+    for (auto& name : out_names) {
+      scope.Var(name)->Clear();
+      GeneratePlaceholderBeforeLoad(name, &scope);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    load_combine_op->Run(scope, place);
+    auto loaded = std::chrono::steady_clock::now();
+    // Touch every parameter, as the first run of a model would.
+    double sum = 0;
+    for (auto& name : out_names) {
+      auto& tensor = scope.FindVar(name)->Get<paddle::framework::LoDTensor>();
+      const float* data = tensor.data<float>();
+      for (int64_t j = 0; j < tensor.numel(); ++j) {
+        sum += data[j];
+      }
+    }
+    auto touched = std::chrono::steady_clock::now();
+    EXPECT_EQ(expected_sum, sum);
+
+    LOG(INFO) << "load_combine " << kNumParams * kRows * kCols * sizeof(float)
+              << " bytes with use_mmap=" << use_mmap << ": "
+              << std::chrono::duration<double, std::milli>(loaded - start)
+                     .count()
+              << " ms to load, "
+              << std::chrono::duration<double, std::milli>(touched - loaded)
+                     .count()
+              << " ms to read every parameter";
+  }
+  std::remove("benchmark_params");
+}
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/macros.h"
+#include "paddle/fluid/operators/distributed/gradient_compression.h"
 #include "paddle/fluid/operators/send_recv_util.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -39,6 +40,11 @@ class SendOp : public framework::OperatorBase {
     std::vector<std::string> epmap = Attr<std::vector<std::string>>("epmap");
     int sync_send = Attr<int>("sync_mode");
 
+    distributed::CompressConfig compress;
+    compress.type =
+        distributed::ParseCompressType(Attr<std::string>("compress_type"));
+    compress.ratio = Attr<float>("compress_ratio");
+
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     auto& ctx = *pool.Get(place);
 
@@ -48,6 +54,7 @@ class SendOp : public framework::OperatorBase {
     for (size_t i = 0; i < ins.size(); i++) {
       if (NeedSend(scope, ins[i])) {
         VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
+        distributed::SetVarCompression(ins[i], compress);
         // TODO(Yancey1989): we need to use an IO threadpool which has
         // a larger number of threads than the computing threadpool.
         rpc_client->AsyncSendVar(epmap[i], ctx, scope, ins[i]);
@@ -82,6 +89,16 @@ This operator will send variables to listen_and_serve op at the parameter server
                                       "Server endpoints in the order of input "
                                       "variables for mapping")
         .SetDefault({"127.0.0.1:6164"});
+    AddAttr<std::string>("compress_type",
+                         "(string, default \"\")"
+                         "How the FP32 LoDTensors are compressed when sent: "
+                         "\"topk\", \"fp16\", \"int8\", or \"\" for none. "
+                         "What is not sent is added to the next send.")
+        .SetDefault("");
+    AddAttr<float>("compress_ratio",
+                   "(float, default 0.01)"
+                   "The fraction of the elements sent by \"topk\".")
+        .SetDefault(0.01f);
   }
 };
 
@@ -16,6 +16,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 namespace paddle {
 namespace operators {
@@ -74,9 +75,24 @@ class SGDOpKernel : public framework::OpKernel<T> {
         for (size_t i = 0; i < grad_rows.size(); i++) {
           PADDLE_ENFORCE(grad_rows[i] < grad_height,
                          "Input rows index should less than height");
-          for (size_t j = 0; j < grad_row_numel; j++) {
-            out_data[grad_rows[i] * grad_row_numel + j] -=
-                lr[0] * grad_data[i * grad_row_numel + j];
+        }
+        // The distinct rows are updated in parallel, and the duplicates of a
+        // row one after another in their order, which is what the serial
+        // update does.
+        math::scatter::RowGroups groups;
+        math::scatter::GroupRows(grad_rows.data(), grad_rows.size(), &groups);
+        int64_t num_rows = groups.rows.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_rows >= \
+                             2 * math::scatter::kMinMergeRowsPerThread)
+#endif
+        for (int64_t k = 0; k < num_rows; ++k) {
+          T *out = out_data + groups.rows[k] * grad_row_numel;
+          for (size_t p = groups.offsets[k]; p < groups.offsets[k + 1]; ++p) {
+            const T *g = grad_data + groups.order[p] * grad_row_numel;
+            for (size_t j = 0; j < grad_row_numel; j++) {
+              out[j] -= lr[0] * g[j];
+            }
           }
         }
       } else {
@@ -108,17 +124,20 @@ class SGDOpKernel : public framework::OpKernel<T> {
       const auto *lr = learning_rate->data<T>();
       const auto *grad_data = grad.value().data<T>();
       auto *out_data = param_out->mutable_value()->data<T>();
-      for (size_t i = 0; i < grad.rows().size(); i++) {
-        PADDLE_ENFORCE(grad.rows()[i] < grad.height(),
+      const auto &grad_rows = grad.rows();
+      for (size_t i = 0; i < grad_rows.size(); i++) {
+        PADDLE_ENFORCE(grad_rows[i] < grad.height(),
                        "Input rows index should less than height");
-        int64_t id_index = param_out->AutoGrownIndex(grad.rows()[i], false);
-        PADDLE_ENFORCE_GE(id_index, static_cast<int64_t>(0),
-                          "id should be in the table");
-        for (int64_t j = 0; j < grad_row_width; j++) {
-          out_data[id_index * grad_row_width + j] -=
-              lr[0] * grad_data[i * grad_row_width + j];
-        }
       }
+      // The rows of the table are updated shard by shard, with the lock of
+      // the shard held.
+      param_out->UpdateRows(
+          grad_rows.data(), grad_rows.size(), [&](int64_t i, int64_t id_index) {
+            for (int64_t j = 0; j < grad_row_width; j++) {
+              out_data[id_index * grad_row_width + j] -=
+                  lr[0] * grad_data[i * grad_row_width + j];
+            }
+          });
     } else {
       PADDLE_THROW("Unsupported Variable Type of Parameter");
     }
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <sys/time.h>
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <limits>
 #include <map>
@@ -39,8 +40,10 @@ static int64_t profiler_lister_id = 0;
 static bool should_send_profile_state = false;
 std::mutex profiler_mu;
 
-// The profiler state, the initial value is ProfilerState::kDisabled
-static ProfilerState g_state = ProfilerState::kDisabled;
+// The profiler state, the initial value is ProfilerState::kDisabled. It is
+// only changed with profiler_mu held, but read without it by RecordEvent to
+// skip locking when the profiler is disabled.
+static std::atomic<ProfilerState> g_state{ProfilerState::kDisabled};
 // The thread local event list only can be accessed by the specific thread
 // The thread index of each thread
 static thread_local int32_t g_thread_id;
@@ -170,7 +173,8 @@ void PopEvent(const std::string& name, const DeviceContext* dev_ctx) {
 }
 
 RecordEvent::RecordEvent(const std::string& name, const DeviceContext* dev_ctx)
-    : is_enabled_(false), start_ns_(PosixInNsec()) {
+    : is_enabled_(false), start_ns_(PosixInNsec()), sample_(SampleEvent(name)) {
+  if (g_state == ProfilerState::kDisabled) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled) return;
   is_enabled_ = true;
@@ -182,8 +186,12 @@ RecordEvent::RecordEvent(const std::string& name, const DeviceContext* dev_ctx)
 }
 
 RecordEvent::~RecordEvent() {
+  if (sample_ != nullptr) {
+    RecordSample(sample_, start_ns_, PosixInNsec());
+  }
+  if (!is_enabled_) return;
   std::lock_guard<std::mutex> l(profiler_mu);
-  if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
+  if (g_state == ProfilerState::kDisabled) return;
   DeviceTracer* tracer = GetDeviceTracer();
   if (tracer) {
     tracer->AddCPURecords(CurAnnotation(), start_ns_, PosixInNsec(),
@@ -195,6 +203,7 @@ RecordEvent::~RecordEvent() {
 
 RecordBlock::RecordBlock(int block_id)
     : is_enabled_(false), start_ns_(PosixInNsec()) {
+  if (g_state == ProfilerState::kDisabled) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled) return;
   is_enabled_ = true;
@@ -203,8 +212,9 @@ RecordBlock::RecordBlock(int block_id)
 }
 
 RecordBlock::~RecordBlock() {
+  if (!is_enabled_) return;
   std::lock_guard<std::mutex> l(profiler_mu);
-  if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
+  if (g_state == ProfilerState::kDisabled) return;
   DeviceTracer* tracer = GetDeviceTracer();
   if (tracer) {
     // We try to put all blocks at the same nested depth in the
@@ -262,6 +272,37 @@ std::vector<std::vector<Event>> GetAllEvents() {
   return result;
 }
 
+void ExportChromeTrace(const std::vector<std::vector<Event>>& events,
+                       std::ostream& os) {
+  std::vector<TraceEvent> ranges;
+  for (auto& thread_events : events) {
+    std::vector<const Event*> pushed_events;
+    for (auto& event : thread_events) {
+      if (event.type() == EventType::kPushRange) {
+        pushed_events.push_back(&event);
+      } else if (event.type() == EventType::kPopRange) {
+        auto rit = pushed_events.rbegin();
+        while (rit != pushed_events.rend() &&
+               (*rit)->name() != event.name()) {
+          ++rit;
+        }
+        if (rit == pushed_events.rend()) {
+          continue;
+        }
+        ranges.push_back({event.name(), event.thread_id(),
+                          static_cast<uint64_t>((*rit)->cpu_ns()),
+                          static_cast<uint64_t>(event.cpu_ns())});
+        pushed_events.erase(std::next(rit).base());
+      }
+    }
+  }
+  std::sort(ranges.begin(), ranges.end(),
+            [](const TraceEvent& a, const TraceEvent& b) {
+              return a.start_ns < b.start_ns;
+            });
+  WriteChromeTrace(ranges, os);
+}
+
 // The information of each event given in the profiling report
 struct EventItem {
   std::string name;
@@ -289,7 +330,7 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
   } else if (g_state == ProfilerState::kAll) {
     place = "All";
   } else {
-    PADDLE_THROW("Invalid profiler state", g_state);
+    PADDLE_THROW("Invalid profiler state", g_state.load());
   }
 
   std::cout << "Place: " << place << std::endl;
@@ -15,9 +15,11 @@ limitations under the License. */
 #pragma once
 #include <forward_list>
 #include <list>
+#include <ostream>
 #include <string>
 #include <vector>
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 namespace paddle {
 namespace platform {
@@ -35,6 +37,7 @@ class Event {
   std::string name() const { return name_; }
   uint32_t thread_id() const { return thread_id_; }
   bool has_cuda() const { return has_cuda_; }
+  int64_t cpu_ns() const { return cpu_ns_; }
 
 #ifdef PADDLE_WITH_CUDA
   cudaEvent_t event() const { return event_; }
@@ -77,6 +80,8 @@ struct RecordEvent {
 
   bool is_enabled_;
   uint64_t start_ns_;
+  // Not null if the event is timed by the sampling profiler.
+  LatencyHistogram* sample_;
   // The device context is used by Event to get the current cuda stream.
   const DeviceContext* dev_ctx_;
   // Event name
@@ -109,6 +114,11 @@ struct RecordBlock {
 // event_lists, event_lists[i][j] represents the j-th Event of i-th thread.
 std::vector<std::vector<Event>> GetAllEvents();
 
+// Pair the push and pop events of every thread returned by GetAllEvents as
+// ranges, and write them in the JSON format loaded by chrome://tracing.
+void ExportChromeTrace(const std::vector<std::vector<Event>>& events,
+                       std::ostream& os);
+
 // Candidate keys to sort the profiling report
 enum EventSortingKey { kDefault, kCalls, kTotal, kMin, kMax, kAve };
 
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
+#include <chrono>  // NOLINT
+#include <sstream>
 #include <string>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda_runtime.h>
@@ -162,6 +164,66 @@ TEST(RecordEvent, RecordEvent) {
   DisableProfiler(EventSortingKey::kTotal, "/tmp/profiler");
 }
 
+TEST(RecordEvent, ExportChromeTrace) {
+  using paddle::platform::EventSortingKey;
+  using paddle::platform::ProfilerState;
+  using paddle::platform::RecordEvent;
+
+  EnableProfiler(ProfilerState::kCPU);
+  for (int i = 0; i < 3; ++i) {
+    RecordEvent outer("outer", nullptr);
+    RecordEvent inner("inner \"quoted\"", nullptr);
+  }
+  std::ostringstream os;
+  ExportChromeTrace(paddle::platform::GetAllEvents(), os);
+  DisableProfiler(EventSortingKey::kDefault, "/tmp/profiler");
+
+  std::string json = os.str();
+  EXPECT_EQ(json.find("{\"traceEvents\":["), 0UL);
+  size_t count = 0;
+  for (size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos;
+       pos = json.find("\"ph\":\"X\"", pos + 1)) {
+    ++count;
+  }
+  EXPECT_EQ(count, 6UL);
+  EXPECT_NE(json.find("\"name\":\"inner \\\"quoted\\\"\""),
+            std::string::npos);
+}
+
+TEST(RecordEvent, SamplingOverhead) {
+  using paddle::platform::RecordEvent;
+
+  auto time_ns = [](int n) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+      RecordEvent record_event("sampled_op", nullptr);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+  };
+  const int kEvents = 1000000;
+  paddle::platform::DisableSampling();
+  double disabled = time_ns(kEvents);
+  paddle::platform::EnableSampling(100);
+  double sampled = time_ns(kEvents);
+  paddle::platform::DisableSampling();
+  LOG(INFO) << "RecordEvent with the profiler disabled: " << disabled
+            << " ns, sampling 1/100: " << sampled << " ns";
+
+  bool found = false;
+  for (auto& stats : paddle::platform::GetLatencyStats()) {
+    if (stats.name == "sampled_op") {
+      found = true;
+      EXPECT_EQ(stats.count, static_cast<uint64_t>(kEvents / 100));
+      EXPECT_LE(stats.p50_ms, stats.p99_ms);
+      EXPECT_LE(stats.p99_ms, stats.p999_ms);
+      EXPECT_LE(stats.p999_ms, stats.max_ms);
+    }
+  }
+  EXPECT_TRUE(found);
+  paddle::platform::ResetSampling();
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(TMP, stream_wait) {
   cudaStream_t stream;
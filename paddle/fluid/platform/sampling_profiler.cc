@@ -0,0 +1,360 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(profiler_sample_period, 0,
+             "If positive, time one in every profiler_sample_period operators "
+             "of each thread and keep their latency histograms, even if the "
+             "profiler is not enabled. 0 disables sampling.");
+DEFINE_int32(profiler_sample_ring_size, 4096,
+             "The number of the latest samples kept by each thread for the "
+             "chrome://tracing exporter of the sampling profiler.");
+
+namespace paddle {
+namespace platform {
+
+constexpr size_t LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram(const std::string& name)
+    : name_(name), count_(0), max_(0) {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+  if (ns < kSubBuckets) {
+    return ns;
+  }
+  int shift = 63 - __builtin_clzll(ns) - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + ((ns >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  int shift = static_cast<int>(index / kSubBuckets) - 1;
+  uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+  return lower + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+  buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (ns > max &&
+         !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  // Counted from the buckets rather than count_, which may be updated
+  // independently by a concurrent Record.
+  uint64_t counts[kNumBuckets];
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  q = std::min(std::max(q, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(BucketUpperBound(i), Max());
+    }
+  }
+  return Max();
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+SampleRing::SampleRing(size_t capacity, uint32_t thread_id)
+    : slots_(new Slot[capacity]),
+      capacity_(capacity),
+      thread_id_(thread_id),
+      head_(0),
+      begin_(0) {
+  PADDLE_ENFORCE_GT(capacity, 0UL);
+}
+
+void SampleRing::Push(const LatencyHistogram* histogram, uint64_t start_ns,
+                      uint64_t end_ns) {
+  uint64_t pos = head_.load(std::memory_order_relaxed);
+  Slot& slot = slots_[pos % capacity_];
+  slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.histogram.store(histogram, std::memory_order_relaxed);
+  slot.start_ns.store(start_ns, std::memory_order_relaxed);
+  slot.end_ns.store(end_ns, std::memory_order_relaxed);
+  slot.seq.store(2 * pos + 2, std::memory_order_release);
+  head_.store(pos + 1, std::memory_order_release);
+}
+
+void SampleRing::Snapshot(std::vector<TraceEvent>* events) const {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t begin = begin_.load(std::memory_order_relaxed);
+  if (head > capacity_) {
+    begin = std::max(begin, head - capacity_);
+  }
+  for (uint64_t pos = begin; pos < head; ++pos) {
+    const Slot& slot = slots_[pos % capacity_];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * pos + 2) {
+      // Being overwritten by a later sample.
+      continue;
+    }
+    auto* histogram = slot.histogram.load(std::memory_order_relaxed);
+    uint64_t start_ns = slot.start_ns.load(std::memory_order_relaxed);
+    uint64_t end_ns = slot.end_ns.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    events->push_back({histogram->name(), thread_id_, start_ns, end_ns});
+  }
+}
+
+void SampleRing::Clear() {
+  begin_.store(head_.load(std::memory_order_acquire),
+               std::memory_order_relaxed);
+}
+
+namespace {
+
+// -1 until FLAGS_profiler_sample_period is read at the first event.
+std::atomic<int> g_sample_period{-1};
+
+struct SamplingRegistry {
+  std::mutex mutex;
+  // Histograms are never deleted, so threads can cache pointers to them.
+  std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+  std::list<std::shared_ptr<SampleRing>> rings;
+  uint32_t next_thread_id = 0;
+};
+
+SamplingRegistry& Registry() {
+  // Never destroyed, since threads may record samples at exit.
+  static SamplingRegistry* registry = new SamplingRegistry;
+  return *registry;
+}
+
+struct ThreadSampler {
+  ThreadSampler() {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ring = std::make_shared<SampleRing>(
+        static_cast<size_t>(std::max(FLAGS_profiler_sample_ring_size, 1)),
+        registry.next_thread_id++);
+    registry.rings.push_back(ring);
+  }
+
+  ~ThreadSampler() {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.rings.remove(ring);
+  }
+
+  LatencyHistogram* Histogram(const std::string& name) {
+    auto it = histograms.find(name);
+    if (it != histograms.end()) {
+      return it->second;
+    }
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto& histogram = registry.histograms[name];
+    if (histogram == nullptr) {
+      histogram.reset(new LatencyHistogram(name));
+    }
+    histograms.emplace(name, histogram.get());
+    return histogram.get();
+  }
+
+  int countdown = 0;
+  std::shared_ptr<SampleRing> ring;
+  std::unordered_map<std::string, LatencyHistogram*> histograms;
+};
+
+ThreadSampler& GetThreadSampler() {
+  static thread_local ThreadSampler sampler;
+  return sampler;
+}
+
+int SamplePeriod() {
+  int period = g_sample_period.load(std::memory_order_relaxed);
+  if (period < 0) {
+    int expected = -1;
+    g_sample_period.compare_exchange_strong(
+        expected, std::max(FLAGS_profiler_sample_period, 0));
+    period = g_sample_period.load(std::memory_order_relaxed);
+  }
+  return period;
+}
+
+void WriteJsonString(const std::string& str, std::ostream& os) {
+  os << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          os << buf;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+// Chrome trace timestamps are in microseconds.
+void WriteMicroseconds(uint64_t ns, std::ostream& os) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%llu.%03llu",
+           static_cast<unsigned long long>(ns / 1000),   // NOLINT
+           static_cast<unsigned long long>(ns % 1000));  // NOLINT
+  os << buf;
+}
+
+}  // namespace
+
+void EnableSampling(int period) {
+  PADDLE_ENFORCE_GT(period, 0, "The sample period must be positive.");
+  g_sample_period.store(period, std::memory_order_relaxed);
+}
+
+void DisableSampling() { g_sample_period.store(0, std::memory_order_relaxed); }
+
+bool IsSamplingEnabled() { return SamplePeriod() > 0; }
+
+LatencyHistogram* SampleEvent(const std::string& name) {
+  int period = SamplePeriod();
+  if (period == 0) {
+    return nullptr;
+  }
+  auto& sampler = GetThreadSampler();
+  if (--sampler.countdown > 0) {
+    return nullptr;
+  }
+  sampler.countdown = period;
+  return sampler.Histogram(name);
+}
+
+void RecordSample(LatencyHistogram* histogram, uint64_t start_ns,
+                  uint64_t end_ns) {
+  histogram->Record(end_ns - start_ns);
+  GetThreadSampler().ring->Push(histogram, start_ns, end_ns);
+}
+
+std::vector<LatencyStats> GetLatencyStats() {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<LatencyStats> stats;
+  for (auto& item : registry.histograms) {
+    auto& histogram = *item.second;
+    if (histogram.Count() == 0) {
+      continue;
+    }
+    stats.push_back({item.first, histogram.Count(),
+                     histogram.Percentile(0.5) / 1e6,
+                     histogram.Percentile(0.99) / 1e6,
+                     histogram.Percentile(0.999) / 1e6, histogram.Max() / 1e6});
+  }
+  return stats;
+}
+
+std::vector<TraceEvent> GetSampledEvents() {
+  auto& registry = Registry();
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& ring : registry.rings) {
+      ring->Snapshot(&events);
+    }
+  }
+  std::sort(events.begin(), events.end(),
+            [](const TraceEvent& a, const TraceEvent& b) {
+              return a.start_ns < b.start_ns;
+            });
+  return events;
+}
+
+void ResetSampling() {
+  auto& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& item : registry.histograms) {
+    item.second->Reset();
+  }
+  for (auto& ring : registry.rings) {
+    ring->Clear();
+  }
+}
+
+void WriteChromeTrace(const std::vector<TraceEvent>& events, std::ostream& os) {
+  // Every event is a complete event ("ph": "X") with its duration.
+  os << "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); ++i) {
+    auto& event = events[i];
+    os << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    WriteJsonString(event.name, os);
+    os << ",\"cat\":\"op\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread_id
+       << ",\"ts\":";
+    WriteMicroseconds(event.start_ns, os);
+    os << ",\"dur\":";
+    WriteMicroseconds(event.end_ns - event.start_ns, os);
+    os << '}';
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,145 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+// A histogram of latencies in nanoseconds, in the layout of HdrHistogram:
+// values are grouped by their power of two, and each power of two is split
+// into 2^kSubBucketBits linear buckets, so every bucket covers a range within
+// 1 / 2^kSubBucketBits (about 3%) of its values. Recording is lock-free and
+// can be done from any thread.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr size_t kSubBuckets = 1UL << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (65 - kSubBucketBits) * kSubBuckets;
+
+  explicit LatencyHistogram(const std::string& name);
+
+  const std::string& name() const { return name_; }
+
+  void Record(uint64_t ns);
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  // The highest latency of the bucket holding the q-th quantile, q in [0, 1].
+  // Returns 0 if nothing has been recorded.
+  uint64_t Percentile(double q) const;
+
+  void Reset();
+
+  static size_t BucketIndex(uint64_t ns);
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  std::string name_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> max_;
+  std::atomic<uint64_t> buckets_[kNumBuckets];
+};
+
+// An event recorded by the sampling profiler, or a range of the events
+// collected by the profiler, in the form exported to chrome://tracing.
+struct TraceEvent {
+  std::string name;
+  uint32_t thread_id;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+struct LatencyStats {
+  std::string name;
+  uint64_t count;
+  double p50_ms;
+  double p99_ms;
+  double p999_ms;
+  double max_ms;
+};
+
+// The sampling profiler times one in every `period` RecordEvent scopes of
+// each thread, whether or not the profiler is enabled. Every sample is added
+// to the latency histogram of its event name, and to a fixed size ring buffer
+// of the thread which keeps the latest samples for chrome://tracing. Neither
+// takes a lock on the recording thread, so it can be left on in production.
+//
+// It is started at the first event if FLAGS_profiler_sample_period is
+// positive, or by EnableSampling at any time.
+void EnableSampling(int period);
+void DisableSampling();
+bool IsSamplingEnabled();
+
+// Returns the histogram of the event if this call is sampled, or nullptr.
+LatencyHistogram* SampleEvent(const std::string& name);
+// Records a sample returned by SampleEvent.
+void RecordSample(LatencyHistogram* histogram, uint64_t start_ns,
+                  uint64_t end_ns);
+
+// The latency percentiles of every sampled event name, sorted by name.
+std::vector<LatencyStats> GetLatencyStats();
+
+// The samples kept in the ring buffers of all threads, sorted by start time.
+std::vector<TraceEvent> GetSampledEvents();
+
+// Clears the histograms and the ring buffers.
+void ResetSampling();
+
+// Writes the events in the JSON format loaded by chrome://tracing.
+void WriteChromeTrace(const std::vector<TraceEvent>& events, std::ostream& os);
+
+// The single-producer ring buffer holding the latest samples of a thread.
+// The owning thread pushes without locking, and other threads take
+// consistent snapshots of it by checking the sequence number of each slot.
+class SampleRing {
+ public:
+  SampleRing(size_t capacity, uint32_t thread_id);
+
+  void Push(const LatencyHistogram* histogram, uint64_t start_ns,
+            uint64_t end_ns);
+
+  // Appends the samples in the buffer to `events`.
+  void Snapshot(std::vector<TraceEvent>* events) const;
+
+  void Clear();
+
+ private:
+  struct Slot {
+    // Odd while the slot is being written.
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const LatencyHistogram*> histogram{nullptr};
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> end_ns{0};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_;
+  uint32_t thread_id_;
+  // The number of samples ever pushed.
+  std::atomic<uint64_t> head_;
+  // Samples before begin_ have been cleared.
+  std::atomic<uint64_t> begin_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,178 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(LatencyHistogram, Buckets) {
+  for (uint64_t ns = 0; ns < 100000; ++ns) {
+    size_t index = LatencyHistogram::BucketIndex(ns);
+    ASSERT_LT(index, LatencyHistogram::kNumBuckets);
+    ASSERT_GE(LatencyHistogram::BucketUpperBound(index), ns);
+    if (index > 0) {
+      ASSERT_LT(LatencyHistogram::BucketUpperBound(index - 1), ns);
+    }
+    // The bucket of a value is at most 1/32 of it wide.
+    ASSERT_LE(LatencyHistogram::BucketUpperBound(index) - ns, ns / 32);
+  }
+  uint64_t max = ~0ULL;
+  EXPECT_EQ(LatencyHistogram::BucketIndex(max),
+            LatencyHistogram::kNumBuckets - 1);
+  EXPECT_EQ(LatencyHistogram::BucketUpperBound(
+                LatencyHistogram::kNumBuckets - 1),
+            max);
+}
+
+TEST(LatencyHistogram, Percentile) {
+  LatencyHistogram histogram("op");
+  EXPECT_EQ(histogram.Percentile(0.5), 0UL);
+  // 1us, 2us, ..., 1000us
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  EXPECT_EQ(histogram.Count(), 1000UL);
+  EXPECT_EQ(histogram.Max(), 1000000UL);
+  auto near = [](uint64_t value, uint64_t expected) {
+    return value >= expected && value <= expected + expected / 32;
+  };
+  EXPECT_TRUE(near(histogram.Percentile(0.5), 500000));
+  EXPECT_TRUE(near(histogram.Percentile(0.99), 990000));
+  EXPECT_TRUE(near(histogram.Percentile(0.999), 999000));
+  EXPECT_EQ(histogram.Percentile(1.0), 1000000UL);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0UL);
+  EXPECT_EQ(histogram.Percentile(0.99), 0UL);
+}
+
+TEST(SampleRing, KeepsLatestSamples) {
+  LatencyHistogram histogram("op");
+  SampleRing ring(4, 7);
+  for (uint64_t i = 0; i < 10; ++i) {
+    ring.Push(&histogram, i * 10, i * 10 + 5);
+  }
+  std::vector<TraceEvent> events;
+  ring.Snapshot(&events);
+  ASSERT_EQ(events.size(), 4UL);
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].name, "op");
+    EXPECT_EQ(events[i].thread_id, 7U);
+    EXPECT_EQ(events[i].start_ns, (6 + i) * 10);
+    EXPECT_EQ(events[i].end_ns, (6 + i) * 10 + 5);
+  }
+
+  ring.Clear();
+  events.clear();
+  ring.Snapshot(&events);
+  EXPECT_TRUE(events.empty());
+  ring.Push(&histogram, 100, 105);
+  ring.Snapshot(&events);
+  ASSERT_EQ(events.size(), 1UL);
+  EXPECT_EQ(events[0].start_ns, 100UL);
+}
+
+TEST(SampleRing, ConcurrentSnapshot) {
+  LatencyHistogram histogram("op");
+  SampleRing ring(64, 0);
+  std::atomic<bool> done(false);
+  std::thread producer([&] {
+    for (uint64_t i = 0; i < 200000; ++i) {
+      // Every sample lasts as long as its start, which a torn read breaks.
+      ring.Push(&histogram, i, 2 * i);
+    }
+    done = true;
+  });
+  while (!done) {
+    std::vector<TraceEvent> events;
+    ring.Snapshot(&events);
+    ASSERT_LE(events.size(), 64UL);
+    for (auto& event : events) {
+      ASSERT_EQ(event.end_ns, 2 * event.start_ns);
+    }
+  }
+  producer.join();
+}
+
+TEST(SamplingProfiler, SampleEvent) {
+  EnableSampling(4);
+  EXPECT_TRUE(IsSamplingEnabled());
+  int sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    LatencyHistogram* histogram = SampleEvent("sampled");
+    if (histogram != nullptr) {
+      ++sampled;
+      EXPECT_EQ(histogram->name(), "sampled");
+      RecordSample(histogram, 1000 * i, 1000 * i + 50);
+    }
+  }
+  EXPECT_EQ(sampled, 25);
+
+  std::thread other([] {
+    for (int i = 0; i < 8; ++i) {
+      LatencyHistogram* histogram = SampleEvent("sampled");
+      if (histogram != nullptr) {
+        RecordSample(histogram, 0, 60);
+      }
+    }
+  });
+  other.join();
+
+  DisableSampling();
+  EXPECT_FALSE(IsSamplingEnabled());
+  EXPECT_EQ(SampleEvent("sampled"), nullptr);
+
+  auto stats = GetLatencyStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].name, "sampled");
+  EXPECT_EQ(stats[0].count, 27UL);
+  EXPECT_DOUBLE_EQ(stats[0].p50_ms, 50 / 1e6);
+  EXPECT_DOUBLE_EQ(stats[0].max_ms, 60 / 1e6);
+
+  // The ring of the exited thread is dropped.
+  auto events = GetSampledEvents();
+  ASSERT_EQ(events.size(), 25UL);
+  for (size_t i = 1; i < events.size(); ++i) {
+    EXPECT_LT(events[i - 1].start_ns, events[i].start_ns);
+  }
+
+  ResetSampling();
+  EXPECT_TRUE(GetLatencyStats().empty());
+  EXPECT_TRUE(GetSampledEvents().empty());
+}
+
+TEST(SamplingProfiler, WriteChromeTrace) {
+  std::ostringstream os;
+  WriteChromeTrace({{"conv2d", 3, 1234567, 1334567}, {"a\"b\\c\n", 0, 0, 1}},
+                   os);
+  EXPECT_EQ(os.str(),
+            "{\"traceEvents\":[\n"
+            "{\"name\":\"conv2d\",\"cat\":\"op\",\"ph\":\"X\",\"pid\":0,"
+            "\"tid\":3,\"ts\":1234.567,\"dur\":100.000},\n"
+            "{\"name\":\"a\\\"b\\\\c\\n\",\"cat\":\"op\",\"ph\":\"X\","
+            "\"pid\":0,\"tid\":0,\"ts\":0.000,\"dur\":0.001}\n"
+            "],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -636,6 +636,12 @@ All parameter, weight, gradient are variables in Paddle.
         self.type_ = experimental ? ExecutionStrategy::kExperimental
                                   : ExecutionStrategy::kDefault;
       });
+  exec_strategy.def_property(
+      "use_work_stealing",
+      [](const ExecutionStrategy &self) { return self.use_work_stealing_; },
+      [](ExecutionStrategy &self, bool use_work_stealing) {
+        self.use_work_stealing_ = use_work_stealing;
+      });
 
   py::class_<BuildStrategy> build_strategy(pe, "BuildStrategy");
 
@@ -672,7 +678,20 @@ All parameter, weight, gradient are variables in Paddle.
       .def_property(
           "enable_data_balance",
           [](const BuildStrategy &self) { return self.enable_data_balance_; },
-          [](BuildStrategy &self, bool b) { self.enable_data_balance_ = b; });
+          [](BuildStrategy &self, bool b) { self.enable_data_balance_ = b; })
+      .def_property(
+          "fuse_all_reduce_ops",
+          [](const BuildStrategy &self) { return self.fuse_all_reduce_ops_; },
+          [](BuildStrategy &self, bool b) { self.fuse_all_reduce_ops_ = b; })
+      .def_property(
+          "fuse_all_reduce_bucket_mb",
+          [](const BuildStrategy &self) {
+            return self.fuse_all_reduce_bucket_mb_;
+          },
+          [](BuildStrategy &self, int mb) {
+            PADDLE_ENFORCE_GT(mb, 0, "The bucket size should be positive.");
+            self.fuse_all_reduce_bucket_mb_ = mb;
+          });
 
   pe.def(py::init<const std::vector<platform::Place> &,
                   const std::unordered_set<std::string> &,
@@ -29,10 +29,12 @@ namespace {
 class RecordIOWriter {
  public:
   RecordIOWriter(const std::string& filename, recordio::Compressor compressor,
-                 size_t max_num_record)
+                 size_t max_num_record, int compress_level,
+                 size_t num_compress_threads)
       : closed_(false),
         stream_(filename),
-        writer_(&stream_, compressor, max_num_record) {}
+        writer_(&stream_, compressor, max_num_record, compress_level,
+                num_compress_threads) {}
 
   void AppendTensor(const framework::LoDTensor& tensor) {
     tensors_.push_back(tensor);
@@ -71,14 +73,22 @@ void BindRecordIOWriter(py::module* m) {
   py::class_<RecordIOWriter> writer(*m, "RecordIOWriter", "");
   py::enum_<recordio::Compressor>(writer, "Compressor", "")
       .value("Snappy", recordio::Compressor::kSnappy)
-      .value("NoCompress", recordio::Compressor::kNoCompress);
+      .value("NoCompress", recordio::Compressor::kNoCompress)
+      .value("LZ4", recordio::Compressor::kLZ4)
+      .value("Zstd", recordio::Compressor::kZstd);
 
   writer
       .def("__init__",
            [](RecordIOWriter& self, const std::string& filename,
-              recordio::Compressor compressor, size_t max_num_record) {
-             new (&self) RecordIOWriter(filename, compressor, max_num_record);
-           })
+              recordio::Compressor compressor, size_t max_num_record,
+              int compress_level, size_t num_compress_threads) {
+             new (&self)
+                 RecordIOWriter(filename, compressor, max_num_record,
+                                compress_level, num_compress_threads);
+           },
+           py::arg("filename"), py::arg("compressor"),
+           py::arg("max_num_record"), py::arg("compress_level") = 0,
+           py::arg("num_compress_threads") = 0)
       .def("append_tensor", &RecordIOWriter::AppendTensor)
       .def("complete_append_tensor", &RecordIOWriter::CompleteAppendTensor)
       .def("close", &RecordIOWriter::Close);
@@ -14,8 +14,12 @@
 
 #include "paddle/fluid/recordio/chunk.h"
 
+#include <lz4.h>
+#include <lz4hc.h>
 #include <zlib.h>
+#include <zstd.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
@@ -76,12 +80,95 @@ static uint32_t Crc32Stream(std::istream& in, size_t limit = 0) {
   return crc;
 }
 
-bool Chunk::Write(std::ostream& os, Compressor ct) const {
+/**
+ * Compress a block. An LZ4 block is prefixed with its uncompressed size,
+ * while a Zstd frame records the size itself.
+ */
+static std::string CompressBlock(const std::string& raw, Compressor ct,
+                                 int level) {
+  std::string out;
+  if (ct == Compressor::kLZ4) {
+    PADDLE_ENFORCE_LE(raw.size(), static_cast<size_t>(LZ4_MAX_INPUT_SIZE),
+                      "chunk is too large to be compressed by LZ4");
+    uint32_t raw_size = static_cast<uint32_t>(raw.size());
+    int bound = LZ4_compressBound(static_cast<int>(raw_size));
+    out.resize(sizeof(uint32_t) + bound);
+    memcpy(&out[0], &raw_size, sizeof(uint32_t));
+    char* dst = &out[sizeof(uint32_t)];
+    int len;
+    if (level > 0) {
+      len = LZ4_compress_HC(raw.data(), dst, static_cast<int>(raw_size), bound,
+                            level);
+    } else {
+      len = LZ4_compress_fast(raw.data(), dst, static_cast<int>(raw_size),
+                              bound, level < 0 ? -level : 1);
+    }
+    PADDLE_ENFORCE_GT(len, 0, "LZ4 compression failed");
+    out.resize(sizeof(uint32_t) + len);
+  } else {
+    size_t bound = ZSTD_compressBound(raw.size());
+    out.resize(bound);
+    size_t len = ZSTD_compress(&out[0], bound, raw.data(), raw.size(), level);
+    PADDLE_ENFORCE(!ZSTD_isError(len), "Zstd compression failed: %s",
+                   ZSTD_getErrorName(len));
+    out.resize(len);
+  }
+  return out;
+}
+
+static std::string DecompressBlock(const std::string& in, Compressor ct) {
+  std::string raw;
+  if (ct == Compressor::kLZ4) {
+    PADDLE_ENFORCE_GE(in.size(), sizeof(uint32_t));
+    uint32_t raw_size;
+    memcpy(&raw_size, in.data(), sizeof(uint32_t));
+    raw.resize(raw_size);
+    int len =
+        LZ4_decompress_safe(in.data() + sizeof(uint32_t), &raw[0],
+                            static_cast<int>(in.size() - sizeof(uint32_t)),
+                            static_cast<int>(raw_size));
+    PADDLE_ENFORCE_EQ(len, static_cast<int>(raw_size),
+                      "LZ4 decompression failed");
+  } else {
+    unsigned long long raw_size =  // NOLINT
+        ZSTD_getFrameContentSize(in.data(), in.size());
+    PADDLE_ENFORCE(raw_size != ZSTD_CONTENTSIZE_ERROR &&
+                       raw_size != ZSTD_CONTENTSIZE_UNKNOWN,
+                   "invalid Zstd frame");
+    raw.resize(raw_size);
+    size_t len = ZSTD_decompress(&raw[0], raw.size(), in.data(), in.size());
+    PADDLE_ENFORCE(!ZSTD_isError(len), "Zstd decompression failed: %s",
+                   ZSTD_getErrorName(len));
+    PADDLE_ENFORCE_EQ(len, raw.size());
+  }
+  return raw;
+}
+
+bool Chunk::Write(std::ostream& os, Compressor ct, int level) const {
   // NOTE(dzhwinter): don't check records.numBytes instead, because
   // empty records are allowed.
   if (records_.empty()) {
     return false;
   }
+  if (ct == Compressor::kLZ4 || ct == Compressor::kZstd) {
+    std::string raw;
+    raw.reserve(num_bytes_ + records_.size() * sizeof(uint32_t));
+    for (auto& record : records_) {
+      uint32_t sz = static_cast<uint32_t>(record.size());
+      raw.append(reinterpret_cast<const char*>(&sz), sizeof(uint32_t))
+          .append(record);
+    }
+    std::string compressed = CompressBlock(raw, ct, level);
+    uint32_t crc = static_cast<uint32_t>(
+        crc32(crc32(0, nullptr, 0),
+              reinterpret_cast<const Bytef*>(compressed.data()),
+              static_cast<uInt>(compressed.size())));
+    Header hdr(static_cast<uint32_t>(records_.size()), crc, ct,
+               static_cast<uint32_t>(compressed.size()));
+    hdr.Write(os);
+    os.write(compressed.data(), compressed.size());
+    return true;
+  }
   std::stringstream sout;
   std::unique_ptr<std::ostream> compressed_stream;
   switch (ct) {
@@ -148,6 +235,17 @@ bool ChunkParser::Init() {
     case Compressor::kSnappy:
       compressed_stream_.reset(new snappy::iSnappyStream(in_));
       break;
+    case Compressor::kLZ4:
+    case Compressor::kZstd: {
+      std::string compressed;
+      compressed.resize(header_.CompressSize());
+      in_.read(&compressed[0], compressed.size());
+      PADDLE_ENFORCE_EQ(in_.gcount(),
+                        static_cast<std::streamsize>(compressed.size()));
+      compressed_stream_.reset(new std::istringstream(
+          DecompressBlock(compressed, header_.CompressType())));
+      break;
+    }
     default:
       PADDLE_THROW("Not implemented");
   }
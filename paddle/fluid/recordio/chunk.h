@@ -33,7 +33,11 @@ class Chunk {
   }
   // dump the chunk into w, and clears the chunk and makes it ready for
   // the next add invocation.
-  bool Write(std::ostream& fo, Compressor ct) const;
+  //
+  // `level` is used by kLZ4 and kZstd. 0 means the default level of the
+  // compressor. For kLZ4, a positive level selects LZ4HC and a negative level
+  // is the acceleration of the fast mode.
+  bool Write(std::ostream& fo, Compressor ct, int level = 0) const;
   void Clear() {
     records_.clear();
     num_bytes_ = 0;
@@ -66,6 +70,8 @@ class ChunkParser {
   Header header_;
   uint32_t pos_{0};
   std::istream& in_;
+  // Streams decompressing the chunk, or holding the decompressed chunk for
+  // kLZ4 and kZstd whose chunks are compressed as one block.
   std::unique_ptr<std::istream> compressed_stream_;
 };
 
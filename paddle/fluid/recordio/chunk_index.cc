@@ -0,0 +1,132 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/recordio/chunk_index.h"
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/recordio/header.h"
+
+namespace paddle {
+namespace recordio {
+
+// MagicNumber of the index files
+constexpr uint32_t kIndexMagicNumber = 0x01020306;
+
+ChunkIndex ChunkIndex::Build(const char* data, size_t size) {
+  ChunkIndex index;
+  uint64_t pos = 0;
+  while (pos < size) {
+    PADDLE_ENFORCE_LE(pos + kHeaderSize, size, "Truncated chunk header");
+    uint32_t header[5];
+    memcpy(header, data + pos, kHeaderSize);
+    PADDLE_ENFORCE_EQ(header[0], kMagicNumber);
+    index.entries_.push_back(Entry{pos, header[1]});
+    // header: magic, num_records, checksum, compressor, compress_size
+    pos += kHeaderSize + header[4];
+    PADDLE_ENFORCE_LE(pos, size, "Truncated chunk at offset %d",
+                      index.entries_.back().offset);
+  }
+  return index;
+}
+
+bool ChunkIndex::Load(const std::string& filename, uint64_t file_size,
+                      int64_t file_mtime) {
+  std::ifstream fin(filename, std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  uint32_t magic = 0;
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  uint64_t num_chunks = 0;
+  fin.read(reinterpret_cast<char*>(&magic), sizeof(magic))
+      .read(reinterpret_cast<char*>(&size), sizeof(size))
+      .read(reinterpret_cast<char*>(&mtime), sizeof(mtime))
+      .read(reinterpret_cast<char*>(&num_chunks), sizeof(num_chunks));
+  if (!fin || magic != kIndexMagicNumber || size != file_size ||
+      mtime != file_mtime || num_chunks > file_size / kHeaderSize) {
+    return false;
+  }
+  std::vector<Entry> entries(num_chunks);
+  for (auto& entry : entries) {
+    fin.read(reinterpret_cast<char*>(&entry.offset), sizeof(entry.offset))
+        .read(reinterpret_cast<char*>(&entry.num_records),
+              sizeof(entry.num_records));
+  }
+  if (!fin) {
+    return false;
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].offset + kHeaderSize > file_size ||
+        (i > 0 && entries[i].offset <= entries[i - 1].offset)) {
+      return false;
+    }
+  }
+  entries_.swap(entries);
+  return true;
+}
+
+bool ChunkIndex::Save(const std::string& filename, uint64_t file_size,
+                      int64_t file_mtime) const {
+  // Unique to the process and the thread writing it.
+  std::string tmp_filename =
+      filename + ".tmp." + std::to_string(getpid()) + "." +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream fout(tmp_filename, std::ios::binary);
+    if (!fout) {
+      return false;
+    }
+    uint64_t num_chunks = entries_.size();
+    fout.write(reinterpret_cast<const char*>(&kIndexMagicNumber),
+               sizeof(kIndexMagicNumber))
+        .write(reinterpret_cast<const char*>(&file_size), sizeof(file_size))
+        .write(reinterpret_cast<const char*>(&file_mtime), sizeof(file_mtime))
+        .write(reinterpret_cast<const char*>(&num_chunks), sizeof(num_chunks));
+    for (auto& entry : entries_) {
+      fout.write(reinterpret_cast<const char*>(&entry.offset),
+                 sizeof(entry.offset))
+          .write(reinterpret_cast<const char*>(&entry.num_records),
+                 sizeof(entry.num_records));
+    }
+    fout.close();
+    if (!fout) {
+      std::remove(tmp_filename.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+uint64_t ChunkIndex::NumRecords() const {
+  uint64_t num = 0;
+  for (auto& entry : entries_) {
+    num += entry.num_records;
+  }
+  return num;
+}
+
+}  // namespace recordio
+}  // namespace paddle
@@ -0,0 +1,67 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace recordio {
+
+// The size of a chunk Header in a file.
+constexpr size_t kHeaderSize = 5 * sizeof(uint32_t);
+
+// ChunkIndex records where each chunk of a RecordIO file starts, so that a
+// reader can seek to any chunk without parsing the chunks before it.
+//
+// The index is built by walking the chunk headers, which does not touch the
+// records. It can be saved next to the data file as "<file>.index" and is
+// loaded only if it was built from a file of the same size and modification
+// time.
+class ChunkIndex {
+ public:
+  struct Entry {
+    uint64_t offset;  // offset of the chunk header in the file
+    uint32_t num_records;
+  };
+
+  // Builds the index of a RecordIO file held in memory.
+  static ChunkIndex Build(const char* data, size_t size);
+
+  // Returns false if the index file does not exist or it does not belong to
+  // a data file of `file_size` bytes modified at `file_mtime`, in
+  // nanoseconds.
+  bool Load(const std::string& filename, uint64_t file_size,
+            int64_t file_mtime);
+
+  // Returns false if the index file cannot be written. The index is written
+  // to a temporary file renamed to `filename`, so that the readers saving
+  // the index of a file at the same time never load a partial one.
+  bool Save(const std::string& filename, uint64_t file_size,
+            int64_t file_mtime) const;
+
+  size_t NumChunks() const { return entries_.size(); }
+
+  const Entry& operator[](size_t i) const { return entries_[i]; }
+
+  uint64_t NumRecords() const;
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+}  // namespace recordio
+}  // namespace paddle
@@ -45,3 +45,29 @@ TEST(Chunk, Compressor) {
   ch.Parse(ss);
   ASSERT_EQ(ch.NumBytes(), 18ul);
 }
+
+TEST(Chunk, BlockCompressor) {
+  using paddle::recordio::Compressor;
+  for (auto ct : {Compressor::kLZ4, Compressor::kZstd}) {
+    for (int level : {-2, 0, 5}) {
+      paddle::recordio::Chunk ch;
+      ch.Add(std::string("12345", 6));
+      ch.Add(std::string(100, 'a'));
+      ch.Add(std::string());
+      ch.Add(std::string(100, 'b'));
+      std::stringstream ss;
+      ch.Write(ss, ct, level);
+      std::stringstream ss2;
+      ch.Write(ss2, Compressor::kNoCompress);
+      ASSERT_LT(ss.tellp(), ss2.tellp());
+
+      ch.Clear();
+      ASSERT_TRUE(ch.Parse(ss));
+      ASSERT_EQ(ch.NumRecords(), 4UL);
+      ASSERT_EQ(ch.NumBytes(), 206UL);
+      ASSERT_EQ(ch.Record(1), std::string(100, 'a'));
+      ASSERT_EQ(ch.Record(2), std::string());
+      ASSERT_EQ(ch.Record(3), std::string(100, 'b'));
+    }
+  }
+}
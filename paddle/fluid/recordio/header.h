@@ -33,6 +33,11 @@ enum class Compressor : uint32_t {
   // Gzip is a well-known compression algorithm.  It is
   // recommmended only you are looking for compression ratio.
   kGzip = 2,
+  // LZ4 is much faster than snappy in decompression with a similar
+  // compression ratio.
+  kLZ4 = 3,
+  // Zstd gives a ratio close to gzip's at a speed close to snappy's.
+  kZstd = 4,
 };
 
 // Header is the metadata of Chunk
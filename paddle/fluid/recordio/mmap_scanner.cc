@@ -0,0 +1,175 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/recordio/mmap_scanner.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/recordio/chunk.h"
+
+namespace paddle {
+namespace recordio {
+
+RecordViewStream::ViewBuf::ViewBuf(RecordView view) {
+  char* begin = const_cast<char*>(view.data);
+  setg(begin, begin, begin + view.size);
+}
+
+std::streambuf::pos_type RecordViewStream::ViewBuf::seekoff(
+    off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if (!(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+  char* pos = gptr();
+  if (dir == std::ios_base::beg) {
+    pos = eback() + off;
+  } else if (dir == std::ios_base::cur) {
+    pos = gptr() + off;
+  } else {
+    pos = egptr() + off;
+  }
+  if (pos < eback() || pos > egptr()) {
+    return pos_type(off_type(-1));
+  }
+  setg(eback(), pos, egptr());
+  return pos_type(pos - eback());
+}
+
+std::streambuf::pos_type RecordViewStream::ViewBuf::seekpos(
+    pos_type pos, std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+RecordViewStream::RecordViewStream(RecordView view)
+    : std::istream(nullptr), buf_(view) {
+  rdbuf(&buf_);
+}
+
+MmapScanner::MmapScanner(const std::string& filename, size_t shard_id,
+                         size_t num_shards) {
+  PADDLE_ENFORCE_GT(num_shards, 0UL);
+  PADDLE_ENFORCE_LT(shard_id, num_shards);
+  int fd = open(filename.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(fd, -1, "Cannot open file %s", filename);
+  struct stat st;
+  PADDLE_ENFORCE_EQ(fstat(fd, &st), 0, "Cannot stat file %s", filename);
+  size_ = static_cast<size_t>(st.st_size);
+#ifdef __APPLE__
+  int64_t mtime = st.st_mtimespec.tv_sec * 1000000000LL +
+                  st.st_mtimespec.tv_nsec;
+#else
+  int64_t mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+  if (size_ > 0) {
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    PADDLE_ENFORCE(addr != MAP_FAILED, "Cannot mmap file %s", filename);
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(addr);
+  }
+  close(fd);
+
+  std::string index_file = filename + ".index";
+  if (!index_.Load(index_file, size_, mtime)) {
+    index_ = ChunkIndex::Build(data_, size_);
+    if (!index_.Save(index_file, size_, mtime)) {
+      VLOG(3) << "Cannot save the chunk index to " << index_file;
+    }
+  }
+
+  size_t num_chunks = index_.NumChunks();
+  begin_chunk_ = num_chunks * shard_id / num_shards;
+  end_chunk_ = num_chunks * (shard_id + 1) / num_shards;
+  Reset();
+}
+
+MmapScanner::~MmapScanner() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+void MmapScanner::SeekChunk(size_t chunk) {
+  PADDLE_ENFORCE(chunk >= begin_chunk_ && chunk <= end_chunk_,
+                 "Chunk %d is out of the shard [%d, %d)", chunk, begin_chunk_,
+                 end_chunk_);
+  next_chunk_ = chunk;
+  next_record_ = 0;
+  records_.clear();
+}
+
+bool MmapScanner::HasNext() const {
+  return next_record_ < records_.size() || next_chunk_ < end_chunk_;
+}
+
+RecordView MmapScanner::Next() {
+  while (next_record_ == records_.size()) {
+    PADDLE_ENFORCE_LT(next_chunk_, end_chunk_, "No more records");
+    LoadChunk(next_chunk_++);
+  }
+  return records_[next_record_++];
+}
+
+void MmapScanner::LoadChunk(size_t chunk) {
+  records_.clear();
+  decompressed_.clear();
+  next_record_ = 0;
+
+  const char* begin = data_ + index_[chunk].offset;
+  RecordViewStream header_stream(RecordView{begin, kHeaderSize});
+  Header header;
+  PADDLE_ENFORCE(header.Parse(header_stream));
+  const char* payload = begin + kHeaderSize;
+
+  if (header.CompressType() != Compressor::kNoCompress) {
+    // ChunkParser checks and decompresses the chunk.
+    RecordViewStream chunk_stream(
+        RecordView{begin, kHeaderSize + header.CompressSize()});
+    ChunkParser parser(chunk_stream);
+    PADDLE_ENFORCE(parser.Init());
+    while (parser.HasNext()) {
+      decompressed_.emplace_back(parser.Next());
+    }
+    for (auto& record : decompressed_) {
+      records_.push_back(RecordView{record.data(), record.size()});
+    }
+    return;
+  }
+
+  uint32_t crc = static_cast<uint32_t>(
+      crc32(crc32(0, nullptr, 0), reinterpret_cast<const Bytef*>(payload),
+            static_cast<uInt>(header.CompressSize())));
+  PADDLE_ENFORCE_EQ(header.Checksum(), crc);
+  const char* pos = payload;
+  const char* end = payload + header.CompressSize();
+  records_.reserve(header.NumRecords());
+  for (uint32_t i = 0; i < header.NumRecords(); ++i) {
+    uint32_t len;
+    PADDLE_ENFORCE_LE(pos + sizeof(uint32_t), end);
+    memcpy(&len, pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    PADDLE_ENFORCE_LE(pos + len, end);
+    records_.push_back(RecordView{pos, len});
+    pos += len;
+  }
+}
+
+}  // namespace recordio
+}  // namespace paddle
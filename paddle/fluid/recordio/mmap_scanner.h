@@ -0,0 +1,106 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/recordio/chunk_index.h"
+
+namespace paddle {
+namespace recordio {
+
+// A record which is not copied out of the file or the chunk holding it.
+struct RecordView {
+  const char* data;
+  size_t size;
+
+  std::string ToString() const { return std::string(data, size); }
+};
+
+// An std::istream reading the bytes of a RecordView without copying them.
+class RecordViewStream : public std::istream {
+ public:
+  explicit RecordViewStream(RecordView view);
+
+ private:
+  class ViewBuf : public std::streambuf {
+   public:
+    explicit ViewBuf(RecordView view);
+
+   protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+  };
+
+  ViewBuf buf_;
+};
+
+// MmapScanner reads a RecordIO file mapped into memory.
+//
+// Records of uncompressed chunks are returned as views into the mapped file,
+// and records of compressed chunks as views into the decompressed chunk. A
+// view is valid until the scanner moves to the next chunk.
+//
+// The chunks can be divided into `num_shards` contiguous shards, and the
+// scanner only reads the chunks of shard `shard_id`, so that threads and
+// trainers can read different parts of one file.
+class MmapScanner {
+ public:
+  explicit MmapScanner(const std::string& filename, size_t shard_id = 0,
+                       size_t num_shards = 1);
+
+  ~MmapScanner();
+
+  const ChunkIndex& Index() const { return index_; }
+
+  // The chunks of the shard are [BeginChunk(), EndChunk()).
+  size_t BeginChunk() const { return begin_chunk_; }
+  size_t EndChunk() const { return end_chunk_; }
+
+  // Go back to the first chunk of the shard.
+  void Reset() { SeekChunk(begin_chunk_); }
+
+  // Go to the first record of the chunk, which should be in the shard.
+  void SeekChunk(size_t chunk);
+
+  bool HasNext() const;
+
+  RecordView Next();
+
+ private:
+  void LoadChunk(size_t chunk);
+
+  const char* data_{nullptr};
+  size_t size_{0};
+  ChunkIndex index_;
+  size_t begin_chunk_;
+  size_t end_chunk_;
+
+  size_t next_chunk_;
+  size_t next_record_{0};
+  std::vector<RecordView> records_;
+  // The records of the current chunk if it is compressed.
+  std::vector<std::string> decompressed_;
+
+  DISABLE_COPY_AND_ASSIGN(MmapScanner);
+};
+
+}  // namespace recordio
+}  // namespace paddle
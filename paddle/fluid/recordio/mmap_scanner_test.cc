@@ -0,0 +1,159 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/recordio/mmap_scanner.h"
+#include "paddle/fluid/recordio/scanner.h"
+#include "paddle/fluid/recordio/writer.h"
+
+namespace paddle {
+namespace recordio {
+
+static std::string Record(int i) {
+  return "record_" + std::to_string(i) + std::string(i % 7, 'x');
+}
+
+static void WriteFile(const std::string& filename, int num_records,
+                      Compressor compressor, size_t records_per_chunk) {
+  std::ofstream fout(filename, std::ios::binary);
+  Writer writer(&fout, compressor, records_per_chunk);
+  for (int i = 0; i < num_records; ++i) {
+    writer.Write(Record(i));
+  }
+  writer.Flush();
+}
+
+static void ReadAll(MmapScanner* scanner, std::vector<std::string>* records) {
+  while (scanner->HasNext()) {
+    records->push_back(scanner->Next().ToString());
+  }
+}
+
+TEST(MmapScanner, Normal) {
+  for (auto compressor : {Compressor::kNoCompress, Compressor::kSnappy,
+                          Compressor::kLZ4, Compressor::kZstd}) {
+    std::string filename = "/tmp/mmap_scanner_test_normal.recordio";
+    WriteFile(filename, 100, compressor, 7);
+    unlink((filename + ".index").c_str());
+
+    MmapScanner scanner(filename);
+    ASSERT_EQ(scanner.Index().NumChunks(), 15UL);
+    ASSERT_EQ(scanner.Index().NumRecords(), 100UL);
+    std::vector<std::string> records;
+    ReadAll(&scanner, &records);
+    ASSERT_EQ(records.size(), 100UL);
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_EQ(records[i], Record(i));
+    }
+
+    scanner.SeekChunk(3);
+    ASSERT_EQ(scanner.Next().ToString(), Record(21));
+    scanner.Reset();
+    ASSERT_EQ(scanner.Next().ToString(), Record(0));
+
+    // The index saved by the first scanner only matches a file of the same
+    // size and modification time.
+    struct stat st;
+    ASSERT_EQ(stat(filename.c_str(), &st), 0);
+    uint64_t file_size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    int64_t mtime = st.st_mtimespec.tv_sec * 1000000000LL +
+                    st.st_mtimespec.tv_nsec;
+#else
+    int64_t mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    ChunkIndex index;
+    ASSERT_TRUE(index.Load(filename + ".index", file_size, mtime));
+    ASSERT_EQ(index.NumChunks(), 15UL);
+    ASSERT_FALSE(index.Load(filename + ".index", file_size + 1, mtime));
+    ASSERT_FALSE(index.Load(filename + ".index", file_size, mtime + 1));
+    MmapScanner reopened(filename);
+    ASSERT_EQ(reopened.Index().NumChunks(), 15UL);
+    records.clear();
+    ReadAll(&reopened, &records);
+    ASSERT_EQ(records.size(), 100UL);
+  }
+}
+
+TEST(MmapScanner, RecordViewStream) {
+  std::string data = "12 34";
+  RecordViewStream stream(RecordView{data.data(), data.size()});
+  int a = 0, b = 0;
+  stream >> a >> b;
+  ASSERT_EQ(a, 12);
+  ASSERT_EQ(b, 34);
+  stream.clear();
+  stream.seekg(3, std::ios::beg);
+  stream >> a;
+  ASSERT_EQ(a, 34);
+}
+
+TEST(MmapScanner, Shards) {
+  std::string filename = "/tmp/mmap_scanner_test_shards.recordio";
+  WriteFile(filename, 1000, Compressor::kNoCompress, 10);
+  std::vector<std::string> records;
+  const size_t num_shards = 3;
+  for (size_t shard_id = 0; shard_id < num_shards; ++shard_id) {
+    MmapScanner scanner(filename, shard_id, num_shards);
+    ReadAll(&scanner, &records);
+  }
+  ASSERT_EQ(records.size(), 1000UL);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(records[i], Record(i));
+  }
+}
+
+TEST(MmapScanner, DISABLED_Benchmark) {
+  std::string filename = "/tmp/mmap_scanner_test_benchmark.recordio";
+  const int num_records = 100000;
+  WriteFile(filename, num_records, Compressor::kNoCompress, 1000);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t bytes = 0;
+  {
+    std::unique_ptr<std::istream> stream(
+        new std::ifstream(filename, std::ios::binary));
+    Scanner scanner(std::move(stream));
+    while (scanner.HasNext()) {
+      bytes += scanner.Next().size();
+    }
+  }
+  auto mid = std::chrono::steady_clock::now();
+  size_t view_bytes = 0;
+  {
+    MmapScanner scanner(filename);
+    while (scanner.HasNext()) {
+      view_bytes += scanner.Next().size;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  ASSERT_EQ(bytes, view_bytes);
+  LOG(INFO) << "Scanner: "
+            << std::chrono::duration<double, std::milli>(mid - start).count()
+            << " ms, MmapScanner: "
+            << std::chrono::duration<double, std::milli>(end - mid).count()
+            << " ms for " << num_records << " records";
+}
+
+}  // namespace recordio
+}  // namespace paddle
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "paddle/fluid/recordio/writer.h"
 
+#include <sstream>
 #include <string>
 
 #include "paddle/fluid/platform/enforce.h"
@@ -20,20 +21,69 @@
 namespace paddle {
 namespace recordio {
 
+Writer::Writer(std::ostream* sout, Compressor compressor,
+               size_t max_num_records_in_chunk, int compress_level,
+               size_t num_compress_threads)
+    : stream_(*sout),
+      max_num_records_in_chunk_(max_num_records_in_chunk),
+      cur_chunk_(new Chunk),
+      compressor_(compressor),
+      compress_level_(compress_level) {
+  if (num_compress_threads > 0) {
+    compress_pool_.reset(new ::ThreadPool(num_compress_threads));
+    max_compressing_chunks_ = 2 * num_compress_threads;
+  }
+}
+
 void Writer::Write(const std::string& record) {
-  cur_chunk_.Add(record);
-  if (cur_chunk_.NumRecords() >= max_num_records_in_chunk_) {
-    Flush();
+  cur_chunk_->Add(record);
+  if (cur_chunk_->NumRecords() >= max_num_records_in_chunk_) {
+    WriteChunk();
+  }
+}
+
+void Writer::WriteChunk() {
+  if (!compress_pool_) {
+    cur_chunk_->Write(stream_, compressor_, compress_level_);
+    cur_chunk_->Clear();
+    return;
   }
+  if (cur_chunk_->Empty()) {
+    return;
+  }
+  while (compressing_chunks_.size() >= max_compressing_chunks_) {
+    WriteCompressedChunk();
+  }
+  std::shared_ptr<Chunk> chunk(cur_chunk_.release());
+  cur_chunk_.reset(new Chunk);
+  Compressor compressor = compressor_;
+  int level = compress_level_;
+  compressing_chunks_.emplace_back(
+      compress_pool_->enqueue([chunk, compressor, level] {
+        std::ostringstream sout;
+        chunk->Write(sout, compressor, level);
+        return sout.str();
+      }));
+}
+
+void Writer::WriteCompressedChunk() {
+  std::string data = compressing_chunks_.front().get();
+  compressing_chunks_.pop_front();
+  stream_.write(data.data(), data.size());
 }
 
 void Writer::Flush() {
-  cur_chunk_.Write(stream_, compressor_);
-  cur_chunk_.Clear();
+  WriteChunk();
+  while (!compressing_chunks_.empty()) {
+    WriteCompressedChunk();
+  }
 }
 
 Writer::~Writer() {
-  PADDLE_ENFORCE(cur_chunk_.Empty(), "Writer must be flushed when destroy.");
+  while (!compressing_chunks_.empty()) {
+    WriteCompressedChunk();
+  }
+  PADDLE_ENFORCE(cur_chunk_->Empty(), "Writer must be flushed when destroy.");
 }
 
 }  // namespace recordio
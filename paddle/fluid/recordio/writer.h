@@ -13,31 +13,49 @@
 // limitations under the License.
 #pragma once
 
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
 #include <string>
 
+#include "ThreadPool.h"
 #include "paddle/fluid/recordio/chunk.h"
 namespace paddle {
 namespace recordio {
 
 class Writer {
  public:
+  // `compress_level` is passed to Chunk::Write. If `num_compress_threads` is
+  // positive, full chunks are compressed by a pool of that many threads while
+  // the caller keeps writing records, and they are written to the stream in
+  // order. At most twice as many chunks as threads are compressed at a time.
   Writer(std::ostream* sout, Compressor compressor,
-         size_t max_num_records_in_chunk = 1000)
-      : stream_(*sout),
-        max_num_records_in_chunk_(max_num_records_in_chunk),
-        compressor_(compressor) {}
+         size_t max_num_records_in_chunk = 1000, int compress_level = 0,
+         size_t num_compress_threads = 0);
 
   void Write(const std::string& record);
 
+  // Writes the current chunk and waits for all chunks to be written.
   void Flush();
 
   ~Writer();
 
  private:
+  // Writes the current chunk, or hands it to the compressing threads.
+  void WriteChunk();
+
+  // Writes the oldest chunk handed to the compressing threads.
+  void WriteCompressedChunk();
+
   std::ostream& stream_;
   size_t max_num_records_in_chunk_;
-  Chunk cur_chunk_;
+  std::unique_ptr<Chunk> cur_chunk_;
   Compressor compressor_;
+  int compress_level_;
+
+  std::unique_ptr<::ThreadPool> compress_pool_;
+  size_t max_compressing_chunks_{0};
+  std::deque<std::future<std::string>> compressing_chunks_;
 };
 
 }  // namespace recordio
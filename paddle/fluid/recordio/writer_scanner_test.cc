@@ -12,9 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>  // NOLINT
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/recordio/scanner.h"
 #include "paddle/fluid/recordio/writer.h"
@@ -68,3 +72,97 @@ TEST(WriterScanner, TinyChunk) {
     ASSERT_FALSE(scanner.HasNext());
   }
 }
+
+static std::string TestRecord(int i) {
+  return "record " + std::to_string(i) + std::string(i % 13, 'x') +
+         std::to_string(i * 7919);
+}
+
+TEST(WriterScanner, ParallelCompress) {
+  using paddle::recordio::Compressor;
+  for (auto ct : {Compressor::kNoCompress, Compressor::kSnappy,
+                  Compressor::kLZ4, Compressor::kZstd}) {
+    std::stringstream expected;
+    {
+      paddle::recordio::Writer writer(&expected, ct, 10);
+      for (int i = 0; i < 1000; ++i) {
+        writer.Write(TestRecord(i));
+      }
+      writer.Flush();
+    }
+
+    std::stringstream* stream = new std::stringstream();
+    {
+      paddle::recordio::Writer writer(stream, ct, 10, 0,
+                                      3 /*num compress threads*/);
+      for (int i = 0; i < 1000; ++i) {
+        writer.Write(TestRecord(i));
+      }
+      writer.Flush();
+      // A full chunk is handed to the compressing threads without Flush, and
+      // written when the writer is destroyed.
+      for (int i = 1000; i < 1010; ++i) {
+        writer.Write(TestRecord(i));
+      }
+    }
+    ASSERT_EQ(stream->str().substr(0, expected.str().size()),
+              expected.str());
+
+    stream->seekg(0, std::ios::beg);
+    std::unique_ptr<std::istream> stream_ptr(stream);
+    paddle::recordio::Scanner scanner(std::move(stream_ptr));
+    for (int i = 0; i < 1010; ++i) {
+      ASSERT_TRUE(scanner.HasNext());
+      ASSERT_EQ(scanner.Next(), TestRecord(i));
+    }
+    ASSERT_FALSE(scanner.HasNext());
+  }
+}
+
+TEST(WriterScanner, DISABLED_CompressorBenchmark) {
+  using paddle::recordio::Compressor;
+  const int num_records = 20000;
+  std::vector<std::pair<std::string, Compressor>> compressors = {
+      {"none", Compressor::kNoCompress},
+      {"snappy", Compressor::kSnappy},
+      {"lz4", Compressor::kLZ4},
+      {"zstd", Compressor::kZstd}};
+  size_t raw_bytes = 0;
+  for (int i = 0; i < num_records; ++i) {
+    raw_bytes += TestRecord(i).size();
+  }
+  for (auto& compressor : compressors) {
+    for (size_t threads : {0, 4}) {
+      std::stringstream* stream = new std::stringstream();
+      auto start = std::chrono::steady_clock::now();
+      {
+        paddle::recordio::Writer writer(stream, compressor.second, 1000, 0,
+                                        threads);
+        for (int i = 0; i < num_records; ++i) {
+          writer.Write(TestRecord(i));
+        }
+        writer.Flush();
+      }
+      auto written = std::chrono::steady_clock::now();
+      size_t file_bytes = stream->str().size();
+      stream->seekg(0, std::ios::beg);
+      std::unique_ptr<std::istream> stream_ptr(stream);
+      paddle::recordio::Scanner scanner(std::move(stream_ptr));
+      int n = 0;
+      while (scanner.HasNext()) {
+        scanner.Next();
+        ++n;
+      }
+      auto read = std::chrono::steady_clock::now();
+      ASSERT_EQ(n, num_records);
+      auto mb_per_sec = [raw_bytes](std::chrono::steady_clock::duration d) {
+        return raw_bytes / std::chrono::duration<double>(d).count() / 1e6;
+      };
+      LOG(INFO) << compressor.first << " with " << threads
+                << " threads: ratio "
+                << static_cast<double>(file_bytes) / raw_bytes << ", write "
+                << mb_per_sec(written - start) << " MB/s, read "
+                << mb_per_sec(read - written) << " MB/s";
+    }
+  }
+}
@@ -196,7 +196,12 @@ def save_vars(executor,
                 type='save_combine',
                 inputs={'X': save_var_list},
                 outputs={},
-                attrs={'file_path': os.path.join(dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(dirname, filename),
+                    # Align the data, so that the file can be mapped into
+                    # memory by load_combine when loading for inference.
+                    'data_alignment': 64
+                })
 
         executor.run(save_program)
 
@@ -728,7 +728,10 @@ def open_files(filenames,
                thread_num=None,
                buffer_size=None,
                pass_num=1,
-               is_test=None):
+               is_test=None,
+               num_shards=1,
+               shard_id=0,
+               readers_per_file=1):
     """
     Open files
 
@@ -749,6 +752,12 @@ def open_files(filenames,
             is used for testing, the order of data generated is same as the file
             order. Otherwise, it is not guaranteed the order of data is same
             between every epoch. [Default: False].
+       num_shards(int): The chunks of each file are divided into num_shards
+            contiguous shards, e.g. one for each trainer. [Default: 1].
+       shard_id(int): The shard of the chunks read by this reader.
+            [Default: 0].
+       readers_per_file(int): The number of readers which read the shard of
+            a file in parallel. [Default: 1].
 
     Returns:
        Variable: A Reader Variable via which we can get file data.
@@ -794,7 +803,10 @@ def open_files(filenames,
         'ranks': ranks,
         'file_names': filenames,
         'thread_num': thread_num,
-        'buffer_size': buffer_size
+        'buffer_size': buffer_size,
+        'num_shards': num_shards,
+        'shard_id': shard_id,
+        'readers_per_file': readers_per_file
     }
     if is_test is not None:
         attrs['is_test'] = is_test
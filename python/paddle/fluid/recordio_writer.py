@@ -25,8 +25,11 @@ __all__ = [
 @contextlib.contextmanager
 def create_recordio_writer(filename,
                            compressor=core.RecordIOWriter.Compressor.Snappy,
-                           max_num_records=1000):
-    writer = core.RecordIOWriter(filename, compressor, max_num_records)
+                           max_num_records=1000,
+                           compress_level=0,
+                           num_compress_threads=0):
+    writer = core.RecordIOWriter(filename, compressor, max_num_records,
+                                 compress_level, num_compress_threads)
     yield writer
     writer.close()
 
@@ -37,7 +40,9 @@ def convert_reader_to_recordio_file(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        compress_level=0,
+        num_compress_threads=0):
     """
     Convert a Python Reader to a recordio file.
 
@@ -67,12 +72,15 @@ def convert_reader_to_recordio_file(
             :ref:`api_guide_python_reader`.
         feeder(DataFeeder): The DataFeeder instance. Used to convert
             :code:`reader_creator` to :code: `lod_tensor`
-        compressor: Must in fluid.core.RecordIOWriter.Compressor.Snappy or
-            fluid.core.RecordIOWriter.Compressor.NoCompress. Use :code:`Snappy`
-            by default.
+        compressor: One of fluid.core.RecordIOWriter.Compressor.Snappy,
+            LZ4, Zstd or NoCompress. Use :code:`Snappy` by default.
         max_num_records(int): Maximum number of records in one chuck. Each record
             is each return value from reader function
         feed_order(list): The order of variable names that the reader returns
+        compress_level(int): The level of LZ4 or Zstd. 0 means the default
+            level of the compressor.
+        num_compress_threads(int): The number of threads compressing chunks
+            in background. 0 means compressing in the calling thread.
 
     Returns:
         int: the number of record that saved.
@@ -80,8 +88,9 @@ def convert_reader_to_recordio_file(
     if feed_order is None:
         feed_order = feeder.feed_names
     counter = 0
-    with create_recordio_writer(filename, compressor,
-                                max_num_records) as writer:
+    with create_recordio_writer(filename, compressor, max_num_records,
+                                compress_level,
+                                num_compress_threads) as writer:
         for batch in reader_creator():
             res = feeder.feed(batch)
             for each in feed_order:
@@ -98,7 +107,9 @@ def convert_reader_to_recordio_files(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        compress_level=0,
+        num_compress_threads=0):
     """
     convert a python reader to many recordio files.
 
@@ -123,7 +134,8 @@ def convert_reader_to_recordio_files(
         if idx >= batch_per_file and idx % batch_per_file == 0:
             filename = "%s-%05d%s" % (f_name, f_idx, f_ext)
             with create_recordio_writer(filename, compressor,
-                                        max_num_records) as writer:
+                                        max_num_records, compress_level,
+                                        num_compress_threads) as writer:
                 for l in lines:
                     res = feeder.feed(l)
                     for each in feed_order:
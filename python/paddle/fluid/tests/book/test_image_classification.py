@@ -17,6 +17,7 @@ from __future__ import print_function
 import paddle
 import paddle.fluid as fluid
 import contextlib
+import itertools
 import math
 import sys
 import numpy
@@ -25,6 +26,20 @@ import os
 import numpy as np
 
 
+def save_test_samples(reader, dirname, num=256):
+    """
+    Dump the first num CIFAR test images and labels into the model
+    directory, for the int8 calibrator tester.
+    """
+    samples = list(itertools.islice(reader(), num))
+    images = numpy.array([s[0] for s in samples], dtype="float32")
+    labels = numpy.array([s[1] for s in samples], dtype="int64")
+    with open(os.path.join(dirname, "test_samples"), "wb") as f:
+        numpy.array(images.shape, dtype="int64").tofile(f)
+        images.tofile(f)
+        labels.tofile(f)
+
+
 def resnet_cifar10(input, depth=32):
     def conv_bn_layer(input,
                       ch_out,
@@ -173,6 +188,8 @@ def train(net_type, use_cuda, save_dirname, is_local):
                     if acc_value > 0.01:  # Low threshold for speeding up CI
                         fluid.io.save_inference_model(save_dirname, ["pixel"],
                                                       [predict], exe)
+                        save_test_samples(paddle.dataset.cifar.test10(),
+                                          save_dirname)
                         return
 
     if is_local:
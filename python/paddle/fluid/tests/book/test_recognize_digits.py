@@ -15,6 +15,7 @@
 from __future__ import print_function
 
 import paddle.fluid.core as core
+import itertools
 import math
 import os
 import sys
@@ -29,6 +30,20 @@ from paddle.fluid.layers.device import get_places
 BATCH_SIZE = 64
 
 
+def save_test_samples(reader, dirname, num=256):
+    """
+    Dump the first num MNIST test images, scaled to [-1, 1] by the reader,
+    and their labels into the model directory for the C++ inference tests.
+    """
+    samples = list(itertools.islice(reader(), num))
+    images = numpy.array([s[0] for s in samples], dtype="float32")
+    labels = numpy.array([s[1] for s in samples], dtype="int64")
+    with open(os.path.join(dirname, "test_samples"), "wb") as f:
+        numpy.array(images.shape, dtype="int64").tofile(f)
+        images.tofile(f)
+        labels.tofile(f)
+
+
 def loss_net(hidden, label):
     prediction = fluid.layers.fc(input=hidden, size=10, act='softmax')
     loss = fluid.layers.cross_entropy(input=prediction, label=label)
@@ -142,6 +157,8 @@ def train(nn_type,
                                 exe,
                                 model_filename=model_filename,
                                 params_filename=params_filename)
+                            save_test_samples(paddle.dataset.mnist.test(),
+                                              save_dirname)
                         return
                     else:
                         print(
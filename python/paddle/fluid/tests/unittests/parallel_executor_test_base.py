@@ -39,7 +39,8 @@ class TestParallelExecutorBase(unittest.TestCase):
                                   use_parallel_executor=True,
                                   use_reduce=False,
                                   optimizer=fluid.optimizer.Adam,
-                                  use_fast_executor=False):
+                                  use_fast_executor=False,
+                                  fuse_all_reduce_ops=False):
         def run_executor(exe, feed, fetch_list, program=None):
             if isinstance(exe, fluid.ParallelExecutor):
                 res = exe.run(fetch_list=fetch_list, feed=feed)
@@ -78,6 +79,7 @@ class TestParallelExecutorBase(unittest.TestCase):
             build_strategy = fluid.BuildStrategy()
             build_strategy.reduce_strategy = fluid.BuildStrategy.ReduceStrategy.Reduce \
                 if use_reduce else fluid.BuildStrategy.ReduceStrategy.AllReduce
+            build_strategy.fuse_all_reduce_ops = fuse_all_reduce_ops
 
             if use_parallel_executor:
                 exe = fluid.ParallelExecutor(
@@ -232,6 +232,32 @@ class TestNoSliceVar(TranspilerTest):
         self.assertEqual(fc_w_var.shape, (1000, 1000))
 
 
+class TestGradCompression(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.grad_compression = {"fc_w": "topk"}
+        config.compress_ratio = 0.05
+
+        trainer, _ = self.get_trainer(config)
+        send_ops = [op for op in trainer.global_block().ops if op.type == "send"]
+        compress = dict((op.attr("op_role_var")[0], op.attr("compress_type"))
+                        for op in send_ops)
+        self.assertEqual(compress, {"fc_w": "topk", "fc_b": ""})
+        for op in send_ops:
+            self.assertAlmostEqual(op.attr("compress_ratio"), 0.05)
+
+
+class TestPipelinedPserver(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.pipelined_pserver = True
+
+        pserver, _ = self.get_pserver(self.pserver1_ep, config)
+        listen_op = pserver.global_block().ops[-1]
+        self.assertEqual(listen_op.type, "listen_and_serv")
+        self.assertTrue(listen_op.attr("pipelined"))
+
+
 class TestLRDecay(TranspilerTest):
     def net_conf(self):
         x = fluid.layers.data(name='x', shape=[1000], dtype='float32')
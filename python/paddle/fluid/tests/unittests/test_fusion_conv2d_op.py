@@ -0,0 +1,123 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_conv2d_op import conv2d_forward_naive
+
+
+class TestFusionConv2DOp(OpTest):
+    def setUp(self):
+        self.op_type = "fusion_conv2d"
+        self.input_size = [2, 3, 5, 5]
+        self.groups = 1
+        self.stride = [1, 1]
+        self.pad = [0, 0]
+        self.dilations = [1, 1]
+        self.filter_hw = [3, 3]
+        self.out_channels = 6
+        self.with_bias = True
+        self.with_residual = True
+        self.activation = 'relu'
+        self.set_conf()
+
+        f_c = self.input_size[1] // self.groups
+        filter_size = [self.out_channels, f_c] + self.filter_hw
+        conv2d_param = {
+            'stride': self.stride,
+            'pad': self.pad,
+            'dilation': self.dilations
+        }
+        input = np.random.uniform(-1, 1, self.input_size).astype("float32")
+        filter = np.random.uniform(-1, 1, filter_size).astype("float32")
+        output = conv2d_forward_naive(input, filter, self.groups,
+                                      conv2d_param)
+
+        self.inputs = {'Input': input, 'Filter': filter}
+        if self.with_bias:
+            bias = np.random.uniform(-1, 1,
+                                     [self.out_channels]).astype("float32")
+            self.inputs['Bias'] = bias
+            output = output + bias.reshape([1, self.out_channels, 1, 1])
+        if self.with_residual:
+            residual = np.random.uniform(-1, 1,
+                                         output.shape).astype("float32")
+            self.inputs['ResidualData'] = residual
+            output = output + residual
+        if self.activation == 'relu':
+            output = np.maximum(output, 0.)
+
+        self.attrs = {
+            'strides': self.stride,
+            'paddings': self.pad,
+            'groups': self.groups,
+            'dilations': self.dilations,
+            'activation': self.activation
+        }
+        self.outputs = {'Output': output.astype("float32")}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionConv2DOpPaddingStride(TestFusionConv2DOp):
+    def set_conf(self):
+        self.input_size = [2, 3, 7, 6]
+        self.stride = [2, 2]
+        self.pad = [1, 1]
+
+
+class TestFusionConv2DOpGroups(TestFusionConv2DOp):
+    def set_conf(self):
+        self.input_size = [2, 4, 6, 6]
+        self.groups = 2
+        self.pad = [1, 1]
+
+
+class TestFusionConv2DOpDilation(TestFusionConv2DOp):
+    def set_conf(self):
+        self.input_size = [2, 3, 8, 8]
+        self.dilations = [2, 2]
+
+
+class TestFusionConv2DOpNoExpand(TestFusionConv2DOp):
+    def set_conf(self):
+        # A 1x1 filter with stride 1 and no padding reads the input as it is.
+        self.input_size = [2, 4, 5, 5]
+        self.filter_hw = [1, 1]
+        self.groups = 2
+
+
+class TestFusionConv2DOpBiasOnly(TestFusionConv2DOp):
+    def set_conf(self):
+        self.groups = 3
+        self.out_channels = 3
+        self.with_residual = False
+        self.activation = 'identity'
+
+
+class TestFusionConv2DOpResidualOnly(TestFusionConv2DOp):
+    def set_conf(self):
+        self.stride = [2, 1]
+        self.with_bias = False
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,60 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def sigmoid(x):
+    return 1. / (1. + np.exp(-x))
+
+
+class TestFusionElemwiseChainOp(OpTest):
+    def setUp(self):
+        self.op_type = "fusion_elemwise_chain"
+        self.shape = (5, 17)
+        self.set_conf()
+        x = np.random.uniform(-2, 2, self.shape).astype("float32")
+        y = np.random.uniform(-2, 2, self.shape).astype("float32")
+        z = np.random.uniform(-2, 2, self.shape).astype("float32")
+        # x - tanh(relu(z * sigmoid(2 * x + y)))
+        out = x - np.tanh(np.maximum(z * sigmoid(2. * x + y), 0.))
+        self.inputs = {'X': [('x', x), ('y', y), ('z', z)]}
+        self.attrs = {
+            'functors': [
+                'scale', 'elementwise_add', 'sigmoid', 'elementwise_mul',
+                'relu', 'tanh', 'elementwise_sub'
+            ],
+            'operands': [0, 1, 0, -3, 0, 0, -1],
+            'scales': [2., 1., 1., 1., 1., 1., 1.]
+        }
+        self.outputs = {'Out': out}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionElemwiseChainOpMultiBlocks(TestFusionElemwiseChainOp):
+    def set_conf(self):
+        self.shape = (3, 1000)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,62 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestFusionEmbeddingSeqPoolOp(OpTest):
+    def setUp(self):
+        self.op_type = "fusion_embedding_seq_pool"
+        self.padding_idx = -1
+        self.set_conf()
+        table = np.random.random((17, 31)).astype("float32")
+        lod = [[4, 1, 3, 3]]
+        ids = np.random.randint(0, 17, (11, 1)).astype("int64")
+        out = np.zeros((len(lod[0]), 31)).astype("float32")
+        begin = 0
+        for i, seq_len in enumerate(lod[0]):
+            for j in range(begin, begin + seq_len):
+                if ids[j][0] != self.padding_idx:
+                    out[i] += table[ids[j][0]]
+            begin += seq_len
+        self.inputs = {'W': table, 'Ids': (ids, lod)}
+        self.attrs = {'padding_idx': self.padding_idx}
+        self.outputs = {'Out': out}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['W'], 'Out', no_grad_set=set('Ids'))
+
+
+class TestFusionEmbeddingSeqPoolOpWithPadding(TestFusionEmbeddingSeqPoolOp):
+    def set_conf(self):
+        self.padding_idx = 3
+
+    def test_check_grad(self):
+        # Since paddings are not trainable and fixed in forward, the gradient of
+        # paddings makes no sense and we don't test the gradient here.
+        pass
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -163,6 +163,35 @@ class TestMNIST(TestParallelExecutorBase):
         self._compare_reduce_and_allreduce(simple_fc_net, True)
         self._compare_reduce_and_allreduce(simple_fc_net, False)
 
+    def _compare_fused_and_unfused_all_reduce(self, model, use_cuda):
+        if use_cuda and not core.is_compiled_with_cuda():
+            return
+
+        img, label = self._init_data()
+
+        first_loss, last_loss = self.check_network_convergence(
+            model,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            fuse_all_reduce_ops=False)
+        fused_first_loss, fused_last_loss = self.check_network_convergence(
+            model,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            fuse_all_reduce_ops=True)
+
+        for loss in zip(first_loss, fused_first_loss):
+            self.assertAlmostEqual(loss[0], loss[1], delta=1e-6)
+        for loss in zip(last_loss, fused_last_loss):
+            self.assertAlmostEqual(loss[0], loss[1], delta=1e-4)
+
+    def test_simple_fc_with_fused_all_reduce(self):
+        # use_cuda
+        self._compare_fused_and_unfused_all_reduce(simple_fc_net, True)
+        self._compare_fused_and_unfused_all_reduce(simple_fc_net, False)
+
     def check_simple_fc_parallel_accuracy(self, use_cuda):
         if use_cuda and not core.is_compiled_with_cuda():
             return
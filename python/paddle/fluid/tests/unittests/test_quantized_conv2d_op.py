@@ -0,0 +1,100 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_conv2d_op import conv2d_forward_naive
+from test_quantized_fc_op import quantize_input, quantize_weight
+
+
+class TestQuantizedConv2DOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantized_conv2d"
+        self.pad = [0, 0]
+        self.stride = [1, 1]
+        self.dilation = [1, 1]
+        self.groups = 1
+        self.low = 0.
+        self.per_channel = True
+        self.init_test_case()
+
+        x = np.random.uniform(self.low, 1., self.input_size).astype("float32")
+        f = np.random.uniform(-1., 1., self.filter_size).astype("float32")
+        out_c = self.filter_size[0]
+        if self.per_channel:
+            weight_scale = np.abs(f.reshape(out_c, -1)).max(axis=1)
+        else:
+            weight_scale = np.array([np.abs(f).max()])
+        weight_scale = weight_scale.astype("float32")
+        qf = quantize_weight(
+            f.reshape(out_c, -1), np.broadcast_to(weight_scale, out_c))
+        qf = qf.reshape(self.filter_size)
+        input_scale = float(np.abs(x).max())
+        is_unsigned = self.low >= 0.
+
+        # The convolution of the quantized values is exact in float64.
+        qx, factor = quantize_input(x, input_scale, is_unsigned)
+        conv_param = {
+            'stride': self.stride,
+            'pad': self.pad,
+            'dilation': self.dilation
+        }
+        acc = conv2d_forward_naive(qx, qf.astype("float64"), self.groups,
+                                   conv_param)
+        scale = np.broadcast_to(weight_scale, out_c) / 127. / factor
+        out = acc * scale.reshape(1, -1, 1, 1)
+
+        self.inputs = {'Input': x, 'Filter': qf}
+        self.attrs = {
+            'strides': self.stride,
+            'paddings': self.pad,
+            'dilations': self.dilation,
+            'groups': self.groups,
+            'input_scale': input_scale,
+            'input_is_unsigned': is_unsigned,
+            'weight_scale': weight_scale.tolist()
+        }
+        self.outputs = {'Output': out.astype("float32")}
+
+    def init_test_case(self):
+        self.input_size = [2, 3, 5, 5]
+        self.filter_size = [6, 3, 3, 3]
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestQuantizedConv2DOpWithPad(TestQuantizedConv2DOp):
+    def init_test_case(self):
+        self.input_size = [2, 3, 5, 5]
+        self.filter_size = [6, 3, 3, 3]
+        self.pad = [1, 1]
+        self.low = -1.
+        self.per_channel = False
+
+
+class TestQuantizedConv2DOpWithGroup(TestQuantizedConv2DOp):
+    def init_test_case(self):
+        self.input_size = [2, 4, 7, 6]
+        self.filter_size = [6, 2, 3, 3]
+        self.pad = [1, 2]
+        self.stride = [2, 1]
+        self.dilation = [1, 2]
+        self.groups = 2
+        self.low = -1.
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,107 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def round_half_away(x):
+    return np.sign(x) * np.floor(np.abs(x) + 0.5)
+
+
+def quantize_weight(w, scale):
+    # w in (O, K), scale of every row.
+    q = round_half_away(w * (127. / scale).reshape(-1, 1).astype("float32"))
+    return np.clip(q, -127, 127).astype("int8")
+
+
+def quantize_input(x, scale, is_unsigned):
+    upper = 255. if is_unsigned else 127.
+    factor = np.float32(upper / scale)
+    q = round_half_away(x.astype("float32") * factor)
+    return np.clip(q, 0. if is_unsigned else -127., upper), factor
+
+
+def quantized_fc_refer(x, qw, bias, input_scale, is_unsigned, weight_scale):
+    qx, factor = quantize_input(x, input_scale, is_unsigned)
+    acc = np.dot(qx.reshape(x.shape[0], -1), qw.astype("float64").T)
+    out = acc * (weight_scale / 127.) / factor
+    if bias is not None:
+        out = out + bias.reshape(1, -1)
+    return out.astype("float32")
+
+
+class TestQuantizedFCOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantized_fc"
+        self.init_test_case()
+        x = np.random.uniform(self.low, 1., self.x_shape).astype("float32")
+        k = int(np.prod(self.x_shape[1:]))
+        w = np.random.uniform(-1., 1., (self.out_size, k)).astype("float32")
+        if self.per_channel:
+            weight_scale = np.abs(w).max(axis=1)
+        else:
+            weight_scale = np.array([np.abs(w).max()])
+        weight_scale = weight_scale.astype("float32")
+        qw = quantize_weight(w, np.broadcast_to(weight_scale, self.out_size))
+        input_scale = float(np.abs(x).max())
+        is_unsigned = self.low >= 0.
+
+        self.inputs = {'Input': x, 'W': qw}
+        bias = None
+        if self.with_bias:
+            bias = np.random.random((1, self.out_size)).astype("float32")
+            self.inputs['Bias'] = bias
+        self.attrs = {
+            'input_scale': input_scale,
+            'input_is_unsigned': is_unsigned,
+            'weight_scale': weight_scale.tolist()
+        }
+        self.outputs = {
+            'Out': quantized_fc_refer(x, qw, bias, input_scale, is_unsigned,
+                                      weight_scale)
+        }
+
+    def init_test_case(self):
+        self.x_shape = (3, 37)
+        self.out_size = 19
+        self.low = 0.
+        self.per_channel = True
+        self.with_bias = True
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestQuantizedFCOpSigned(TestQuantizedFCOp):
+    def init_test_case(self):
+        self.x_shape = (5, 2, 3, 3)
+        self.out_size = 8
+        self.low = -1.
+        self.per_channel = False
+        self.with_bias = False
+
+
+class TestQuantizedFCOpLarge(TestQuantizedFCOp):
+    def init_test_case(self):
+        self.x_shape = (2, 300)
+        self.out_size = 65
+        self.low = -1.
+        self.per_channel = True
+        self.with_bias = True
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -122,11 +122,21 @@ class DistributeTranspilerConfig(object):
         According:https://github.com/PaddlePaddle/Paddle/issues/8638#issuecomment-369912156
         We can use bandwidth effiently when data size is larger than 2MB.If you
         want to change it, please be sure you see the slice_variable function.
+    grad_compression (dict): Maps parameter names to how their FP32 gradients
+        are compressed when sent to pservers: "topk", "fp16" or "int8". What
+        is not sent is kept by the trainer and added to the next gradient.
+    compress_ratio (float): The fraction of the gradient sent by "topk".
+    pipelined_pserver (bool): In sync mode, let pservers run the optimize
+        block of a parameter once its gradients are received from all the
+        trainers, and send the parameter back without waiting for the others.
     """
 
     slice_var_up = True
     split_method = None
     min_block_size = 8192
+    grad_compression = None
+    compress_ratio = 0.01
+    pipelined_pserver = False
 
 
 class DistributeTranspiler(object):
@@ -273,6 +283,10 @@ class DistributeTranspiler(object):
                 name=framework.generate_control_dev_var_name())
             grad_name_to_send_dummy_out[grad_varname] = dummy_output
 
+            param_name = self.grad_name_to_param_name[grad_varname]
+            compress_type = (self.config.grad_compression or
+                             {}).get(param_name, "")
+
             # get send op_role_var, if not splited, the grad should have .trainer suffix
             # if splited, grad should be the original grad var name (split_by_ref and send
             # will be on the same place). ParallelExecutor
@@ -285,11 +299,10 @@ class DistributeTranspiler(object):
                 attrs={
                     "epmap": eplist,
                     RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
-                    OP_ROLE_VAR_ATTR_NAME: [
-                        self.grad_name_to_param_name[grad_varname],
-                        splited_grad_varname
-                    ],
+                    OP_ROLE_VAR_ATTR_NAME: [param_name, splited_grad_varname],
                     "sync_mode": not self.sync_mode,
+                    "compress_type": compress_type,
+                    "compress_ratio": self.config.compress_ratio,
                 })
             for _, var in enumerate(splited_vars):
                 send_vars.append(var)
@@ -661,6 +674,7 @@ class DistributeTranspiler(object):
             "endpoint": endpoint,
             "Fanin": self.trainer_num,
             "sync_mode": self.sync_mode,
+            "pipelined": self.sync_mode and self.config.pipelined_pserver,
             "grad_to_block_id": grad_to_block_id,
         }
         if len(prefetch_var_name_to_block_id) > 0: